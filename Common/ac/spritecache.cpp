@@ -12,6 +12,12 @@
 //
 //=============================================================================
 #include "ac/spritecache.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 #include "ac/gamestructdefines.h"
 #include "debug/out.h"
 #include "gfx/bitmap.h"
@@ -40,11 +46,32 @@ namespace AGS
 namespace Common
 {
 
+struct SpriteCache::PrefetchState
+{
+    std::thread Thread;
+    bool Running = false;
+    // Guards the request and result lists
+    std::mutex Mutex;
+    // Signals that either new requests were added or a sprite was loaded
+    std::condition_variable Cond;
+    // Guards the sprite file, which is shared with the main thread
+    std::mutex FileMutex;
+    // Sprites waiting to be loaded
+    std::deque<sprkey_t> Queue;
+    // Sprite which is being loaded right now
+    sprkey_t InFlight = -1;
+    // Loaded sprites, waiting to be put into cache;
+    // a null bitmap means that the sprite failed to load
+    std::vector<std::pair<sprkey_t, std::unique_ptr<Bitmap>>> Ready;
+    std::atomic<bool> HasReady{ false };
+};
+
 SpriteCache::SpriteCache(std::vector<SpriteInfo> &sprInfos)
     : _sprInfos(sprInfos)
     , _maxCacheSize(DEFAULTCACHESIZE_KB * 1024u)
     , _cacheSize(0u)
     , _lockedSize(0u)
+    , _prefetch(new PrefetchState())
 {
 }
 
@@ -81,6 +108,7 @@ void SpriteCache::SetMaxCacheSize(size_t size)
 
 void SpriteCache::Reset()
 {
+    StopPrefetchThread();
     _file.Close();
     // TODO: find out if it's safe to simply always delete _spriteData.Image with array element
     for (size_t i = 0; i < _spriteData.size(); ++i)
@@ -204,21 +232,39 @@ bool SpriteCache::SpriteData::IsLocked() const
     return (Flags & SPRCACHEFLAG_LOCKED) != 0;
 }
 
+bool SpriteCache::SpriteData::IsMapped() const
+{
+    return (Flags & SPRCACHEFLAG_MAPPED) != 0;
+}
+
 bool SpriteCache::DoesSpriteExist(sprkey_t index) const
 {
     return index >= 0 && (size_t)index < _spriteData.size() && _spriteData[index].DoesSpriteExist();
 }
 
+bool SpriteCache::IsMappedImage(const Bitmap *image) const
+{
+    return image && _file.IsMappedData(image->GetData());
+}
+
 Bitmap *SpriteCache::operator [] (sprkey_t index)
 {
     // invalid sprite slot
     if (index < 0 || (size_t)index >= _spriteData.size())
         return nullptr;
 
-    // Externally added sprite or locked sprite, don't put it into MRU list
-    if (_spriteData[index].IsExternalSprite() || _spriteData[index].IsLocked())
+    // Externally added sprite, locked or mapped sprite, don't put it into MRU list
+    if (_spriteData[index].IsExternalSprite() || _spriteData[index].IsLocked() ||
+        _spriteData[index].IsMapped())
         return _spriteData[index].Image;
 
+    if (_prefetch->HasReady)
+    {
+        SyncPrefetched();
+        if (_spriteData[index].IsMapped())
+            return _spriteData[index].Image; // was just loaded
+    }
+
     if (_spriteData[index].Image)
     {
         // Move to the beginning of the MRU list
@@ -228,7 +274,8 @@ Bitmap *SpriteCache::operator [] (sprkey_t index)
     {
         // Sprite exists in file but is not in mem, load it
         LoadSprite(index);
-        _spriteData[index].MruIt = _mru.insert(_mru.begin(), index);
+        if (!_spriteData[index].IsMapped())
+            _spriteData[index].MruIt = _mru.insert(_mru.begin(), index);
     }
     return _spriteData[index].Image;
 }
@@ -278,6 +325,7 @@ void SpriteCache::DisposeOldest()
 
 void SpriteCache::DisposeAll()
 {
+    CancelPrefetch();
     for (size_t i = 0; i < _spriteData.size(); ++i)
     {
         if (!_spriteData[i].IsLocked() && // not locked
@@ -285,6 +333,7 @@ void SpriteCache::DisposeAll()
         {
             delete _spriteData[i].Image;
             _spriteData[i].Image = nullptr;
+            _spriteData[i].Flags &= ~SPRCACHEFLAG_MAPPED;
         }
     }
     _cacheSize = _lockedSize;
@@ -304,7 +353,7 @@ void SpriteCache::Precache(sprkey_t index)
     {
         sprSize = LoadSprite(index);
     }
-    else if (!_spriteData[index].IsLocked())
+    else if (!_spriteData[index].IsLocked() && !_spriteData[index].IsMapped())
     {
         sprSize = _spriteData[index].Size;
         // Remove locked sprite from the MRU list
@@ -332,8 +381,15 @@ size_t SpriteCache::LoadSprite(sprkey_t index)
         return 0;
 
     sprkey_t load_index = GetDataIndex(index);
-    Bitmap *image;
-    HError err = _file.LoadSprite(load_index, image);
+    Bitmap *image = nullptr;
+    HError err = HError::None();
+    if ((_spriteData[index].Flags & SPRCACHEFLAG_PREFETCH) != 0)
+        image = TakePrefetched(index);
+    if (!image)
+    {
+        std::lock_guard<std::mutex> lk(_prefetch->FileMutex);
+        err = _file.LoadSprite(load_index, image);
+    }
     if (!image)
     {
         Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Warn,
@@ -342,7 +398,11 @@ size_t SpriteCache::LoadSprite(sprkey_t index)
         RemapSpriteToSprite0(index);
         return 0;
     }
+    return InitLoadedSprite(index, image);
+}
 
+size_t SpriteCache::InitLoadedSprite(sprkey_t index, Bitmap *image)
+{
     // update the stored width/height
     _sprInfos[index].Width = image->GetWidth();
     _sprInfos[index].Height = image->GetHeight();
@@ -361,6 +421,15 @@ size_t SpriteCache::LoadSprite(sprkey_t index)
     if (index != 0)  // leave sprite 0 locked
         _spriteData[index].Flags &= ~SPRCACHEFLAG_LOCKED;
 
+    // If the engine did not have to convert the bitmap, then it still uses
+    // the mapped file's memory, and does not count towards the cache size
+    if (_file.IsMappedData(_spriteData[index].Image->GetData()))
+    {
+        _spriteData[index].Flags |= SPRCACHEFLAG_MAPPED;
+        _spriteData[index].Size = 0;
+        return 0;
+    }
+
     const size_t size = _sprInfos[index].Width * _sprInfos[index].Height *
         _spriteData[index].Image->GetBPP();
     // Clear up space before adding to cache
@@ -375,6 +444,189 @@ size_t SpriteCache::LoadSprite(sprkey_t index)
     return size;
 }
 
+void SpriteCache::PrefetchSprites(const std::vector<sprkey_t> &indexes)
+{
+#if !defined(AGS_DISABLE_THREADS)
+    // Don't schedule more than the cache may hold at once, otherwise
+    // the prefetched sprites would push each other out of the cache.
+    // As the final color depth is not known until the sprite is initialized,
+    // assume the largest one.
+    const size_t free_space = _maxCacheSize - std::min(_maxCacheSize, _lockedSize);
+    size_t total_size = 0;
+    std::vector<sprkey_t> requests;
+    for (const auto index : indexes)
+    {
+        if (index <= 0 || (size_t)index >= _spriteData.size())
+            continue;
+        auto &spr = _spriteData[index];
+        if (!spr.IsAssetSprite() || spr.Image ||
+            (spr.Flags & (SPRCACHEFLAG_REMAPPED | SPRCACHEFLAG_PREFETCH)) != 0)
+            continue; // not from file, already loaded or queued
+        const size_t size = _sprInfos[index].Width * _sprInfos[index].Height * 4;
+        if (total_size + size > free_space)
+            break;
+        total_size += size;
+        spr.Flags |= SPRCACHEFLAG_PREFETCH;
+        requests.push_back(index);
+    }
+    if (requests.empty())
+        return;
+
+    auto &pf = *_prefetch;
+    std::lock_guard<std::mutex> lk(pf.Mutex);
+    pf.Queue.insert(pf.Queue.end(), requests.begin(), requests.end());
+    if (!pf.Running)
+    {
+        pf.Running = true;
+        pf.Thread = std::thread(&SpriteCache::RunPrefetch, this);
+    }
+    pf.Cond.notify_all();
+#ifdef DEBUG_SPRITECACHE
+    Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Debug, "PrefetchSprites: scheduled %zu sprites, approx %zu KB",
+        requests.size(), total_size / 1024);
+#endif
+#endif // !AGS_DISABLE_THREADS
+}
+
+void SpriteCache::CancelPrefetch()
+{
+    auto &pf = *_prefetch;
+    std::deque<sprkey_t> queue;
+    std::vector<std::pair<sprkey_t, std::unique_ptr<Bitmap>>> ready;
+    {
+        std::unique_lock<std::mutex> lk(pf.Mutex);
+        // wait for the sprite in flight, as it is not cancellable
+        while (pf.InFlight >= 0)
+            pf.Cond.wait(lk);
+        queue.swap(pf.Queue);
+        ready.swap(pf.Ready);
+        pf.HasReady = false;
+    }
+    for (const auto index : queue)
+        if ((size_t)index < _spriteData.size())
+            _spriteData[index].Flags &= ~SPRCACHEFLAG_PREFETCH;
+    for (const auto &r : ready)
+        if ((size_t)r.first < _spriteData.size())
+            _spriteData[r.first].Flags &= ~SPRCACHEFLAG_PREFETCH;
+}
+
+void SpriteCache::WaitForPrefetch()
+{
+    auto &pf = *_prefetch;
+    std::unique_lock<std::mutex> lk(pf.Mutex);
+    while (pf.Running && (!pf.Queue.empty() || pf.InFlight >= 0))
+        pf.Cond.wait(lk);
+}
+
+Bitmap *SpriteCache::TakePrefetched(sprkey_t index)
+{
+    _spriteData[index].Flags &= ~SPRCACHEFLAG_PREFETCH;
+    auto &pf = *_prefetch;
+    std::unique_lock<std::mutex> lk(pf.Mutex);
+    auto it_queue = std::find(pf.Queue.begin(), pf.Queue.end(), index);
+    if (it_queue != pf.Queue.end())
+    { // not started yet, so let the caller load it right away
+        pf.Queue.erase(it_queue);
+        return nullptr;
+    }
+    while (pf.InFlight == index)
+        pf.Cond.wait(lk);
+    for (auto it = pf.Ready.begin(); it != pf.Ready.end(); ++it)
+    {
+        if (it->first == index)
+        {
+            Bitmap *image = it->second.release();
+            pf.Ready.erase(it);
+            return image;
+        }
+    }
+    return nullptr;
+}
+
+void SpriteCache::SyncPrefetched()
+{
+    if (_syncingPrefetch)
+        return; // sprite initialization may call back into the cache
+    auto &pf = *_prefetch;
+    std::vector<std::pair<sprkey_t, std::unique_ptr<Bitmap>>> ready;
+    {
+        std::lock_guard<std::mutex> lk(pf.Mutex);
+        ready.swap(pf.Ready);
+        pf.HasReady = false;
+    }
+
+    _syncingPrefetch = true;
+    for (auto &r : ready)
+    {
+        const sprkey_t index = r.first;
+        // Slot could be reset or reassigned while the sprite was loading
+        if ((size_t)index >= _spriteData.size() ||
+            (_spriteData[index].Flags & SPRCACHEFLAG_PREFETCH) == 0)
+            continue;
+        _spriteData[index].Flags &= ~SPRCACHEFLAG_PREFETCH;
+        // If failed to load, then let the regular load report the error later
+        if (!r.second)
+            continue;
+        InitLoadedSprite(index, r.second.release());
+        if (!_spriteData[index].IsMapped())
+            _spriteData[index].MruIt = _mru.insert(_mru.begin(), index);
+    }
+    _syncingPrefetch = false;
+}
+
+void SpriteCache::StopPrefetchThread()
+{
+    auto &pf = *_prefetch;
+    {
+        std::lock_guard<std::mutex> lk(pf.Mutex);
+        pf.Running = false;
+        pf.Cond.notify_all();
+    }
+    if (pf.Thread.joinable())
+        pf.Thread.join();
+    CancelPrefetch();
+}
+
+void SpriteCache::RunPrefetch()
+{
+    auto &pf = *_prefetch;
+    std::unique_lock<std::mutex> lk(pf.Mutex);
+    while (pf.Running)
+    {
+        if (pf.Queue.empty())
+        {
+            pf.Cond.wait(lk);
+            continue;
+        }
+        const sprkey_t index = pf.Queue.front();
+        pf.Queue.pop_front();
+        pf.InFlight = index;
+        lk.unlock();
+
+        // Only the file read is done under lock, the sprite is decoded after,
+        // so that the main thread is not kept waiting for the decompression.
+        // Sprites which may be used right from the mapped file are not read,
+        // but get the same view into the file as the regular load gives.
+        // Errors are ignored here, they will be reported if the sprite
+        // is loaded again on the main thread.
+        SpriteDatHeader hdr;
+        std::vector<uint8_t> data;
+        Bitmap *image = nullptr;
+        {
+            std::lock_guard<std::mutex> file_lk(pf.FileMutex);
+            _file.LoadRawData(index, hdr, data, image);
+        }
+        if (!image)
+            _file.DecodeRawData(index, hdr, data, image);
+
+        lk.lock();
+        pf.InFlight = -1;
+        pf.Ready.push_back(std::make_pair(index, std::unique_ptr<Bitmap>(image)));
+        pf.HasReady = true;
+        pf.Cond.notify_all();
+    }
+}
+
 void SpriteCache::RemapSpriteToSprite0(sprkey_t index)
 {
     _sprInfos[index].Flags = _sprInfos[0].Flags;
@@ -382,6 +634,7 @@ void SpriteCache::RemapSpriteToSprite0(sprkey_t index)
     _sprInfos[index].Height = _sprInfos[0].Height;
     _spriteData[index].Image = nullptr;
     _spriteData[index].Size = _spriteData[0].Size;
+    _spriteData[index].Flags &= ~SPRCACHEFLAG_MAPPED;
     _spriteData[index].Flags |= SPRCACHEFLAG_REMAPPED;
 #ifdef DEBUG_SPRITECACHE
     Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Debug, "RemapSpriteToSprite0: %d", index);
@@ -401,6 +654,7 @@ int SpriteCache::SaveToFile(const String &filename, int store_flags, SpriteCompr
         pre_save_sprite(_spriteData[i].Image);
         sprites.push_back(std::make_pair(DoesSpriteExist(i), _spriteData[i].Image));
     }
+    std::lock_guard<std::mutex> lk(_prefetch->FileMutex);
     return SaveSpriteFile(filename, sprites, &_file, store_flags, compress, index);
 }
 
@@ -409,7 +663,7 @@ HError SpriteCache::InitFile(const String &filename, const String &sprindex_file
     Reset();
 
     std::vector<Size> metrics;
-    HError err = _file.OpenFile(filename, sprindex_filename, metrics);
+    HError err = _file.OpenFile(filename, sprindex_filename, metrics, _useMapping);
     if (!err)
         return err;
 
@@ -438,8 +692,31 @@ HError SpriteCache::InitFile(const String &filename, const String &sprindex_file
 
 void SpriteCache::DetachFile()
 {
+    StopPrefetchThread();
+    // Mapped bitmaps cannot outlive the file, so turn them into the regular ones
+    for (size_t i = 0; i < _spriteData.size(); ++i)
+        DetachMappedSprite(i);
     _file.Close();
 }
 
+void SpriteCache::DetachMappedSprite(sprkey_t index)
+{
+    if (index < 0 || (size_t)index >= _spriteData.size())
+        return;
+    auto &spr = _spriteData[index];
+    if (!spr.IsMapped())
+        return;
+    Bitmap *image = BitmapHelper::CreateBitmapCopy(spr.Image);
+    delete spr.Image;
+    spr.Image = image;
+    spr.Flags &= ~SPRCACHEFLAG_MAPPED;
+    spr.Size = image->GetWidth() * image->GetHeight() * image->GetBPP();
+    _cacheSize += spr.Size;
+    if (spr.IsLocked())
+        _lockedSize += spr.Size;
+    else
+        spr.MruIt = _mru.insert(_mru.begin(), index);
+}
+
 } // namespace Common
 } // namespace AGS
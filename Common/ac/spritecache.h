@@ -17,6 +17,18 @@
 // SpriteCache provides bitmaps by demand; it uses SpriteFile to load sprites
 // and does MRU (most-recent-use) caching.
 //
+// Sprites may also be requested for loading in advance ("prefetched"): these
+// are read and decoded on a background thread and put into the cache either
+// when they are first accessed or on any following cache access, whichever
+// comes first. Accessing a sprite which is still being loaded in background
+// blocks until that sprite is ready.
+//
+// If the sprite file is not compressed, it may be memory-mapped instead of
+// being read. The sprites which do not require any conversion by the engine
+// then stay as bitmaps which pixels point right into the mapped file. These
+// are not accounted in the cache size and are never disposed, as the memory
+// they take is managed by the system.
+//
 // TODO: store sprite data in a specialized container type that is optimized
 // for having most keys allocated in large continious sequences by default.
 //
@@ -32,6 +44,7 @@
 #define __AGS_CN_AC__SPRCACHE_H
 
 #include <list>
+#include <memory>
 #include "core/platform.h"
 #include "ac/spritefile.h"
 
@@ -41,6 +54,10 @@
 #define SPRCACHEFLAG_REMAPPED       0x02
 // Locked sprites are ones that should not be freed when out of cache space.
 #define SPRCACHEFLAG_LOCKED         0x04
+// Tells that the sprite was scheduled for loading in background.
+#define SPRCACHEFLAG_PREFETCH       0x08
+// Tells that the sprite's bitmap is a view into the memory-mapped sprite file.
+#define SPRCACHEFLAG_MAPPED         0x10
 
 // Max size of the sprite cache, in bytes
 #if AGS_PLATFORM_OS_ANDROID || AGS_PLATFORM_OS_IOS
@@ -73,6 +90,15 @@ public:
     int         SaveToFile(const Common::String &filename, int store_flags, SpriteCompression compress, SpriteFileIndex &index);
     // Closes an active sprite file stream
     void        DetachFile();
+    // Sets whether the sprite file should be memory-mapped when possible;
+    // applied on the next InitFile call
+    void        SetMemoryMapping(bool on) { _useMapping = on; }
+    // Tells if the given bitmap is a view into the memory-mapped sprite file;
+    // such bitmaps should not be modified in place, but copied instead
+    bool        IsMappedImage(const Common::Bitmap *image) const;
+    // Replaces a sprite which is a view into the memory-mapped file with
+    // its own copy, which may be safely modified
+    void        DetachMappedSprite(sprkey_t index);
 
     inline int GetStoreFlags() const { return _file.GetStoreFlags(); }
     inline SpriteCompression GetSpriteCompression() const { return _file.GetSpriteCompression(); }
@@ -113,6 +139,13 @@ public:
     void        SubstituteBitmap(sprkey_t index, Common::Bitmap *);
     // Sets max cache size in bytes
     void        SetMaxCacheSize(size_t size);
+    // Schedules the list of sprites for loading in background; sprites that
+    // are already loaded, or do not fit into the cache size limit, are skipped.
+    void        PrefetchSprites(const std::vector<sprkey_t> &indexes);
+    // Discards any sprites scheduled for background loading which were not used yet
+    void        CancelPrefetch();
+    // Waits until all the sprites scheduled for background loading are loaded
+    void        WaitForPrefetch();
 
     // Loads (if it's not in cache yet) and returns bitmap by the sprite index
     Common::Bitmap *operator[] (sprkey_t index);
@@ -127,6 +160,17 @@ private:
     void        DisposeOldest();
     // Keep disposing oldest elements until cache has at least the given free space
     void        FreeMem(size_t space);
+    // Initializes a freshly loaded bitmap and registers it in the cache
+    size_t      InitLoadedSprite(sprkey_t index, Common::Bitmap *image);
+    // Takes the prefetched sprite's bitmap, waits if it's being loaded right now;
+    // returns nullptr if the sprite was not loaded in background yet
+    Common::Bitmap *TakePrefetched(sprkey_t index);
+    // Puts all the sprites that finished loading in background into the cache
+    void        SyncPrefetched();
+    // Stops the background loading thread
+    void        StopPrefetchThread();
+    // Background loading thread's entry
+    void        RunPrefetch();
 
     // Information required for the sprite streaming
     struct SpriteData
@@ -147,6 +191,8 @@ private:
         bool IsExternalSprite() const;
         // Tells if sprite is locked and should not be disposed by cache logic
         bool IsLocked() const;
+        // Tells if sprite's bitmap is a view into the memory-mapped file
+        bool IsMapped() const;
     };
 
     // Provided map of sprite infos, to fill in loaded sprite properties
@@ -155,6 +201,7 @@ private:
     std::vector<SpriteData> _spriteData;
 
     SpriteFile _file;
+    bool _useMapping = false; // try to memory-map the sprite file
 
     size_t _maxCacheSize;  // cache size limit
     size_t _lockedSize;    // size in bytes of currently locked images
@@ -165,6 +212,12 @@ private:
     // that were last time used long ago.
     std::list<sprkey_t> _mru;
 
+    // Background loading state; defined privately to keep threading headers
+    // out of this one.
+    struct PrefetchState;
+    std::unique_ptr<PrefetchState> _prefetch;
+    bool _syncingPrefetch = false; // guards against recursive sync
+
     // Initialize the empty sprite slot
     void        InitNullSpriteParams(sprkey_t index);
 };
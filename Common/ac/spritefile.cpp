@@ -15,6 +15,7 @@
 #include <algorithm>
 #include <time.h>
 #include "core/assetmanager.h"
+#include "debug/out.h"
 #include "gfx/bitmap.h"
 #include "util/compress.h"
 #include "util/file.h"
@@ -153,7 +154,7 @@ SpriteFile::SpriteFile()
 }
 
 HError SpriteFile::OpenFile(const String &filename, const String &sprindex_filename,
-    std::vector<Size> &metrics)
+    std::vector<Size> &metrics, bool use_mmap)
 {
     Close();
 
@@ -223,6 +224,19 @@ HError SpriteFile::OpenFile(const String &filename, const String &sprindex_filen
         _stream->ReadInt8();
     }
 
+    // Uncompressed sprites may be used right from the file, if it's mapped,
+    // and RLE and LZ4 sprites are decompressed right from it too.
+    // The pixel data is stored in little-endian order, which suits the
+    // bitmaps only on the little-endian systems.
+#if AGS_PLATFORM_ENDIAN_LITTLE
+    if (use_mmap && ((_compress == kSprCompress_None) ||
+        (_compress == kSprCompress_RLE) || (_compress == kSprCompress_LZ4)))
+    {
+        if (AssetMgr->GetAssetView(filename, _mapping))
+            Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Info, "Sprite file is memory-mapped (%zu KB)", _mapping.Size / 1024);
+    }
+#endif
+
     // if there is a sprite index file, use it
     if (LoadSpriteIndexFile(sprindex_filename, spriteFileID,
         spr_initial_offs, topmost, metrics))
@@ -238,6 +252,7 @@ HError SpriteFile::OpenFile(const String &filename, const String &sprindex_filen
 void SpriteFile::Close()
 {
     _stream.reset();
+    _mapping = AssetDataView();
     _spriteData.clear();
     _version = kSprfVersion_Undefined;
     _storeFlags = 0;
@@ -394,7 +409,38 @@ HError SpriteFile::LoadSprite(sprkey_t index, Common::Bitmap *&sprite)
     SpriteDatHeader hdr;
     ReadSprHeader(hdr, _stream.get(), _version, _compress);
     if (hdr.BPP == 0) return HError::None(); // empty slot, this is normal
-    int bpp = hdr.BPP, w = hdr.Width, h = hdr.Height;
+    sprite = TryMapSprite(hdr);
+    if (sprite)
+        return HError::None();
+    HError err = DecodeSprite(index, hdr, _stream.get(),
+        [this](size_t size) { return GetRawChunk(size); }, sprite);
+    if (err)
+        _curPos = index + 1; // mark correct pos
+    return err;
+}
+
+HError SpriteFile::DecodeRawData(sprkey_t index, const SpriteDatHeader &hdr,
+    const std::vector<uint8_t> &data, Bitmap *&sprite) const
+{
+    sprite = nullptr;
+    if (hdr.BPP == 0)
+        return HError::None(); // empty slot, this is normal
+    MemoryStream in(data.data(), data.size());
+    return DecodeSprite(index, hdr, &in,
+        [&in, &data](size_t size) -> const uint8_t*
+        {
+            const size_t pos = static_cast<size_t>(in.GetPosition());
+            if (pos + size > data.size())
+                return nullptr;
+            in.Seek(static_cast<soff_t>(size), kSeekCurrent);
+            return data.data() + pos;
+        }, sprite);
+}
+
+HError SpriteFile::DecodeSprite(sprkey_t index, const SpriteDatHeader &hdr, Stream *in,
+    const std::function<const uint8_t*(size_t)> &get_chunk, Bitmap *&sprite) const
+{
+    const int bpp = hdr.BPP, w = hdr.Width, h = hdr.Height;
     Bitmap *image = BitmapHelper::CreateBitmap(w, h, bpp * 8);
     if (image == nullptr)
     {
@@ -410,9 +456,9 @@ HError SpriteFile::LoadSprite(sprkey_t index, Common::Bitmap *&sprite)
     { // read palette if format assumes one
         switch (pal_bpp)
         {
-        case 2: for (uint32_t i = 0; i < hdr.PalCount; ++i) { palette[i] = _stream->ReadInt16(); }
+        case 2: for (uint32_t i = 0; i < hdr.PalCount; ++i) { palette[i] = in->ReadInt16(); }
             break;
-        case 4: for (uint32_t i = 0; i < hdr.PalCount; ++i) { palette[i] = _stream->ReadInt32(); }
+        case 4: for (uint32_t i = 0; i < hdr.PalCount; ++i) { palette[i] = in->ReadInt32(); }
             break;
         default: assert(0); break;
         }
@@ -422,7 +468,7 @@ HError SpriteFile::LoadSprite(sprkey_t index, Common::Bitmap *&sprite)
     // (Optional) Decompress the image data into the temp buffer
     size_t in_data_size =
         ((_version >= kSprfVersion_StorageFormats) || _compress != kSprCompress_None) ?
-        (uint32_t)_stream->ReadInt32() : (w * h * bpp);
+        (uint32_t)in->ReadInt32() : (w * h * bpp);
     if (hdr.Compress != kSprCompress_None)
     {
         if (in_data_size == 0)
@@ -432,10 +478,25 @@ HError SpriteFile::LoadSprite(sprkey_t index, Common::Bitmap *&sprite)
         }
         switch (hdr.Compress)
         {
-        case kSprCompress_RLE: rle_decompress(im_data.Buf, im_data.Size, im_data.BPP, _stream.get());
+        case kSprCompress_LZW: lzw_decompress(im_data.Buf, im_data.Size, im_data.BPP, in);
             break;
-        case kSprCompress_LZW: lzw_decompress(im_data.Buf, im_data.Size, im_data.BPP, _stream.get());
+        case kSprCompress_RLE:
+        case kSprCompress_LZ4:
+        {
+            // decompress from the whole compressed chunk in memory
+            const uint8_t *in_data = get_chunk(in_data_size);
+            bool result = false;
+            if (in_data && hdr.Compress == kSprCompress_RLE)
+                result = rle_decompress(im_data.Buf, im_data.Size, im_data.BPP, in_data, in_data_size);
+            else if (in_data)
+                result = lz4_decompress(im_data.Buf, im_data.Size, im_data.BPP, in_data, in_data_size);
+            if (!result)
+            {
+                delete image;
+                return new Error(String::FromFormat("LoadSprite: bad compressed data for sprite %d.", index));
+            }
             break;
+        }
         default: assert(!"Unsupported compression type!"); break;
         }
         // TODO: test that not more than data_size was read!
@@ -445,12 +506,12 @@ HError SpriteFile::LoadSprite(sprkey_t index, Common::Bitmap *&sprite)
     {
         switch (im_data.BPP)
         {
-        case 1: _stream->Read(im_data.Buf, im_data.Size);
+        case 1: in->Read(im_data.Buf, im_data.Size);
             break;
-        case 2: _stream->ReadArrayOfInt16(
+        case 2: in->ReadArrayOfInt16(
                 reinterpret_cast<int16_t*>(im_data.Buf), im_data.Size / sizeof(int16_t));
             break;
-        case 4: _stream->ReadArrayOfInt32(
+        case 4: in->ReadArrayOfInt32(
                 reinterpret_cast<int32_t*>(im_data.Buf), im_data.Size / sizeof(int32_t));
             break;
         default: assert(0); break;
@@ -463,13 +524,26 @@ HError SpriteFile::LoadSprite(sprkey_t index, Common::Bitmap *&sprite)
     }
 
     sprite = image;
-    _curPos = index + 1; // mark correct pos
     return HError::None();
 }
 
 HError SpriteFile::LoadRawData(sprkey_t index, SpriteDatHeader &hdr, std::vector<uint8_t> &data)
+{
+    return LoadRawDataImpl(index, hdr, data, nullptr);
+}
+
+HError SpriteFile::LoadRawData(sprkey_t index, SpriteDatHeader &hdr, std::vector<uint8_t> &data,
+    Bitmap *&mapped_sprite)
+{
+    return LoadRawDataImpl(index, hdr, data, &mapped_sprite);
+}
+
+HError SpriteFile::LoadRawDataImpl(sprkey_t index, SpriteDatHeader &hdr, std::vector<uint8_t> &data,
+    Bitmap **mapped_sprite)
 {
     hdr = SpriteDatHeader();
+    if (mapped_sprite)
+        *mapped_sprite = nullptr;
     data.resize(0);
     if (index < 0 || (size_t)index >= _spriteData.size())
         return new Error(String::FromFormat("LoadSprite: slot index %d out of bounds (%d - %d).",
@@ -483,6 +557,12 @@ HError SpriteFile::LoadRawData(sprkey_t index, SpriteDatHeader &hdr, std::vector
 
     ReadSprHeader(hdr, _stream.get(), _version, _compress);
     if (hdr.BPP == 0) return HError::None(); // empty slot, this is normal
+    if (mapped_sprite)
+    {
+        *mapped_sprite = TryMapSprite(hdr);
+        if (*mapped_sprite)
+            return HError::None();
+    }
     size_t data_size = 0;
     soff_t data_pos = _stream->GetPosition();
     // Optional palette
@@ -503,6 +583,55 @@ HError SpriteFile::LoadRawData(sprkey_t index, SpriteDatHeader &hdr, std::vector
     return HError::None();
 }
 
+Bitmap *SpriteFile::TryMapSprite(const SpriteDatHeader &hdr)
+{
+    // Uncompressed sprites without palette may be used right from the mapped file
+    if (!IsMemoryMapped() || (hdr.Compress != kSprCompress_None) || (GetPaletteBPP(hdr.SFormat) != 0))
+        return nullptr;
+    soff_t data_pos = _stream->GetPosition();
+    if (_version >= kSprfVersion_StorageFormats)
+        data_pos += sizeof(uint32_t); // skip data size
+    return CreateMappedSprite(hdr, data_pos);
+}
+
+Bitmap *SpriteFile::CreateMappedSprite(const SpriteDatHeader &hdr, soff_t data_pos)
+{
+    const size_t data_size = hdr.Width * hdr.Height * hdr.BPP;
+    if ((hdr.Width <= 0) || (hdr.Height <= 0) ||
+        (data_pos < 0) || ((size_t)data_pos + data_size > _mapping.Size))
+        return nullptr;
+    switch (hdr.BPP)
+    {
+    case 1: case 2: case 4: break;
+    default: return nullptr; // other formats are not expected to be used as-is
+    }
+    // The library mapping is copy-on-write, so any changes to the bitmap
+    // stay in memory and never reach the file
+    uint8_t *data = const_cast<uint8_t*>(_mapping.Data) + data_pos;
+    // Sprite data is not aligned in file, but some architectures
+    // cannot read from the unaligned pixel addresses
+#if !(defined (__i386__) || defined (__x86_64__) || defined (_M_IX86) || defined (_M_X64) || \
+      defined (__aarch64__) || defined (_M_ARM64))
+    if (((uintptr_t)data % hdr.BPP) != 0)
+        return nullptr;
+#endif
+    return BitmapHelper::CreateBitmapOnData(hdr.Width, hdr.Height, hdr.BPP * 8, data);
+}
+
+const uint8_t *SpriteFile::GetRawChunk(size_t size)
+{
+    const soff_t pos = _stream->GetPosition();
+    if (IsMemoryMapped() && (pos >= 0) && ((size_t)pos + size <= _mapping.Size))
+    {
+        _stream->Seek(size);
+        return _mapping.Data + pos;
+    }
+    _readBuf.resize(size);
+    if (_stream->Read(_readBuf.data(), size) != size)
+        return nullptr;
+    return _readBuf.data();
+}
+
 void SpriteFile::SeekToSprite(sprkey_t index)
 {
     // If we didn't just load the previous sprite, seek to it
@@ -684,6 +813,8 @@ void SpriteFileWriter::WriteBitmap(Bitmap *image)
             break;
         case kSprCompress_LZW: lzw_compress(im_data.Buf, im_data.Size, im_data.BPP, &mems);
             break;
+        case kSprCompress_LZ4: lz4_compress(im_data.Buf, im_data.Size, im_data.BPP, &mems);
+            break;
         default: assert(!"Unsupported compression type!"); break;
         }
         // mark to write as a plain byte array
@@ -21,8 +21,10 @@
 #ifndef __AGS_CN_AC__SPRFILE_H
 #define __AGS_CN_AC__SPRFILE_H
 
+#include <functional>
 #include <memory>
 #include <vector>
+#include "core/assetmanager.h"
 #include "core/types.h"
 #include "util/error.h"
 #include "util/geometry.h"
@@ -83,7 +85,8 @@ enum SpriteCompression
 {
     kSprCompress_None = 0,
     kSprCompress_RLE,
-    kSprCompress_LZW
+    kSprCompress_LZW,
+    kSprCompress_LZ4
 };
 
 typedef int32_t sprkey_t;
@@ -128,9 +131,11 @@ public:
     static const String DefaultSpriteIndexName;
 
     SpriteFile();
-    // Loads sprite reference information and inits sprite stream
+    // Loads sprite reference information and inits sprite stream;
+    // optionally tries to memory-map the uncompressed sprite file, in which
+    // case LoadSprite returns bitmaps that point right into the mapped data.
     HError      OpenFile(const String &filename, const String &sprindex_filename,
-        std::vector<Size> &metrics);
+        std::vector<Size> &metrics, bool use_mmap = false);
     // Closes stream; no reading will be possible unless opened again
     void        Close();
 
@@ -139,6 +144,16 @@ public:
     SpriteCompression GetSpriteCompression() const;
     // Tells the highest known sprite index
     sprkey_t    GetTopmostSprite() const;
+    // Tells if the sprite file is memory-mapped
+    bool        IsMemoryMapped() const { return _mapping.Data != nullptr; }
+    // Tells if the given pixel data belongs to the memory-mapped sprite file,
+    // which means that the bitmap is only a view and must not outlive this file
+    bool        IsMappedData(const void *data) const
+    {
+        return (_mapping.Data != nullptr) &&
+            (static_cast<const uint8_t*>(data) >= _mapping.Data) &&
+            (static_cast<const uint8_t*>(data) < _mapping.Data + _mapping.Size);
+    }
 
     // Loads sprite index file
     bool        LoadSpriteIndexFile(const String &filename, int expectedFileID,
@@ -150,10 +165,38 @@ public:
     HError      LoadSprite(sprkey_t index, Bitmap *&sprite);
     // Loads a raw sprite element data into the buffer, stores header info separately
     HError      LoadRawData(sprkey_t index, SpriteDatHeader &hdr, std::vector<uint8_t> &data);
+    // Same as above, except that a sprite which may be used right from the
+    // mapped file is returned as a ready bitmap in mapped_sprite, and no data
+    // is read for it; otherwise mapped_sprite is set to null.
+    HError      LoadRawData(sprkey_t index, SpriteDatHeader &hdr, std::vector<uint8_t> &data,
+        Bitmap *&mapped_sprite);
+    // Creates a bitmap from the raw sprite element data, got by LoadRawData;
+    // does not access the file, so may be called without locking the file
+    // while the other sprites are being loaded.
+    HError      DecodeRawData(sprkey_t index, const SpriteDatHeader &hdr,
+        const std::vector<uint8_t> &data, Bitmap *&sprite) const;
 
 private:
     // Seek stream to sprite
     void        SeekToSprite(sprkey_t index);
+    // Reads the sprite element's header and raw data, or maps the sprite
+    // if mapped_sprite is provided and the sprite's format allows that
+    HError      LoadRawDataImpl(sprkey_t index, SpriteDatHeader &hdr, std::vector<uint8_t> &data,
+        Bitmap **mapped_sprite);
+    // Creates a bitmap over the sprite's pixels in the mapped file, if the
+    // sprite's format allows that; stream must be positioned right after
+    // the sprite's header
+    Bitmap     *TryMapSprite(const SpriteDatHeader &hdr);
+    // Creates a bitmap over the sprite's pixels in the mapped file, if possible
+    Bitmap     *CreateMappedSprite(const SpriteDatHeader &hdr, soff_t data_pos);
+    // Decodes the sprite image from the sprite element data in the stream,
+    // which must be positioned right after the header; get_chunk should
+    // return the next chunk of data of the given size, advancing the stream
+    HError      DecodeSprite(sprkey_t index, const SpriteDatHeader &hdr, Stream *in,
+        const std::function<const uint8_t*(size_t)> &get_chunk, Bitmap *&sprite) const;
+    // Gets the next chunk of raw data, either right from the mapped file,
+    // or reading it into the internal buffer; advances the stream
+    const uint8_t *GetRawChunk(size_t size);
 
     // Internal sprite reference
     struct SpriteRef
@@ -166,6 +209,8 @@ private:
     // Array of sprite references
     std::vector<SpriteRef> _spriteData;
     std::unique_ptr<Stream> _stream; // the sprite stream
+    AssetDataView _mapping; // optional direct view of the sprite file, shared with AssetManager
+    std::vector<uint8_t> _readBuf; // buffer for reading the raw data
     SpriteFileVersion _version = kSprfVersion_Current;
     int _storeFlags = 0; // storage flags, specify how sprites may be stored
     SpriteCompression _compress = kSprCompress_None; // sprite compression type
@@ -13,8 +13,9 @@
 //=============================================================================
 #include "core/assetmanager.h"
 #include <algorithm>
-#include <regex>
 #include "util/directory.h"
+#include "util/memorymappedfile.h"
+#include "util/memorystream.h"
 #include "util/multifilelib.h"
 #include "util/path.h"
 #include "util/string_utils.h" // cbuf_to_string_and_free
@@ -29,6 +30,11 @@ namespace Common
 std::unique_ptr<AssetManager> AssetMgr;
 
 
+// Largest library file that is allowed to be mapped; on 32-bit systems
+// mapping a huge file could exhaust the address space
+static const soff_t MaxMappedFileSize = (sizeof(void*) >= 8) ? INT64_MAX : (256 * 1024 * 1024);
+
+
 inline static bool IsAssetLibDir(const AssetLibInfo *lib) { return lib->BaseFileName.IsEmpty(); }
 inline static bool IsAssetLibFile(const AssetLibInfo *lib) { return !lib->BaseFileName.IsEmpty(); }
 
@@ -39,6 +45,44 @@ bool AssetManager::AssetLibEx::TestFilter(const String &filter) const
         (std::find(Filters.begin(), Filters.end(), filter) != Filters.end());
 }
 
+void AssetManager::AssetLibEx::BuildIndex()
+{
+    AssetIndex.clear();
+    AssetIndex.reserve(AssetInfos.size());
+    SortedAssets.resize(AssetInfos.size());
+    for (uint32_t i = 0; i < AssetInfos.size(); ++i)
+    {
+        // if there are duplicate names, the first asset is used
+        AssetIndex.emplace(AssetInfos[i].FileName, i);
+        SortedAssets[i] = i;
+    }
+    std::sort(SortedAssets.begin(), SortedAssets.end(),
+        [this](uint32_t a, uint32_t b)
+        { return AssetInfos[a].FileName.CompareNoCase(AssetInfos[b].FileName) < 0; });
+}
+
+void AssetManager::AssetLibEx::FindAssets(std::vector<String> &assets, const String &wildcard) const
+{
+    // Find the constant part of the pattern, and only test the names starting with it
+    const size_t prefix_len = std::min(wildcard.GetLength(),
+        std::min(wildcard.FindChar('*'), wildcard.FindChar('?')));
+    auto it = SortedAssets.begin();
+    if (prefix_len > 0)
+    {
+        it = std::lower_bound(SortedAssets.begin(), SortedAssets.end(), wildcard,
+            [this, prefix_len](uint32_t a, const String &prefix)
+            { return AssetInfos[a].FileName.CompareLeftNoCase(prefix, prefix_len) < 0; });
+    }
+    for (; it != SortedAssets.end(); ++it)
+    {
+        const String &name = AssetInfos[*it].FileName;
+        if ((prefix_len > 0) && (name.CompareLeftNoCase(wildcard, prefix_len) != 0))
+            break; // past the names with the matching prefix
+        if (StrUtil::MatchWildcard(wildcard, name, false))
+            assets.push_back(name);
+    }
+}
+
 
 bool AssetManager::LibsByPriority::operator()(const AssetLibInfo *lib1, const AssetLibInfo *lib2) const
 {
@@ -87,6 +131,7 @@ void AssetManager::SetSearchPriority(AssetSearchPriority priority)
 {
     _libsByPriority.Priority = priority;
     std::sort(_activeLibs.begin(), _activeLibs.end(), _libsByPriority);
+    RebuildAssetIndex();
 }
 
 AssetSearchPriority AssetManager::GetSearchPriority() const
@@ -94,6 +139,21 @@ AssetSearchPriority AssetManager::GetSearchPriority() const
     return _libsByPriority.Priority;
 }
 
+void AssetManager::SetMemoryMapping(bool on)
+{
+#if !defined(AGS_DISABLE_THREADS)
+    std::lock_guard<std::mutex> lk(_mappingMutex);
+#endif
+    _useMapping = on;
+    if (on)
+        return;
+    for (auto &lib : _libs)
+    {
+        for (auto &mapping : lib->Mappings)
+            mapping.reset();
+    }
+}
+
 AssetError AssetManager::AddLibrary(const String &path, const AssetLibInfo **out_lib)
 {
     return AddLibrary(path, "", out_lib);
@@ -123,6 +183,7 @@ AssetError AssetManager::AddLibrary(const String &path, const String &filters, c
     lib->Filters = filters.Split(',');
     auto place = std::upper_bound(_activeLibs.begin(), _activeLibs.end(), lib, _libsByPriority);
     _activeLibs.insert(place, lib);
+    RebuildAssetIndex();
     if (out_lib)
         *out_lib = lib;
     return kAssetNoError;
@@ -137,6 +198,7 @@ void AssetManager::RemoveLibrary(const String &path)
             auto it_end = std::remove(_activeLibs.begin(), _activeLibs.end(), (*it).get());
             _activeLibs.erase(it_end, _activeLibs.end());
             _libs.erase(it);
+            RebuildAssetIndex();
             return;
         }
     }
@@ -146,6 +208,7 @@ void AssetManager::RemoveAllLibraries()
 {
     _libs.clear();
     _activeLibs.clear();
+    RebuildAssetIndex();
 }
 
 size_t AssetManager::GetLibraryCount() const
@@ -158,10 +221,63 @@ const AssetLibInfo *AssetManager::GetLibraryInfo(size_t index) const
     return index < _libs.size() ? _libs[index].get() : nullptr;
 }
 
+void AssetManager::RebuildAssetIndex()
+{
+    _assetIndex.clear();
+    _assetRefs.clear();
+    size_t total = 0;
+    for (const auto *lib : _activeLibs)
+        total += lib->AssetInfos.size();
+    _assetIndex.reserve(total);
+    _assetRefs.reserve(total);
+
+    // Go through libs starting with the lowest priority, each new ref
+    // found for the existing name is put in the head of its chain
+    for (size_t lib_index = _activeLibs.size(); lib_index-- > 0;)
+    {
+        const auto *lib = _activeLibs[lib_index];
+        if (IsAssetLibDir(lib))
+            continue;
+        for (const auto &entry : lib->AssetIndex)
+        {
+            const uint32_t ref = static_cast<uint32_t>(_assetRefs.size());
+            auto it = _assetIndex.find(entry.first);
+            if (it == _assetIndex.end())
+            {
+                _assetRefs.push_back({ lib_index, &lib->AssetInfos[entry.second], NoAssetRef });
+                _assetIndex.emplace(entry.first, ref);
+            }
+            else
+            {
+                _assetRefs.push_back({ lib_index, &lib->AssetInfos[entry.second], it->second });
+                it->second = ref;
+            }
+        }
+    }
+}
+
+uint32_t AssetManager::FindAssetRef(const String &asset_name) const
+{
+    auto it = _assetIndex.find(asset_name);
+    return it != _assetIndex.end() ? it->second : NoAssetRef;
+}
+
+const AssetInfo *AssetManager::NextAssetRef(uint32_t &ref, size_t lib_index) const
+{
+    // refs are chained in the order of active libs
+    while ((ref != NoAssetRef) && (_assetRefs[ref].LibIndex < lib_index))
+        ref = _assetRefs[ref].Next;
+    if ((ref != NoAssetRef) && (_assetRefs[ref].LibIndex == lib_index))
+        return _assetRefs[ref].Info;
+    return nullptr;
+}
+
 bool AssetManager::DoesAssetExist(const String &asset_name, const String &filter) const
 {
-    for (const auto &lib : _activeLibs)
+    uint32_t ref = FindAssetRef(asset_name);
+    for (size_t i = 0; i < _activeLibs.size(); ++i)
     {
+        const auto *lib = _activeLibs[i];
         if (!lib->TestFilter(filter)) continue; // filter does not match
 
         if (IsAssetLibDir(lib))
@@ -171,10 +287,7 @@ bool AssetManager::DoesAssetExist(const String &asset_name, const String &filter
         }
         else
         {
-            for (const auto &a : lib->AssetInfos)
-            {
-                if (a.FileName.CompareNoCase(asset_name) == 0) return true;
-            }
+            if (NextAssetRef(ref, i)) return true;
         }
     }
     return false;
@@ -183,10 +296,6 @@ bool AssetManager::DoesAssetExist(const String &asset_name, const String &filter
 void AssetManager::FindAssets(std::vector<String> &assets, const String &wildcard,
     const String &filter) const
 {
-    String pattern = StrUtil::WildcardToRegex(wildcard);
-    const std::regex regex(pattern.GetCStr(), std::regex_constants::icase);
-    std::cmatch mr;
-
     for (const auto *lib : _activeLibs)
     {
         if (!lib->TestFilter(filter)) continue; // filter does not match
@@ -199,11 +308,7 @@ void AssetManager::FindAssets(std::vector<String> &assets, const String &wildcar
         }
         else
         {
-            for (const auto &a : lib->AssetInfos)
-            {
-                if (std::regex_match(a.FileName.GetCStr(), mr, regex))
-                    assets.push_back(a.FileName);
-            }
+            lib->FindAssets(assets, wildcard);
         }
     }
 
@@ -248,6 +353,8 @@ AssetError AssetManager::RegisterAssetLib(const String &path, AssetLibEx *&out_l
         {
             lib->RealLibFiles.push_back(File::FindFileCI(lib->BaseDir, lib->LibFileNames[i]));
         }
+        lib->Mappings.resize(lib->RealLibFiles.size());
+        lib->BuildIndex();
     }
 
     out_lib = lib.get();
@@ -257,34 +364,42 @@ AssetError AssetManager::RegisterAssetLib(const String &path, AssetLibEx *&out_l
 
 Stream *AssetManager::OpenAsset(const String &asset_name, const String &filter) const
 {
-    for (const auto *lib : _activeLibs)
+    uint32_t ref = FindAssetRef(asset_name);
+    for (size_t i = 0; i < _activeLibs.size(); ++i)
     {
+        const auto *lib = _activeLibs[i];
         if (!lib->TestFilter(filter)) continue; // filter does not match
 
         Stream *s = nullptr;
         if (IsAssetLibDir(lib))
+        {
             s = OpenAssetFromDir(lib, asset_name);
+        }
         else
-            s = OpenAssetFromLib(lib, asset_name);
+        {
+            const AssetInfo *asset = NextAssetRef(ref, i);
+            if (asset)
+                s = OpenAssetFromLib(lib, *asset);
+        }
         if (s)
             return s;
     }
     return nullptr;
 }
 
-Stream *AssetManager::OpenAssetFromLib(const AssetLibEx *lib, const String &asset_name) const
+Stream *AssetManager::OpenAssetFromLib(const AssetLibEx *lib, const AssetInfo &asset) const
 {
-    for (const auto &a : lib->AssetInfos)
+    const String &libfile = lib->RealLibFiles[asset.LibUid];
+    if (libfile.IsEmpty())
+        return nullptr;
+    auto mapping = GetLibMapping(lib, asset.LibUid);
+    if (mapping && (asset.Offset >= 0) && (asset.Size >= 0) &&
+        (static_cast<uint64_t>(asset.Offset + asset.Size) <= mapping->GetSize()))
     {
-        if (a.FileName.CompareNoCase(asset_name) == 0)
-        {
-            String libfile = lib->RealLibFiles[a.LibUid];
-            if (libfile.IsEmpty())
-                return nullptr;
-            return File::OpenFile(libfile, a.Offset, a.Offset + a.Size);
-        }
+        return new SharedMemoryStream(mapping, mapping->GetData() + asset.Offset,
+            static_cast<size_t>(asset.Size));
     }
-    return nullptr;
+    return File::OpenFile(libfile, asset.Offset, asset.Offset + asset.Size);
 }
 
 Stream *AssetManager::OpenAssetFromDir(const AssetLibEx *lib, const String &file_name) const
@@ -300,6 +415,125 @@ Stream *AssetManager::OpenAsset(const String &asset_name) const
     return OpenAsset(asset_name, "");
 }
 
+bool AssetManager::GetAssetLocation(const String &asset_name, AssetLocation &loc, const String &filter) const
+{
+    uint32_t ref = FindAssetRef(asset_name);
+    for (size_t i = 0; i < _activeLibs.size(); ++i)
+    {
+        const auto *lib = _activeLibs[i];
+        if (!lib->TestFilter(filter)) continue; // filter does not match
+
+        bool found = false;
+        if (IsAssetLibDir(lib))
+        {
+            found = GetAssetFromDir(lib, asset_name, loc);
+        }
+        else
+        {
+            const AssetInfo *asset = NextAssetRef(ref, i);
+            if (asset)
+                found = GetAssetFromLib(lib, *asset, loc);
+        }
+        if (found)
+            return true;
+    }
+    return false;
+}
+
+bool AssetManager::GetAssetFromLib(const AssetLibEx *lib, const AssetInfo &asset, AssetLocation &loc) const
+{
+    const String &libfile = lib->RealLibFiles[asset.LibUid];
+    if (libfile.IsEmpty())
+        return false;
+    loc.FileName = libfile;
+    loc.Offset = asset.Offset;
+    loc.Size = asset.Size;
+    return true;
+}
+
+bool AssetManager::GetAssetFromDir(const AssetLibEx *lib, const String &file_name, AssetLocation &loc) const
+{
+    String found_file = File::FindFileCI(lib->BaseDir, file_name);
+    if (found_file.IsEmpty())
+        return false;
+    loc.FileName = found_file;
+    loc.Offset = 0;
+    loc.Size = File::GetFileSize(found_file);
+    return true;
+}
+
+bool AssetManager::GetAssetView(const String &asset_name, AssetDataView &view, const String &filter) const
+{
+    uint32_t ref = FindAssetRef(asset_name);
+    for (size_t i = 0; i < _activeLibs.size(); ++i)
+    {
+        const auto *lib = _activeLibs[i];
+        if (!lib->TestFilter(filter)) continue; // filter does not match
+
+        if (IsAssetLibDir(lib))
+        {
+            String found_file = File::FindFileCI(lib->BaseDir, asset_name);
+            if (found_file.IsEmpty())
+                continue;
+            // the asset is found, but may only be read as a file if mapping fails
+            return GetAssetViewFromDir(found_file, view);
+        }
+        else
+        {
+            const AssetInfo *asset = NextAssetRef(ref, i);
+            if (asset)
+                return GetAssetViewFromLib(lib, *asset, view);
+        }
+    }
+    return false;
+}
+
+bool AssetManager::GetAssetViewFromLib(const AssetLibEx *lib, const AssetInfo &asset, AssetDataView &view) const
+{
+    auto mapping = GetLibMapping(lib, asset.LibUid);
+    if (!mapping || (asset.Offset < 0) || (asset.Size < 0) ||
+        (static_cast<uint64_t>(asset.Offset + asset.Size) > mapping->GetSize()))
+        return false;
+    view.Owner = mapping;
+    view.Data = mapping->GetData() + asset.Offset;
+    view.Size = static_cast<size_t>(asset.Size);
+    return true;
+}
+
+bool AssetManager::GetAssetViewFromDir(const String &file_path, AssetDataView &view) const
+{
+    // Separate files are not kept mapped, the view owns its own mapping
+    if (!_useMapping || (File::GetFileSize(file_path) > MaxMappedFileSize))
+        return false;
+    auto mapping = std::make_shared<MemoryMappedFile>();
+    if (!mapping->Open(file_path))
+        return false;
+    view.Data = mapping->GetData();
+    view.Size = mapping->GetSize();
+    view.Owner = std::move(mapping);
+    return true;
+}
+
+std::shared_ptr<MemoryMappedFile> AssetManager::GetLibMapping(const AssetLibEx *lib, size_t lib_uid) const
+{
+    if (lib_uid >= lib->Mappings.size())
+        return nullptr;
+#if !defined(AGS_DISABLE_THREADS)
+    std::lock_guard<std::mutex> lk(_mappingMutex);
+#endif
+    auto &mapping = lib->Mappings[lib_uid];
+    if (!mapping)
+    {
+        if (!_useMapping)
+            return nullptr; // don't remember, may be enabled later
+        mapping = std::make_shared<MemoryMappedFile>();
+        const String &libfile = lib->RealLibFiles[lib_uid];
+        if (!libfile.IsEmpty() && (File::GetFileSize(libfile) <= MaxMappedFileSize))
+            mapping->Open(libfile);
+    }
+    return mapping->IsValid() ? mapping : nullptr;
+}
+
 
 String GetAssetErrorText(AssetError err)
 {
@@ -21,6 +21,11 @@
 //-----------------------------------------------------------------------------
 // TODO: consider replace/merge with PhysFS library in the future.
 //
+// Library files are memory-mapped on the first access, whenever possible,
+// and the assets are read from these shared mappings without opening any
+// new file handles. The users which need the asset's bytes as a whole may
+// borrow them directly from the mapping, see GetAssetView().
+//
 // TODO: support streams that work on a file subsection, limited by size,
 // to avoid having to return an asset size separately from a stream.
 // TODO: return stream as smart pointer.
@@ -30,14 +35,20 @@
 #define __AGS_CN_CORE__ASSETMANAGER_H
 
 #include <memory>
+#include <unordered_map>
+#if !defined(AGS_DISABLE_THREADS)
+#include <mutex>
+#endif
 #include "core/asset.h"
 #include "util/file.h" // TODO: extract filestream mode constants or introduce generic ones
+#include "util/string_types.h"
 
 namespace AGS
 {
 namespace Common
 {
 
+class MemoryMappedFile;
 class Stream;
 struct MultiFileLib;
 
@@ -64,6 +75,23 @@ struct AssetPath
     AssetPath(const String &name = "", const String &filter = "") : Name(name), Filter(filter) {}
 };
 
+// AssetLocation describes where the asset's data physically resides
+struct AssetLocation
+{
+    String FileName; // file containing the asset
+    soff_t Offset = 0; // asset's data offset in the file
+    soff_t Size = 0; // asset's data size
+};
+
+// AssetDataView is a read-only reference to the asset's data in memory;
+// the Owner keeps the memory valid for as long as the view is held
+struct AssetDataView
+{
+    std::shared_ptr<const void> Owner;
+    const uint8_t *Data = nullptr;
+    size_t Size = 0u;
+};
+
 
 class AssetManager
 {
@@ -80,6 +108,10 @@ public:
     void         SetSearchPriority(AssetSearchPriority priority);
     // Gets current asset search priority
     AssetSearchPriority GetSearchPriority() const;
+    // Sets whether library files may be memory-mapped for reading assets;
+    // disabling releases the existing mappings, but these remain valid
+    // for any streams and views that are still using them
+    void         SetMemoryMapping(bool on);
 
     // Add library location to the list of asset locations
     AssetError   AddLibrary(const String &path, const AssetLibInfo **lib = nullptr);
@@ -106,26 +138,80 @@ public:
     // Open asset stream, providing a single filter to search in matching libraries
     Stream      *OpenAsset(const String &asset_name, const String &filter) const;
     inline Stream *OpenAsset(const AssetPath &apath) const { return OpenAsset(apath.Name, apath.Filter); }
+    // Finds out the asset's physical location, for the cases when the file has
+    // to be accessed directly, bypassing the streams (e.g. memory mapping)
+    bool         GetAssetLocation(const String &asset_name, AssetLocation &loc, const String &filter = "") const;
+    // Gets the asset's data right from the memory-mapped file, without copying;
+    // returns false if the asset is not found, or its file could not be mapped,
+    // in which case the asset should be read using a stream
+    bool         GetAssetView(const String &asset_name, AssetDataView &view, const String &filter = "") const;
+    inline bool  GetAssetView(const AssetPath &apath, AssetDataView &view) const { return GetAssetView(apath.Name, view, apath.Filter); }
 
 private:
+    // Case-insensitive map of asset names to the arbitrary index
+    typedef std::unordered_map<String, uint32_t, HashStrNoCase, StrEqNoCase> AssetNameIndex;
+
     // AssetLibEx combines library info with extended internal data required for the manager
     struct AssetLibEx : AssetLibInfo
     {
         std::vector<String> Filters; // asset filters this library is matching to
         std::vector<String> RealLibFiles; // fixed up library filenames
+        AssetNameIndex AssetIndex; // asset names to AssetInfos index
+        std::vector<uint32_t> SortedAssets; // AssetInfos indexes, sorted by names (case-insensitive)
+        // Memory mappings of the library files, made on demand;
+        // null if not tried yet, invalid object if mapping has failed
+        mutable std::vector<std::shared_ptr<MemoryMappedFile>> Mappings;
 
         bool TestFilter(const String &filter) const;
+        // Builds lookup indexes over the library contents
+        void BuildIndex();
+        // Collects names of assets matching the wildcard pattern
+        void FindAssets(std::vector<String> &assets, const String &wildcard) const;
+    };
+
+    // AssetRef is an entry in the merged asset index, refers to an asset
+    // found in one of the active library files
+    struct AssetRef
+    {
+        size_t LibIndex; // library's position in the active libs list
+        const AssetInfo *Info;
+        uint32_t Next; // next asset with the same name, in lower priority lib
     };
+    static const uint32_t NoAssetRef = UINT32_MAX;
 
     // Loads library and registers its contents into the cache
     AssetError  RegisterAssetLib(const String &path, AssetLibEx *&lib);
+    // Rebuilds the merged index of assets in all active library files;
+    // must be called whenever the list of active libs or their order changes
+    void        RebuildAssetIndex();
+    // Returns the first asset ref for the given name, or NoAssetRef if none found
+    uint32_t    FindAssetRef(const String &asset_name) const;
+    // Advances the asset ref to the given active library, and returns the asset
+    // if it's present in that library, or null otherwise
+    const AssetInfo *NextAssetRef(uint32_t &ref, size_t lib_index) const;
 
     // Tries to find asset in the given location, and then opens a stream for reading
-    Stream     *OpenAssetFromLib(const AssetLibEx *lib, const String &asset_name) const;
+    Stream     *OpenAssetFromLib(const AssetLibEx *lib, const AssetInfo &asset) const;
     Stream     *OpenAssetFromDir(const AssetLibEx *lib, const String &asset_name) const;
+    // Tries to find asset in the given location, and fills its physical location
+    bool        GetAssetFromLib(const AssetLibEx *lib, const AssetInfo &asset, AssetLocation &loc) const;
+    bool        GetAssetFromDir(const AssetLibEx *lib, const String &asset_name, AssetLocation &loc) const;
+    // Gets the asset's data from the mapped library or a separate file
+    bool        GetAssetViewFromLib(const AssetLibEx *lib, const AssetInfo &asset, AssetDataView &view) const;
+    bool        GetAssetViewFromDir(const String &file_path, AssetDataView &view) const;
+    // Returns the mapping of the library file, maps it on the first call;
+    // returns null if the file could not be mapped
+    std::shared_ptr<MemoryMappedFile> GetLibMapping(const AssetLibEx *lib, size_t lib_uid) const;
 
     std::vector<std::unique_ptr<AssetLibEx>> _libs;
     std::vector<AssetLibEx*> _activeLibs;
+    // Merged index of assets in all the active library files
+    AssetNameIndex _assetIndex; // asset names to the first ref in _assetRefs
+    std::vector<AssetRef> _assetRefs;
+    bool _useMapping = true;
+#if !defined(AGS_DISABLE_THREADS)
+    mutable std::mutex _mappingMutex; // guards the lazy mapping of lib files
+#endif
 
     struct LibsByPriority : public std::binary_function<const AssetLibInfo*, const AssetLibInfo*, bool>
     {
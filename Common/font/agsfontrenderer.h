@@ -15,6 +15,8 @@
 #ifndef __AC_AGSFONTRENDERER_H
 #define __AC_AGSFONTRENDERER_H
 
+#include <stddef.h>
+
 struct BITMAP;
 
 // WARNING: this interface is exposed for plugins and declared for the second time in agsplugin.h
@@ -51,6 +53,16 @@ struct FontMetrics
     int CompatHeight = 0; // either formal or real height, depending on compat settings
 };
 
+// Statistics of the cache of rendered glyphs
+struct GlyphCacheStats
+{
+    size_t Hits = 0; // number of glyphs drawn from the cache
+    size_t Misses = 0; // number of glyphs which had to be added to the cache
+    size_t Evictions = 0; // number of font atlases dropped for exceeding the cache limit
+    size_t GlyphCount = 0; // number of glyphs currently in cache
+    size_t MemSize = 0; // approximate memory used by the cache, in bytes
+};
+
 // NOTE: this extending interface is not yet exposed to plugins
 class IAGSFontRenderer2
 {
@@ -64,6 +76,9 @@ public:
   virtual const char *GetName(int fontNumber) = 0;
   // Perform any necessary adjustments when the AA mode is toggled
   virtual void AdjustFontForAntiAlias(int fontNumber, bool aa_mode) = 0;
+  // Get the width of the text range [text, text_end); unlike GetTextWidth this
+  // must be additive: the width of any text equals the sum of its parts' widths
+  virtual int GetTextWidthRange(const char *text, const char *text_end, int fontNumber) = 0;
 protected:
   IAGSFontRenderer2() = default;
   ~IAGSFontRenderer2() = default;
@@ -17,6 +17,7 @@
 #include <alfont.h>
 #include "ac/common.h" // set_our_eip
 #include "ac/gamestructdefines.h"
+#include "debug/out.h"
 #include "font/fonts.h"
 #include "font/ttffontrenderer.h"
 #include "font/wfnfontrenderer.h"
@@ -80,6 +81,10 @@ void init_font_renderer()
 void shutdown_font_renderer()
 {
   set_our_eip(9919);
+  const GlyphCacheStats &stats = ttfRenderer.GetGlyphCacheStats();
+  if (stats.Hits + stats.Misses > 0)
+    Debug::Printf("TTF glyph cache: %zu hits, %zu misses, %zu evictions; %zu glyphs, %zu KB in use",
+      stats.Hits, stats.Misses, stats.Evictions, stats.GlyphCount, stats.MemSize / 1024);
   alfont_exit();
 }
 
@@ -340,6 +345,56 @@ void unescape_script_string(const char *cstr, std::vector<char> &out)
     out.insert(out.end(), cstr, off + 1);
 }
 
+// Measures the width of a line of text with the outline, adding one character
+// at a time; this is only possible if the font renderers support measuring
+// separate text ranges, otherwise the whole line has to be measured each time
+class LineWidthMeter
+{
+public:
+    LineWidthMeter(size_t font_number)
+    {
+        if (font_number >= fonts.size() || !fonts[font_number].Renderer2)
+            return;
+        const Font &font = fonts[font_number];
+        _font = font_number;
+        _renderer = font.Renderer2;
+        const int outline = font.Info.Outline;
+        if (outline < 0 || static_cast<size_t>(outline) > fonts.size())
+        { // FONT_OUTLINE_AUTO or FONT_OUTLINE_NONE
+            _extraWidth = 2 * font.Info.AutoOutlineThickness;
+        }
+        else
+        {
+            if (static_cast<size_t>(outline) == fonts.size() || !fonts[outline].Renderer2)
+                _renderer = nullptr;
+            else
+                _outlineRenderer = fonts[outline].Renderer2;
+            _outline = outline;
+        }
+    }
+
+    inline bool IsValid() const { return _renderer != nullptr; }
+    inline void Reset() { _width = 0; _outlineWidth = 0; }
+    // Adds the character range to the line, returns resulting line width
+    inline int Add(const char *text, const char *text_end)
+    {
+        _width += _renderer->GetTextWidthRange(text, text_end, _font);
+        if (!_outlineRenderer)
+            return _width + _extraWidth;
+        _outlineWidth += _outlineRenderer->GetTextWidthRange(text, text_end, _outline);
+        return std::max(_width, _outlineWidth);
+    }
+
+private:
+    IAGSFontRenderer2 *_renderer = nullptr;
+    IAGSFontRenderer2 *_outlineRenderer = nullptr;
+    int _font = 0;
+    int _outline = 0;
+    int _extraWidth = 0;
+    int _width = 0;
+    int _outlineWidth = 0;
+};
+
 // Break up the text into lines
 size_t split_lines(const char *todis, SplitLines &lines, int wii, int fonnt, size_t max_lines) {
     // NOTE: following hack accomodates for the legacy math mistake in split_lines.
@@ -358,6 +413,7 @@ size_t split_lines(const char *todis, SplitLines &lines, int wii, int fonnt, siz
     char *scan_ptr = theline;
     char *prev_ptr = theline;
     char *last_whitespace = nullptr;
+    LineWidthMeter meter(fonnt);
     while (1) {
         char *split_at = nullptr;
 
@@ -377,13 +433,22 @@ size_t split_lines(const char *todis, SplitLines &lines, int wii, int fonnt, siz
             split_at = scan_ptr;
         // otherwise, see if we are too wide
         } else {
-            // temporarily terminate the line in the *next* char and test its width
             char *next_ptr = scan_ptr;
             ugetx(&next_ptr);
-            const int next_chwas = ugetc(next_ptr);
-            *next_ptr = 0;
+            int line_width;
+            if (meter.IsValid()) {
+                // add the next char's width to the line's width
+                line_width = meter.Add(scan_ptr, next_ptr);
+            } else {
+                // temporarily terminate the line in the *next* char and test its width
+                const int next_chwas = ugetc(next_ptr);
+                *next_ptr = 0;
+                line_width = get_text_width_outlined(theline, fonnt);
+                // restore the character that was there before
+                usetc(next_ptr, next_chwas);
+            }
 
-            if (get_text_width_outlined(theline, fonnt) > wii) {
+            if (line_width > wii) {
                 // line is too wide, order the split
                 if (last_whitespace)
                     // revert to the last whitespace
@@ -392,9 +457,6 @@ size_t split_lines(const char *todis, SplitLines &lines, int wii, int fonnt, siz
                     // single very wide word, display as much as possible
                     split_at = prev_ptr;
             }
-
-            // restore the character that was there before
-            usetc(next_ptr, next_chwas);
         }
 
         if (split_at == nullptr) {
@@ -425,6 +487,7 @@ size_t split_lines(const char *todis, SplitLines &lines, int wii, int fonnt, siz
             scan_ptr = theline;
             prev_ptr = theline;
             last_whitespace = nullptr;
+            meter.Reset();
         }
     }
     return lines.Count();
@@ -543,6 +606,16 @@ void adjust_fonts_for_render_mode(bool aa_mode)
     }
 }
 
+void set_font_glyph_cache_size(size_t max_size)
+{
+    ttfRenderer.SetGlyphCacheLimit(max_size);
+}
+
+GlyphCacheStats get_font_glyph_cache_stats()
+{
+    return ttfRenderer.GetGlyphCacheStats();
+}
+
 void wfreefont(size_t fontNumber)
 {
   if (fontNumber >= fonts.size())
@@ -20,6 +20,9 @@
 
 // TODO: we need to make some kind of TextManager class of this module
 
+// Default size of the rendered glyphs cache of the TTF fonts
+#define DEFAULT_GLYPHCACHESIZE_KB (8 * 1024)
+
 namespace AGS { namespace Common { class Bitmap; } }
 using namespace AGS;
 
@@ -27,6 +30,7 @@ class IAGSFontRenderer;
 class IAGSFontRenderer2;
 struct FontInfo;
 struct FontRenderParams;
+struct GlyphCacheStats;
 
 void init_font_renderer();
 void shutdown_font_renderer();
@@ -96,6 +100,11 @@ void alloc_font_outline_buffers(size_t font_number,
     int text_width, int text_height, int color_depth);
 // Perform necessary adjustments on all fonts in case the text render mode changed (anti-aliasing etc)
 void adjust_fonts_for_render_mode(bool aa_mode);
+// Sets the maximal memory size of the rendered glyphs cache of the TTF fonts;
+// 0 disables the cache
+void set_font_glyph_cache_size(size_t max_size);
+// Gets statistics of the rendered glyphs cache of the TTF fonts
+GlyphCacheStats get_font_glyph_cache_stats();
 // Free particular font's data
 void wfreefont(size_t fontNumber);
 // Free all fonts data
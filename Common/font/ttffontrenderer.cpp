@@ -12,11 +12,14 @@
 //
 //=============================================================================
 #include "font/ttffontrenderer.h"
+#include <string.h>
+#include <algorithm>
 #include <alfont.h>
 #include "ac/game_version.h"
 #include "core/platform.h"
 #include "core/assetmanager.h"
 #include "font/fonts.h"
+#include "util/geometry.h"
 #include "util/stream.h"
 
 using namespace AGS::Common;
@@ -39,7 +42,57 @@ void TTFFontRenderer::EnsureTextValidForFont(char * /*text*/, int /*fontNumber*/
 
 int TTFFontRenderer::GetTextWidth(const char *text, int fontNumber)
 {
-  return alfont_text_length(_fontData[fontNumber].AlFont, text);
+  if (!text)
+    return 0;
+  return GetTextWidthRange(text, text + strlen(text), fontNumber);
+}
+
+// NOTE: alfont_text_length() sums the advances of all the characters, as the
+// kerning is disabled in alfont, and AGS does not use the italic style or
+// fixed width mode; so the advances may be calculated once and reused.
+static int MeasureChar(ALFONT_FONT *alfptr, int code)
+{
+  char buf[8]{}; // enough for any character in any text format
+  usetc(buf, code);
+  return alfont_text_length(alfptr, buf);
+}
+
+int TTFFontRenderer::GetCharAdvance(FontData &font, int code)
+{
+  if (code >= 0 && code < 256)
+  {
+    int &advance = font.LowAdvances[code];
+    if (advance < 0)
+      advance = MeasureChar(font.AlFont, code);
+    return advance;
+  }
+  auto it = font.Advances.find(code);
+  if (it != font.Advances.end())
+    return it->second;
+  int advance = MeasureChar(font.AlFont, code);
+  font.Advances.insert(std::make_pair(code, advance));
+  return advance;
+}
+
+void TTFFontRenderer::ResetAdvances(FontData &font)
+{
+  font.LowAdvances.assign(256, -1);
+  font.Advances.clear();
+}
+
+int TTFFontRenderer::GetTextWidthRange(const char *text, const char *text_end, int fontNumber)
+{
+  FontData &font = _fontData[fontNumber];
+  int width = 0;
+  while (text < text_end)
+  {
+    // characters are decoded using the current text format, same as alfont does
+    const int code = ugetxc(&text);
+    if (code == 0)
+      break;
+    width += GetCharAdvance(font, code);
+  }
+  return width;
 }
 
 int TTFFontRenderer::GetTextHeight(const char * /*text*/, int fontNumber)
@@ -53,10 +106,240 @@ void TTFFontRenderer::RenderText(const char *text, int fontNumber, BITMAP *desti
     return;
 
   // Y - 1 because it seems to get drawn down a bit
-  if ((ShouldAntiAliasText()) && (bitmap_color_depth(destination) > 8))
-    alfont_textout_aa(destination, _fontData[fontNumber].AlFont, text, x, y - 1, colour);
+  FontData &font = _fontData[fontNumber];
+  const bool aa = ShouldAntiAliasText() && (bitmap_color_depth(destination) > 8);
+  if (RenderTextCached(font, text, destination, x, y - 1, colour, aa))
+    return;
+  if (aa)
+    alfont_textout_aa(destination, font.AlFont, text, x, y - 1, colour);
+  else
+    alfont_textout(destination, font.AlFont, text, x, y - 1, colour);
+}
+
+TTFFontRenderer::GlyphView TTFFontRenderer::GetGlyph(FontData &font, int code, bool aa)
+{
+  GlyphView view;
+  auto &glyphs = font.Atlas.Glyphs[aa ? 1 : 0];
+  auto it = glyphs.find(code);
+  if (it == glyphs.end())
+  {
+    _glyphStats.Misses++;
+    ALFONT_GLYPH_INFO info;
+    alfont_get_glyph_info(font.AlFont, code, aa ? 1 : 0, &info);
+    GlyphEntry glyph;
+    glyph.AdvanceX = info.advancex;
+    glyph.AdvanceY = info.advancey;
+    glyph.OffX = info.offx;
+    glyph.OffY = info.offy;
+    glyph.Width = info.width;
+    glyph.Height = info.height;
+    const size_t data_size = (info.bmp && info.width > 0 && info.height > 0) ?
+        static_cast<size_t>(info.width * info.height) : 0u;
+    const size_t add_size = sizeof(GlyphEntry) + data_size;
+    if (add_size > _glyphCacheLimit)
+    { // does not fit even in the empty cache, use alfont's data directly
+      view.AdvanceX = glyph.AdvanceX; view.AdvanceY = glyph.AdvanceY;
+      view.OffX = glyph.OffX; view.OffY = glyph.OffY;
+      view.Width = glyph.Width; view.Height = glyph.Height;
+      view.Bitmap = data_size > 0 ? info.bmp : nullptr;
+      return view;
+    }
+    if (_glyphStats.MemSize + add_size > _glyphCacheLimit)
+      EvictAtlases(font, add_size);
+    if (data_size > 0)
+    {
+      glyph.DataOffset = font.Atlas.Data.size();
+      font.Atlas.Data.insert(font.Atlas.Data.end(), info.bmp, info.bmp + data_size);
+    }
+    it = glyphs.insert(std::make_pair(code, glyph)).first;
+    _glyphStats.GlyphCount++;
+    _glyphStats.MemSize += add_size;
+  }
   else
-    alfont_textout(destination, _fontData[fontNumber].AlFont, text, x, y - 1, colour);
+  {
+    _glyphStats.Hits++;
+  }
+
+  const GlyphEntry &glyph = it->second;
+  view.AdvanceX = glyph.AdvanceX; view.AdvanceY = glyph.AdvanceY;
+  view.OffX = glyph.OffX; view.OffY = glyph.OffY;
+  view.Width = glyph.Width; view.Height = glyph.Height;
+  if (glyph.DataOffset != SIZE_MAX)
+    view.Bitmap = &font.Atlas.Data[glyph.DataOffset];
+  return view;
+}
+
+void TTFFontRenderer::ResetAtlas(FontData &font)
+{
+  for (auto &glyphs : font.Atlas.Glyphs)
+  {
+    _glyphStats.GlyphCount -= glyphs.size();
+    _glyphStats.MemSize -= glyphs.size() * sizeof(GlyphEntry);
+    glyphs.clear();
+  }
+  _glyphStats.MemSize -= font.Atlas.Data.size();
+  font.Atlas.Data.clear();
+  font.Atlas.Data.shrink_to_fit();
+}
+
+void TTFFontRenderer::ResetAllAtlases()
+{
+  for (auto &font : _fontData)
+    ResetAtlas(font.second);
+}
+
+void TTFFontRenderer::EvictAtlases(FontData &font, size_t add_size)
+{
+  while (_glyphStats.MemSize + add_size > _glyphCacheLimit)
+  {
+    FontData *lru_font = nullptr;
+    for (auto &other : _fontData)
+    {
+      const GlyphAtlas &atlas = other.second.Atlas;
+      if ((&other.second == &font) || (atlas.Glyphs[0].empty() && atlas.Glyphs[1].empty()))
+        continue;
+      if (!lru_font || (atlas.LastUse < lru_font->Atlas.LastUse))
+        lru_font = &other.second;
+    }
+    if (!lru_font)
+    { // only this font's glyphs are left
+      ResetAtlas(font);
+      _glyphStats.Evictions++;
+      return;
+    }
+    ResetAtlas(*lru_font);
+    _glyphStats.Evictions++;
+  }
+}
+
+void TTFFontRenderer::SetGlyphCacheLimit(size_t max_size)
+{
+  _glyphCacheLimit = max_size;
+  if (_glyphStats.MemSize > _glyphCacheLimit)
+    ResetAllAtlases();
+}
+
+// Same as __preservedalpha_blender_trans24 in alfont.c, which alfont uses
+// for drawing the antialiased text on 32-bit bitmaps
+static inline unsigned long BlendAlpha32(unsigned long x, unsigned long y, unsigned long n)
+{
+  unsigned long res, g, alpha;
+  alpha = (y & 0xFF000000);
+  if ((y & 0xFFFFFF) == 0xFF00FF)
+    return ((x & 0xFFFFFF) | (n << 24));
+  if (n)
+    n++;
+  res = ((x & 0xFF00FF) - (y & 0xFF00FF)) * n / 256 + y;
+  y &= 0xFF00;
+  x &= 0xFF00;
+  g = (x - y) * n / 256 + y;
+  res &= 0xFF00FF;
+  g &= 0xFF00;
+  return res | g | alpha;
+}
+
+// Same as __skiptranspixels_blender_trans16 in alfont.c
+static inline unsigned long BlendAlpha16(unsigned long x, unsigned long y, unsigned long n)
+{
+  unsigned long result;
+  if ((y & 0xFFFF) == 0xF81F)
+    return x;
+  if (n)
+    n = (n + 1) / 8;
+  x = ((x & 0xFFFF) | (x << 16)) & 0x7E0F81F;
+  y = ((y & 0xFFFF) | (y << 16)) & 0x7E0F81F;
+  result = ((x - y) * n / 32 + y) & 0x7E0F81F;
+  return ((result & 0xFFFF) | (result >> 16));
+}
+
+// Same as __skiptranspixels_blender_trans15 in alfont.c
+static inline unsigned long BlendAlpha15(unsigned long x, unsigned long y, unsigned long n)
+{
+  unsigned long result;
+  if ((y & 0xFFFF) == 0x7C1F)
+    return x;
+  if (n)
+    n = (n + 1) / 8;
+  x = ((x & 0xFFFF) | (x << 16)) & 0x3E07C1F;
+  y = ((y & 0xFFFF) | (y << 16)) & 0x3E07C1F;
+  result = ((x - y) * n / 32 + y) & 0x3E07C1F;
+  return ((result & 0xFFFF) | (result >> 16));
+}
+
+// Draws the glyph bitmap within the clipping rectangle: plain glyph pixels
+// are filled with color, and antialiased ones are blended the same way as
+// alfont does it with putpixel and the trans blender
+template <typename TPixel, unsigned long (*Blend)(unsigned long, unsigned long, unsigned long)>
+static void DrawGlyph(BITMAP *dst, const Rect &clip, int gx, int gy, int w, int h,
+    const uint8_t *bitmap, int colour, bool aa)
+{
+  const int x1 = std::max(0, clip.Left - gx), x2 = std::min(w, clip.Right + 1 - gx);
+  const int y1 = std::max(0, clip.Top - gy), y2 = std::min(h, clip.Bottom + 1 - gy);
+  const TPixel color = static_cast<TPixel>(colour);
+  for (int y = y1; y < y2; ++y)
+  {
+    TPixel *line = reinterpret_cast<TPixel*>(dst->line[gy + y]) + gx;
+    const uint8_t *src = bitmap + y * w;
+    for (int x = x1; x < x2; ++x)
+    {
+      const uint8_t a = src[x];
+      if (a == 0)
+        continue;
+      if (!aa || a >= 255)
+        line[x] = color;
+      else
+        line[x] = static_cast<TPixel>(Blend(colour, line[x], a));
+    }
+  }
+}
+
+static unsigned long NoBlend(unsigned long x, unsigned long, unsigned long)
+{
+  return x;
+}
+
+bool TTFFontRenderer::RenderTextCached(FontData &font, const char *text, BITMAP *destination, int x, int y, int colour, bool aa)
+{
+  if (_glyphCacheLimit == 0 || !is_memory_bitmap(destination))
+    return false;
+  const int depth = bitmap_color_depth(destination);
+  void(*draw_glyph)(BITMAP*, const Rect&, int, int, int, int, const uint8_t*, int, bool);
+  switch (depth)
+  {
+  case 8: if (aa) return false; draw_glyph = DrawGlyph<uint8_t, NoBlend>; break;
+  case 15: draw_glyph = DrawGlyph<uint16_t, BlendAlpha15>; break;
+  case 16: draw_glyph = DrawGlyph<uint16_t, BlendAlpha16>; break;
+  case 32: draw_glyph = DrawGlyph<uint32_t, BlendAlpha32>; break;
+  default: return false;
+  }
+
+  if (!text)
+    return true;
+  font.Atlas.LastUse = ++_atlasUseCounter;
+  // The string is considered clipped with the same condition as alfont uses
+  if ((y + alfont_get_font_height(font.AlFont) < destination->ct) ||
+      (y > destination->cb) || (x > destination->cr))
+    return true;
+  // NOTE: allegro's cr and cb are exclusive
+  const Rect clip = destination->clip ?
+      Rect(destination->cl, destination->ct, destination->cr - 1, destination->cb - 1) :
+      RectWH(0, 0, destination->w, destination->h);
+
+  // characters are decoded using the current text format, same as alfont does
+  for (int code = ugetxc(&text); code != 0; code = ugetxc(&text))
+  {
+    if (x > destination->cr)
+      break;
+    const GlyphView glyph = GetGlyph(font, code, aa);
+    if (glyph.Bitmap)
+      draw_glyph(destination, clip, x + glyph.OffX, y + glyph.OffY, glyph.Width, glyph.Height,
+        glyph.Bitmap, colour, aa);
+    x += glyph.AdvanceX;
+    y += glyph.AdvanceY;
+  }
+  // alfont leaves the solid drawing mode
+  solid_mode();
+  return true;
 }
 
 bool TTFFontRenderer::LoadFromDisk(int fontNumber, int fontSize)
@@ -122,6 +405,8 @@ bool TTFFontRenderer::LoadFromDiskEx(int fontNumber, int fontSize,
 
     _fontData[fontNumber].AlFont = alfptr;
     _fontData[fontNumber].Params = params ? *params : FontRenderParams();
+    ResetAdvances(_fontData[fontNumber]);
+    ResetAtlas(_fontData[fontNumber]);
     return true;
 }
 
@@ -138,11 +423,14 @@ void TTFFontRenderer::AdjustFontForAntiAlias(int fontNumber, bool /*aa_mode*/)
     const FontRenderParams &params = _fontData[fontNumber].Params;
     int old_height = alfont_get_font_height(alfptr);
     alfont_set_font_size_ex(alfptr, old_height, GetAlfontFlags(params.LoadMode));
+    ResetAdvances(_fontData[fontNumber]);
+    ResetAtlas(_fontData[fontNumber]);
   }
 }
 
 void TTFFontRenderer::FreeMemory(int fontNumber)
 {
+  ResetAtlas(_fontData[fontNumber]);
   alfont_destroy_font(_fontData[fontNumber].AlFont);
   _fontData.erase(fontNumber);
 }
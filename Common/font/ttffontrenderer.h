@@ -14,7 +14,10 @@
 #ifndef __AC_TTFFONTRENDERER_H
 #define __AC_TTFFONTRENDERER_H
 
+#include <stdint.h>
 #include <map>
+#include <unordered_map>
+#include <vector>
 #include "font/agsfontrenderer.h"
 #include "util/string.h"
 
@@ -38,6 +41,7 @@ public:
       FontMetrics *metrics) override;
   const char *GetName(int fontNumber) override;
   void AdjustFontForAntiAlias(int fontNumber, bool aa_mode) override;
+  int GetTextWidthRange(const char *text, const char *text_end, int fontNumber) override;
 
   //
   // Utility functions
@@ -48,13 +52,70 @@ public:
   // as close to the requested as possible; report its metrics
   static bool MeasureFontOfPixelHeight(const AGS::Common::String &filename, int pixel_height, FontMetrics *metrics);
 
+  // Sets the maximal memory size of the rendered glyphs cache, shared by all
+  // the fonts; 0 disables the cache, and the text is drawn by alfont directly
+  void SetGlyphCacheLimit(size_t max_size);
+  const GlyphCacheStats &GetGlyphCacheStats() const { return _glyphStats; }
+
 private:
+    // Rendered glyph, as stored in the font's atlas
+    struct GlyphEntry
+    {
+        int AdvanceX = 0, AdvanceY = 0;
+        int OffX = 0, OffY = 0; // bitmap's offset from the pen position
+        int Width = 0, Height = 0;
+        size_t DataOffset = SIZE_MAX; // position in the atlas data, SIZE_MAX if no bitmap
+    };
+
+    // Glyph atlas keeps the glyphs rendered at the font's current size,
+    // in one block of memory: 8-bit alpha for the antialiased glyphs,
+    // 0 or 1 per pixel for others
+    struct GlyphAtlas
+    {
+        std::unordered_map<int, GlyphEntry> Glyphs[2]; // plain and AA glyphs, by char code
+        std::vector<uint8_t> Data;
+        uint64_t LastUse = 0u; // use stamp, for evicting the least recently used atlas
+    };
+
+    // Glyph ready for drawing
+    struct GlyphView
+    {
+        int AdvanceX = 0, AdvanceY = 0;
+        int OffX = 0, OffY = 0;
+        int Width = 0, Height = 0;
+        const uint8_t *Bitmap = nullptr;
+    };
+
     struct FontData
     {
         ALFONT_FONT     *AlFont;
         FontRenderParams Params;
+        // Cached character advances, for the first 256 character codes
+        // (-1 means not calculated yet), and for the rest
+        std::vector<int> LowAdvances;
+        std::unordered_map<int, int> Advances;
+        GlyphAtlas Atlas;
     };
+
+    // Gets the character's advance, calculating and caching it if necessary
+    static int GetCharAdvance(FontData &font, int code);
+    static void ResetAdvances(FontData &font);
+    // Gets the rendered glyph, adding it to the font's atlas if necessary
+    GlyphView GetGlyph(FontData &font, int code, bool aa);
+    void ResetAtlas(FontData &font);
+    void ResetAllAtlases();
+    // Frees the cache space for the new glyph of the given font, by dropping
+    // the atlases of the least recently used fonts; the font's own atlas is
+    // only dropped if the others did not free enough
+    void EvictAtlases(FontData &font, size_t add_size);
+    // Draws text using the glyph atlas; returns false if the destination is not supported
+    bool RenderTextCached(FontData &font, const char *text, BITMAP *destination, int x, int y, int colour, bool aa);
+
     std::map<int, FontData> _fontData;
+    size_t _glyphCacheLimit = 0u;
+    GlyphCacheStats _glyphStats;
+    // Counter for stamping the atlases' use
+    uint64_t _atlasUseCounter = 0u;
 };
 
 #endif // __AC_TTFFONTRENDERER_H
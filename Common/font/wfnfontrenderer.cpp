@@ -47,16 +47,20 @@ void WFNFontRenderer::EnsureTextValidForFont(char *text, int fontNumber)
 
 int WFNFontRenderer::GetTextWidth(const char *text, int fontNumber)
 {
-  const WFNFont* font = _fontData[fontNumber].Font;
-  const FontRenderParams &params = _fontData[fontNumber].Params;
+  const int *advances = _fontData[fontNumber].Advances;
   int text_width = 0;
-
   for (; *text; ++text)
-  {
-    const WFNChar &wfn_char = font->GetChar(GetCharCode(*text, font));
-    text_width += wfn_char.Width;
-  }
-  return text_width * params.SizeMultiplier;
+    text_width += advances[(unsigned char)*text];
+  return text_width;
+}
+
+int WFNFontRenderer::GetTextWidthRange(const char *text, const char *text_end, int fontNumber)
+{
+  const int *advances = _fontData[fontNumber].Advances;
+  int text_width = 0;
+  for (; text < text_end && *text; ++text)
+    text_width += advances[(unsigned char)*text];
+  return text_width;
 }
 
 int WFNFontRenderer::GetTextHeight(const char *text, int fontNumber)
@@ -165,8 +169,11 @@ bool WFNFontRenderer::LoadFromDiskEx(int fontNumber, int /*fontSize*/,
     delete font;
     return false;
   }
-  _fontData[fontNumber].Font = font;
-  _fontData[fontNumber].Params = params ? *params : FontRenderParams();
+  FontData &font_data = _fontData[fontNumber];
+  font_data.Font = font;
+  font_data.Params = params ? *params : FontRenderParams();
+  for (int code = 0; code < 256; ++code)
+    font_data.Advances[code] = font->GetChar(GetCharCode(code, font)).Width * font_data.Params.SizeMultiplier;
   return true;
 }
 
@@ -38,12 +38,15 @@ public:
       FontMetrics *metrics) override;
   const char *GetName(int /*fontNumber*/) override { return ""; }
   void AdjustFontForAntiAlias(int /*fontNumber*/, bool /*aa_mode*/) override { /* do nothing */}
+  int GetTextWidthRange(const char *text, const char *text_end, int fontNumber) override;
 
 private:
   struct FontData
   {
     WFNFont         *Font;
     FontRenderParams Params;
+    // Scaled widths of all the 256 character codes
+    int              Advances[256];
   };
   std::map<int, FontData> _fontData;
 };
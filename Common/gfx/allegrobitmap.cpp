@@ -105,6 +105,14 @@ bool Bitmap::ResizeSubBitmap(int width, int height)
     return true;
 }
 
+bool Bitmap::CreateOnData(int width, int height, int color_depth, uint8_t *data)
+{
+    Destroy();
+    _alBitmap = create_bitmap_on_data(color_depth, width, height, data);
+    _isDataOwner = true; // owns the allegro struct, but not the pixels
+    return _alBitmap != nullptr;
+}
+
 bool Bitmap::CreateCopy(Bitmap *src, int color_depth)
 {
     if (Create(src->_alBitmap->w, src->_alBitmap->h, color_depth ? color_depth : bitmap_color_depth(src->_alBitmap)))
@@ -50,6 +50,9 @@ public:
     bool    CreateSubBitmap(Bitmap *src, const Rect &rc);
     // Resizes existing sub-bitmap within the borders of its parent
     bool    ResizeSubBitmap(int width, int height);
+    // Create a bitmap which uses external pixel buffer; the buffer must
+    // stay valid while the bitmap exists, and is not freed by the bitmap
+    bool    CreateOnData(int width, int height, int color_depth, uint8_t *data);
     // Create a copy of given bitmap
     bool	CreateCopy(Bitmap *src, int color_depth = 0);
     // TODO: a temporary solution for plugin support
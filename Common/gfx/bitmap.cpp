@@ -69,6 +69,17 @@ Bitmap *CreateSubBitmap(Bitmap *src, const Rect &rc)
 	return bitmap;
 }
 
+Bitmap *CreateBitmapOnData(int width, int height, int color_depth, uint8_t *data)
+{
+    Bitmap *bitmap = new Bitmap();
+    if (!bitmap->CreateOnData(width, height, color_depth, data))
+    {
+        delete bitmap;
+        bitmap = nullptr;
+    }
+    return bitmap;
+}
+
 Bitmap *CreateBitmapCopy(Bitmap *src, int color_depth)
 {
     Bitmap *bitmap = new Bitmap();
@@ -67,6 +67,8 @@ namespace BitmapHelper
     Bitmap *CreateTransparentBitmap(int width, int height, int color_depth = 0);
 	Bitmap *CreateSubBitmap(Bitmap *src, const Rect &rc);
     Bitmap *CreateBitmapCopy(Bitmap *src, int color_depth = 0);
+    // Creates a bitmap over an external pixel buffer, see Bitmap::CreateOnData
+    Bitmap *CreateBitmapOnData(int width, int height, int color_depth, uint8_t *data);
 	Bitmap *LoadFromFile(const char *filename);
     inline Bitmap *LoadFromFile(const String &filename) { return LoadFromFile(filename.GetCStr()); }
     Bitmap *LoadFromFile(PACKFILE *pf);
@@ -86,6 +86,11 @@ void GUIMain::InitDefaults()
     _controls.clear();
     _ctrlRefs.clear();
     _ctrlDrawOrder.clear();
+    _ctrlDrawState.clear();
+    _drawnCtrlOrder.clear();
+    _drawnHighlight = -1;
+    _drawnDisabled = false;
+    _hasDrawState = false;
 }
 
 int GUIMain::FindControlAt(int atx, int aty, int leeway, bool must_be_clickable) const
@@ -281,44 +286,131 @@ void GUIMain::DrawWithControls(Bitmap *ds)
 {
     ds->ResetClip();
     DrawSelf(ds);
+    _hasDrawState = false;
 
     if ((all_buttons_disabled >= 0) && (GUI::Options.DisabledStyle == kGuiDis_Blackout))
         return; // don't draw GUI controls
 
-    Bitmap tempbmp; // in case we need transforms
+    _ctrlDrawState.resize(_controls.size());
     for (size_t ctrl_index = 0; ctrl_index < _controls.size(); ++ctrl_index)
+        UpdateControlDrawState(ctrl_index, true);
+    DrawControls(ds, RectWH(0, 0, ds->GetWidth(), ds->GetHeight()));
+    ds->ResetClip();
+
+    for (auto *ctrl : _controls)
+        ctrl->ClearChanged();
+    _drawnCtrlOrder = _ctrlDrawOrder;
+    _drawnHighlight = HighlightCtrl;
+    _drawnDisabled = all_buttons_disabled >= 0;
+    _hasDrawState = true;
+    SET_EIP(380);
+}
+
+// Max number of separate regions to redraw on the GUI; if there are more
+// changes, then the regions are merged into one
+static const size_t MaxGUIDirtyRects = 8;
+
+// Adds a region to the list of dirty rects, merging it with any overlapping ones
+static void add_dirty_rect(std::vector<Rect> &rects, Rect rc)
+{
+    if (rc.IsEmpty())
+        return;
+    for (size_t i = 0; i < rects.size();)
+    {
+        if (AreRectsIntersecting(rects[i], rc))
+        {
+            rc = SumRects(rects[i], rc);
+            rects.erase(rects.begin() + i);
+            i = 0; // grown rect may now overlap previous ones
+        }
+        else
+        {
+            ++i;
+        }
+    }
+    rects.push_back(rc);
+    if (rects.size() > MaxGUIDirtyRects)
     {
-        set_eip_guiobj(_ctrlDrawOrder[ctrl_index]);
+        for (size_t i = 1; i < rects.size(); ++i)
+            rects[0] = SumRects(rects[0], rects[i]);
+        rects.resize(1);
+    }
+}
 
-        GUIObject *objToDraw = _controls[_ctrlDrawOrder[ctrl_index]];
+bool GUIMain::DrawChangedControls(Bitmap *ds, std::vector<Rect> &dirty_rects)
+{
+    dirty_rects.clear();
+    if (!_hasDrawState || (_ctrlDrawState.size() != _controls.size()) ||
+        (_drawnCtrlOrder != _ctrlDrawOrder) || (_drawnDisabled != (all_buttons_disabled >= 0)))
+        return false; // partial update is not possible
 
-        if (!objToDraw->IsVisible() || (objToDraw->Width <= 0 || objToDraw->Height <= 0))
+    // Gather the old and new areas of all the changed controls
+    const Rect gui_area = RectWH(0, 0, ds->GetWidth(), ds->GetHeight());
+    for (size_t ctrl_index = 0; ctrl_index < _controls.size(); ++ctrl_index)
+    {
+        const bool highlight_changed = (HighlightCtrl != _drawnHighlight) &&
+            ((HighlightCtrl == (int)ctrl_index) || (_drawnHighlight == (int)ctrl_index));
+        if (!_controls[ctrl_index]->HasChanged() && !highlight_changed &&
+            !HasControlDrawStateChanged(ctrl_index))
             continue;
-        if (!objToDraw->IsEnabled() && (GUI::Options.DisabledStyle == kGuiDis_Blackout))
+
+        const ControlDrawState &state = _ctrlDrawState[ctrl_index];
+        if (state.Drawn)
+            add_dirty_rect(dirty_rects, IntersectRects(gui_area, state.Area));
+        UpdateControlDrawState(ctrl_index, false);
+        if (state.Drawn)
+            add_dirty_rect(dirty_rects, IntersectRects(gui_area, state.Area));
+    }
+
+    // Repaint the GUI background and all the controls within each region
+    for (const auto &rc : dirty_rects)
+    {
+        ds->SetClip(rc);
+        ds->ClearTransparent();
+        DrawSelf(ds);
+        DrawControls(ds, rc);
+    }
+    ds->ResetClip();
+
+    for (auto *ctrl : _controls)
+        ctrl->ClearChanged();
+    _drawnHighlight = HighlightCtrl;
+    SET_EIP(380);
+    return true;
+}
+
+void GUIMain::DrawControls(Bitmap *ds, const Rect &area)
+{
+    for (size_t draw_index = 0; draw_index < _ctrlDrawOrder.size(); ++draw_index)
+    {
+        const int ctrl_index = _ctrlDrawOrder[draw_index];
+        set_eip_guiobj(ctrl_index);
+
+        const ControlDrawState &state = _ctrlDrawState[ctrl_index];
+        if (!state.Drawn || !AreRectsIntersecting(state.Area, area))
             continue;
 
-        // Depending on draw properties - draw directly on the gui surface, or use a buffer
-        if (objToDraw->GetTransparency() == 0)
+        GUIObject *objToDraw = _controls[ctrl_index];
+        // Depending on draw properties - draw directly on the gui surface, or use a cached image
+        if (state.Image)
         {
-            if (GUI::Options.ClipControls && objToDraw->IsContentClipped())
-                ds->SetClip(RectWH(objToDraw->X, objToDraw->Y, objToDraw->Width, objToDraw->Height));
-            else
-                ds->ResetClip();
-            objToDraw->Draw(ds, objToDraw->X, objToDraw->Y);
+            ds->SetClip(area);
+            draw_gui_sprite(ds, true, state.ImagePos.X, state.ImagePos.Y,
+                state.Image.get(), objToDraw->HasAlphaChannel(), kBlendMode_Alpha,
+                GfxDef::LegacyTrans255ToAlpha255(objToDraw->GetTransparency()));
         }
         else
         {
-            const Rect rc = objToDraw->CalcGraphicRect(GUI::Options.ClipControls && objToDraw->IsContentClipped());
-            tempbmp.CreateTransparent(rc.GetWidth(), rc.GetHeight());
-            objToDraw->Draw(&tempbmp, -rc.Left, -rc.Top);
-            draw_gui_sprite(ds, true, objToDraw->X + rc.Left, objToDraw->Y + rc.Top,
-                &tempbmp, objToDraw->HasAlphaChannel(), kBlendMode_Alpha,
-                GfxDef::LegacyTrans255ToAlpha255(objToDraw->GetTransparency()));
+            if (GUI::Options.ClipControls && objToDraw->IsContentClipped())
+                ds->SetClip(IntersectRects(area, state.Frame));
+            else
+                ds->SetClip(area);
+            objToDraw->Draw(ds, objToDraw->X, objToDraw->Y);
         }
 
         int selectedColour = 14;
 
-        if (HighlightCtrl == _ctrlDrawOrder[ctrl_index])
+        if (HighlightCtrl == ctrl_index)
         {
             if (GUI::Options.OutlineControls)
                 selectedColour = 13;
@@ -332,21 +424,80 @@ void GUIMain::DrawWithControls(Bitmap *ds)
         if (GUI::Options.OutlineControls)
         {
             // draw a dotted outline round all objects
+            // NOTE: PutPixel ignores clipping, so test against the area here
             color_t draw_color = ds->GetCompatibleColor(selectedColour);
+            auto put_pixel = [ds, &area, draw_color](int x, int y)
+                { if (area.IsInside(x, y)) ds->PutPixel(x, y, draw_color); };
             for (int i = 0; i < objToDraw->Width; i += 2)
             {
-                ds->PutPixel(i + objToDraw->X, objToDraw->Y, draw_color);
-                ds->PutPixel(i + objToDraw->X, objToDraw->Y + objToDraw->Height - 1, draw_color);
+                put_pixel(i + objToDraw->X, objToDraw->Y);
+                put_pixel(i + objToDraw->X, objToDraw->Y + objToDraw->Height - 1);
             }
             for (int i = 0; i < objToDraw->Height; i += 2)
             {
-                ds->PutPixel(objToDraw->X, i + objToDraw->Y, draw_color);
-                ds->PutPixel(objToDraw->X + objToDraw->Width - 1, i + objToDraw->Y, draw_color);
+                put_pixel(objToDraw->X, i + objToDraw->Y);
+                put_pixel(objToDraw->X + objToDraw->Width - 1, i + objToDraw->Y);
             }
         }
     }
+}
 
-    SET_EIP(380);
+bool GUIMain::HasControlDrawStateChanged(int index) const
+{
+    const GUIObject *obj = _controls[index];
+    const ControlDrawState &state = _ctrlDrawState[index];
+    const bool drawn = obj->IsVisible() && (obj->Width > 0) && (obj->Height > 0) &&
+        (obj->IsEnabled() || (GUI::Options.DisabledStyle != kGuiDis_Blackout));
+    return (drawn != state.Drawn) ||
+        !(RectWH(obj->X, obj->Y, obj->Width, obj->Height) == state.Frame) ||
+        (obj->GetTransparency() != state.Transparency) ||
+        (obj->IsEnabled() != state.Enabled);
+}
+
+void GUIMain::UpdateControlDrawState(int index, bool redraw_image)
+{
+    GUIObject *obj = _controls[index];
+    ControlDrawState &state = _ctrlDrawState[index];
+    state.Drawn = obj->IsVisible() && (obj->Width > 0) && (obj->Height > 0) &&
+        (obj->IsEnabled() || (GUI::Options.DisabledStyle != kGuiDis_Blackout));
+    state.Frame = RectWH(obj->X, obj->Y, obj->Width, obj->Height);
+    state.Transparency = obj->GetTransparency();
+    state.Enabled = obj->IsEnabled();
+    if (!state.Drawn)
+    {
+        state.Image.reset();
+        return;
+    }
+
+    // Selection blobs may stick out of the very small controls
+    const int blob_size = get_fixed_pixel_size(1);
+    const Rect blobs_rc(std::min(obj->X, obj->X + obj->Width - blob_size - 1),
+        std::min(obj->Y, obj->Y + obj->Height - blob_size - 1),
+        std::max(obj->X + blob_size, obj->X + obj->Width - 1),
+        std::max(obj->Y + blob_size, obj->Y + obj->Height - 1));
+    const bool clipped = GUI::Options.ClipControls && obj->IsContentClipped();
+    if (obj->GetTransparency() == 0)
+    {
+        // Opaque controls are drawn directly on the gui surface
+        state.Image.reset();
+        state.Area = clipped ? blobs_rc :
+            SumRects(blobs_rc, OffsetRect(obj->CalcGraphicRect(false), Point(obj->X, obj->Y)));
+        return;
+    }
+
+    // Translucent controls are drawn on a separate image first, which is kept
+    // until the control changes, and blended onto the gui surface
+    const Rect rc = obj->CalcGraphicRect(clipped);
+    state.Area = SumRects(blobs_rc, OffsetRect(rc, Point(obj->X, obj->Y)));
+    state.ImagePos = Point(obj->X + rc.Left, obj->Y + rc.Top);
+    if (!redraw_image && state.Image && !obj->HasChanged() &&
+        (state.Image->GetWidth() == rc.GetWidth()) && (state.Image->GetHeight() == rc.GetHeight()))
+        return; // cached image is still valid
+
+    if (!state.Image)
+        state.Image.reset(new Bitmap());
+    state.Image->CreateTransparent(rc.GetWidth(), rc.GetHeight());
+    obj->Draw(state.Image.get(), -rc.Left, -rc.Top);
 }
 
 void GUIMain::DrawBlob(Bitmap *ds, int x, int y, color_t draw_color)
@@ -427,6 +578,7 @@ HError GUIMain::RebuildArray()
     }
 
     ResortZOrder();
+    _hasDrawState = false;
     return HError::None();
 }
 
@@ -14,6 +14,7 @@
 #ifndef __AC_GUIMAIN_H
 #define __AC_GUIMAIN_H
 
+#include <memory>
 #include <vector>
 #include "ac/common_defines.h" // TODO: split out gui drawing helpers
 #include "gfx/gfx_def.h" // TODO: split out gui drawing helpers
@@ -121,6 +122,13 @@ public:
     bool    BringControlToFront(int index);
     void    DrawSelf(Bitmap *ds);
     void    DrawWithControls(Bitmap *ds);
+    // Redraws only those parts of the GUI surface which are affected by the
+    // controls changed since the last DrawWithControls or DrawChangedControls;
+    // the surface is expected to still contain the result of that previous draw.
+    // Fills the list of updated regions, in GUI's local coordinates.
+    // Returns false if the partial update is not possible; in such case nothing
+    // is drawn, and the whole GUI must be redrawn with DrawWithControls.
+    bool    DrawChangedControls(Bitmap *ds, std::vector<Rect> &dirty_rects);
     // Polls GUI state, providing current cursor (mouse) coordinates
     void    Poll(int mx, int my);
     HError  RebuildArray();
@@ -154,6 +162,13 @@ public:
 
 private:
     void    DrawBlob(Bitmap *ds, int x, int y, color_t draw_color);
+    // Draws the controls which intersect the given area, clipped by that area
+    void    DrawControls(Bitmap *ds, const Rect &area);
+    // Tells if the control's drawing state differs from the one it was last drawn with
+    bool    HasControlDrawStateChanged(int index) const;
+    // Records the control's current drawing state, and redraws its cached
+    // image if necessary; redraw_image forces to redraw the cached image
+    void    UpdateControlDrawState(int index, bool redraw_image);
     // Same as FindControlAt but expects local space coordinates
     int32_t FindControlAtLocal(int atx, int aty, int leeway, bool must_be_clickable) const;
 
@@ -197,6 +212,26 @@ private:
     std::vector<GUIObject*> _controls;
     // Sorted array of controls in z-order.
     std::vector<int32_t>    _ctrlDrawOrder;
+
+    // Control's state as of the last time it was drawn on the GUI surface
+    struct ControlDrawState
+    {
+        bool    Drawn = false;  // whether control was drawn at all
+        Rect    Frame;          // control's position and size
+        Rect    Area;           // the area of the GUI covered by the control's graphic
+        int     Transparency = 0;
+        bool    Enabled = false;
+        // Cached image of a translucent control, and its position on GUI
+        std::shared_ptr<Bitmap> Image;
+        Point   ImagePos;
+    };
+    // Drawing states of the child controls, used to find out which parts
+    // of the GUI surface have to be redrawn after controls change
+    std::vector<ControlDrawState> _ctrlDrawState;
+    std::vector<int32_t> _drawnCtrlOrder; // controls z-order at the last draw
+    int32_t _drawnHighlight;  // highlighted control at the last draw
+    bool    _drawnDisabled;   // whether all controls were disabled at the last draw
+    bool    _hasDrawState;    // whether the recorded drawing states are valid
 };
 
 
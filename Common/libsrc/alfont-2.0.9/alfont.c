@@ -4937,6 +4937,40 @@ void alfont_set_char_extra_spacing(ALFONT_FONT *f, int spacing) {
 }
 
 
+int alfont_get_glyph_info(ALFONT_FONT *f, int character, int aa, ALFONT_GLYPH_INFO *info) {
+  int glyph_index;
+  struct _ALFONT_CACHED_GLYPH *cglyph;
+
+  /* get the character out of the font */
+  if (f->face->charmap)
+    glyph_index = FT_Get_Char_Index(f->face, character);
+  else
+    glyph_index = character;
+
+  /* cache the glyph */
+  _alfont_cache_glyph(f, glyph_index);
+  cglyph = &f->cached_glyphs[glyph_index];
+
+  info->advancex = cglyph->advancex ? cglyph->advancex + f->ch_spacing : 0;
+  info->advancey = cglyph->advancey ? cglyph->advancey + f->ch_spacing : 0;
+  if (aa) {
+    info->offx = cglyph->aaleft;
+    info->offy = f->face_ascender - cglyph->aatop;
+    info->width = cglyph->aawidth;
+    info->height = cglyph->aaheight;
+    info->bmp = cglyph->aa_available ? cglyph->aabmp : NULL;
+  }
+  else {
+    info->offx = cglyph->left;
+    info->offy = f->face_ascender - cglyph->top;
+    info->width = cglyph->width;
+    info->height = cglyph->height;
+    info->bmp = cglyph->mono_available ? cglyph->bmp : NULL;
+  }
+  return info->bmp != NULL;
+}
+
+
 void alfont_set_language(ALFONT_FONT *f, const char *language) {
   if (language == NULL) {
 	f->language = NULL;
@@ -117,6 +117,20 @@ ALFONT_DLL_DECLSPEC int alfont_get_nof_available_fixed_sizes(ALFONT_FONT *f);
 ALFONT_DLL_DECLSPEC int alfont_get_char_extra_spacing(ALFONT_FONT *f);
 ALFONT_DLL_DECLSPEC void alfont_set_char_extra_spacing(ALFONT_FONT *f, int spacing);
 
+/* rendered glyph data, for drawing the text without alfont (AGS addition) */
+typedef struct ALFONT_GLYPH_INFO {
+  int advancex, advancey;  /* pen advance, including the extra char spacing */
+  int offx, offy;          /* glyph bitmap's offset from the pen position */
+  int width, height;
+  const unsigned char *bmp;/* glyph bitmap, one byte per pixel: 0-255 alpha for
+                              the antialiased glyph, 0 or 1 otherwise; may be NULL */
+} ALFONT_GLYPH_INFO;
+
+/* Gets the glyph of the given character, rendered the same way as used by
+   alfont_textout_aa (if aa is set) or alfont_textout; returns 0 if the glyph
+   has no bitmap (it still has an advance) */
+ALFONT_DLL_DECLSPEC int alfont_get_glyph_info(ALFONT_FONT *f, int character, int aa, ALFONT_GLYPH_INFO *info);
+
 #ifdef __cplusplus
 }
 #endif
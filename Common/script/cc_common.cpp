@@ -39,7 +39,8 @@ int ccGetOption(int optbit)
 // Returns current running script callstack as a human-readable text
 extern String cc_get_callstack(int max_lines = INT_MAX);
 
-static ScriptError ccError;
+// Last error is kept per thread, so that scripts may be compiled in parallel
+static thread_local ScriptError ccError;
 
 void cc_clear_error()
 {
@@ -52,6 +52,6 @@ void cc_error(const ScriptError &err);
 // Project-dependent script error formatting
 AGS::Common::String cc_format_error(const AGS::Common::String &message);
 
-extern int currentline;
+extern thread_local int currentline;
 
 #endif // __CC_ERROR_H
@@ -22,8 +22,8 @@
 
 using namespace AGS::Common;
 
-// currently executed line
-int currentline;
+// currently executed (or compiled) line, per thread
+thread_local int currentline;
 // script file format signature
 const char scfilesig[5] = "SCOM";
 
@@ -0,0 +1,261 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+#include <chrono>
+#include <memory>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "gtest/gtest.h"
+#include "core/platform.h"
+#include "core/assetmanager.h"
+#include "util/file.h"
+#include "util/multifilelib.h"
+#include "util/path.h"
+#include "util/stream.h"
+#include "util/string_utils.h"
+
+using namespace AGS::Common;
+
+#if (AGS_PLATFORM_TEST_FILE_IO)
+
+// Writes asset library, where each asset contains its own name and a tag
+static void WriteTestLib(const String &filename, const std::vector<String> &names, int tag)
+{
+    AssetLibInfo lib;
+    lib.LibFileNames.push_back(filename);
+    for (const auto &name : names)
+    {
+        AssetInfo asset;
+        asset.FileName = name;
+        asset.LibUid = 0;
+        lib.AssetInfos.push_back(asset);
+    }
+
+    std::unique_ptr<Stream> out(File::CreateFile(filename));
+    ASSERT_TRUE(out.get());
+    MFLUtil::WriteHeader(lib, MFLUtil::kMFLVersion_MultiV30, 0, out.get());
+    for (auto &asset : lib.AssetInfos)
+    {
+        asset.Offset = out->GetPosition();
+        StrUtil::WriteString(asset.FileName, out.get());
+        out->WriteInt32(tag);
+        asset.Size = out->GetPosition() - asset.Offset;
+    }
+    out->Seek(0, kSeekBegin);
+    MFLUtil::WriteHeader(lib, MFLUtil::kMFLVersion_MultiV30, 0, out.get());
+    out->Seek(0, kSeekEnd);
+    MFLUtil::WriteEnder(0, MFLUtil::kMFLVersion_MultiV30, out.get());
+}
+
+// Opens the asset and reads its name and tag back
+static bool ReadTestAsset(const AssetManager &mgr, const String &name, const String &filter,
+    String &real_name, int &tag)
+{
+    std::unique_ptr<Stream> in(mgr.OpenAsset(name, filter));
+    if (!in)
+        return false;
+    real_name = StrUtil::ReadString(in.get());
+    tag = in->ReadInt32();
+    return true;
+}
+
+static const char *TestLib1 = "assettest1.dat";
+static const char *TestLib2 = "assettest2.dat";
+
+class AssetManagerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        WriteTestLib(TestLib1, { "room1.crm", "Room2.crm", "speech.vox", "Sound1.ogg", "sound10.ogg", "music.ogg" }, 1);
+        WriteTestLib(TestLib2, { "room2.crm", "sound2.ogg", "SOUND1.OGG", "other.dat" }, 2);
+    }
+
+    void TearDown() override {
+        File::DeleteFile(TestLib1);
+        File::DeleteFile(TestLib2);
+    }
+};
+
+TEST_F(AssetManagerTest, OpenAsset) {
+    AssetManager mgr;
+    ASSERT_EQ(kAssetNoError, mgr.AddLibrary(TestLib1));
+    ASSERT_EQ(kAssetNoError, mgr.AddLibrary(TestLib2, "audio"));
+
+    String name; int tag;
+    ASSERT_TRUE(ReadTestAsset(mgr, "ROOM1.CRM", "", name, tag));
+    EXPECT_STREQ("room1.crm", name.GetCStr()); EXPECT_EQ(1, tag);
+    ASSERT_TRUE(ReadTestAsset(mgr, "room2.crm", "", name, tag));
+    EXPECT_STREQ("Room2.crm", name.GetCStr()); EXPECT_EQ(1, tag);
+    // second library is only searched with the matching filter
+    EXPECT_FALSE(ReadTestAsset(mgr, "sound2.ogg", "", name, tag));
+    ASSERT_TRUE(ReadTestAsset(mgr, "Sound2.ogg", "audio", name, tag));
+    EXPECT_STREQ("sound2.ogg", name.GetCStr()); EXPECT_EQ(2, tag);
+    ASSERT_TRUE(ReadTestAsset(mgr, "sound1.ogg", "audio", name, tag));
+    EXPECT_STREQ("SOUND1.OGG", name.GetCStr()); EXPECT_EQ(2, tag);
+    // "*" filter searches everywhere, in the order of libraries
+    ASSERT_TRUE(ReadTestAsset(mgr, "sound1.ogg", "*", name, tag));
+    EXPECT_STREQ("Sound1.ogg", name.GetCStr()); EXPECT_EQ(1, tag);
+    EXPECT_FALSE(ReadTestAsset(mgr, "missing.ogg", "*", name, tag));
+
+    EXPECT_TRUE(mgr.DoesAssetExist("MUSIC.ogg"));
+    EXPECT_FALSE(mgr.DoesAssetExist("other.dat"));
+    EXPECT_TRUE(mgr.DoesAssetExist("other.dat", "audio"));
+    AssetLocation loc;
+    ASSERT_TRUE(mgr.GetAssetLocation("Other.Dat", loc, "audio"));
+    EXPECT_EQ(Path::MakeAbsolutePath(TestLib2), Path::MakeAbsolutePath(loc.FileName));
+
+    // removing a library updates the index
+    mgr.RemoveLibrary(TestLib1);
+    ASSERT_TRUE(ReadTestAsset(mgr, "room2.crm", "*", name, tag));
+    EXPECT_STREQ("room2.crm", name.GetCStr()); EXPECT_EQ(2, tag);
+    EXPECT_FALSE(mgr.DoesAssetExist("room1.crm", "*"));
+    // re-adding puts it after the remaining one
+    ASSERT_EQ(kAssetNoError, mgr.AddLibrary(TestLib1, "audio"));
+    ASSERT_TRUE(ReadTestAsset(mgr, "sound1.ogg", "audio", name, tag));
+    EXPECT_EQ(2, tag);
+    ASSERT_TRUE(ReadTestAsset(mgr, "room1.crm", "audio", name, tag));
+    EXPECT_EQ(1, tag);
+}
+
+TEST_F(AssetManagerTest, FindAssets) {
+    AssetManager mgr;
+    ASSERT_EQ(kAssetNoError, mgr.AddLibrary(TestLib1));
+    ASSERT_EQ(kAssetNoError, mgr.AddLibrary(TestLib2, "audio"));
+
+    std::vector<String> assets;
+    mgr.FindAssets(assets, "sound*.ogg");
+    ASSERT_EQ(2u, assets.size());
+    EXPECT_STREQ("Sound1.ogg", assets[0].GetCStr());
+    EXPECT_STREQ("sound10.ogg", assets[1].GetCStr());
+
+    assets.clear();
+    mgr.FindAssets(assets, "SOUND?.OGG", "*");
+    ASSERT_EQ(3u, assets.size());
+    EXPECT_STREQ("SOUND1.OGG", assets[0].GetCStr());
+    EXPECT_STREQ("Sound1.ogg", assets[1].GetCStr());
+    EXPECT_STREQ("sound2.ogg", assets[2].GetCStr());
+
+    assets.clear();
+    mgr.FindAssets(assets, "*.crm");
+    ASSERT_EQ(2u, assets.size());
+    EXPECT_STREQ("Room2.crm", assets[0].GetCStr());
+    EXPECT_STREQ("room1.crm", assets[1].GetCStr());
+
+    assets.clear();
+    mgr.FindAssets(assets, "MUSIC.OGG");
+    ASSERT_EQ(1u, assets.size());
+    EXPECT_STREQ("music.ogg", assets[0].GetCStr());
+
+    assets.clear();
+    mgr.FindAssets(assets, "room*2*");
+    ASSERT_EQ(1u, assets.size());
+    EXPECT_STREQ("Room2.crm", assets[0].GetCStr());
+
+    assets.clear();
+    mgr.FindAssets(assets, "*");
+    EXPECT_EQ(6u, assets.size());
+}
+
+TEST_F(AssetManagerTest, AssetView) {
+    AssetManager mgr;
+    ASSERT_EQ(kAssetNoError, mgr.AddLibrary(TestLib1));
+    ASSERT_EQ(kAssetNoError, mgr.AddLibrary(TestLib2, "audio"));
+
+    AssetLocation loc;
+    ASSERT_TRUE(mgr.GetAssetLocation("sound2.ogg", loc, "audio"));
+    AssetDataView view;
+    if (!mgr.GetAssetView("sound2.ogg", view, "audio"))
+        return; // memory mapping is not supported on this platform
+    ASSERT_NE(nullptr, view.Data);
+    ASSERT_EQ(static_cast<size_t>(loc.Size), view.Size);
+    // view contains the same bytes that the stream reads
+    std::vector<uint8_t> buf(view.Size);
+    {
+        std::unique_ptr<Stream> in(mgr.OpenAsset("sound2.ogg", "audio"));
+        ASSERT_TRUE(in.get());
+        ASSERT_EQ(static_cast<soff_t>(view.Size), in->GetLength());
+        ASSERT_EQ(view.Size, in->Read(buf.data(), buf.size()));
+        EXPECT_TRUE(in->EOS());
+    }
+    EXPECT_EQ(0, memcmp(buf.data(), view.Data, view.Size));
+    EXPECT_FALSE(mgr.GetAssetView("sound2.ogg", view));
+
+    // streams and views stay valid after the library is gone
+    std::unique_ptr<Stream> in(mgr.OpenAsset("room1.crm"));
+    ASSERT_TRUE(in.get());
+    mgr.RemoveAllLibraries();
+    mgr.SetMemoryMapping(false);
+    EXPECT_EQ(0, memcmp(buf.data(), view.Data, view.Size));
+    EXPECT_STREQ("room1.crm", StrUtil::ReadString(in.get()).GetCStr());
+    EXPECT_EQ(1, in->ReadInt32());
+
+    // with mapping disabled, the assets are still read from files
+    ASSERT_EQ(kAssetNoError, mgr.AddLibrary(TestLib1));
+    EXPECT_FALSE(mgr.GetAssetView("room1.crm", view));
+    String name; int tag;
+    ASSERT_TRUE(ReadTestAsset(mgr, "Room1.crm", "", name, tag));
+    EXPECT_STREQ("room1.crm", name.GetCStr()); EXPECT_EQ(1, tag);
+}
+
+// Measures asset lookup and open latency with a large library.
+// Disabled by default, run with:
+// common_test --gtest_also_run_disabled_tests --gtest_filter=*Benchmark*
+TEST(AssetManagerBenchmark, DISABLED_OpenAsset) {
+    const int asset_count = 50000;
+    const int open_count = 20000;
+    std::vector<String> names;
+    for (int i = 0; i < asset_count; ++i)
+        names.push_back(String::FromFormat("Speech/Character%d/Line%05d.ogg", i % 40, i));
+    const char *lib_name = "assetbench.dat";
+    WriteTestLib(lib_name, names, 0);
+
+    typedef std::chrono::steady_clock Clock;
+    AssetManager mgr;
+    auto start = Clock::now();
+    ASSERT_EQ(kAssetNoError, mgr.AddLibrary(lib_name));
+    const double reg_sec = std::chrono::duration<double>(Clock::now() - start).count();
+
+    // request names in a different case, in a scattered order
+    std::vector<String> requests;
+    for (int i = 0; i < open_count; ++i)
+        requests.push_back(names[(i * 7919) % asset_count].Upper());
+
+    start = Clock::now();
+    int found = 0;
+    for (const auto &name : requests)
+        found += mgr.DoesAssetExist(name) ? 1 : 0;
+    const double exist_sec = std::chrono::duration<double>(Clock::now() - start).count();
+    EXPECT_EQ(open_count, found);
+
+    start = Clock::now();
+    for (const auto &name : requests)
+    {
+        std::unique_ptr<Stream> in(mgr.OpenAsset(name));
+        ASSERT_TRUE(in.get());
+    }
+    const double open_sec = std::chrono::duration<double>(Clock::now() - start).count();
+
+    start = Clock::now();
+    std::vector<String> assets;
+    for (int i = 0; i < 40; ++i)
+        mgr.FindAssets(assets, String::FromFormat("speech/character%d/*", i));
+    const double find_sec = std::chrono::duration<double>(Clock::now() - start).count();
+    EXPECT_EQ(static_cast<size_t>(asset_count), assets.size());
+
+    printf("%d assets: registered in %.3f ms; DoesAssetExist %.3f us, OpenAsset %.3f us, FindAssets (prefix) %.3f ms\n",
+        asset_count, reg_sec * 1000.0, exist_sec * 1000000.0 / open_count,
+        open_sec * 1000000.0 / open_count, find_sec * 1000.0 / 40);
+    File::DeleteFile(lib_name);
+}
+
+#endif // AGS_PLATFORM_TEST_FILE_IO
@@ -0,0 +1,296 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "gtest/gtest.h"
+#include "util/lz4.h"
+#include "util/lzw.h"
+#include "util/memorystream.h"
+#include "util/rle.h"
+#include "test/test_random.h"
+
+using namespace AGS::Common;
+
+// Makes a sprite-like 32-bit image: flat areas, gradients and some noise
+static std::vector<uint8_t> MakeTestImage(int width, int height)
+{
+    std::vector<uint8_t> data(width * height * 4);
+    uint32_t seed = 12345;
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            uint32_t col;
+            if (x < width / 4)
+                col = 0xFFFF00FF; // transparent key area
+            else if (y < height / 2)
+                col = 0xFF000000 | ((x / 4) << 16) | ((y / 2) << 8) | ((x + y) & 0xFF);
+            else
+            {
+                NextRandom(seed);
+                col = 0xFF000000 | ((seed >> 16) & 0x0F0F0F);
+            }
+            memcpy(&data[(y * width + x) * 4], &col, 4);
+        }
+    }
+    return data;
+}
+
+// Makes a 8-bit image similar to the room masks: large flat areas
+static std::vector<uint8_t> MakeTestMask(int width, int height)
+{
+    std::vector<uint8_t> data(width * height);
+    for (int y = 0; y < height; ++y)
+        for (int x = 0; x < width; ++x)
+            data[y * width + x] = static_cast<uint8_t>(((x / 40) + (y / 30) * 3) % 5 + ((x * y) % 97 == 0));
+    return data;
+}
+
+// Converts the 32-bit image to 16-bit, keeping the runs in place
+static std::vector<uint8_t> MakeTestImage16(const std::vector<uint8_t> &image32)
+{
+    std::vector<uint8_t> data(image32.size() / 2);
+    for (size_t i = 0; i < image32.size() / 4; ++i)
+    {
+        uint32_t col;
+        memcpy(&col, &image32[i * 4], 4);
+        const uint16_t col16 = static_cast<uint16_t>(((col >> 8) & 0xF800) | ((col >> 5) & 0x07E0) | ((col >> 3) & 0x001F));
+        memcpy(&data[i * 2], &col16, 2);
+    }
+    return data;
+}
+
+TEST(Compress, RLEFormat) {
+    // Runs, sequences, run longer than a single command, and the last pixel alone
+    std::vector<uint8_t> data = { 1, 1, 1, 2, 3, 4, 4 };
+    data.insert(data.end(), 130, 5);
+    data.push_back(6);
+    std::vector<uint8_t> packed;
+    rlecompress(data.data(), data.size(), 1, packed);
+    const std::vector<uint8_t> expect = {
+        (uint8_t)-2, 1,     // 3 x 1
+        2, 2, 3, 4,         // 2, 3, 4
+        1, 4, 5,            // 4, 5 (sequence takes the first pixel of the next run)
+        (uint8_t)-126, 5,   // 127 x 5
+        (uint8_t)-1, 5,     // 2 x 5
+        0, 6                // 6
+    };
+    ASSERT_TRUE(packed == expect);
+
+    // 16 and 32-bit pixels are stored as little-endian
+    const uint16_t data16[] = { 0x1234, 0x1234 };
+    const uint32_t data32[] = { 0x12345678, 0x9ABCDEF0 };
+    packed.clear();
+    rlecompress(reinterpret_cast<const uint8_t*>(data16), sizeof(data16), 2, packed);
+    ASSERT_TRUE(packed == (std::vector<uint8_t>{ (uint8_t)-1, 0x34, 0x12 }));
+    packed.clear();
+    rlecompress(reinterpret_cast<const uint8_t*>(data32), sizeof(data32), 4, packed);
+    ASSERT_TRUE(packed == (std::vector<uint8_t>{ 1, 0x78, 0x56, 0x34, 0x12, 0xF0, 0xDE, 0xBC, 0x9A }));
+}
+
+TEST(Compress, RLERoundTrip) {
+    const std::vector<uint8_t> image32 = MakeTestImage(160, 120);
+    const std::vector<uint8_t> images[] =
+        { MakeTestMask(160, 120), MakeTestImage16(image32), image32 };
+    const int bpps[] = { 1, 2, 4 };
+    for (int i = 0; i < 3; ++i)
+    {
+        const std::vector<uint8_t> &image = images[i];
+        const int bpp = bpps[i];
+        std::vector<uint8_t> packed;
+        rlecompress(image.data(), image.size(), bpp, packed);
+        ASSERT_LT(packed.size(), image.size());
+        // Decompress from memory
+        std::vector<uint8_t> unpacked(image.size() + 1, 0xAA);
+        ASSERT_TRUE(rleexpand(packed.data(), packed.size(), unpacked.data(), image.size(), bpp));
+        ASSERT_TRUE(memcmp(image.data(), unpacked.data(), image.size()) == 0);
+        ASSERT_EQ(unpacked[image.size()], 0xAA); // no write past the end
+        // Decompress from stream
+        std::fill(unpacked.begin(), unpacked.end(), 0);
+        MemoryStream in(packed.data(), packed.size());
+        ASSERT_TRUE(rleexpand(&in, unpacked.data(), image.size(), bpp));
+        ASSERT_TRUE(memcmp(image.data(), unpacked.data(), image.size()) == 0);
+        ASSERT_EQ(in.GetPosition(), static_cast<soff_t>(packed.size()));
+
+        // Malformed input
+        ASSERT_FALSE(rleexpand(packed.data(), packed.size() - 1, unpacked.data(), image.size(), bpp));
+        ASSERT_FALSE(rleexpand(packed.data(), 0, unpacked.data(), image.size(), bpp));
+        for (size_t j = 0; j < packed.size(); j += 11)
+        {
+            std::vector<uint8_t> corrupt = packed;
+            corrupt[j] ^= 0x85;
+            rleexpand(corrupt.data(), corrupt.size(), unpacked.data(), image.size(), bpp);
+        }
+    }
+}
+
+TEST(Compress, LZWRoundTrip) {
+    const std::vector<uint8_t> image = MakeTestImage(160, 120);
+    std::vector<uint8_t> packed;
+    {
+        MemoryStream in(image.data(), image.size());
+        VectorStream out(packed, kStream_Write);
+        ASSERT_TRUE(lzwcompress(&in, &out));
+    }
+    ASSERT_LT(packed.size(), image.size());
+    std::vector<uint8_t> unpacked(image.size());
+    MemoryStream in(packed.data(), packed.size());
+    MemoryStream out(unpacked.data(), unpacked.size(), kStream_Write);
+    ASSERT_TRUE(lzwexpand(&in, &out, unpacked.size()));
+    ASSERT_TRUE(unpacked == image);
+}
+
+TEST(Compress, LZ4RoundTrip) {
+    const std::vector<uint8_t> image = MakeTestImage(160, 120);
+    // Test various lengths, including the ones too short to have any matches
+    const size_t lengths[] = { 0, 1, 4, 12, 13, 16, 100, 1000, image.size() };
+    for (size_t len : lengths)
+    {
+        std::vector<uint8_t> packed;
+        lz4compress(image.data(), len, packed);
+        std::vector<uint8_t> unpacked(len + 1, 0xAA);
+        ASSERT_TRUE(lz4expand(packed.data(), packed.size(), unpacked.data(), len));
+        ASSERT_TRUE(memcmp(image.data(), unpacked.data(), len) == 0);
+        ASSERT_EQ(unpacked[len], 0xAA); // no write past the end
+    }
+
+    // Long runs, which produce the overlapping matches
+    std::vector<uint8_t> runs(100000);
+    for (size_t i = 0; i < runs.size(); ++i)
+        runs[i] = static_cast<uint8_t>((i / 1000) % 3 == 0 ? 7 : (i % ((i / 1000) % 11 + 1)));
+    std::vector<uint8_t> packed;
+    lz4compress(runs.data(), runs.size(), packed);
+    ASSERT_LT(packed.size(), runs.size() / 10);
+    std::vector<uint8_t> unpacked(runs.size());
+    ASSERT_TRUE(lz4expand(packed.data(), packed.size(), unpacked.data(), unpacked.size()));
+    ASSERT_TRUE(unpacked == runs);
+}
+
+TEST(Compress, LZ4Malformed) {
+    const std::vector<uint8_t> image = MakeTestImage(64, 64);
+    std::vector<uint8_t> packed;
+    lz4compress(image.data(), image.size(), packed);
+    std::vector<uint8_t> unpacked(image.size());
+    // Wrong output size
+    ASSERT_FALSE(lz4expand(packed.data(), packed.size(), unpacked.data(), unpacked.size() - 1));
+    ASSERT_FALSE(lz4expand(packed.data(), packed.size(), unpacked.data(), unpacked.size() / 2));
+    // Truncated input
+    ASSERT_FALSE(lz4expand(packed.data(), 0, unpacked.data(), unpacked.size()));
+    ASSERT_FALSE(lz4expand(packed.data(), packed.size() - 1, unpacked.data(), unpacked.size()));
+    ASSERT_FALSE(lz4expand(packed.data(), packed.size() / 2, unpacked.data(), unpacked.size()));
+    // Match offset pointing before the output start
+    const uint8_t bad_offset[] = { 0x10, 'A', 0x10, 0x00, 0x00 };
+    ASSERT_FALSE(lz4expand(bad_offset, sizeof(bad_offset), unpacked.data(), 6));
+    // Zero offset
+    const uint8_t zero_offset[] = { 0x10, 'A', 0x00, 0x00, 0x00 };
+    ASSERT_FALSE(lz4expand(zero_offset, sizeof(zero_offset), unpacked.data(), 6));
+    // Corrupted data must never crash
+    for (size_t i = 0; i < packed.size(); i += 7)
+    {
+        std::vector<uint8_t> corrupt = packed;
+        corrupt[i] ^= 0x5A;
+        lz4expand(corrupt.data(), corrupt.size(), unpacked.data(), unpacked.size());
+    }
+}
+
+// Compares speed of the RLE decompression from stream and from memory.
+// Disabled by default, run with:
+// common_test --gtest_also_run_disabled_tests --gtest_filter=CompressBenchmark.*
+TEST(CompressBenchmark, DISABLED_RLEDecompressionSpeed) {
+    const int num_images = 16;
+    const std::vector<uint8_t> image32 = MakeTestImage(320, 200);
+    const std::vector<uint8_t> images[] =
+        { MakeTestMask(320, 200), MakeTestImage16(image32), image32 };
+    const int bpps[] = { 1, 2, 4 };
+    typedef std::chrono::high_resolution_clock Clock;
+    for (int i = 0; i < 3; ++i)
+    {
+        const std::vector<uint8_t> &image = images[i];
+        const int bpp = bpps[i];
+        const double total_mb = (double)(image.size() * num_images) / (1024 * 1024);
+        std::vector<uint8_t> packed;
+        rlecompress(image.data(), image.size(), bpp, packed);
+        std::vector<uint8_t> unpacked(image.size());
+
+        auto t0 = Clock::now();
+        for (int n = 0; n < num_images; ++n)
+        {
+            MemoryStream in(packed.data(), packed.size());
+            rleexpand(&in, unpacked.data(), unpacked.size(), bpp);
+        }
+        auto stream_time = std::chrono::duration<double>(Clock::now() - t0).count();
+        ASSERT_TRUE(unpacked == image);
+
+        std::fill(unpacked.begin(), unpacked.end(), 0);
+        t0 = Clock::now();
+        for (int n = 0; n < num_images; ++n)
+        {
+            ASSERT_TRUE(rleexpand(packed.data(), packed.size(), unpacked.data(), unpacked.size(), bpp));
+        }
+        auto mem_time = std::chrono::duration<double>(Clock::now() - t0).count();
+        ASSERT_TRUE(unpacked == image);
+
+        printf("RLE %d-bit: ratio %.2f, decompression from stream %.1f MB/s, from memory %.1f MB/s\n",
+            bpp * 8, (double)packed.size() / image.size(),
+            total_mb / std::max(stream_time, 1e-9), total_mb / std::max(mem_time, 1e-9));
+    }
+}
+
+// Compares decompression speed of the sprite compression methods.
+// Disabled by default, run with:
+// common_test --gtest_also_run_disabled_tests --gtest_filter=CompressBenchmark.*
+TEST(CompressBenchmark, DISABLED_DecompressionSpeed) {
+    const int num_sprites = 16;
+    const std::vector<uint8_t> image = MakeTestImage(320, 200);
+    std::vector<uint8_t> unpacked(image.size());
+    typedef std::chrono::high_resolution_clock Clock;
+    const double total_mb = (double)(image.size() * num_sprites) / (1024 * 1024);
+
+    // LZW
+    std::vector<uint8_t> lzw_packed;
+    {
+        MemoryStream in(image.data(), image.size());
+        VectorStream out(lzw_packed, kStream_Write);
+        ASSERT_TRUE(lzwcompress(&in, &out));
+    }
+    auto t0 = Clock::now();
+    for (int i = 0; i < num_sprites; ++i)
+    {
+        MemoryStream in(lzw_packed.data(), lzw_packed.size());
+        MemoryStream out(unpacked.data(), unpacked.size(), kStream_Write);
+        lzwexpand(&in, &out, unpacked.size());
+    }
+    auto lzw_time = std::chrono::duration<double>(Clock::now() - t0).count();
+    ASSERT_TRUE(unpacked == image);
+
+    // LZ4
+    std::fill(unpacked.begin(), unpacked.end(), 0);
+    std::vector<uint8_t> lz4_packed;
+    lz4compress(image.data(), image.size(), lz4_packed);
+    t0 = Clock::now();
+    for (int i = 0; i < num_sprites; ++i)
+    {
+        ASSERT_TRUE(lz4expand(lz4_packed.data(), lz4_packed.size(), unpacked.data(), unpacked.size()));
+    }
+    auto lz4_time = std::chrono::duration<double>(Clock::now() - t0).count();
+    ASSERT_TRUE(unpacked == image);
+
+    printf("LZW: ratio %.2f, decompression %.1f MB/s\n",
+        (double)lzw_packed.size() / image.size(), total_mb / std::max(lzw_time, 1e-9));
+    printf("LZ4: ratio %.2f, decompression %.1f MB/s\n",
+        (double)lz4_packed.size() / image.size(), total_mb / std::max(lz4_time, 1e-9));
+}
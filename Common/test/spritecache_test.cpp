@@ -0,0 +1,153 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+#include <memory>
+#include <vector>
+#include "gtest/gtest.h"
+#include "core/platform.h"
+#include "ac/gamestructdefines.h"
+#include "ac/spritecache.h"
+#include "core/assetmanager.h"
+#include "gfx/bitmap.h"
+#include "util/file.h"
+
+using namespace AGS::Common;
+
+// Engine-side parts of the sprite cache and bitmap; sprites are kept as loaded
+void initialize_sprite(int) {}
+void pre_save_sprite(Bitmap*) {}
+void get_new_size_for_sprite(int, int width, int height, int &newwidth, int &newheight)
+{
+    newwidth = width;
+    newheight = height;
+}
+
+void AGS::Common::SpriteCache::InitNullSpriteParams(sprkey_t index)
+{
+    _sprInfos[index].Width = _sprInfos[0].Width;
+    _sprInfos[index].Height = _sprInfos[0].Height;
+    _spriteData[index].Image = nullptr;
+    _spriteData[index].Size = _spriteData[0].Size;
+    _spriteData[index].Flags = SPRCACHEFLAG_REMAPPED;
+}
+
+void __my_setcolor(int *ctset, int newcol, int /*wantColDep*/)
+{
+    ctset[0] = newcol;
+}
+
+#if (AGS_PLATFORM_TEST_FILE_IO)
+
+static const char *SpriteTestFile = "spritecache_test.spr";
+
+// Writes sprite file with 32-bit sprites in slots 1..count, filled with
+// a pattern which depends on the slot
+static void WriteTestSprites(SpriteCompression compress, int count)
+{
+    SpriteFileWriter writer(std::unique_ptr<Stream>(File::CreateFile(SpriteTestFile)));
+    writer.Begin(0, compress, count);
+    writer.WriteEmptySlot();
+    for (int i = 1; i <= count; ++i)
+    {
+        std::unique_ptr<Bitmap> bmp(BitmapHelper::CreateBitmap(16 + i, 8 + i, 32));
+        for (int y = 0; y < bmp->GetHeight(); ++y)
+        {
+            uint32_t *line = reinterpret_cast<uint32_t*>(bmp->GetScanLineForWriting(y));
+            for (int x = 0; x < bmp->GetWidth(); ++x)
+                line[x] = (i << 16) | (y << 8) | x;
+        }
+        writer.WriteBitmap(bmp.get());
+    }
+    writer.Finalize();
+}
+
+static bool IsTestSprite(const Bitmap *bmp, int index)
+{
+    if (!bmp || bmp->GetWidth() != 16 + index || bmp->GetHeight() != 8 + index)
+        return false;
+    for (int y = 0; y < bmp->GetHeight(); ++y)
+    {
+        const uint32_t *line = reinterpret_cast<const uint32_t*>(bmp->GetScanLine(y));
+        for (int x = 0; x < bmp->GetWidth(); ++x)
+            if (line[x] != static_cast<uint32_t>((index << 16) | (y << 8) | x))
+                return false;
+    }
+    return true;
+}
+
+TEST(SpriteCache, PrefetchKeepsMappedSprites) {
+    const int sprite_count = 4;
+    AssetMgr.reset(new AssetManager());
+    AssetMgr->AddLibrary(".");
+
+    for (auto compress : { kSprCompress_None, kSprCompress_LZ4 })
+    {
+        WriteTestSprites(compress, sprite_count);
+        std::vector<SpriteInfo> infos;
+        std::unique_ptr<SpriteCache> cache(new SpriteCache(infos));
+        cache->SetMemoryMapping(true);
+        ASSERT_TRUE(cache->InitFile(SpriteTestFile, ""));
+
+        cache->PrefetchSprites({ 1, 2, 3, 4 });
+        cache->WaitForPrefetch();
+        for (int i = 1; i <= sprite_count; ++i)
+        {
+            Bitmap *bmp = (*cache)[i];
+            ASSERT_TRUE(IsTestSprite(bmp, i)) << "sprite " << i << ", compression " << compress;
+#if AGS_PLATFORM_ENDIAN_LITTLE
+            // Uncompressed sprites are views into the mapped file, and do not
+            // take space in the cache, same as when loaded on the main thread
+            EXPECT_EQ(compress == kSprCompress_None, cache->IsMappedImage(bmp)) << "sprite " << i;
+#endif
+        }
+#if AGS_PLATFORM_ENDIAN_LITTLE
+        if (compress == kSprCompress_None)
+        {
+            EXPECT_EQ(0u, cache->GetCacheSize());
+        }
+#endif
+        cache.reset();
+    }
+
+    AssetMgr.reset();
+    File::DeleteFile(SpriteTestFile);
+}
+
+TEST(SpriteCache, DetachedMappedSpriteKeepsFileIntact) {
+    AssetMgr.reset(new AssetManager());
+    AssetMgr->AddLibrary(".");
+    WriteTestSprites(kSprCompress_None, 1);
+    std::vector<SpriteInfo> infos;
+    std::unique_ptr<SpriteCache> cache(new SpriteCache(infos));
+    cache->SetMemoryMapping(true);
+    ASSERT_TRUE(cache->InitFile(SpriteTestFile, ""));
+
+    Bitmap *bmp = (*cache)[1];
+    ASSERT_TRUE(IsTestSprite(bmp, 1));
+    cache->DetachMappedSprite(1);
+    bmp = (*cache)[1];
+    ASSERT_TRUE(IsTestSprite(bmp, 1));
+    EXPECT_FALSE(cache->IsMappedImage(bmp));
+    EXPECT_EQ(static_cast<size_t>(bmp->GetWidth() * bmp->GetHeight() * 4), cache->GetCacheSize());
+
+    // Changes to the detached copy must not be seen when the sprite is reloaded
+    bmp->ClearTransparent();
+    cache->DisposeAll();
+    EXPECT_TRUE(IsTestSprite((*cache)[1], 1));
+
+    cache.reset();
+    AssetMgr.reset();
+    File::DeleteFile(SpriteTestFile);
+}
+
+#endif // AGS_PLATFORM_TEST_FILE_IO
@@ -1,9 +1,19 @@
 #include <array>
 #include <memory>
 #include <vector>
+#include <stdio.h>
+#include "core/platform.h"
+#if !AGS_PLATFORM_OS_WINDOWS
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 #include "gtest/gtest.h"
 #include "util/alignedstream.h"
 #include "util/bufferedstream.h"
+#include "util/directory.h"
+#include "util/file.h"
+#include "util/memorymappedfile.h"
 #include "util/memorystream.h"
 #include "util/string_utils.h"
 
@@ -568,6 +578,124 @@ TEST_F(FileBasedTest, BufferedSectionStream) {
     File::DeleteFile(DummyFile);
 }
 
+TEST_F(FileBasedTest, MemoryMappedFile) {
+    //-------------------------------------------------------------------------
+    // Write data into the temp file; make it larger than a memory page,
+    // so that the section does not begin at the page boundary
+    FileStream out(DummyFile, kFile_CreateAlways, kFile_Write);
+    out.WriteByteCount(0, 4096 + 3);
+    const auto section_start = out.GetPosition();
+    for (int32_t i = 0; i < 100; ++i)
+        out.WriteInt32(i);
+    const auto section_end = out.GetPosition();
+    out.WriteInt32(100);
+    out.Close();
+
+    //-------------------------------------------------------------------------
+    // Map and read data back
+    {
+        MemoryMappedFile mf;
+        ASSERT_TRUE(mf.Open(DummyFile, section_start, section_end - section_start));
+        ASSERT_TRUE(mf.IsValid());
+        ASSERT_EQ(mf.GetSize(), section_end - section_start);
+        const uint8_t *data = mf.GetData();
+        ASSERT_TRUE(mf.Contains(data));
+        ASSERT_TRUE(mf.Contains(data + mf.GetSize() - 1));
+        ASSERT_FALSE(mf.Contains(data + mf.GetSize()));
+        for (int32_t i = 0; i < 100; ++i)
+            ASSERT_EQ(BBOp::Int32FromLE(*reinterpret_cast<const int32_t*>(data + i * sizeof(int32_t))), i);
+        // Changes are private and must not be written to file
+        mf.GetData()[0] = 0xFF;
+        mf.Close();
+        ASSERT_FALSE(mf.IsValid());
+
+        // Map till the file's end, and past the file's end
+        ASSERT_TRUE(mf.Open(DummyFile, section_end));
+        ASSERT_EQ(mf.GetSize(), sizeof(int32_t));
+        ASSERT_TRUE(mf.Open(DummyFile, section_end, 1000));
+        ASSERT_EQ(mf.GetSize(), sizeof(int32_t));
+        ASSERT_FALSE(mf.Open(DummyFile, section_end + sizeof(int32_t)));
+        ASSERT_FALSE(mf.Open("does-not-exist.dat"));
+    }
+
+    FileStream in(DummyFile, kFile_Open, kFile_Read);
+    in.Seek(section_start, kSeekBegin);
+    ASSERT_EQ(in.ReadInt32(), 0);
+    in.Close();
+
+    File::DeleteFile(DummyFile);
+}
+
+TEST_F(FileBasedTest, FindFileCI) {
+    // Find the file, and the files made after the directory was searched
+    delete File::CreateFile("FindFileTest1.Dat");
+    String found = File::FindFileCI(".", "findfiletest1.dat");
+    ASSERT_TRUE(File::IsFile(found));
+    ASSERT_TRUE(File::IsFile(File::FindFileCI("", "FINDFILETEST1.DAT")));
+    ASSERT_TRUE(File::IsFile(File::FindFileCI("", "./FindFileTest1.dat")));
+    ASSERT_TRUE(File::IsFile(File::FindFileCI(Directory::GetCurrentDirectory(), "findfiletest1.dat")));
+    ASSERT_FALSE(File::IsFile(File::FindFileCI(".", "findfiletest2.dat")));
+    delete File::CreateFile("FindFileTest2.Dat");
+    found = File::FindFileCI(".", "findfiletest2.dat");
+    ASSERT_TRUE(File::IsFile(found));
+
+    // Renamed and deleted files
+    ASSERT_TRUE(File::RenameFile(found, "FindFileTest3.Dat"));
+    EXPECT_FALSE(File::IsFile(File::FindFileCI(".", "findfiletest2.dat")));
+    EXPECT_TRUE(File::IsFile(File::FindFileCI(".", "FINDFILETEST3.dat")));
+    File::DeleteFile(File::FindFileCI(".", "findfiletest1.dat"));
+    File::DeleteFile(File::FindFileCI(".", "findfiletest3.dat"));
+    EXPECT_FALSE(File::IsFile(File::FindFileCI(".", "findfiletest1.dat")));
+    EXPECT_FALSE(File::IsFile(File::FindFileCI(".", "findfiletest3.dat")));
+    EXPECT_TRUE(File::FindFileCI(".", "").IsEmpty());
+
+    // Following checks are only for the case-sensitive filesystems
+    delete File::CreateFile("FindFileTest4.Dat");
+    const bool case_sensitive = !File::IsFile("findfiletest4.dat");
+    File::DeleteFile("FindFileTest4.Dat");
+    if (!case_sensitive)
+        return;
+    // Exactly matching name is preferred to the other names
+    delete File::CreateFile("FindFileTest5.Dat");
+    delete File::CreateFile("findfiletest5.dat");
+    EXPECT_STREQ("./FindFileTest5.Dat", File::FindFileCI(".", "FindFileTest5.Dat").GetCStr());
+    EXPECT_STREQ("./findfiletest5.dat", File::FindFileCI(".", "findfiletest5.dat").GetCStr());
+    File::DeleteFile("FindFileTest5.Dat");
+    File::DeleteFile("findfiletest5.dat");
+#if !AGS_PLATFORM_OS_WINDOWS
+    // Files changed bypassing File functions are found when the directory's
+    // modification time changes; until then the lookups that miss the index
+    // do not read the directory again
+    const String dir = "findfiletest.dir";
+    ASSERT_TRUE(Directory::CreateDirectory(dir));
+    delete File::CreateFile("findfiletest.dir/findfiletest6.dat");
+    EXPECT_TRUE(File::IsFile(File::FindFileCI(dir, "FindFileTest6.dat")));
+    struct stat dir_stat;
+    ASSERT_EQ(0, stat(dir.GetCStr(), &dir_stat));
+#if AGS_PLATFORM_OS_MACOS || AGS_PLATFORM_OS_IOS
+    struct timespec dir_times[2] = { dir_stat.st_atimespec, dir_stat.st_mtimespec };
+#else
+    struct timespec dir_times[2] = { dir_stat.st_atim, dir_stat.st_mtim };
+#endif
+    FILE *f = fopen("findfiletest.dir/FINDFILETEST7.DAT", "wb");
+    ASSERT_NE(nullptr, f);
+    fclose(f);
+    // as if the file was made within the same timestamp tick
+    ASSERT_EQ(0, utimensat(AT_FDCWD, dir.GetCStr(), dir_times, 0));
+    EXPECT_TRUE(File::FindFileCI(dir, "findfiletest7.dat").IsEmpty());
+    EXPECT_TRUE(File::FindFileCI(dir, "findfiletest7.dat").IsEmpty());
+    dir_times[1].tv_sec++;
+    ASSERT_EQ(0, utimensat(AT_FDCWD, dir.GetCStr(), dir_times, 0));
+    EXPECT_STREQ("findfiletest.dir/FINDFILETEST7.DAT", File::FindFileCI(dir, "findfiletest7.dat").GetCStr());
+    // A file found in the index, but removed since, makes the directory reindexed
+    remove("findfiletest.dir/findfiletest6.dat");
+    ASSERT_EQ(0, utimensat(AT_FDCWD, dir.GetCStr(), dir_times, 0));
+    EXPECT_TRUE(File::FindFileCI(dir, "FindFileTest6.dat").IsEmpty());
+    remove("findfiletest.dir/FINDFILETEST7.DAT");
+    rmdir(dir.GetCStr());
+#endif // !AGS_PLATFORM_OS_WINDOWS
+}
+
 #endif // AGS_PLATFORM_TEST_FILE_IO
 
 
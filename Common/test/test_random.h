@@ -0,0 +1,70 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Random data for the unit tests. Uses its own generator, so that the tests
+// get the same data on every platform and standard library.
+//
+//=============================================================================
+#ifndef __AGS_CN_TEST__TESTRANDOM_H
+#define __AGS_CN_TEST__TESTRANDOM_H
+
+#include <stdint.h>
+#include "gfx/bitmap.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+// Advances the linear congruential generator, returns the new seed
+inline uint32_t NextRandom(uint32_t &seed)
+{
+    seed = seed * 1103515245 + 12345;
+    return seed;
+}
+
+// Advances the generator, returns a number in the [0, max) range
+inline int NextRandom(uint32_t &seed, int max)
+{
+    return (NextRandom(seed) >> 8) % max;
+}
+
+// Fills 32-bit bitmap with random pixels, some of them transparent, and
+// some having extreme alpha and color values
+inline void FillRandom(Bitmap *bmp, uint32_t &seed)
+{
+    for (int y = 0; y < bmp->GetHeight(); ++y)
+    {
+        uint32_t *line = reinterpret_cast<uint32_t*>(bmp->GetScanLineForWriting(y));
+        for (int x = 0; x < bmp->GetWidth(); ++x)
+        {
+            NextRandom(seed);
+            uint32_t col = (seed >> 8) ^ (seed << 16);
+            switch ((seed >> 28) & 0x7)
+            {
+            case 0: col = MASK_COLOR_32; break;
+            case 1: col &= 0x00FFFFFF; break;
+            case 2: col |= 0xFF000000; break;
+            case 3: col |= 0x00FF00FF; break;
+            default: break;
+            }
+            line[x] = col;
+        }
+    }
+}
+
+} // namespace Common
+} // namespace AGS
+
+#endif // __AGS_CN_TEST__TESTRANDOM_H
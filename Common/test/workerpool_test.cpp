@@ -0,0 +1,35 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+#include <vector>
+#include "gtest/gtest.h"
+#include "util/workerpool.h"
+
+using namespace AGS::Common;
+
+TEST(WorkerPool, RunTasks) {
+    for (int thread_count : { 0, 1, 3 })
+    {
+        WorkerPool pool(thread_count);
+        // Each task is run exactly once, and all are complete on return;
+        // repeated jobs reuse the same threads
+        for (size_t count : { 0u, 1u, 2u, 7u, 100u })
+        {
+            std::vector<int> runs(count);
+            pool.RunTasks(count, [&runs](size_t index) { runs[index]++; });
+            for (size_t i = 0; i < count; ++i)
+                ASSERT_EQ(1, runs[i]) << "task " << i << " of " << count
+                    << ", using " << thread_count << " threads";
+        }
+    }
+}
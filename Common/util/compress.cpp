@@ -21,7 +21,9 @@
 #include <stdio.h>
 #include "ac/common.h"	// quit, update_polled_stuff
 #include "gfx/bitmap.h"
+#include "util/lz4.h"
 #include "util/lzw.h"
+#include "util/rle.h"
 #include "util/memorystream.h"
 #if AGS_PLATFORM_ENDIAN_BIG
 #include "util/bbop.h"
@@ -33,251 +35,21 @@ using namespace AGS::Common;
 // RLE
 //-----------------------------------------------------------------------------
 
-static void cpackbitl(const uint8_t *line, size_t size, Stream *out)
-{
-  size_t cnt = 0;               // bytes encoded
-
-  while (cnt < size) {
-    // IMPORTANT: the algorithm below requires signed operations
-    int i = static_cast<int32_t>(cnt);
-    int j = i + 1;
-    int jmax = i + 126;
-    if (static_cast<uint32_t>(jmax) >= size)
-      jmax = size - 1;
-
-    if (static_cast<uint32_t>(i) == size - 1) { //......last byte alone
-      out->WriteInt8(0);
-      out->WriteInt8(line[i]);
-      cnt++;
-
-    } else if (line[i] == line[j]) {    //....run
-      while ((j < jmax) && (line[j] == line[j + 1]))
-        j++;
-     
-      out->WriteInt8(i - j);
-      out->WriteInt8(line[i]);
-      cnt += j - i + 1;
-
-    } else {                    //.............................sequence
-      while ((j < jmax) && (line[j] != line[j + 1]))
-        j++;
-
-      out->WriteInt8(j - i);
-      out->Write(line + i, j - i + 1);
-      cnt += j - i + 1;
-
-    }
-  } // end while
-}
-
-static void cpackbitl16(const uint16_t *line, size_t size, Stream *out)
-{
-  size_t cnt = 0;               // bytes encoded
-
-  while (cnt < size) {
-    // IMPORTANT: the algorithm below requires signed operations
-    int i = cnt;
-    int j = i + 1;
-    int jmax = i + 126;
-    if (static_cast<uint32_t>(jmax) >= size)
-      jmax = size - 1;
-
-    if (static_cast<uint32_t>(i) == size - 1) { //......last byte alone
-      out->WriteInt8(0);
-      out->WriteInt16(line[i]);
-      cnt++;
-
-    } else if (line[i] == line[j]) {    //....run
-      while ((j < jmax) && (line[j] == line[j + 1]))
-        j++;
-     
-      out->WriteInt8(i - j);
-      out->WriteInt16(line[i]);
-      cnt += j - i + 1;
-
-    } else {                    //.............................sequence
-      while ((j < jmax) && (line[j] != line[j + 1]))
-        j++;
-
-      out->WriteInt8(j - i);
-      out->WriteArray(line + i, j - i + 1, 2);
-      cnt += j - i + 1;
-
-    }
-  } // end while
-}
-
-static void cpackbitl32(const uint32_t *line, size_t size, Stream *out)
-{
-  size_t cnt = 0;               // bytes encoded
-
-  while (cnt < size) {
-    // IMPORTANT: the algorithm below requires signed operations
-    int i = cnt;
-    int j = i + 1;
-    int jmax = i + 126;
-    if (static_cast<uint32_t>(jmax) >= size)
-      jmax = size - 1;
-
-    if (static_cast<uint32_t>(i) == size - 1) { //......last byte alone
-      out->WriteInt8(0);
-      out->WriteInt32(line[i]);
-      cnt++;
-
-    } else if (line[i] == line[j]) {    //....run
-      while ((j < jmax) && (line[j] == line[j + 1]))
-        j++;
-     
-      out->WriteInt8(i - j);
-      out->WriteInt32(line[i]);
-      cnt += j - i + 1;
-
-    } else {                    //.............................sequence
-      while ((j < jmax) && (line[j] != line[j + 1]))
-        j++;
-
-      out->WriteInt8(j - i);
-      out->WriteArray(line + i, j - i + 1, 4);
-      cnt += j - i + 1;
-
-    }
-  } // end while
-}
-
-static int cunpackbitl(uint8_t *line, size_t size, Stream *in)
-{
-  size_t n = 0;                  // number of bytes decoded
-
-  while (n < size) {
-    int ix = in->ReadByte();     // get index byte
-    if (in->HasErrors())
-      break;
-
-    signed char cx = ix;
-    if (cx == -128)
-      cx = 0;
-
-    if (cx < 0) {                //.............run
-      int i = 1 - cx;
-      char ch = in->ReadInt8();
-      while (i--) {
-        // test for buffer overflow
-        if (n >= size)
-          return -1;
-
-        line[n++] = ch;
-      }
-    } else {                     //.....................seq
-      int i = cx + 1;
-      while (i--) {
-        // test for buffer overflow
-        if (n >= size)
-          return -1;
-
-        line[n++] = in->ReadByte();
-      }
-    }
-  }
-
-  return in->HasErrors() ? -1 : 0;
-}
-
-static int cunpackbitl16(uint16_t *line, size_t size, Stream *in)
+void rle_compress(const uint8_t *data, size_t data_sz, int image_bpp, Stream *out)
 {
-  size_t n = 0;                  // number of bytes decoded
-
-  while (n < size) {
-    int ix = in->ReadByte();     // get index byte
-    if (in->HasErrors())
-      break;
-
-    signed char cx = ix;
-    if (cx == -128)
-      cx = 0;
-
-    if (cx < 0) {                //.............run
-      int i = 1 - cx;
-      unsigned short ch = in->ReadInt16();
-      while (i--) {
-        // test for buffer overflow
-        if (n >= size)
-          return -1;
-
-        line[n++] = ch;
-      }
-    } else {                     //.....................seq
-      int i = cx + 1;
-      while (i--) {
-        // test for buffer overflow
-        if (n >= size)
-          return -1;
-
-        line[n++] = in->ReadInt16();
-      }
-    }
-  }
-
-  return in->HasErrors() ? -1 : 0;
+    std::vector<uint8_t> membuf;
+    rlecompress(data, data_sz, image_bpp, membuf);
+    out->Write(membuf.data(), membuf.size());
 }
 
-static int cunpackbitl32(uint32_t *line, size_t size, Stream *in)
-{
-  size_t n = 0;                  // number of bytes decoded
-
-  while (n < size) {
-    int ix = in->ReadByte();     // get index byte
-    if (in->HasErrors())
-      break;
-
-    signed char cx = ix;
-    if (cx == -128)
-      cx = 0;
-
-    if (cx < 0) {                //.............run
-      int i = 1 - cx;
-      unsigned int ch = in->ReadInt32();
-      while (i--) {
-        // test for buffer overflow
-        if (n >= size)
-          return -1;
-
-        line[n++] = ch;
-      }
-    } else {                     //.....................seq
-      int i = cx + 1;
-      while (i--) {
-        // test for buffer overflow
-        if (n >= size)
-          return -1;
-
-        line[n++] = (unsigned int)in->ReadInt32();
-      }
-    }
-  }
-
-  return in->HasErrors() ? -1 : 0;
-}
-
-void rle_compress(const uint8_t *data, size_t data_sz, int image_bpp, Stream *out)
+void rle_decompress(uint8_t *data, size_t data_sz, int image_bpp, Stream *in)
 {
-    switch (image_bpp)
-    {
-    case 1: cpackbitl(data, data_sz, out); break;
-    case 2: cpackbitl16(reinterpret_cast<const uint16_t*>(data), data_sz / sizeof(uint16_t), out); break;
-    case 4: cpackbitl32(reinterpret_cast<const uint32_t*>(data), data_sz / sizeof(uint32_t), out); break;
-    default: assert(0); break;
-    }
+    rleexpand(in, data, data_sz, image_bpp);
 }
 
-void rle_decompress(uint8_t *data, size_t data_sz, int image_bpp, Stream *in)
+bool rle_decompress(uint8_t *data, size_t data_sz, int image_bpp, const uint8_t *in, size_t in_sz)
 {
-    switch (image_bpp)
-    {
-    case 1: cunpackbitl(data, data_sz, in); break;
-    case 2: cunpackbitl16(reinterpret_cast<uint16_t*>(data), data_sz / sizeof(uint16_t), in); break;
-    case 4: cunpackbitl32(reinterpret_cast<uint32_t*>(data), data_sz / sizeof(uint32_t), in); break;
-    default: assert(0); break;
-    }
+    return rleexpand(in, in_sz, data, data_sz, image_bpp);
 }
 
 void save_rle_bitmap8(Stream *out, const Bitmap *bmp, const RGB (*pal)[256])
@@ -286,7 +58,7 @@ void save_rle_bitmap8(Stream *out, const Bitmap *bmp, const RGB (*pal)[256])
     out->WriteInt16(static_cast<uint16_t>(bmp->GetWidth()));
     out->WriteInt16(static_cast<uint16_t>(bmp->GetHeight()));
     // Pack the pixels
-    cpackbitl(bmp->GetData(), bmp->GetWidth() * bmp->GetHeight(), out);
+    rle_compress(bmp->GetData(), bmp->GetWidth() * bmp->GetHeight(), 1, out);
     // Save palette
     if (!pal)
     { // if no pal, write dummy palette, because we have to
@@ -309,7 +81,7 @@ std::unique_ptr<Bitmap> load_rle_bitmap8(Stream *in, RGB (*pal)[256])
     std::unique_ptr<Bitmap> bmp(BitmapHelper::CreateBitmap(w, h, 8));
     if (!bmp) return nullptr;
     // Unpack the pixels
-    cunpackbitl(bmp->GetDataForWriting(), w * h, in);
+    rle_decompress(bmp->GetDataForWriting(), w * h, 1, in);
     // Load or skip the palette
     if (!pal)
     {
@@ -444,3 +216,19 @@ std::unique_ptr<Bitmap> load_lzw(Stream *in, int dst_bpp, RGB (*pal)[256])
 
   return bmm;
 }
+
+//-----------------------------------------------------------------------------
+// LZ4
+//-----------------------------------------------------------------------------
+
+void lz4_compress(const uint8_t *data, size_t data_sz, int /*image_bpp*/, Stream *out)
+{
+    std::vector<uint8_t> membuf;
+    lz4compress(data, data_sz, membuf);
+    out->Write(membuf.data(), membuf.size());
+}
+
+bool lz4_decompress(uint8_t *data, size_t data_sz, int /*image_bpp*/, const uint8_t *in, size_t in_sz)
+{
+    return lz4expand(in, in_sz, data, data_sz);
+}
@@ -26,6 +26,8 @@ using namespace AGS; // FIXME later
 // RLE compression
 void rle_compress(const uint8_t *data, size_t data_sz, int image_bpp, Common::Stream *out);
 void rle_decompress(uint8_t *data, size_t data_sz, int image_bpp, Common::Stream *in);
+// Decompresses RLE data from the memory buffer of the known size, which is much faster
+bool rle_decompress(uint8_t *data, size_t data_sz, int image_bpp, const uint8_t *in, size_t in_sz);
 // Packs a 8-bit bitmap using RLE compression, and writes into stream along with the palette
 void save_rle_bitmap8(Common::Stream *out, const Common::Bitmap *bmp, const RGB (*pal)[256] = nullptr);
 // Reads a 8-bit bitmap with palette from the stream and unpacks from RLE
@@ -41,4 +43,9 @@ void save_lzw(Common::Stream *out, const Common::Bitmap *bmpp, const RGB (*pal)[
 // Loads bitmap decompressing
 std::unique_ptr<Common::Bitmap> load_lzw(Common::Stream *in, int dst_bpp, RGB (*pal)[256] = nullptr);
 
+// LZ4 compression; because LZ4 data does not tell where it ends, the
+// decompression is done from a memory buffer of the exact compressed size
+void lz4_compress(const uint8_t *data, size_t data_sz, int image_bpp, Common::Stream *out);
+bool lz4_decompress(uint8_t *data, size_t data_sz, int image_bpp, const uint8_t *in, size_t in_sz);
+
 #endif // __AC_COMPRESS_H
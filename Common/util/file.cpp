@@ -19,11 +19,21 @@
 #include <dirent.h>
 #include <string.h> // strcasecmp
 #endif
+#if defined (AGS_CASE_SENSITIVE_FILESYSTEM)
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#if !defined(AGS_DISABLE_THREADS)
+#include <mutex>
+#endif
+#endif
 #include "core/platform.h"
 #include "util/bufferedstream.h"
+#include "util/directory.h"
 #include "util/filestream.h"
 #include "util/path.h"
 #include "util/stdio_compat.h"
+#include "util/string_types.h"
 #if AGS_PLATFORM_OS_ANDROID
 #include "util/aasset_stream.h"
 #include "util/android_file.h"
@@ -34,6 +44,151 @@ namespace AGS
 namespace Common
 {
 
+#if defined (AGS_CASE_SENSITIVE_FILESYSTEM)
+// Case-insensitive index of the files found in a directory; the set stores
+// real file names, which may be found using the name written in any case
+typedef std::unordered_set<String, HashStrNoCase, StrEqNoCase> DirFileIndex;
+// Directory's modification time, with the precision which filesystem gives
+struct DirModTime
+{
+    time_t Sec = 0;
+    long   NSec = 0;
+
+    bool operator ==(const DirModTime &other) const
+    {
+        return Sec == other.Sec && NSec == other.NSec;
+    }
+    bool operator !=(const DirModTime &other) const { return !(*this == other); }
+};
+// Directory index, with the directory's modification time at the moment
+// when it was read
+struct DirIndex
+{
+    DirFileIndex Files;
+    DirModTime   ModTime;
+};
+// Indexes of the directories where the files were looked for, by dir path.
+// Indexes are populated on the first lookup in the directory, and dropped
+// when the files in that directory are created, deleted or renamed using
+// the File functions. Changes made bypassing these functions are detected
+// by the directory's modification time, which is tested with a single
+// stat() on each lookup.
+static std::unordered_map<String, std::unique_ptr<DirIndex>> DirIndexCache;
+#if !defined(AGS_DISABLE_THREADS)
+static std::mutex DirIndexMutex;
+#endif
+
+// Makes a directory index key: relative paths are made absolute, so that
+// the same directory is found regardless of how the path was written
+// (only the leading "./" is resolved, other relative parts are kept as-is)
+static String MakeDirIndexKey(const String &dir_path)
+{
+    String key = Path::MakePathNoSlash(dir_path);
+    if (key.GetLength() > 0 && key[0u] == '/')
+        return key;
+    if (key == ".")
+        key.Empty();
+    else if (key.StartsWith("./"))
+        key.ClipLeft(2);
+    return Path::ConcatPaths(Directory::GetCurrentDirectory(), key);
+}
+
+// Gets the directory's last modification time
+static bool GetDirModTime(const String &directory, DirModTime &time)
+{
+    struct stat statbuf;
+    if (stat(directory.GetCStr(), &statbuf) != 0)
+        return false;
+    time.Sec = statbuf.st_mtime;
+#if AGS_PLATFORM_OS_MACOS || AGS_PLATFORM_OS_IOS
+    time.NSec = statbuf.st_mtimespec.tv_nsec;
+#else
+    time.NSec = statbuf.st_mtim.tv_nsec;
+#endif
+    return true;
+}
+
+// Reads the list of regular files and links in the directory
+static bool ReadDirIndex(const String &directory, DirFileIndex &index)
+{
+    DIR *dir = opendir(directory.GetCStr());
+    if (dir == nullptr)
+    {
+        fprintf(stderr, "ci_find_file: cannot open directory: %s\n", directory.GetCStr());
+        return false;
+    }
+    struct dirent *entry;
+    struct stat statbuf;
+    while ((entry = readdir(dir)) != nullptr)
+    {
+        if (entry->d_type == DT_UNKNOWN)
+        {
+            // the filesystem does not provide file types, get them separately
+            String path = Path::ConcatPaths(directory, entry->d_name);
+            if (lstat(path.GetCStr(), &statbuf) != 0 ||
+                !(S_ISREG(statbuf.st_mode) || S_ISLNK(statbuf.st_mode)))
+                continue;
+        }
+        else if (entry->d_type != DT_REG && entry->d_type != DT_LNK)
+        {
+            continue;
+        }
+        // if there are names differing only in case, the first found is used
+        index.insert(entry->d_name);
+    }
+    closedir(dir);
+    return true;
+}
+
+// Finds the file's real name in the directory's index; indexes directory
+// if it was not indexed yet, or was modified since; rebuild tells to index
+// the directory again in any case
+static bool FindInDirIndex(const String &directory, const String &filename, String &real_name,
+    bool rebuild)
+{
+    const String key = MakeDirIndexKey(directory);
+    DirModTime mod_time;
+    if (!GetDirModTime(directory, mod_time))
+        return false;
+#if !defined(AGS_DISABLE_THREADS)
+    std::lock_guard<std::mutex> lk(DirIndexMutex);
+#endif
+    auto it = DirIndexCache.find(key);
+    if (it != DirIndexCache.end() && (rebuild || it->second->ModTime != mod_time))
+    {
+        DirIndexCache.erase(it);
+        it = DirIndexCache.end();
+    }
+    if (it == DirIndexCache.end())
+    {
+        std::unique_ptr<DirIndex> index(new DirIndex());
+        if (!ReadDirIndex(directory, index->Files))
+            return false;
+        index->ModTime = mod_time;
+        it = DirIndexCache.emplace(key, std::move(index)).first;
+    }
+    const DirFileIndex &files = it->second->Files;
+    auto found = files.find(filename);
+    if (found == files.end())
+        return false;
+    // make a full copy, as the strings' reference counters are not thread-safe
+    real_name = found->GetCStr();
+    return true;
+}
+
+// Drops the index of the directory, where the file was changed
+static void InvalidateDirIndex(const String &filename)
+{
+    const String key = MakeDirIndexKey(Path::GetParent(filename));
+#if !defined(AGS_DISABLE_THREADS)
+    std::lock_guard<std::mutex> lk(DirIndexMutex);
+#endif
+    DirIndexCache.erase(key);
+}
+#else
+inline static void InvalidateDirIndex(const String &/*filename*/) {}
+#endif // AGS_CASE_SENSITIVE_FILESYSTEM
+
 bool File::IsDirectory(const String &filename)
 {
     // stat() does not like trailing slashes, remove them
@@ -109,6 +264,7 @@ bool File::TestCreateFile(const String &filename)
 
 bool File::DeleteFile(const String &filename)
 {
+    InvalidateDirIndex(filename);
     if (ags_remove(filename.GetCStr()) != 0)
     {
         int err;
@@ -127,6 +283,8 @@ bool File::DeleteFile(const String &filename)
 
 bool File::RenameFile(const String &old_name, const String &new_name)
 {
+    InvalidateDirIndex(old_name);
+    InvalidateDirIndex(new_name);
     return ags_rename(old_name.GetCStr(), new_name.GetCStr()) == 0;
 }
 
@@ -204,6 +362,9 @@ String File::GetCMode(FileOpenMode open_mode, FileWorkMode work_mode)
 
 Stream *File::OpenFile(const String &filename, FileOpenMode open_mode, FileWorkMode work_mode)
 {
+    // Opening for writing may create a new file
+    if ((open_mode != kFile_Open) || (work_mode != kFile_Read))
+        InvalidateDirIndex(filename);
     Stream *fs = nullptr;
     try {
         fs = new BufferedStream(filename, open_mode, work_mode);
@@ -254,80 +415,62 @@ String File::FindFileCI(const String &dir_name, const String &file_name)
     // Case insensitive file find - on case sensitive filesystems
     //
     // TODO: still not covered: a situation when the file_name contains
-    // nested path -and- the case of at least one path parts does not match
-    // (with all matching case the file will be found by an early check).
+    // nested path -and- the case of at least one parent dir does not match
+    // (only the case of the file name itself is resolved).
     //
-    struct stat   statbuf;
-    struct dirent *entry = nullptr;
-
-    if (dir_name.IsEmpty() && file_name.IsEmpty())
+    if (file_name.IsEmpty())
         return nullptr;
 
-    String directory;
-    String filename;
-    String buf;
+    String directory = dir_name;
+    String filename = file_name;
+    Path::FixupPath(directory);
+    Path::FixupPath(filename);
 
-    if (!dir_name.IsEmpty())
-    {
-        directory = dir_name;
-        Path::FixupPath(directory);
-    }
-    if (!file_name.IsEmpty())
-    {
-        filename = file_name;
-        Path::FixupPath(filename);
-    }
-
-    if (!filename.IsEmpty())
+    // Separate the file's own name from any parent dirs in it
+    const String match = Path::GetFilename(filename);
+    if (match.IsEmpty())
+        return nullptr;
+    if (match.GetLength() < filename.GetLength())
     {
-        // TODO: move this case to ConcatPaths too?
-        if (directory.IsEmpty() && filename[0] == '/')
-            buf = filename;
+        String parent = Path::GetParent(filename);
+        if (filename[0u] == '/' && filename.FindChar('/', 1) == String::NoIndex)
+            parent = "/"; // file in the root dir
+        if (directory.IsEmpty())
+            directory = parent;
         else
-            buf = Path::ConcatPaths(directory.IsEmpty() ? "." : directory, filename);
-
-        if (lstat(buf.GetCStr(), &statbuf) == 0 &&
-            (S_ISREG(statbuf.st_mode) || S_ISLNK(statbuf.st_mode)))
-        {
-            return buf;
-        }
+            directory = Path::ConcatPaths(directory, parent);
+        filename = match;
     }
-
-    if (directory.IsEmpty())
+    else if (directory.IsEmpty())
     {
-        String match = Path::GetFilename(filename);
-        if (match.IsEmpty())
-            return nullptr;
-        directory = Path::GetParent(filename);
-        filename = match;
+        directory = ".";
     }
 
-    DIR *rough = nullptr;
-    if ((rough = opendir(directory.GetCStr())) == nullptr)
+    // The file with exactly matching name always takes priority
+    struct stat statbuf;
+    String buf = Path::ConcatPaths(directory, filename);
+    if (lstat(buf.GetCStr(), &statbuf) == 0 &&
+        (S_ISREG(statbuf.st_mode) || S_ISLNK(statbuf.st_mode)))
     {
-        fprintf(stderr, "ci_find_file: cannot open directory: %s\n", directory.GetCStr());
-        return nullptr;
+        return buf;
     }
 
-    String diamond;
-    while ((entry = readdir(rough)) != nullptr)
+    // Look up the directory index; if the found file does not exist anymore,
+    // the directory was changed too soon for its modification time to tell
+    // (within the filesystem's timestamp precision), so index it again
+    String real_name;
+    for (int attempt = 0; attempt < 2; ++attempt)
     {
-        if (strcasecmp(filename.GetCStr(), entry->d_name) == 0)
+        if (!FindInDirIndex(directory, filename, real_name, attempt > 0))
+            return nullptr;
+        buf = Path::ConcatPaths(directory, real_name);
+        if (lstat(buf.GetCStr(), &statbuf) == 0 &&
+            (S_ISREG(statbuf.st_mode) || S_ISLNK(statbuf.st_mode)))
         {
-            if (lstat(entry->d_name, &statbuf) == 0 &&
-                (S_ISREG(statbuf.st_mode) || S_ISLNK(statbuf.st_mode)))
-            {
-#if AGS_PLATFORM_DEBUG
-                fprintf(stderr, "ci_find_file: Looked for %s in rough %s, found diamond %s.\n",
-                    filename.GetCStr(), directory.GetCStr(), entry->d_name);
-#endif // AGS_PLATFORM_DEBUG
-                diamond = Path::ConcatPaths(directory, entry->d_name);
-                break;
-            }
+            return buf;
         }
     }
-    closedir(rough);
-    return diamond;
+    return nullptr;
 #endif
 }
 
@@ -0,0 +1,214 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// The block is a sequence of commands, each consisting of:
+//  - token byte: high 4 bits tell the literals length, low 4 bits tell the
+//    match length minus 4; value 15 means that the length continues in the
+//    following bytes, each adding up to 255, until a byte less than 255;
+//  - literals, copied to the output as-is;
+//  - 16-bit little-endian match offset, counted back from the current output
+//    position, and optional match length bytes.
+// The last command has literals only, and ends the block.
+//
+//=============================================================================
+#include "util/lz4.h"
+#include <string.h>
+
+#ifdef _MANAGED
+// ensure this doesn't get compiled to .NET IL
+#pragma unmanaged
+#endif
+
+static const size_t LZ4_MINMATCH = 4;
+// the last match must start at least this many bytes before the block end
+static const size_t LZ4_MFLIMIT = 12;
+// the last bytes of the block are always literals
+static const size_t LZ4_LASTLITERALS = 5;
+static const size_t LZ4_MAXOFFSET = 0xFFFF;
+static const int    LZ4_HASHLOG = 14;
+
+static inline uint32_t lz4_read32(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint32_t lz4_hash(uint32_t seq)
+{
+    return (seq * 2654435761u) >> (32 - LZ4_HASHLOG);
+}
+
+static inline void lz4_put_length(std::vector<uint8_t> &out, size_t len)
+{
+    for (; len >= 255; len -= 255)
+        out.push_back(255);
+    out.push_back(static_cast<uint8_t>(len));
+}
+
+static void lz4_put_sequence(std::vector<uint8_t> &out, const uint8_t *lit, size_t lit_len,
+    size_t offset, size_t match_len)
+{
+    const size_t ml = match_len - LZ4_MINMATCH;
+    uint8_t token = static_cast<uint8_t>(((lit_len < 15) ? lit_len : 15) << 4);
+    if (match_len > 0)
+        token |= static_cast<uint8_t>((ml < 15) ? ml : 15);
+    out.push_back(token);
+    if (lit_len >= 15)
+        lz4_put_length(out, lit_len - 15);
+    out.insert(out.end(), lit, lit + lit_len);
+    if (match_len == 0)
+        return; // last sequence
+    out.push_back(static_cast<uint8_t>(offset & 0xFF));
+    out.push_back(static_cast<uint8_t>((offset >> 8) & 0xFF));
+    if (ml >= 15)
+        lz4_put_length(out, ml - 15);
+}
+
+void lz4compress(const uint8_t *in_buf, size_t in_sz, std::vector<uint8_t> &out)
+{
+    const uint8_t *ip = in_buf;
+    const uint8_t *anchor = in_buf;
+    const uint8_t *const in_end = in_buf + in_sz;
+    out.reserve(out.size() + in_sz + in_sz / 255 + 16);
+
+    if (in_sz > LZ4_MFLIMIT)
+    {
+        const uint8_t *const mf_limit = in_end - LZ4_MFLIMIT;
+        const uint8_t *const match_limit = in_end - LZ4_LASTLITERALS;
+        // positions of the last seen 4-byte sequences, by hash
+        std::vector<uint32_t> table(1 << LZ4_HASHLOG, 0);
+        size_t misses = 0;
+        while (ip <= mf_limit)
+        {
+            const uint32_t seq = lz4_read32(ip);
+            const uint32_t h = lz4_hash(seq);
+            const uint8_t *ref = in_buf + table[h];
+            table[h] = static_cast<uint32_t>(ip - in_buf);
+            if ((ref >= ip) || (static_cast<size_t>(ip - ref) > LZ4_MAXOFFSET) ||
+                (lz4_read32(ref) != seq))
+            {
+                // skip faster through the incompressible data
+                ip += 1 + (misses++ >> 6);
+                continue;
+            }
+            misses = 0;
+            // extend the match backwards, then forwards
+            while ((ip > anchor) && (ref > in_buf) && (ip[-1] == ref[-1]))
+            {
+                --ip;
+                --ref;
+            }
+            const uint8_t *match_end = ip + LZ4_MINMATCH;
+            for (const uint8_t *r = ref + LZ4_MINMATCH;
+                (match_end < match_limit) && (*match_end == *r); ++match_end, ++r);
+            lz4_put_sequence(out, anchor, ip - anchor, ip - ref, match_end - ip);
+            ip = anchor = match_end;
+            // register a position inside the match, improves next matches
+            if (ip - 2 > in_buf)
+                table[lz4_hash(lz4_read32(ip - 2))] = static_cast<uint32_t>(ip - 2 - in_buf);
+        }
+    }
+    lz4_put_sequence(out, anchor, in_end - anchor, 0, 0);
+}
+
+bool lz4expand(const uint8_t *in_buf, size_t in_sz, uint8_t *out_buf, size_t out_sz)
+{
+    const uint8_t *ip = in_buf;
+    const uint8_t *const in_end = in_buf + in_sz;
+    uint8_t *op = out_buf;
+    uint8_t *const out_end = out_buf + out_sz;
+
+    for (;;)
+    {
+        if (ip >= in_end)
+            return false;
+        const unsigned token = *ip++;
+
+        // Literals
+        size_t len = token >> 4;
+        if ((len < 15) && (in_end - ip >= 16) && (out_end - op >= 16))
+        { // common short case: copy fixed amount, the tail is overwritten later
+            memcpy(op, ip, 16);
+        }
+        else
+        {
+            if (len == 15)
+            {
+                uint8_t b;
+                do
+                {
+                    if (ip >= in_end)
+                        return false;
+                    b = *ip++;
+                    len += b;
+                } while (b == 255);
+            }
+            if ((len > static_cast<size_t>(in_end - ip)) || (len > static_cast<size_t>(out_end - op)))
+                return false;
+            memcpy(op, ip, len);
+        }
+        ip += len;
+        op += len;
+        if (ip == in_end)
+            return op == out_end; // last sequence
+
+        // Match
+        if (in_end - ip < 2)
+            return false;
+        const size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if ((offset == 0) || (offset > static_cast<size_t>(op - out_buf)))
+            return false;
+        len = token & 0xF;
+        if (len == 15)
+        {
+            uint8_t b;
+            do
+            {
+                if (ip >= in_end)
+                    return false;
+                b = *ip++;
+                len += b;
+            } while (b == 255);
+        }
+        len += LZ4_MINMATCH;
+        if (len > static_cast<size_t>(out_end - op))
+            return false;
+
+        const uint8_t *match = op - offset;
+        if (offset >= len)
+        { // no overlap
+            memcpy(op, match, len);
+        }
+        else if ((offset >= 8) && (out_end - op >= static_cast<ptrdiff_t>(len + 8)))
+        { // overlaps, but every 8-byte step does not
+            uint8_t *dst = op;
+            const uint8_t *src = match;
+            for (uint8_t *const dst_end = op + len; dst < dst_end; dst += 8, src += 8)
+                memcpy(dst, src, 8);
+        }
+        else
+        { // short repeating pattern: copy it once, then keep doubling the copy
+            memcpy(op, match, offset);
+            for (size_t done = offset; done < len;)
+            {
+                const size_t n = (done < len - done) ? done : (len - done);
+                memcpy(op + done, op, n);
+                done += n;
+            }
+        }
+        op += len;
+    }
+}
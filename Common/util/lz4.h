@@ -0,0 +1,35 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// LZ4 block compression. Implements the LZ4 block format only, without the
+// frame format: the block stores neither its own size nor the size
+// of the decompressed data, which must be saved elsewhere by the user.
+//
+// Unlike the other compression methods, works over the whole memory buffers,
+// which lets the decompression run nearly at the memory copy speed.
+//
+//=============================================================================
+#ifndef __AGS_CN_UTIL__LZ4_H
+#define __AGS_CN_UTIL__LZ4_H
+
+#include <vector>
+#include "core/types.h"
+
+// Compresses the input buffer as a single block, appends to the output vector
+void lz4compress(const uint8_t *in_buf, size_t in_sz, std::vector<uint8_t> &out);
+// Decompresses a single block into the output buffer of the exact original size;
+// returns false if the data is malformed or does not match the output size
+bool lz4expand(const uint8_t *in_buf, size_t in_sz, uint8_t *out_buf, size_t out_sz);
+
+#endif // __AGS_CN_UTIL__LZ4_H
@@ -43,7 +43,6 @@ void _delete(int);
 uint8_t *lzbuffer;
 int *node;
 int pos;
-size_t outbytes = 0, maxsize = 0, putbytes = 0;
 
 int insert(int i, int run)
 {
@@ -175,7 +174,6 @@ bool lzwcompress(Stream *lzw_in, Stream *out)
 
       if (!((mask += mask) & 0xFF)) {
         out->Write(buf, size);
-        outbytes += size;
         size = mask = 1;
         buf[0] = 0;
       }
@@ -185,14 +183,13 @@ bool lzwcompress(Stream *lzw_in, Stream *out)
 
   if (size > 1) {
     out->Write(buf, size);
-    outbytes += size;
   }
 
   free(lzbuffer);
   return true;
 }
 
-inline void myputc(uint8_t ccc, Stream *out)
+inline void myputc(uint8_t ccc, Stream *out, size_t &putbytes, size_t maxsize)
 {
   if (maxsize > 0) {
     putbytes++;
@@ -200,18 +197,19 @@ inline void myputc(uint8_t ccc, Stream *out)
       return;
   }
 
-  outbytes++;
   out->WriteInt8(ccc);
 }
 
+// NOTE: unlike lzwcompress, lzwexpand keeps all of its state local,
+// as sprites may be decompressed on multiple threads at once.
 bool lzwexpand(Stream *lzw_in, Stream *out, size_t out_size)
 {
   int bits, ch, i, j, len, mask;
-  outbytes = 0; putbytes = 0;
-  maxsize = out_size;
+  size_t putbytes = 0;
+  const size_t maxsize = out_size;
 
-  lzbuffer = (uint8_t *)malloc(N);
-  if (lzbuffer == nullptr) {
+  uint8_t *expbuf = (uint8_t *)malloc(N);
+  if (expbuf == nullptr) {
     return false;
   }
   i = N - F;
@@ -228,13 +226,13 @@ bool lzwexpand(Stream *lzw_in, Stream *out, size_t out_size)
         j = (i - j - 1) & (N - 1);
 
         while (len--) {
-          myputc(lzbuffer[i] = lzbuffer[j], out);
+          myputc(expbuf[i] = expbuf[j], out, putbytes, maxsize);
           j = (j + 1) & (N - 1);
           i = (i + 1) & (N - 1);
         }
       } else {
         ch = lzw_in->ReadByte();
-        myputc(lzbuffer[i] = static_cast<uint8_t>(ch), out);
+        myputc(expbuf[i] = static_cast<uint8_t>(ch), out, putbytes, maxsize);
         i = (i + 1) & (N - 1);
       }
 
@@ -242,7 +240,7 @@ bool lzwexpand(Stream *lzw_in, Stream *out, size_t out_size)
         break;
 
       if ((lzw_in->EOS()) && (maxsize > 0)) {
-        free(lzbuffer);
+        free(expbuf);
         return false;
       }
     }                           // end for mask
@@ -251,6 +249,6 @@ bool lzwexpand(Stream *lzw_in, Stream *out, size_t out_size)
       break;
   }
 
-  free(lzbuffer);
+  free(expbuf);
   return true;
 }
@@ -0,0 +1,159 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+#include "util/memorymappedfile.h"
+#include "core/platform.h"
+#if AGS_PLATFORM_OS_WINDOWS
+#include "platform/windows/windows.h"
+#elif !AGS_PLATFORM_OS_PSP
+#define AGS_HAS_POSIX_MMAP (1)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include "util/stdio_compat.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+    Close();
+}
+
+#if AGS_PLATFORM_OS_WINDOWS
+
+bool MemoryMappedFile::Open(const String &filename, soff_t offset, soff_t size)
+{
+    Close();
+    if (offset < 0)
+        return false;
+    WCHAR wstr[MAX_PATH_SZ];
+    MultiByteToWideChar(CP_UTF8, 0, filename.GetCStr(), -1, wstr, MAX_PATH_SZ);
+    HANDLE file = CreateFileW(wstr, GENERIC_READ, FILE_SHARE_READ, NULL,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size) || offset >= file_size.QuadPart)
+    {
+        CloseHandle(file);
+        return false;
+    }
+    if (size < 0 || offset + size > file_size.QuadPart)
+        size = file_size.QuadPart - offset;
+    HANDLE mapping = CreateFileMappingW(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    CloseHandle(file); // mapping keeps its own reference
+    if (mapping == NULL)
+        return false;
+    // view offset must be a multiple of the allocation granularity
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    const soff_t view_off = offset - (offset % si.dwAllocationGranularity);
+    const soff_t view_size = size + (offset - view_off);
+    if ((uint64_t)view_size > SIZE_MAX)
+    {
+        CloseHandle(mapping);
+        return false;
+    }
+    void *view = MapViewOfFile(mapping, FILE_MAP_COPY,
+        (DWORD)((uint64_t)view_off >> 32), (DWORD)((uint64_t)view_off & 0xFFFFFFFF),
+        (SIZE_T)view_size);
+    CloseHandle(mapping); // view keeps its own reference
+    if (view == NULL)
+        return false;
+    _view = view;
+    _viewSize = (size_t)view_size;
+    _data = static_cast<uint8_t*>(view) + (offset - view_off);
+    _size = (size_t)size;
+    return true;
+}
+
+void MemoryMappedFile::Close()
+{
+    if (_view)
+        UnmapViewOfFile(_view);
+    _view = nullptr;
+    _viewSize = 0;
+    _data = nullptr;
+    _size = 0;
+}
+
+#elif defined (AGS_HAS_POSIX_MMAP)
+
+bool MemoryMappedFile::Open(const String &filename, soff_t offset, soff_t size)
+{
+    Close();
+    if (offset < 0)
+        return false;
+    int fd = open(filename.GetCStr(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || offset >= st.st_size)
+    {
+        close(fd);
+        return false;
+    }
+    if (size < 0 || offset + size > st.st_size)
+        size = st.st_size - offset;
+    // mapping offset must be a multiple of the page size
+    const soff_t page_size = sysconf(_SC_PAGESIZE);
+    const soff_t view_off = offset - (offset % page_size);
+    const soff_t view_size = size + (offset - view_off);
+    if ((uint64_t)view_size > SIZE_MAX)
+    {
+        close(fd);
+        return false;
+    }
+    // private writable mapping, so that in-place changes stay local
+    void *view = mmap(nullptr, (size_t)view_size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+        fd, (off_t)view_off);
+    close(fd); // mapping keeps its own reference
+    if (view == MAP_FAILED)
+        return false;
+    _view = view;
+    _viewSize = (size_t)view_size;
+    _data = static_cast<uint8_t*>(view) + (offset - view_off);
+    _size = (size_t)size;
+    return true;
+}
+
+void MemoryMappedFile::Close()
+{
+    if (_view)
+        munmap(_view, _viewSize);
+    _view = nullptr;
+    _viewSize = 0;
+    _data = nullptr;
+    _size = 0;
+}
+
+#else // no mapping support
+
+bool MemoryMappedFile::Open(const String &/*filename*/, soff_t /*offset*/, soff_t /*size*/)
+{
+    return false;
+}
+
+void MemoryMappedFile::Close()
+{
+}
+
+#endif
+
+} // namespace Common
+} // namespace AGS
@@ -0,0 +1,73 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// MemoryMappedFile maps a range of a file into the process memory for
+// reading. The mapping is copy-on-write: the memory may be written to, but
+// the changes are private to the process and never reach the file.
+//
+// Mapping is not supported on every platform, and may fail for other reasons
+// (e.g. file is inside an archive, or there's not enough address space);
+// the users must be ready to fallback to the regular file reading.
+//
+//=============================================================================
+#ifndef __AGS_CN_UTIL__MEMORYMAPPEDFILE_H
+#define __AGS_CN_UTIL__MEMORYMAPPEDFILE_H
+
+#include "core/types.h"
+#include "util/string.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+class MemoryMappedFile
+{
+public:
+    MemoryMappedFile() = default;
+    MemoryMappedFile(const MemoryMappedFile&) = delete;
+    ~MemoryMappedFile();
+
+    // Maps the range of the file, starting at offset and of given size;
+    // if size is negative, then maps everything till the end of file.
+    bool Open(const String &filename, soff_t offset = 0, soff_t size = -1);
+    // Unmaps the file; any pointers to the mapped data become invalid
+    void Close();
+
+    inline bool IsValid() const { return _data != nullptr; }
+    // Gets the beginning of the mapped range
+    inline uint8_t *GetData() const { return _data; }
+    // Gets the size of the mapped range, in bytes
+    inline size_t GetSize() const { return _size; }
+    // Tells if the given pointer is inside the mapped range
+    inline bool Contains(const void *ptr) const
+    {
+        return (_data != nullptr) &&
+            (static_cast<const uint8_t*>(ptr) >= _data) &&
+            (static_cast<const uint8_t*>(ptr) < _data + _size);
+    }
+
+    MemoryMappedFile &operator =(const MemoryMappedFile&) = delete;
+
+private:
+    void   *_view = nullptr;    // system mapping, aligned to the page boundary
+    size_t  _viewSize = 0;
+    uint8_t *_data = nullptr;   // requested range
+    size_t  _size = 0;
+};
+
+} // namespace Common
+} // namespace AGS
+
+#endif // __AGS_CN_UTIL__MEMORYMAPPEDFILE_H
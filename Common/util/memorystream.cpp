@@ -212,5 +212,20 @@ int32_t VectorStream::WriteByte(uint8_t val)
     return val;
 }
 
+
+
+SharedMemoryStream::SharedMemoryStream(const std::shared_ptr<const void> &owner,
+        const uint8_t *cbuf, size_t buf_sz, DataEndianess stream_endianess)
+    : MemoryStream(cbuf, buf_sz, stream_endianess)
+    , _owner(owner)
+{
+}
+
+void SharedMemoryStream::Close()
+{
+    MemoryStream::Close();
+    _owner.reset();
+}
+
 } // namespace Common
 } // namespace AGS
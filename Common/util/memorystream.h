@@ -19,12 +19,17 @@
 //
 // VectorStream is a specialized implementation that works with std::vector.
 // Unlike base MemoryStream provides continiously resizing buffer for writing.
+//
+// SharedMemoryStream is a read-only stream, which co-owns the memory object
+// that it reads from; the buffer is guaranteed to persist while the stream
+// is open, even if all the other owners have released it.
 // TODO: separate StringStream for reading & writing String object?
 //
 //=============================================================================
 #ifndef __AGS_CN_UTIL__MEMORYSTREAM_H
 #define __AGS_CN_UTIL__MEMORYSTREAM_H
 
+#include <memory>
 #include <vector>
 #include "util/datastream.h"
 #include "util/string.h"
@@ -104,6 +109,25 @@ private:
     std::vector<uint8_t> *_vec = nullptr; // writeable vector (may be null)
 };
 
+
+class SharedMemoryStream : public MemoryStream
+{
+public:
+    // Construct memory stream in the read-only mode over a C-buffer,
+    // which lifetime is controlled by the owner object
+    SharedMemoryStream(const std::shared_ptr<const void> &owner, const uint8_t *cbuf, size_t buf_sz,
+        DataEndianess stream_endianess = kLittleEndian);
+    ~SharedMemoryStream() override = default;
+
+    void    Close() override;
+
+    // Gets the beginning of the stream's buffer
+    const uint8_t *GetData() const { return _cbuf; }
+
+private:
+    std::shared_ptr<const void> _owner;
+};
+
 } // namespace Common
 } // namespace AGS
 
@@ -0,0 +1,303 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+#include "util/rle.h"
+#include <algorithm>
+#include <assert.h>
+#include <string.h>
+#include "core/platform.h"
+#include "util/stream.h"
+#if AGS_PLATFORM_ENDIAN_BIG
+#include "util/bbop.h"
+#endif
+
+using namespace AGS::Common;
+
+#ifdef _MANAGED
+// ensure this doesn't get compiled to .NET IL
+#pragma unmanaged
+#endif
+
+// Max number of pixels which the encoder stores in a single command
+static const size_t RLE_MAXCOUNT = 127;
+
+template <typename T> inline T rle_swap_le(T val) { return val; }
+#if AGS_PLATFORM_ENDIAN_BIG
+template <> inline uint16_t rle_swap_le(uint16_t val)
+    { return static_cast<uint16_t>(BBOp::SwapBytesInt16(static_cast<int16_t>(val))); }
+template <> inline uint32_t rle_swap_le(uint32_t val)
+    { return static_cast<uint32_t>(BBOp::SwapBytesInt32(static_cast<int32_t>(val))); }
+#endif
+
+template <typename T> inline T rle_read_pixel(const uint8_t *p)
+{
+    T val;
+    memcpy(&val, p, sizeof(T));
+    return rle_swap_le(val);
+}
+
+template <typename T> inline void rle_write_pixels(uint8_t *p, const T *px, size_t count)
+{
+#if AGS_PLATFORM_ENDIAN_BIG
+    for (size_t i = 0; i < count; ++i, p += sizeof(T))
+    {
+        const T val = rle_swap_le(px[i]);
+        memcpy(p, &val, sizeof(T));
+    }
+#else
+    memcpy(p, px, count * sizeof(T));
+#endif
+}
+
+template <typename T> inline void rle_read_pixels(T *px, const uint8_t *p, size_t count)
+{
+#if AGS_PLATFORM_ENDIAN_BIG
+    for (size_t i = 0; i < count; ++i, p += sizeof(T))
+        px[i] = rle_read_pixel<T>(p);
+#else
+    memcpy(px, p, count * sizeof(T));
+#endif
+}
+
+template <typename T>
+static void rle_pack(const T *line, size_t size, std::vector<uint8_t> &out)
+{
+    // every command holds at least 2 pixels, except maybe the last one
+    const size_t start = out.size();
+    out.resize(start + size * sizeof(T) + size / 2 + 2);
+    uint8_t *op = out.data() + start;
+
+    for (size_t i = 0; i < size;)
+    {
+        if (i == size - 1)
+        { // last pixel alone
+            *op++ = 0;
+            rle_write_pixels(op, line + i, 1);
+            op += sizeof(T);
+            i++;
+            continue;
+        }
+        const size_t jmax = std::min(i + RLE_MAXCOUNT - 1, size - 1);
+        size_t j = i + 1;
+        if (line[i] == line[j])
+        { // run
+            while ((j < jmax) && (line[j] == line[j + 1]))
+                j++;
+            *op++ = static_cast<uint8_t>(static_cast<int8_t>(-static_cast<int>(j - i)));
+            rle_write_pixels(op, line + i, 1);
+            op += sizeof(T);
+        }
+        else
+        { // sequence
+            while ((j < jmax) && (line[j] != line[j + 1]))
+                j++;
+            *op++ = static_cast<uint8_t>(j - i);
+            rle_write_pixels(op, line + i, j - i + 1);
+            op += (j - i + 1) * sizeof(T);
+        }
+        i = j + 1;
+    }
+    out.resize(op - out.data());
+}
+
+template <typename T>
+static bool rle_unpack(const uint8_t *in_buf, size_t in_sz, T *line, size_t size)
+{
+    const uint8_t *ip = in_buf;
+    const uint8_t *const in_end = in_buf + in_sz;
+    T *op = line;
+    T *const out_end = line + size;
+
+    while (op < out_end)
+    {
+        if (ip >= in_end)
+            return false;
+        int cx = static_cast<int8_t>(*ip++);
+        if (cx == -128)
+            cx = 0;
+
+        if (cx < 0)
+        { // run
+            const size_t count = 1 - cx;
+            if ((static_cast<size_t>(in_end - ip) < sizeof(T)) ||
+                (count > static_cast<size_t>(out_end - op)))
+                return false;
+            const T px = rle_read_pixel<T>(ip);
+            ip += sizeof(T);
+            std::fill(op, op + count, px); // simple loop, vectorized by the compiler
+            op += count;
+        }
+        else
+        { // sequence
+            const size_t count = cx + 1;
+            if ((static_cast<size_t>(in_end - ip) < count * sizeof(T)) ||
+                (count > static_cast<size_t>(out_end - op)))
+                return false;
+            rle_read_pixels(op, ip, count);
+            ip += count * sizeof(T);
+            op += count;
+        }
+    }
+    return true;
+}
+
+void rlecompress(const uint8_t *in_buf, size_t in_sz, int image_bpp, std::vector<uint8_t> &out)
+{
+    switch (image_bpp)
+    {
+    case 1: rle_pack(in_buf, in_sz, out); break;
+    case 2: rle_pack(reinterpret_cast<const uint16_t*>(in_buf), in_sz / sizeof(uint16_t), out); break;
+    case 4: rle_pack(reinterpret_cast<const uint32_t*>(in_buf), in_sz / sizeof(uint32_t), out); break;
+    default: assert(0); break;
+    }
+}
+
+bool rleexpand(const uint8_t *in_buf, size_t in_sz, uint8_t *out_buf, size_t out_sz, int image_bpp)
+{
+    switch (image_bpp)
+    {
+    case 1: return rle_unpack(in_buf, in_sz, out_buf, out_sz);
+    case 2: return rle_unpack(in_buf, in_sz, reinterpret_cast<uint16_t*>(out_buf), out_sz / sizeof(uint16_t));
+    case 4: return rle_unpack(in_buf, in_sz, reinterpret_cast<uint32_t*>(out_buf), out_sz / sizeof(uint32_t));
+    default: assert(0); return false;
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Stream-based decompression
+//-----------------------------------------------------------------------------
+
+static int cunpackbitl(uint8_t *line, size_t size, Stream *in)
+{
+  size_t n = 0;                  // number of bytes decoded
+
+  while (n < size) {
+    int ix = in->ReadByte();     // get index byte
+    if (in->HasErrors())
+      break;
+
+    signed char cx = ix;
+    if (cx == -128)
+      cx = 0;
+
+    if (cx < 0) {                //.............run
+      int i = 1 - cx;
+      char ch = in->ReadInt8();
+      while (i--) {
+        // test for buffer overflow
+        if (n >= size)
+          return -1;
+
+        line[n++] = ch;
+      }
+    } else {                     //.....................seq
+      int i = cx + 1;
+      while (i--) {
+        // test for buffer overflow
+        if (n >= size)
+          return -1;
+
+        line[n++] = in->ReadByte();
+      }
+    }
+  }
+
+  return in->HasErrors() ? -1 : 0;
+}
+
+static int cunpackbitl16(uint16_t *line, size_t size, Stream *in)
+{
+  size_t n = 0;                  // number of bytes decoded
+
+  while (n < size) {
+    int ix = in->ReadByte();     // get index byte
+    if (in->HasErrors())
+      break;
+
+    signed char cx = ix;
+    if (cx == -128)
+      cx = 0;
+
+    if (cx < 0) {                //.............run
+      int i = 1 - cx;
+      unsigned short ch = in->ReadInt16();
+      while (i--) {
+        // test for buffer overflow
+        if (n >= size)
+          return -1;
+
+        line[n++] = ch;
+      }
+    } else {                     //.....................seq
+      int i = cx + 1;
+      while (i--) {
+        // test for buffer overflow
+        if (n >= size)
+          return -1;
+
+        line[n++] = in->ReadInt16();
+      }
+    }
+  }
+
+  return in->HasErrors() ? -1 : 0;
+}
+
+static int cunpackbitl32(uint32_t *line, size_t size, Stream *in)
+{
+  size_t n = 0;                  // number of bytes decoded
+
+  while (n < size) {
+    int ix = in->ReadByte();     // get index byte
+    if (in->HasErrors())
+      break;
+
+    signed char cx = ix;
+    if (cx == -128)
+      cx = 0;
+
+    if (cx < 0) {                //.............run
+      int i = 1 - cx;
+      unsigned int ch = in->ReadInt32();
+      while (i--) {
+        // test for buffer overflow
+        if (n >= size)
+          return -1;
+
+        line[n++] = ch;
+      }
+    } else {                     //.....................seq
+      int i = cx + 1;
+      while (i--) {
+        // test for buffer overflow
+        if (n >= size)
+          return -1;
+
+        line[n++] = (unsigned int)in->ReadInt32();
+      }
+    }
+  }
+
+  return in->HasErrors() ? -1 : 0;
+}
+
+bool rleexpand(Stream *in, uint8_t *out_buf, size_t out_sz, int image_bpp)
+{
+    switch (image_bpp)
+    {
+    case 1: return cunpackbitl(out_buf, out_sz, in) == 0;
+    case 2: return cunpackbitl16(reinterpret_cast<uint16_t*>(out_buf), out_sz / sizeof(uint16_t), in) == 0;
+    case 4: return cunpackbitl32(reinterpret_cast<uint32_t*>(out_buf), out_sz / sizeof(uint32_t), in) == 0;
+    default: assert(0); return false;
+    }
+}
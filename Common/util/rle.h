@@ -0,0 +1,41 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// RLE compression of the 8, 16 and 32-bit pixel data (a PackBits variant).
+//
+// The data is a sequence of commands, each starting with a signed count
+// byte: negative count N is followed by a single pixel which is repeated
+// (1 - N) times, non-negative count N is followed by (N + 1) literal pixels.
+// Multi-byte pixels are stored in the little-endian order.
+//
+//=============================================================================
+#ifndef __AGS_CN_UTIL__RLE_H
+#define __AGS_CN_UTIL__RLE_H
+
+#include <vector>
+#include "core/types.h"
+
+namespace AGS { namespace Common { class Stream; } }
+using namespace AGS; // FIXME later
+
+// Compresses the pixel data of the given bytes per pixel, appends to the output vector
+void rlecompress(const uint8_t *in_buf, size_t in_sz, int image_bpp, std::vector<uint8_t> &out);
+// Decompresses the pixel data from the memory buffer, fills exactly out_sz bytes;
+// returns false if the data is malformed or is too short
+bool rleexpand(const uint8_t *in_buf, size_t in_sz, uint8_t *out_buf, size_t out_sz, int image_bpp);
+// Decompresses the pixel data reading the stream; this is much slower than
+// decompressing from memory, and is meant for when the compressed size is not known
+bool rleexpand(Common::Stream *in, uint8_t *out_buf, size_t out_sz, int image_bpp);
+
+#endif // __AGS_CN_UTIL__RLE_H
@@ -119,6 +119,41 @@ String StrUtil::WildcardToRegex(const String &wildcard)
     return pattern;
 }
 
+bool StrUtil::MatchWildcard(const String &wildcard, const String &str, bool case_sensitive)
+{
+    const char *wc = wildcard.GetCStr();
+    const char *s = str.GetCStr();
+    // position of the last met '*', and of the string where it began to match
+    const char *star_wc = nullptr, *star_s = nullptr;
+    while (*s)
+    {
+        if (*wc == '*')
+        {
+            star_wc = wc++;
+            star_s = s;
+        }
+        else if (*wc && ((*wc == '?') || (*wc == *s) ||
+            (!case_sensitive && (tolower((uint8_t)*wc) == tolower((uint8_t)*s)))))
+        {
+            ++wc;
+            ++s;
+        }
+        else if (star_wc)
+        {
+            // let the last '*' consume one more character, and retry
+            wc = star_wc + 1;
+            s = ++star_s;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    while (*wc == '*')
+        ++wc;
+    return *wc == 0;
+}
+
 String StrUtil::ReadString(Stream *in)
 {
     size_t len = in->ReadInt32();
@@ -54,6 +54,9 @@ namespace StrUtil
     String          Unescape(const String &s);
     // Converts a classic wildcard search pattern into C++11 compatible regex pattern
     String          WildcardToRegex(const String &wildcard);
+    // Tests whether the string matches a classic wildcard pattern,
+    // where '*' stands for any sequence of characters and '?' for any single one
+    bool            MatchWildcard(const String &wildcard, const String &str, bool case_sensitive = true);
 
     // Serialize and unserialize unterminated string prefixed with 32-bit length;
     // length is presented as 32-bit integer integer
@@ -0,0 +1,106 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+#include "util/workerpool.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+#if !defined(AGS_DISABLE_THREADS)
+
+WorkerPool::WorkerPool(int thread_count)
+{
+    for (int i = 0; i < thread_count; ++i)
+        _threads.emplace_back(&WorkerPool::Run, this);
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lk(_mutex);
+        _stop = true;
+        _taskCond.notify_all();
+    }
+    for (auto &thread : _threads)
+        thread.join();
+}
+
+int WorkerPool::GetThreadCount() const
+{
+    return static_cast<int>(_threads.size());
+}
+
+void WorkerPool::RunTasks(size_t count, const std::function<void(size_t)> &task)
+{
+    std::unique_lock<std::mutex> lk(_mutex);
+    _task = task;
+    _taskCount = count;
+    _nextTask = 0u;
+    _tasksLeft = count;
+    _taskCond.notify_all();
+    RunPendingTasks(lk);
+    _doneCond.wait(lk, [this]() { return _tasksLeft == 0u; });
+    _task = nullptr;
+    _taskCount = 0u;
+}
+
+void WorkerPool::RunPendingTasks(std::unique_lock<std::mutex> &lk)
+{
+    while (_nextTask < _taskCount)
+    {
+        const size_t index = _nextTask++;
+        lk.unlock();
+        _task(index);
+        lk.lock();
+        if (--_tasksLeft == 0u)
+            _doneCond.notify_all();
+    }
+}
+
+void WorkerPool::Run()
+{
+    std::unique_lock<std::mutex> lk(_mutex);
+    for (;;)
+    {
+        _taskCond.wait(lk, [this]() { return _stop || (_nextTask < _taskCount); });
+        if (_stop)
+            return;
+        RunPendingTasks(lk);
+    }
+}
+
+#else // AGS_DISABLE_THREADS
+
+WorkerPool::WorkerPool(int /*thread_count*/)
+{
+}
+
+WorkerPool::~WorkerPool() = default;
+
+int WorkerPool::GetThreadCount() const
+{
+    return 0;
+}
+
+void WorkerPool::RunTasks(size_t count, const std::function<void(size_t)> &task)
+{
+    for (size_t i = 0; i < count; ++i)
+        task(i);
+}
+
+#endif // !AGS_DISABLE_THREADS
+
+} // namespace Common
+} // namespace AGS
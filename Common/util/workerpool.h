@@ -0,0 +1,82 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// WorkerPool is a fixed set of threads, which run a job split into a number
+// of indexed tasks. The calling thread takes part in running the tasks, and
+// returns when all of them are complete. Tasks of the same job may run in
+// any order and in parallel, and must not depend on each other.
+//
+// When the threads are disabled by the build configuration, all the tasks
+// are run on the calling thread.
+//
+//=============================================================================
+#ifndef __AGS_CN_UTIL__WORKERPOOL_H
+#define __AGS_CN_UTIL__WORKERPOOL_H
+
+#include <stddef.h>
+#include <functional>
+#include <vector>
+#if !defined(AGS_DISABLE_THREADS)
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+namespace AGS
+{
+namespace Common
+{
+
+class WorkerPool
+{
+public:
+    // Creates the pool with the given number of worker threads,
+    // not counting the thread which will be running the jobs
+    WorkerPool(int thread_count);
+    WorkerPool(const WorkerPool&) = delete;
+    ~WorkerPool();
+    WorkerPool &operator=(const WorkerPool&) = delete;
+
+    // Gets the number of worker threads
+    int  GetThreadCount() const;
+    // Runs the task for each index in [0, count) range, on the worker
+    // threads and the calling thread; returns when all tasks are complete
+    void RunTasks(size_t count, const std::function<void(size_t)> &task);
+
+private:
+#if !defined(AGS_DISABLE_THREADS)
+    // Takes and runs the tasks of the current job until none are left
+    void RunPendingTasks(std::unique_lock<std::mutex> &lk);
+    // Worker thread's entry
+    void Run();
+
+    std::vector<std::thread> _threads;
+    std::mutex _mutex;
+    // Notifies the threads about a new job, or the stop request
+    std::condition_variable _taskCond;
+    // Notifies the job's caller that all its tasks are complete
+    std::condition_variable _doneCond;
+    // Current job: a task function called for each task index
+    std::function<void(size_t)> _task;
+    size_t _taskCount = 0u;
+    size_t _nextTask = 0u;
+    size_t _tasksLeft = 0u;
+    bool _stop = false;
+#endif // !AGS_DISABLE_THREADS
+};
+
+} // namespace Common
+} // namespace AGS
+
+#endif // __AGS_CN_UTIL__WORKERPOOL_H
@@ -11,11 +11,17 @@
 // http://www.opensource.org/licenses/artistic-license-2.0.php
 //
 //=============================================================================
+#include <algorithm>
+#include <atomic>
 #include <utility>
 #include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include "compiler.h"
 #include "script/cs_compiler.h"
+#include "script/cc_optimizer.h"
 #include "script/cc_common.h"
 #include "script/cc_internal.h"
 #include "util/filestream.h"
@@ -65,10 +71,24 @@ std::vector<const char *> GetScriptAPIs()
 
 void CompilerOptions::PrintToStdout() const {
     printf("\n--- Compiler Settings ---\n");
-    printf("Input: %s\n", InputScriptFile.c_str());
-    printf("Output: %s\n", OutputObjFile.c_str());
-    printf("Headers:");
+    printf("Input:");
     bool comma = false;
+    for (const auto& input : InputScriptFiles)
+    {
+        if (comma) printf(", ");
+        printf("%s", input.c_str());
+        comma = true;
+    }
+    printf("\nOutput:");
+    comma = false;
+    for (const auto& output : OutputObjFiles)
+    {
+        if (comma) printf(", ");
+        printf("%s", output.c_str());
+        comma = true;
+    }
+    printf("\nHeaders:");
+    comma = false;
     for (const auto& header : HeaderFiles)
     {
         if (comma) printf(", ");
@@ -84,6 +104,7 @@ void CompilerOptions::PrintToStdout() const {
         comma = true;
     }
     printf("\nVersion: %s\n", Version.c_str());
+    if (Jobs > 0) printf("Jobs: %d\n", Jobs);
     printf("ScriptAPIVersion: %s\n", ScriptAPI.ScriptAPIVersion.c_str());
     printf("ScriptCompatLevel: %s\n", ScriptAPI.ScriptCompatLevel.c_str());
     printf("Flags: ");
@@ -98,10 +119,82 @@ void CompilerOptions::PrintToStdout() const {
     if (Flags.EnforceNewStrings) printf("EnforceNewStrings; ");
     if (Flags.EnforceNewAudio) printf("EnforceNewAudio; ");
     if (Flags.UseOldCustomDialogOptionsAPI) printf("UseOldCustomDialogOptionsAPI; ");
+    if(Optimize) printf("Optimize; ");
     if(DebugMode) printf("\nDebugMode\n");
 }
 
 
+// A script module compiled by agscc
+struct ScriptModule
+{
+    std::string InputFile;
+    std::string OutputFile;
+    String Name;         // script name, used in the error reports
+    String Source;       // script text, preprocessed before compiling
+    std::string Warning; // set if compilation succeeded with a warning
+    std::string Error;   // set if compilation failed
+};
+
+// Compiles the preprocessed module on top of the compiled headers,
+// and writes the script object; may be called from any thread
+static void CompileModule(ScriptModule &module, const ccHeaderSnapshot &headers, bool optimize)
+{
+    std::unique_ptr<ccScript> script(ccCompileTextWithHeaders(module.Source.GetCStr(), module.Name.GetCStr(), headers));
+    if (!script || cc_has_error())
+    {
+        const auto &error = cc_get_error();
+        module.Error = std::string("Error: compile failed at ") + ccCurScriptName +
+            ", line " + std::to_string(error.Line) + " : " + error.ErrorString.GetCStr();
+        return;
+    }
+
+    if(optimize)
+    {
+        int removed = ccOptimizeScript(script.get());
+        if (removed < 0)
+            module.Warning = "Warning: failed to optimize compiled script " + module.InputFile +
+                ", the code is left unchanged";
+    }
+
+    if(!module.OutputFile.empty())
+    {
+        std::unique_ptr<Stream> out (File::CreateFile(module.OutputFile.c_str()));
+        if (!out || !(out->CanWrite())) {
+            module.Error = "Error: failed to open for writing: " + module.OutputFile;
+            return;
+        }
+        script->Write(out.get());
+    }
+}
+
+// Compiles all the modules, using up to the given number of threads
+static void CompileModules(std::vector<ScriptModule> &modules, const ccHeaderSnapshot &headers,
+    bool optimize, int jobs)
+{
+#if !defined(AGS_DISABLE_THREADS)
+    const size_t thread_count = std::min(static_cast<size_t>(jobs), modules.size());
+    if (thread_count > 1)
+    {
+        // each thread takes the next module in line, until there are none left
+        std::atomic<size_t> next_module(0);
+        auto worker = [&]()
+        {
+            for (size_t i = next_module++; i < modules.size(); i = next_module++)
+                CompileModule(modules[i], headers, optimize);
+        };
+        std::vector<std::thread> threads;
+        for (size_t i = 1; i < thread_count; ++i)
+            threads.emplace_back(worker);
+        worker(); // calling thread does its share too
+        for (auto &thread : threads)
+            thread.join();
+        return;
+    }
+#endif
+    for (auto &module : modules)
+        CompileModule(module, headers, optimize);
+}
+
 int Compile(const CompilerOptions& comp_opts)
 {
     comp_opts.PrintToStdout();
@@ -212,17 +305,19 @@ int Compile(const CompilerOptions& comp_opts)
         sr.ReleaseStream();
     }
 
-    String script_input;
-    const char* src = nullptr;
-    if(!comp_opts.InputScriptFile.empty())
+    std::vector<ScriptModule> modules;
+    for(size_t i = 0; i < comp_opts.InputScriptFiles.size(); ++i)
     {
-        if (comp_opts.InputScriptFile.empty())
+        ScriptModule module;
+        module.InputFile = comp_opts.InputScriptFiles[i];
+        module.OutputFile = comp_opts.OutputObjFiles[i];
+        if (module.InputFile.empty())
         {
             std::cerr << "Error: empty script filename." << std::endl;
             return -1;
         }
 
-        src = comp_opts.InputScriptFile.c_str();
+        const char *src = module.InputFile.c_str();
         std::unique_ptr<Stream> in (File::OpenFileRead(src));
         if (!in)
         {
@@ -230,8 +325,12 @@ int Compile(const CompilerOptions& comp_opts)
             return -1;
         }
         TextStreamReader sr(in.get());
-        script_input = sr.ReadAll();
+        module.Source = sr.ReadAll();
         sr.ReleaseStream();
+
+        String filename = Path::GetFilename(src);
+        module.Name = Path::RemoveExtension(filename);
+        modules.push_back(std::move(module));
     }
 
     //-----------------------------------------------------------------------//
@@ -241,6 +340,13 @@ int Compile(const CompilerOptions& comp_opts)
     for(const auto& head: heads)
     {
         String preprocessed_header = pp.Preprocess(head.first,head.second);
+        if ((preprocessed_header == nullptr) || (cc_has_error()))
+        {
+            const auto &error = cc_get_error();
+            std::cerr << "Error: preprocessor failed at " << head.second.GetCStr() <<
+                ", line " << error.Line << " : " << error.ErrorString.GetCStr() << std::endl;
+            return -1;
+        }
         preprocessed_heads.emplace_back(preprocessed_header.GetCStr(),head.second);
 
         ccAddDefaultHeader((char *) preprocessed_heads.back().first.GetCStr(), (char *) preprocessed_heads.back().second.GetCStr());
@@ -248,37 +354,41 @@ int Compile(const CompilerOptions& comp_opts)
     heads.clear();
 
     //-----------------------------------------------------------------------//
-    // Preprocess script
+    // Preprocess scripts
     //-----------------------------------------------------------------------//
-    String script_pp = nullptr;
-    String filename = Path::GetFilename(comp_opts.InputScriptFile.c_str());
-    String script_name = Path::RemoveExtension(filename);
-
-    script_pp = pp.Preprocess(script_input,script_name);
-    if ((script_pp == nullptr) || (cc_has_error()))
+    for(auto& module: modules)
     {
-        const auto &error = cc_get_error();
-        std::cerr << "Error: preprocessor failed at " << script_name.GetCStr() <<
-            ", line " << error.Line << " : " << error.ErrorString.GetCStr() << std::endl;
-        return -1;
+        // each script starts with the macros defined by the headers,
+        // and does not see the ones defined by the other scripts
+        AGS::Preprocessor::Preprocessor script_pp = pp;
+        module.Source = script_pp.Preprocess(module.Source, module.Name);
+        if ((module.Source == nullptr) || (cc_has_error()))
+        {
+            const auto &error = cc_get_error();
+            std::cerr << "Error: preprocessor failed at " << module.Name.GetCStr() <<
+                ", line " << error.Line << " : " << error.ErrorString.GetCStr() << std::endl;
+            return -1;
+        }
+
+        if(comp_opts.PreprocessOnly)
+        {
+            std::unique_ptr<Stream> out (File::CreateFile(module.OutputFile.c_str()));
+            if (!out || !(out->CanWrite())) {
+                std::cerr << "Error: failed to open for writing: " << module.OutputFile << std::endl;
+                return -1;
+            }
+            module.Source.Write(out.get());
+        }
     }
 
     if(comp_opts.PreprocessOnly)
-    {
-        std::unique_ptr<Stream> out (File::CreateFile(comp_opts.OutputObjFile.c_str()));
-        if (!out || !(out->CanWrite())) {
-            std::cerr << "Error: failed to open for writing: " << comp_opts.OutputObjFile << std::endl;
-            return -1;
-        }
-        script_pp.Write(out.get());
         return 0;
-    }
 
     //-----------------------------------------------------------------------//
-    // Compile script
+    // Compile headers, once for all the scripts
     //-----------------------------------------------------------------------//
-    ccScript* script = ccCompileText(script_pp.GetCStr(), script_name.GetCStr());
-    if ((script == nullptr) || (cc_has_error()))
+    std::unique_ptr<ccHeaderSnapshot> headers = ccCompileDefaultHeaders();
+    if (!headers)
     {
         const auto &error = cc_get_error();
         std::cerr << "Error: compile failed at " << ccCurScriptName << ", line " << error.Line << " : " << error.ErrorString.GetCStr() << std::endl;
@@ -286,17 +396,23 @@ int Compile(const CompilerOptions& comp_opts)
     }
 
     //-----------------------------------------------------------------------//
-    // Write script object
+    // Compile scripts and write script objects
     //-----------------------------------------------------------------------//
-    if(!comp_opts.OutputObjFile.empty())
+    int jobs = comp_opts.Jobs;
+    if (jobs <= 0)
+        jobs = std::max(1, (int)std::thread::hardware_concurrency());
+    CompileModules(modules, *headers, comp_opts.Optimize, jobs);
+
+    int result = 0;
+    for (const auto &module : modules)
     {
-        std::unique_ptr<Stream> out (File::CreateFile(comp_opts.OutputObjFile.c_str()));
-        if (!out || !(out->CanWrite())) {
-            std::cerr << "Error: failed to open for writing: " << comp_opts.OutputObjFile << std::endl;
-            return -1;
+        if (!module.Warning.empty())
+            std::cerr << module.Warning << std::endl;
+        if (!module.Error.empty())
+        {
+            std::cerr << module.Error << std::endl;
+            result = -1;
         }
-        script->Write(out.get());
     }
-
-    return 0;
-}
\ No newline at end of file
+    return result;
+}
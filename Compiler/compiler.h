@@ -50,10 +50,12 @@ public:
     Flags Flags;
     bool PreprocessOnly = false;
     bool DebugMode = false; // build for debug
+    bool Optimize = false; // optimize compiled bytecode
     std::vector<std::pair<std::string, std::string>> Macros{};
     std::vector<std::string> HeaderFiles{};
-    std::string InputScriptFile{};
-    std::string OutputObjFile{};
+    std::vector<std::string> InputScriptFiles{};
+    std::vector<std::string> OutputObjFiles{}; // one per input script
+    int Jobs = 0; // number of scripts compiled in parallel, 0 for automatic
     std::string Version{};
     CompilerOptions() = default;
     ~CompilerOptions() = default;
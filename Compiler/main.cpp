@@ -5,18 +5,20 @@
 #include <map>
 #include "util/path.h"
 #include "util/cmdlineopts.h"
+#include "util/string_utils.h"
 #include "compiler.h"
 #include "core/def_version.h"
 
 using namespace AGS::Common;
 using namespace AGS::Common::CmdLineOpts;
 
-const char *HELP_STRING = R"EOS(Usage: agscc [options] <INPUT.asc>
+const char *HELP_STRING = R"EOS(Usage: agscc [options] <INPUT.asc> [<INPUT2.asc>...]
 -A <version>                 Script API Version               (default:Highest)
 -C <version>                 Script API Compatibility version (default:Highest)
 -H, --Headers <H1>[:<H2>...] Header Files in order  (; as separator in cmd.exe)
 -D <macro>[=<val>]           Define <macro> to <val> (or 1 if <val> omitted)
 -E                           Only run the preprocessor
+-O                           Optimize compiled bytecode
 -fshowwarnings[=0]           Print warnings to console              (default:1)
 -fexportall[=0]              Exports all functions automatically    (default:1)
 -flinenumbers[=0]            Include line numbers in compiled code  (default:1)
@@ -29,8 +31,10 @@ const char *HELP_STRING = R"EOS(Usage: agscc [options] <INPUT.asc>
 -fforcenewaudio[=0]          Enforce new audio system               (default:1)
 -foldcustomdialogopt[=0]     Use old custom dialog API
 -g                           Generate debug information
+-j <N>, --jobs <N>           Compile up to N scripts in parallel  (default:CPUs)
 --tell-api-versions          Returns supported Script API Versions
 -o <OUT.o>, --output <OUT.o> Place output in specified file.  (default:INPUT.o)
+                             Only allowed with a single input script
 --override-version <VERSION> Overrides editor version
 -h, --help                   Print this usage message
 )EOS";
@@ -87,6 +91,7 @@ ParsedOptions parser_to_compiler_opts(const ParseResult& parseResult)
 
     compilerOptions.PreprocessOnly = parseResult.Opt.count("-E");
     compilerOptions.DebugMode = parseResult.Opt.count("-g");
+    compilerOptions.Optimize = parseResult.Opt.count("-O");
 
     for(const auto& opt_with_value : parseResult.OptWithValue)
     {
@@ -156,7 +161,18 @@ ParsedOptions parser_to_compiler_opts(const ParseResult& parseResult)
 
         if(opt_with_value.first == "-o" || opt_with_value.first == "--output")
         {
-            compilerOptions.OutputObjFile = opt_with_value.second.GetCStr();
+            compilerOptions.OutputObjFiles.push_back(opt_with_value.second.GetCStr());
+            continue;
+        }
+
+        if(opt_with_value.first == "-j" || opt_with_value.first == "--jobs")
+        {
+            int jobs = StrUtil::StringToInt(opt_with_value.second, -1);
+            if(jobs <= 0) {
+                std::cerr << "Error: invalid number of jobs " << opt_with_value.second.GetCStr() << std::endl;
+                return ParsedOptions(-1);
+            }
+            compilerOptions.Jobs = jobs;
             continue;
         }
 
@@ -226,12 +242,24 @@ ParsedOptions parser_to_compiler_opts(const ParseResult& parseResult)
         }
     }
 
-    compilerOptions.InputScriptFile = parseResult.PosArgs[0].GetCStr();
+    for(const auto& pos_arg : parseResult.PosArgs)
+    {
+        compilerOptions.InputScriptFiles.push_back(pos_arg.GetCStr());
+    }
+
+    if(compilerOptions.OutputObjFiles.size() > 1 ||
+        (!compilerOptions.OutputObjFiles.empty() && compilerOptions.InputScriptFiles.size() > 1)) {
+        std::cerr << "Error: output file may only be set for a single input script" << std::endl;
+        return ParsedOptions(-1);
+    }
 
-    if(compilerOptions.OutputObjFile.empty()) {
+    if(compilerOptions.OutputObjFiles.empty()) {
         // no output file explicitly set, let's use input.o instead
-        std::string filename = Path::RemoveExtension(compilerOptions.InputScriptFile.c_str()).GetCStr();
-        compilerOptions.OutputObjFile = filename + ".o";
+        for(const auto& input : compilerOptions.InputScriptFiles)
+        {
+            std::string filename = Path::RemoveExtension(input.c_str()).GetCStr();
+            compilerOptions.OutputObjFiles.push_back(filename + ".o");
+        }
     }
 
     if(compilerOptions.Version.empty()) {
@@ -252,7 +280,8 @@ Copyright (c) 2021 AGS Team and contributors
 )EOS"
     );
 
-    ParseResult parseResult = Parse(argc,argv,{"-D", "-H", "--Headers", "-A", "-C", "-f"});
+    ParseResult parseResult = Parse(argc,argv,{"-D", "-H", "--Headers", "-A", "-C", "-f",
+        "-o", "--output", "-j", "--jobs", "--override-version"});
     ParsedOptions parsedOptions = parser_to_compiler_opts(parseResult);
 
     if(parsedOptions.Exit) return parsedOptions.ErrorCode;
@@ -9,7 +9,7 @@
 
 using namespace AGS::Common;
 
-extern int currentline; // in script/script_common
+extern thread_local int currentline; // in script/script_common
 
 namespace AGS {
 namespace Preprocessor {
@@ -123,7 +123,7 @@ namespace Preprocessor {
         }
         else if (directive.CompareRight("def") == 0)
         {
-            includeCodeBlock = _macros.contains(macroName.GetCStr());
+            includeCodeBlock = _macros.contains(macroName);
             if (directive == "ifndef")
             {
                 includeCodeBlock = !includeCodeBlock;
@@ -260,7 +260,7 @@ namespace Preprocessor {
             {
                 LogError(ErrorCode::MacroNameInvalid, String::FromFormat("Macro name '%s' cannot start with a digit", macroName.GetCStr()));
             }
-            else if (_macros.contains(macroName.GetCStr()))
+            else if (_macros.contains(macroName))
             {
                 LogError(ErrorCode::MacroAlreadyExists, String::FromFormat("Macro '%s' is already defined", macroName.GetCStr()));
             }
@@ -350,12 +350,12 @@ namespace Preprocessor {
 
                 String theWord = GetNextWord(line, false, false);
 
-                if ((!precededByDot) && (!Contains(ignored, theWord)) && (_macros.contains(theWord.GetCStr())))
+                if ((!precededByDot) && (!Contains(ignored, theWord)) && (_macros.contains(theWord)))
                 {
                     previousOutput.push_back(output);
                     previousLine.push_back(line);
                     ignored.push_back(theWord);
-                    line = _macros.get_macro(theWord.GetCStr());
+                    line = _macros.get_macro(theWord);
                     output = StringBuilder(line.GetLength());
                 }
                 else
@@ -42,6 +42,22 @@ ccCompiledScript::ccCompiledScript() {
     ax_val_type = 0;
     ax_val_scope = 0;
 }
+ccCompiledScript::ccCompiledScript(const ccCompiledScript &src)
+    : ccScript(src) {
+    codeallocated = codesize;
+    numfunctions = src.numfunctions;
+    memset(functions, 0, sizeof(functions));
+    for (long i = 0; i < numfunctions; i++) {
+        functions[i] = (char*)malloc(strlen(src.functions[i])+20);
+        strcpy(functions[i], src.functions[i]);
+    }
+    memcpy(funccodeoffs, src.funccodeoffs, sizeof(funccodeoffs));
+    memcpy(funcnumparams, src.funcnumparams, sizeof(funcnumparams));
+    cur_sp = src.cur_sp;
+    next_line = src.next_line;
+    ax_val_type = src.ax_val_type;
+    ax_val_scope = src.ax_val_scope;
+}
 ccCompiledScript::~ccCompiledScript() {
     shutdown();
 }
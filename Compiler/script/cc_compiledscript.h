@@ -43,6 +43,8 @@ struct ccCompiledScript: public ccScript {
     void pop_reg(int regg);
 
     ccCompiledScript();
+    // makes a full copy of the script, including the compilation state
+    ccCompiledScript(const ccCompiledScript &src);
     virtual ~ccCompiledScript();
 };
 
@@ -2,7 +2,7 @@
 #include <stdlib.h>
 #include "cc_internallist.h"
 
-extern int currentline;  // in script_common
+extern thread_local int currentline;  // in script_common
 
 void ccInternalList::startread() {
     pos=0;
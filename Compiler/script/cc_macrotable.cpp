@@ -6,15 +6,26 @@
 using namespace AGS::Common;
 
 
+int MacroTable::find(const String &name) const {
+    return _index.findValue(name.GetCStr(), name.GetLength());
+}
 void MacroTable::merge(MacroTable &others) {
-    _macro_table.insert(others._macro_table.begin(), others._macro_table.end());
+    // existing macros are not overwritten
+    for (size_t i = 0; i < others._names.size(); i++) {
+        if ((others.find(others._names[i]) == static_cast<int>(i)) && !contains(others._names[i])) {
+            _index.addEntry(others._names[i].GetCStr(), others._names[i].GetLength(), static_cast<int>(_names.size()));
+            _names.push_back(others._names[i]);
+            _values.push_back(others._values[i]);
+        }
+    }
 }
 bool MacroTable::contains(const String &name) {
-    return _macro_table.count(name) > 0;
+    return find(name) >= 0;
 }
 String MacroTable::get_macro(const String &name) {
-    if(_macro_table.count(name)) {
-        return _macro_table[name];
+    int idx = find(name);
+    if (idx >= 0) {
+        return _values[idx];
     }
     return nullptr;
 }
@@ -24,16 +35,22 @@ void MacroTable::add(const String &macroname, const String &value) {
         return;
     }
 
-    _macro_table[macroname] = value;
+    _index.addEntry(macroname.GetCStr(), macroname.GetLength(), static_cast<int>(_names.size()));
+    _names.push_back(macroname);
+    _values.push_back(value);
 }
 void MacroTable::remove(String &macroname) {
-    if (!this->contains(macroname)) {
+    int idx = find(macroname);
+    if (idx < 0) {
         cc_error("MacroTable::Remove: macro '%s' not found", macroname.GetCStr());
         return;
     }
-    _macro_table.erase(macroname);
+    _index.addEntry(macroname.GetCStr(), macroname.GetLength(), -1);
+    _values[idx] = nullptr;
 }
 
 void MacroTable::clear() {
-    _macro_table.clear();
+    _index.clear();
+    _names.clear();
+    _values.clear();
 }
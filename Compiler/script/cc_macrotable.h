@@ -1,14 +1,21 @@
 #ifndef __CC_MACROTABLE_H
 #define __CC_MACROTABLE_H
 
-#include <map>
+#include <vector>
+#include "script/cc_treemap.h"
 #include "util/string.h"
 
 typedef AGS::Common::String AGString;
 
 struct MacroTable {
 private:
-    std::map<AGString,AGString> _macro_table;
+    // maps interned macro names to the indexes in the lists below;
+    // removed macros are mapped to -1
+    ccTreeMap _index;
+    std::vector<AGString> _names;
+    std::vector<AGString> _values;
+
+    int find(const AGString &name) const;
 public:
     bool contains(const AGString &name);
     AGString get_macro(const AGString &name) ;
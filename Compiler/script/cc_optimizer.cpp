@@ -0,0 +1,861 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+#include <utility>
+#include <vector>
+#include "script/cc_optimizer.h"
+#include "script/cc_common.h"      // ccGetOption
+#include "script/cc_internal.h"    // bytecode definitions
+
+namespace
+{
+
+// Number of arguments of each script command
+const int ScCmdArgCount[CC_NUM_SCCMDS] =
+{
+    0, // NULL
+    2, // SCMD_ADD
+    2, // SCMD_SUB
+    2, // SCMD_REGTOREG
+    2, // SCMD_WRITELIT
+    0, // SCMD_RET
+    2, // SCMD_LITTOREG
+    1, // SCMD_MEMREAD
+    1, // SCMD_MEMWRITE
+    2, // SCMD_MULREG
+    2, // SCMD_DIVREG
+    2, // SCMD_ADDREG
+    2, // SCMD_SUBREG
+    2, // SCMD_BITAND
+    2, // SCMD_BITOR
+    2, // SCMD_ISEQUAL
+    2, // SCMD_NOTEQUAL
+    2, // SCMD_GREATER
+    2, // SCMD_LESSTHAN
+    2, // SCMD_GTE
+    2, // SCMD_LTE
+    2, // SCMD_AND
+    2, // SCMD_OR
+    1, // SCMD_CALL
+    1, // SCMD_MEMREADB
+    1, // SCMD_MEMREADW
+    1, // SCMD_MEMWRITEB
+    1, // SCMD_MEMWRITEW
+    1, // SCMD_JZ
+    1, // SCMD_PUSHREG
+    1, // SCMD_POPREG
+    1, // SCMD_JMP
+    2, // SCMD_MUL
+    1, // SCMD_CALLEXT
+    1, // SCMD_PUSHREAL
+    1, // SCMD_SUBREALSTACK
+    1, // SCMD_LINENUM
+    1, // SCMD_CALLAS
+    1, // SCMD_THISBASE
+    1, // SCMD_NUMFUNCARGS
+    2, // SCMD_MODREG
+    2, // SCMD_XORREG
+    1, // SCMD_NOTREG
+    2, // SCMD_SHIFTLEFT
+    2, // SCMD_SHIFTRIGHT
+    1, // SCMD_CALLOBJ
+    2, // SCMD_CHECKBOUNDS
+    1, // SCMD_MEMWRITEPTR
+    1, // SCMD_MEMREADPTR
+    0, // SCMD_MEMZEROPTR
+    1, // SCMD_MEMINITPTR
+    1, // SCMD_LOADSPOFFS
+    0, // SCMD_CHECKNULL
+    2, // SCMD_FADD
+    2, // SCMD_FSUB
+    2, // SCMD_FMULREG
+    2, // SCMD_FDIVREG
+    2, // SCMD_FADDREG
+    2, // SCMD_FSUBREG
+    2, // SCMD_FGREATER
+    2, // SCMD_FLESSTHAN
+    2, // SCMD_FGTE
+    2, // SCMD_FLTE
+    1, // SCMD_ZEROMEMORY
+    1, // SCMD_CREATESTRING
+    2, // SCMD_STRINGSEQUAL
+    2, // SCMD_STRINGSNOTEQ
+    1, // SCMD_CHECKNULLREG
+    0, // SCMD_LOOPCHECKOFF
+    0, // SCMD_MEMZEROPTRND
+    1, // SCMD_JNZ
+    1, // SCMD_DYNAMICBOUNDS
+    3, // SCMD_NEWARRAY
+    2, // SCMD_NEWUSEROBJECT
+};
+
+// Max number of optimization passes over the code
+const int MaxOptimizationPasses = 16;
+// Max number of instructions between PUSHREG and POPREG that are checked
+const int MaxPushPopDistance = 64;
+
+const int AllRegs = ((1 << CC_NUM_REGISTERS) - 1) & ~1;
+
+inline bool IsReg(int32_t reg) { return reg > 0 && reg < CC_NUM_REGISTERS; }
+inline int  RegBit(int32_t reg) { return 1 << reg; }
+
+// A decoded instruction
+struct ScOp
+{
+    int32_t Code = 0;
+    int32_t Args[MAX_SCMD_ARGS] = {};
+    int     ArgCount = 0;
+    char    Fixups[MAX_SCMD_ARGS] = {}; // fixup type of each argument
+    int     CodeRefs[MAX_SCMD_ARGS] = { -1, -1, -1 }; // instructions referenced by absolute address
+    int     Target = -1;    // jump destination instruction
+    bool    Label = false;  // may be entered not only from the previous instruction
+    bool    Removed = false;
+
+    bool HasFixups() const
+    {
+        return Fixups[0] != 0 || Fixups[1] != 0 || Fixups[2] != 0;
+    }
+
+    void Set(int32_t code, int32_t arg1, int32_t arg2)
+    {
+        Code = code;
+        ArgCount = ScCmdArgCount[code];
+        Args[0] = arg1;
+        Args[1] = arg2;
+        Args[2] = 0;
+        for (int i = 0; i < MAX_SCMD_ARGS; ++i)
+        {
+            Fixups[i] = 0;
+            CodeRefs[i] = -1;
+        }
+        Target = -1;
+    }
+};
+
+enum ScOpFlags
+{
+    kOpPure     = 0x01, // only writes registers; may be removed if result is not used
+    kOpNoStack  = 0x02, // does not access stack nor depends on stack pointer
+    kOpBlockEnd = 0x04, // transfers control elsewhere
+    kOpBarrier  = 0x08  // has unknown effect on registers
+};
+
+struct ScOpInfo
+{
+    int Reads;  // registers read by instruction
+    int Writes; // registers written by instruction
+    int Flags;
+};
+
+ScOpInfo GetOpInfo(const ScOp &op)
+{
+    const int32_t r1 = op.Args[0];
+    const int32_t r2 = op.Args[1];
+    const int sp = RegBit(SREG_SP);
+    const int mar = RegBit(SREG_MAR);
+    switch (op.Code)
+    {
+    case SCMD_LINENUM:
+        return ScOpInfo{ 0, 0, kOpNoStack };
+    case SCMD_LITTOREG:
+        if (!IsReg(r1)) break;
+        return ScOpInfo{ 0, RegBit(r1), r1 == SREG_SP ? 0 : kOpPure | kOpNoStack };
+    case SCMD_ADD:
+    case SCMD_MUL:
+    case SCMD_FADD:
+    case SCMD_FSUB:
+        if (!IsReg(r1)) break;
+        return ScOpInfo{ RegBit(r1), RegBit(r1), r1 == SREG_SP ? 0 : kOpPure | kOpNoStack };
+    case SCMD_SUB:
+        // SUB on a stack pointer value works as LOADSPOFFS
+        if (!IsReg(r1)) break;
+        return ScOpInfo{ RegBit(r1) | sp, RegBit(r1), 0 };
+    case SCMD_REGTOREG:
+        if (!IsReg(r1) || !IsReg(r2)) break;
+        return ScOpInfo{ RegBit(r1), RegBit(r2),
+            (r1 == SREG_SP || r2 == SREG_SP) ? 0 : kOpPure | kOpNoStack };
+    case SCMD_MEMREAD:
+    case SCMD_MEMREADB:
+    case SCMD_MEMREADW:
+    case SCMD_MEMREADPTR:
+        if (!IsReg(r1)) break;
+        return ScOpInfo{ mar, RegBit(r1), r1 == SREG_SP ? 0 : kOpNoStack };
+    case SCMD_MEMWRITE:
+    case SCMD_MEMWRITEB:
+    case SCMD_MEMWRITEW:
+        if (!IsReg(r1)) break;
+        return ScOpInfo{ RegBit(r1) | mar, 0, 0 };
+    case SCMD_ADDREG:
+    case SCMD_SUBREG:
+    case SCMD_MULREG:
+    case SCMD_BITAND:
+    case SCMD_BITOR:
+    case SCMD_XORREG:
+    case SCMD_ISEQUAL:
+    case SCMD_NOTEQUAL:
+    case SCMD_GREATER:
+    case SCMD_LESSTHAN:
+    case SCMD_GTE:
+    case SCMD_LTE:
+    case SCMD_AND:
+    case SCMD_OR:
+    case SCMD_SHIFTLEFT:
+    case SCMD_SHIFTRIGHT:
+    case SCMD_FMULREG:
+    case SCMD_FADDREG:
+    case SCMD_FSUBREG:
+    case SCMD_FGREATER:
+    case SCMD_FLESSTHAN:
+    case SCMD_FGTE:
+    case SCMD_FLTE:
+        if (!IsReg(r1) || !IsReg(r2)) break;
+        return ScOpInfo{ RegBit(r1) | RegBit(r2), RegBit(r1),
+            (r1 == SREG_SP || r2 == SREG_SP) ? 0 : kOpPure | kOpNoStack };
+    case SCMD_DIVREG:
+    case SCMD_MODREG:
+    case SCMD_FDIVREG:
+    case SCMD_STRINGSEQUAL:
+    case SCMD_STRINGSNOTEQ:
+        // these may raise script errors, so never removed
+        if (!IsReg(r1) || !IsReg(r2)) break;
+        return ScOpInfo{ RegBit(r1) | RegBit(r2), RegBit(r1),
+            (r1 == SREG_SP || r2 == SREG_SP) ? 0 : kOpNoStack };
+    case SCMD_NOTREG:
+        if (!IsReg(r1)) break;
+        return ScOpInfo{ RegBit(r1), RegBit(r1), r1 == SREG_SP ? 0 : kOpPure | kOpNoStack };
+    case SCMD_CHECKBOUNDS:
+    case SCMD_CHECKNULLREG:
+        if (!IsReg(r1)) break;
+        return ScOpInfo{ RegBit(r1), 0, r1 == SREG_SP ? 0 : kOpNoStack };
+    case SCMD_DYNAMICBOUNDS:
+        if (!IsReg(r1)) break;
+        return ScOpInfo{ RegBit(r1) | mar, 0, r1 == SREG_SP ? 0 : kOpNoStack };
+    case SCMD_CHECKNULL:
+        return ScOpInfo{ mar, 0, kOpNoStack };
+    case SCMD_LOADSPOFFS:
+        return ScOpInfo{ sp, mar, 0 };
+    case SCMD_PUSHREG:
+        if (!IsReg(r1)) break;
+        return ScOpInfo{ RegBit(r1) | sp, sp, 0 };
+    case SCMD_POPREG:
+        if (!IsReg(r1)) break;
+        return ScOpInfo{ sp, RegBit(r1) | sp, 0 };
+    case SCMD_JMP:
+        return ScOpInfo{ 0, 0, kOpBlockEnd };
+    case SCMD_JZ:
+    case SCMD_JNZ:
+        return ScOpInfo{ RegBit(SREG_AX), 0, kOpBlockEnd };
+    case SCMD_RET:
+    case SCMD_CALL:
+    case SCMD_CALLEXT:
+    case SCMD_CALLAS:
+        return ScOpInfo{ AllRegs, AllRegs, kOpBlockEnd | kOpBarrier };
+    default:
+        break;
+    }
+    return ScOpInfo{ AllRegs, AllRegs, kOpBarrier };
+}
+
+inline bool IsJump(int32_t code)
+{
+    return code == SCMD_JMP || code == SCMD_JZ || code == SCMD_JNZ;
+}
+
+// Returns index of the first instruction at or after the given one, which was not removed
+size_t FirstKept(const std::vector<ScOp> &ops, size_t index)
+{
+    for (; index < ops.size() && ops[index].Removed; ++index);
+    return index;
+}
+
+inline size_t NextOp(const std::vector<ScOp> &ops, size_t index)
+{
+    return FirstKept(ops, index + 1);
+}
+
+void RemoveOp(std::vector<ScOp> &ops, size_t index)
+{
+    ops[index].Removed = true;
+    // whatever jumped here will now arrive to the next instruction
+    if (ops[index].Label)
+    {
+        const size_t next = NextOp(ops, index);
+        if (next < ops.size())
+            ops[next].Label = true;
+    }
+}
+
+// Calculates the result of an operation on two integer constants,
+// the same way as the script interpreter does
+bool FoldConstants(int32_t code, int32_t a, int32_t b, int32_t &result)
+{
+    const uint32_t ua = static_cast<uint32_t>(a);
+    const uint32_t ub = static_cast<uint32_t>(b);
+    switch (code)
+    {
+    case SCMD_ADDREG: result = static_cast<int32_t>(ua + ub); return true;
+    case SCMD_SUBREG: result = static_cast<int32_t>(ua - ub); return true;
+    case SCMD_MULREG: result = static_cast<int32_t>(ua * ub); return true;
+    case SCMD_DIVREG:
+    case SCMD_MODREG:
+        // leave division errors for the runtime to report
+        if (b == 0 || (a == INT32_MIN && b == -1))
+            return false;
+        result = (code == SCMD_DIVREG) ? a / b : a % b;
+        return true;
+    case SCMD_BITAND: result = a & b; return true;
+    case SCMD_BITOR: result = a | b; return true;
+    case SCMD_XORREG: result = a ^ b; return true;
+    case SCMD_ISEQUAL: result = a == b; return true;
+    case SCMD_NOTEQUAL: result = a != b; return true;
+    case SCMD_GREATER: result = a > b; return true;
+    case SCMD_LESSTHAN: result = a < b; return true;
+    case SCMD_GTE: result = a >= b; return true;
+    case SCMD_LTE: result = a <= b; return true;
+    case SCMD_AND: result = a && b; return true;
+    case SCMD_OR: result = a || b; return true;
+    case SCMD_SHIFTLEFT:
+    case SCMD_SHIFTRIGHT:
+        if (b < 0 || b >= 32)
+            return false;
+        result = (code == SCMD_SHIFTLEFT) ? static_cast<int32_t>(ua << b) : a >> b;
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Tracks known register values within a basic block
+struct RegState
+{
+    struct Value
+    {
+        bool    Known = false; // has a known integer constant
+        int32_t Const = 0;
+        int     Id = 0;        // unique id of unknown value
+    };
+
+    Value Regs[CC_NUM_REGISTERS];
+    int   NextId = 0;
+
+    void Reset()
+    {
+        for (int reg = 0; reg < CC_NUM_REGISTERS; ++reg)
+            SetUnknown(reg);
+    }
+
+    void SetUnknown(int reg)
+    {
+        Regs[reg].Known = false;
+        Regs[reg].Id = ++NextId;
+    }
+
+    void SetConst(int reg, int32_t value)
+    {
+        Regs[reg].Known = true;
+        Regs[reg].Const = value;
+    }
+
+    bool IsKnown(int reg) const { return Regs[reg].Known; }
+    int32_t GetConst(int reg) const { return Regs[reg].Const; }
+
+    bool HasConst(int reg, int32_t value) const
+    {
+        return Regs[reg].Known && Regs[reg].Const == value;
+    }
+
+    bool Same(int reg1, int reg2) const
+    {
+        const Value &v1 = Regs[reg1], &v2 = Regs[reg2];
+        if (v1.Known || v2.Known)
+            return v1.Known && v2.Known && v1.Const == v2.Const;
+        return v1.Id == v2.Id;
+    }
+};
+
+// Folds operations on known constants, and replaces register operands
+// with literals where possible
+bool PropagateConstants(std::vector<ScOp> &ops)
+{
+    bool changed = false;
+    RegState st;
+    st.Reset();
+    for (size_t i = 0; i < ops.size(); ++i)
+    {
+        ScOp &op = ops[i];
+        if (op.Removed)
+            continue;
+        if (op.Label)
+            st.Reset();
+
+        const ScOpInfo info = GetOpInfo(op);
+        // division is not removable, but still may be folded
+        const bool is_division = (op.Code == SCMD_DIVREG || op.Code == SCMD_MODREG) &&
+            (info.Flags & kOpNoStack) != 0;
+        if (((info.Flags & kOpPure) == 0 && !is_division) || op.HasFixups())
+        {
+            for (int reg = 0; reg < CC_NUM_REGISTERS; ++reg)
+            {
+                if (info.Writes & RegBit(reg))
+                    st.SetUnknown(reg);
+            }
+            continue;
+        }
+
+        const int32_t r1 = op.Args[0];
+        const int32_t r2 = op.Args[1];
+        int32_t result;
+        switch (op.Code)
+        {
+        case SCMD_LITTOREG:
+            if (st.HasConst(r1, op.Args[1]))
+            {
+                RemoveOp(ops, i);
+                changed = true;
+            }
+            else
+            {
+                st.SetConst(r1, op.Args[1]);
+            }
+            break;
+        case SCMD_REGTOREG:
+            if (st.Same(r1, r2))
+            {
+                RemoveOp(ops, i);
+                changed = true;
+                break;
+            }
+            if (st.IsKnown(r1))
+            {
+                op.Set(SCMD_LITTOREG, r2, st.GetConst(r1));
+                changed = true;
+            }
+            st.Regs[r2] = st.Regs[r1];
+            break;
+        case SCMD_ADD:
+        case SCMD_MUL:
+            if (st.IsKnown(r1))
+            {
+                FoldConstants(op.Code == SCMD_ADD ? SCMD_ADDREG : SCMD_MULREG, st.GetConst(r1), op.Args[1], result);
+                op.Set(SCMD_LITTOREG, r1, result);
+                st.SetConst(r1, result);
+                changed = true;
+            }
+            else if (op.Args[1] == (op.Code == SCMD_ADD ? 0 : 1))
+            {
+                RemoveOp(ops, i);
+                changed = true;
+            }
+            else
+            {
+                st.SetUnknown(r1);
+            }
+            break;
+        case SCMD_FADD:
+        case SCMD_FSUB:
+            st.SetUnknown(r1);
+            break;
+        case SCMD_NOTREG:
+            if (st.IsKnown(r1))
+            {
+                result = st.GetConst(r1) == 0;
+                op.Set(SCMD_LITTOREG, r1, result);
+                st.SetConst(r1, result);
+                changed = true;
+            }
+            else
+            {
+                st.SetUnknown(r1);
+            }
+            break;
+        default:
+            if (st.IsKnown(r1) && st.IsKnown(r2) &&
+                FoldConstants(op.Code, st.GetConst(r1), st.GetConst(r2), result))
+            {
+                op.Set(SCMD_LITTOREG, r1, result);
+                st.SetConst(r1, result);
+                changed = true;
+                break;
+            }
+            // LITTOREG + ADDREG/SUBREG -> ADD
+            if ((op.Code == SCMD_ADDREG || op.Code == SCMD_SUBREG) && st.IsKnown(r2))
+            {
+                const uint32_t value = static_cast<uint32_t>(st.GetConst(r2));
+                op.Set(SCMD_ADD, r1, static_cast<int32_t>(op.Code == SCMD_ADDREG ? value : 0u - value));
+                changed = true;
+            }
+            st.SetUnknown(r1);
+            break;
+        }
+    }
+    return changed;
+}
+
+// Replaces PUSHREG/POPREG pairs with register moves, if the instructions
+// in between do not use the stack and do not interfere with the registers;
+// local variable addresses in between are corrected for the removed value
+bool ReplacePushPop(std::vector<ScOp> &ops)
+{
+    bool changed = false;
+    for (size_t i = 0; i < ops.size(); ++i)
+    {
+        ScOp &push = ops[i];
+        if (push.Removed || push.Code != SCMD_PUSHREG ||
+            !IsReg(push.Args[0]) || push.Args[0] == SREG_SP)
+            continue;
+
+        int reads = 0, writes = 0;
+        std::vector<size_t> sp_offsets;
+        size_t pop_at = ops.size();
+        int distance = 0;
+        for (size_t j = NextOp(ops, i); j < ops.size() && distance < MaxPushPopDistance;
+             j = NextOp(ops, j), ++distance)
+        {
+            if (ops[j].Label)
+                break;
+            if (ops[j].Code == SCMD_POPREG)
+            {
+                pop_at = j;
+                break;
+            }
+            const ScOpInfo info = GetOpInfo(ops[j]);
+            if (ops[j].Code == SCMD_LOADSPOFFS && !ops[j].HasFixups() &&
+                ops[j].Args[0] > static_cast<int32_t>(sizeof(int32_t)))
+                sp_offsets.push_back(j); // addresses data below the pushed value
+            else if ((info.Flags & kOpNoStack) == 0)
+                break;
+            reads |= info.Reads;
+            writes |= info.Writes;
+        }
+        if (pop_at == ops.size())
+            continue;
+
+        ScOp &pop = ops[pop_at];
+        const int32_t reg_push = push.Args[0];
+        const int32_t reg_pop = pop.Args[0];
+        if (!IsReg(reg_pop) || reg_pop == SREG_SP)
+            continue;
+
+        if ((writes & RegBit(reg_push)) == 0)
+        {
+            // pushed register still has the same value at pop
+            if (reg_push == reg_pop)
+                RemoveOp(ops, pop_at);
+            else
+                pop.Set(SCMD_REGTOREG, reg_push, reg_pop);
+            RemoveOp(ops, i);
+        }
+        else if (((reads | writes) & RegBit(reg_pop)) == 0)
+        {
+            // target register is not used in between, so may be assigned early
+            push.Set(SCMD_REGTOREG, reg_push, reg_pop);
+            RemoveOp(ops, pop_at);
+        }
+        else
+        {
+            continue;
+        }
+        for (size_t at : sp_offsets)
+            ops[at].Args[0] -= sizeof(int32_t);
+        changed = true;
+    }
+    return changed;
+}
+
+// Merges sequential additions of literals to the same register
+bool CollapseAdditions(std::vector<ScOp> &ops)
+{
+    bool changed = false;
+    for (size_t i = 0; i < ops.size(); ++i)
+    {
+        ScOp &op = ops[i];
+        if (op.Removed || op.Code != SCMD_ADD || op.Args[0] == SREG_SP || op.HasFixups())
+            continue;
+        for (size_t next = NextOp(ops, i); next < ops.size(); next = NextOp(ops, i))
+        {
+            const ScOp &add = ops[next];
+            if (add.Label || add.Code != SCMD_ADD || add.Args[0] != op.Args[0] || add.HasFixups())
+                break;
+            op.Args[1] = static_cast<int32_t>(static_cast<uint32_t>(op.Args[1]) + static_cast<uint32_t>(add.Args[1]));
+            RemoveOp(ops, next);
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+// Removes instructions which write registers that are overwritten
+// before being read again
+bool RemoveDeadWrites(std::vector<ScOp> &ops)
+{
+    bool changed = false;
+    int live = AllRegs;
+    for (size_t i = ops.size(); i-- > 0;)
+    {
+        if (ops[i].Removed)
+            continue;
+        const ScOpInfo info = GetOpInfo(ops[i]);
+        if (info.Flags & kOpBlockEnd)
+            live = AllRegs; // we do not track registers across jumps
+        if ((info.Flags & kOpPure) && (info.Writes & live) == 0)
+        {
+            RemoveOp(ops, i);
+            changed = true;
+            continue;
+        }
+        const int overwritten = (info.Flags & kOpBarrier) ? 0 : info.Writes;
+        live = (live & ~overwritten) | info.Reads;
+    }
+    return changed;
+}
+
+// Removes jumps to the next instruction
+bool RemoveRedundantJumps(std::vector<ScOp> &ops)
+{
+    bool changed = false;
+    for (size_t i = 0; i < ops.size(); ++i)
+    {
+        if (ops[i].Removed || !IsJump(ops[i].Code))
+            continue;
+        if (FirstKept(ops, ops[i].Target) == NextOp(ops, i))
+        {
+            RemoveOp(ops, i);
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+// Removes line numbers that are immediately followed by another line number,
+// or all of them if they are not required
+bool RemoveLineNumbers(std::vector<ScOp> &ops, bool keep_linenums)
+{
+    bool changed = false;
+    for (size_t i = 0; i < ops.size(); ++i)
+    {
+        if (ops[i].Removed || ops[i].Code != SCMD_LINENUM)
+            continue;
+        const size_t next = NextOp(ops, i);
+        if (!keep_linenums || (next < ops.size() && ops[next].Code == SCMD_LINENUM))
+        {
+            RemoveOp(ops, i);
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+} // namespace
+
+
+int ccOptimizeScript(ccScript *scrip)
+{
+    const int32_t codesize = scrip->codesize;
+
+    // Decode instructions
+    std::vector<ScOp> ops;
+    std::vector<int> pos_to_op(codesize + 1, -1);
+    for (int32_t pos = 0; pos < codesize;)
+    {
+        ScOp op;
+        op.Code = scrip->code[pos];
+        if (op.Code < 0 || op.Code >= CC_NUM_SCCMDS)
+            return -1;
+        op.ArgCount = ScCmdArgCount[op.Code];
+        if (pos + op.ArgCount >= codesize)
+            return -1;
+        for (int i = 0; i < op.ArgCount; ++i)
+            op.Args[i] = scrip->code[pos + 1 + i];
+        pos_to_op[pos] = static_cast<int>(ops.size());
+        ops.push_back(op);
+        pos += op.ArgCount + 1;
+    }
+    pos_to_op[codesize] = static_cast<int>(ops.size());
+
+    // Resolve the code references
+    std::vector<int32_t> op_pos(ops.size() + 1);
+    for (int32_t pos = 0; pos <= codesize; ++pos)
+    {
+        if (pos_to_op[pos] >= 0)
+            op_pos[pos_to_op[pos]] = pos;
+    }
+    auto op_at = [&](int32_t pos) { return (pos >= 0 && pos <= codesize) ? pos_to_op[pos] : -1; };
+
+    for (size_t i = 0; i < ops.size(); ++i)
+    {
+        ScOp &op = ops[i];
+        if (IsJump(op.Code))
+        {
+            op.Target = op_at(op_pos[i] + 2 + op.Args[0]);
+            if (op.Target < 0)
+                return -1;
+        }
+        else if (op.Code == SCMD_THISBASE)
+        {
+            op.CodeRefs[0] = op_at(op.Args[0]);
+            if (op.CodeRefs[0] < 0)
+                return -1;
+        }
+    }
+
+    std::vector<std::pair<int, int>> fixup_args(scrip->numfixups, std::make_pair(-1, -1));
+    for (int i = 0; i < scrip->numfixups; ++i)
+    {
+        if (scrip->fixuptypes[i] == FIXUP_DATADATA)
+            continue; // this is a fixup in global data
+        // find the instruction which has this argument
+        const int32_t pos = scrip->fixups[i];
+        if (pos < 0 || pos >= codesize || op_at(pos) >= 0)
+            return -1; // not an instruction argument
+        int op_index = -1;
+        for (int32_t at = pos - 1; at >= 0 && op_index < 0; --at)
+            op_index = op_at(at);
+        if (op_index < 0)
+            return -1;
+        ScOp &op = ops[op_index];
+        const int arg = pos - op_pos[op_index] - 1;
+        if (arg >= op.ArgCount)
+            return -1;
+        op.Fixups[arg] = scrip->fixuptypes[i];
+        if (op.Fixups[arg] == FIXUP_FUNCTION)
+        {
+            op.CodeRefs[arg] = op_at(op.Args[arg]);
+            if (op.CodeRefs[arg] < 0)
+                return -1;
+        }
+        fixup_args[i] = std::make_pair(op_index, arg);
+    }
+
+    std::vector<int> export_ops(scrip->numexports, -1);
+    for (int i = 0; i < scrip->numexports; ++i)
+    {
+        if (((scrip->export_addr[i] >> 24) & 0xFF) != EXPORT_FUNCTION)
+            continue;
+        export_ops[i] = op_at(scrip->export_addr[i] & 0x00FFFFFF);
+        if (export_ops[i] < 0)
+            return -1;
+    }
+
+    std::vector<int> section_ops(scrip->numSections, -1);
+    for (int i = 0; i < scrip->numSections; ++i)
+    {
+        section_ops[i] = op_at(scrip->sectionOffsets[i]);
+        if (section_ops[i] < 0)
+            return -1;
+    }
+
+    // Mark instructions that may be entered from anywhere except the previous one
+    auto mark_label = [&](int index) { if (index < static_cast<int>(ops.size())) ops[index].Label = true; };
+    for (size_t i = 0; i < ops.size(); ++i)
+    {
+        const ScOp &op = ops[i];
+        if (op.Target >= 0)
+            mark_label(op.Target);
+        for (int arg = 0; arg < op.ArgCount; ++arg)
+        {
+            if (op.CodeRefs[arg] >= 0)
+                mark_label(op.CodeRefs[arg]);
+        }
+        if (GetOpInfo(op).Flags & kOpBlockEnd)
+            mark_label(static_cast<int>(i) + 1);
+    }
+    for (int index : export_ops)
+    {
+        if (index >= 0)
+            mark_label(index);
+    }
+    for (int index : section_ops)
+        mark_label(index);
+
+    // Optimize
+    const bool keep_linenums = ccGetOption(SCOPT_LINENUMBERS) != 0;
+    for (int pass = 0; pass < MaxOptimizationPasses; ++pass)
+    {
+        bool changed = RemoveLineNumbers(ops, keep_linenums);
+        changed |= PropagateConstants(ops);
+        changed |= ReplacePushPop(ops);
+        changed |= CollapseAdditions(ops);
+        changed |= RemoveDeadWrites(ops);
+        changed |= RemoveRedundantJumps(ops);
+        if (!changed)
+            break;
+    }
+
+    // Calculate new instruction positions; removed instructions are
+    // substituted by the next remaining one
+    std::vector<int32_t> new_pos(ops.size() + 1);
+    int32_t pos = 0;
+    for (size_t i = 0; i < ops.size(); ++i)
+    {
+        new_pos[i] = pos;
+        if (!ops[i].Removed)
+            pos += ops[i].ArgCount + 1;
+    }
+    new_pos[ops.size()] = pos;
+    for (size_t i = ops.size(); i-- > 0;)
+    {
+        if (ops[i].Removed)
+            new_pos[i] = new_pos[i + 1];
+    }
+
+    // Write the code back
+    const int32_t new_codesize = pos;
+    for (size_t i = 0; i < ops.size(); ++i)
+    {
+        const ScOp &op = ops[i];
+        if (op.Removed)
+            continue;
+        int32_t *code = &scrip->code[new_pos[i]];
+        code[0] = op.Code;
+        for (int arg = 0; arg < op.ArgCount; ++arg)
+        {
+            if (op.CodeRefs[arg] >= 0)
+                code[1 + arg] = new_pos[op.CodeRefs[arg]];
+            else
+                code[1 + arg] = op.Args[arg];
+        }
+        if (op.Target >= 0)
+            code[1] = new_pos[op.Target] - (new_pos[i] + 2);
+    }
+    scrip->codesize = new_codesize;
+
+    int num_fixups = 0;
+    for (int i = 0; i < scrip->numfixups; ++i)
+    {
+        const int op_index = fixup_args[i].first;
+        const int arg = fixup_args[i].second;
+        if (op_index >= 0)
+        {
+            if (ops[op_index].Removed || ops[op_index].Fixups[arg] == 0)
+                continue;
+            scrip->fixups[num_fixups] = new_pos[op_index] + 1 + arg;
+        }
+        else
+        {
+            scrip->fixups[num_fixups] = scrip->fixups[i];
+        }
+        scrip->fixuptypes[num_fixups] = scrip->fixuptypes[i];
+        num_fixups++;
+    }
+    scrip->numfixups = num_fixups;
+
+    for (int i = 0; i < scrip->numexports; ++i)
+    {
+        if (export_ops[i] >= 0)
+            scrip->export_addr[i] = new_pos[export_ops[i]] | (EXPORT_FUNCTION << 24);
+    }
+    for (int i = 0; i < scrip->numSections; ++i)
+        scrip->sectionOffsets[i] = new_pos[section_ops[i]];
+
+    return codesize - new_codesize;
+}
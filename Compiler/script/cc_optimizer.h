@@ -0,0 +1,36 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Bytecode optimizer, run over the compiled script as a post-pass.
+//
+// Performs constant folding and propagation within basic blocks, replaces
+// PUSHREG/POPREG pairs with register moves where the stack is not touched
+// in between, collapses literal additions, removes dead register writes,
+// redundant jumps and line number instructions. Jump offsets, code fixups,
+// function addresses, exports and sections are remapped accordingly, so the
+// result remains compatible with the existing script interpreter.
+//
+//=============================================================================
+#ifndef __CC_OPTIMIZER_H
+#define __CC_OPTIMIZER_H
+
+#include "script/cc_script.h"  // ccScript
+
+// Optimizes the bytecode of the compiled script in place.
+// If SCOPT_LINENUMBERS option is off, also strips all the line numbers.
+// Returns the number of code words removed, or -1 if the bytecode could not
+// be analyzed, in which case the script is left unchanged.
+extern int ccOptimizeScript(ccScript *scrip);
+
+#endif // __CC_OPTIMIZER_H
@@ -15,6 +15,51 @@ symbolTable::symbolTable() {
     stringStructSym = 0;
 }
 
+symbolTable::symbolTable(const symbolTable &other)
+    : normalIntSym(other.normalIntSym)
+    , normalStringSym(other.normalStringSym)
+    , normalFloatSym(other.normalFloatSym)
+    , normalVoidSym(other.normalVoidSym)
+    , nullSym(other.nullSym)
+    , stringStructSym(other.stringStructSym)
+    , entries(other.entries)
+    , symbolTree(other.symbolTree) {
+    update_tree_names();
+}
+
+symbolTable::~symbolTable() {
+    clear_name_cache();
+}
+
+symbolTable &symbolTable::operator=(const symbolTable &other) {
+    if (this == &other)
+        return *this;
+    clear_name_cache();
+    normalIntSym = other.normalIntSym;
+    normalStringSym = other.normalStringSym;
+    normalFloatSym = other.normalFloatSym;
+    normalVoidSym = other.normalVoidSym;
+    nullSym = other.nullSym;
+    stringStructSym = other.stringStructSym;
+    entries = other.entries;
+    symbolTree = other.symbolTree;
+    update_tree_names();
+    return *this;
+}
+
+void symbolTable::clear_name_cache() {
+	for (std::map<int, char*>::iterator it = nameGenCache.begin(); it != nameGenCache.end(); ++it) {
+		free(it->second);
+	}
+	nameGenCache.clear();
+}
+
+void symbolTable::update_tree_names() {
+    symbolTreeNames.resize(entries.size());
+    for (size_t i = 0; i < entries.size(); ++i)
+        symbolTreeNames[i] = symbolTree.findKey(entries[i].sname.c_str());
+}
+
 int SymbolTableEntry::get_num_args() {
 	// TODO: assert is func?
     return sscope % 100;
@@ -51,15 +96,13 @@ int SymbolTableEntry::get_propset() {
 }
 
 void symbolTable::reset() {
-	for (std::map<int, char*>::iterator it = nameGenCache.begin(); it != nameGenCache.end(); ++it) {
-		free(it->second);
-	}
-	nameGenCache.clear();
+	clear_name_cache();
 
 	entries.clear();
 
     stringStructSym = 0;
     symbolTree.clear();
+    symbolTreeNames.clear();
 
     add_ex("___dummy__sym0",999,0);
     normalIntSym = add_ex("int",SYM_VARTYPE,4);
@@ -194,13 +237,19 @@ std::string symbolTable::get_name_string(int idx) {
 }
 
 const char *symbolTable::get_name(int idx) {
-	if (nameGenCache.count(idx) > 0) {
-		return nameGenCache[idx];
-	}
-
 	int actualIdx = idx & STYPE_MASK;
 	if (actualIdx < 0 || (size_t)actualIdx >= entries.size()) { return NULL; }
 
+	// plain symbol names are interned by the symbol tree
+	if ((idx == actualIdx) && symbolTreeNames[idx]) {
+		return symbolTreeNames[idx];
+	}
+
+	std::map<int, char*>::const_iterator cached = nameGenCache.find(idx);
+	if (cached != nameGenCache.end()) {
+		return cached->second;
+	}
+
 	std::string resultString = get_name_string(idx);
 	char *result = (char *)malloc(resultString.length() + 1);
 	strcpy(result, resultString.c_str());
@@ -233,7 +282,7 @@ int symbolTable::add_ex(const char*nta,int typo,char sizee) {
 	entry.funcParamHasDefaultValues = std::vector<bool>(MAX_FUNCTION_PARAMETERS + 1);
 	entries.push_back(entry);
 
-    symbolTree.addEntry(nta, p_value);
+    symbolTreeNames.push_back(symbolTree.addEntry(nta, p_value));
     return p_value;
 }
 int symbolTable::add_operator(const char *nta, int priority, int vcpucmd) {
@@ -244,4 +293,4 @@ int symbolTable::add_operator(const char *nta, int priority, int vcpucmd) {
     return nss;
 }
 
-symbolTable sym;
+thread_local symbolTable sym;
@@ -51,6 +51,10 @@ struct symbolTable {
 	std::vector<SymbolTableEntry> entries;
 
     symbolTable();
+    // copies the symbols; generated names are not shared with the copy
+    symbolTable(const symbolTable &other);
+    ~symbolTable();
+    symbolTable &operator=(const symbolTable &other);
     void reset();    // clears table
     int  find(const char*);  // returns ID of symbol, or -1
     int  add_ex(const char*,int,char);  // adds new symbol of type and size
@@ -68,13 +72,17 @@ private:
     std::map<int, char *> nameGenCache;
 
     ccTreeMap symbolTree;
-    std::vector<char *> symbolTreeNames;
+    // interned symbol names, stored in the symbolTree, for each entry
+    std::vector<const char *> symbolTreeNames;
 
+    void clear_name_cache();
+    void update_tree_names();
     int  add_operator(const char*, int priority, int vcpucmd); // adds new operator
     std::string get_name_string(int idx);
 };
 
 
-extern symbolTable sym;
+// Symbol table of the script being compiled; each thread has its own
+extern thread_local symbolTable sym;
 
 #endif //__CC_SYMBOLTABLE_H
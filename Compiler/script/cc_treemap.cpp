@@ -12,27 +12,143 @@
 //
 //=============================================================================
 
+#include <algorithm>
 #include <cstring>
 #include "cc_treemap.h"
 
-int ccTreeMap::findValue(const char *key) {
-	if (!key || strlen(key) <= 0) { return -1; }
-    std::string cppkey(key);
-    if (this->storage.count(cppkey) <= 0) { return -1; }
-    return this->storage[cppkey];
+namespace {
+// Initial number of slots; must be a power of 2
+const size_t InitialCapacity = 256;
+// Size of a memory block for the interned keys
+const size_t KeyBlockSize = 16 * 1024;
 }
 
-void ccTreeMap::addEntry(const char* ntx, int p_value) {
-    // don't add if it's an empty string or if it's already here
-    if (!ntx || strlen(ntx) <= 0) { return; }
-
-    this->storage[std::string(ntx)] = p_value;
+ccTreeMap::ccTreeMap()
+    : count(0)
+    , block_pos(NULL)
+    , block_free(0) {
 }
 
-void ccTreeMap::clear() {
-    this->storage.clear();
+ccTreeMap::ccTreeMap(const ccTreeMap &other)
+    : count(0)
+    , block_pos(NULL)
+    , block_free(0) {
+    *this = other;
 }
 
 ccTreeMap::~ccTreeMap() {
-    this->storage.clear();
-}
\ No newline at end of file
+    clear();
+}
+
+ccTreeMap &ccTreeMap::operator=(const ccTreeMap &other) {
+    if (this == &other)
+        return *this;
+    clear();
+    // keys are interned anew, as they must not point to the other's storage
+    if (other.count > 0)
+        rehash(other.slots.size());
+    for (const auto &slot : other.slots) {
+        if (slot.key)
+            addEntry(slot.key, slot.keylen, slot.value);
+    }
+    return *this;
+}
+
+uint32_t ccTreeMap::hash_key(const char *key, size_t len) {
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; ++i) {
+        hash ^= static_cast<uint8_t>(key[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+const ccTreeMap::Slot &ccTreeMap::find_slot(const char *key, size_t len, uint32_t hash) const {
+    const size_t mask = slots.size() - 1;
+    for (size_t i = hash & mask; ; i = (i + 1) & mask) {
+        const Slot &slot = slots[i];
+        if (!slot.key ||
+            (slot.hash == hash && slot.keylen == len && memcmp(slot.key, key, len) == 0))
+            return slot;
+    }
+}
+
+int ccTreeMap::findValue(const char *key) const {
+    if (!key) { return -1; }
+    return findValue(key, strlen(key));
+}
+
+int ccTreeMap::findValue(const char *key, size_t len) const {
+    if (!key || len == 0 || count == 0) { return -1; }
+    const Slot &slot = find_slot(key, len, hash_key(key, len));
+    return slot.key ? slot.value : -1;
+}
+
+const char *ccTreeMap::findKey(const char *key) const {
+    if (!key || count == 0) { return NULL; }
+    const size_t len = strlen(key);
+    if (len == 0) { return NULL; }
+    return find_slot(key, len, hash_key(key, len)).key;
+}
+
+const char *ccTreeMap::addEntry(const char *ntx, int p_value) {
+    if (!ntx) { return NULL; }
+    return addEntry(ntx, strlen(ntx), p_value);
+}
+
+const char *ccTreeMap::addEntry(const char *ntx, size_t len, int p_value) {
+    // don't add if it's an empty string, only update value if it's already here
+    if (!ntx || len == 0) { return NULL; }
+
+    // keep the table at most half full, for short probe sequences
+    if ((count + 1) * 2 > slots.size())
+        rehash(slots.empty() ? InitialCapacity : slots.size() * 2);
+
+    const uint32_t hash = hash_key(ntx, len);
+    Slot &slot = const_cast<Slot&>(find_slot(ntx, len, hash));
+    if (!slot.key) {
+        slot.key = intern(ntx, len);
+        slot.keylen = static_cast<uint32_t>(len);
+        slot.hash = hash;
+        count++;
+    }
+    slot.value = p_value;
+    return slot.key;
+}
+
+const char *ccTreeMap::intern(const char *key, size_t len) {
+    if (len + 1 > block_free) {
+        const size_t block_size = std::max(KeyBlockSize, len + 1);
+        blocks.emplace_back(new char[block_size]);
+        block_pos = blocks.back().get();
+        block_free = block_size;
+    }
+    char *interned = block_pos;
+    memcpy(interned, key, len);
+    interned[len] = 0;
+    block_pos += len + 1;
+    block_free -= len + 1;
+    return interned;
+}
+
+void ccTreeMap::rehash(size_t capacity) {
+    std::vector<Slot> old_slots(capacity, Slot());
+    old_slots.swap(slots);
+    const size_t mask = slots.size() - 1;
+    for (const auto &old : old_slots) {
+        if (!old.key) continue;
+        size_t i = old.hash & mask;
+        while (slots[i].key)
+            i = (i + 1) & mask;
+        slots[i] = old;
+    }
+}
+
+void ccTreeMap::clear() {
+    slots.clear();
+    count = 0;
+    blocks.clear();
+    block_pos = NULL;
+    block_free = 0;
+}
@@ -19,18 +19,51 @@
 #ifndef __CC_TREEMAP_H
 #define __CC_TREEMAP_H
 
-#include <map>
-#include <string>
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
 
-// Mimics original interface but uses a std::map for storage
+// Mimics original interface, but interns the keys and looks them up in
+// a hash table with open addressing. Each distinct key is stored once,
+// in memory blocks which are never relocated, so the interned keys
+// returned by addEntry and findKey remain valid until clear().
 struct ccTreeMap {
-    int findValue(const char *key);
-    void addEntry(const char *ntx, int p_value);
-    void clear();
+    ccTreeMap();
+    ccTreeMap(const ccTreeMap &other);
     ~ccTreeMap();
+    ccTreeMap &operator=(const ccTreeMap &other);
+
+    int findValue(const char *key) const;
+    int findValue(const char *key, size_t len) const;
+    // returns the interned key, or NULL if the key was not added
+    const char *findKey(const char *key) const;
+    // adds new key or updates existing one; returns the interned key,
+    // or NULL if the key is empty and was not added
+    const char *addEntry(const char *ntx, int p_value);
+    const char *addEntry(const char *ntx, size_t len, int p_value);
+    size_t size() const { return count; }
+    void clear();
 
 private:
-    std::map<std::string, int> storage;
+    struct Slot {
+        const char *key; // interned key, NULL if slot is free
+        uint32_t keylen;
+        uint32_t hash;
+        int value;
+    };
+
+    static uint32_t hash_key(const char *key, size_t len);
+    // returns the slot holding the key, or the free slot to put it in
+    const Slot &find_slot(const char *key, size_t len, uint32_t hash) const;
+    const char *intern(const char *key, size_t len);
+    void rehash(size_t capacity);
+
+    std::vector<Slot> slots; // capacity is always a power of 2
+    size_t count;
+    std::vector<std::unique_ptr<char[]>> blocks; // interned key storage
+    char *block_pos; // free space in the last block
+    size_t block_free;
 };
 
 #endif // __CC_TREEMAP_H
\ No newline at end of file
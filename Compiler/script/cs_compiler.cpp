@@ -11,7 +11,7 @@
 #include "script/cs_parser.h"
 
 const char *ccSoftwareVersion = "1.0";
-const char *ccCurScriptName = "";
+thread_local const char *ccCurScriptName = "";
 
 std::vector<const char*> defaultheaders;
 std::vector<const char*> defaultHeaderNames;
@@ -34,17 +34,11 @@ void ccSetSoftwareVersion(const char *versionNumber) {
     ccSoftwareVersion = versionNumber;
 }
 
-ccScript* ccCompileText(const char *texo, const char *scriptName) {
-    ccCompiledScript *cctemp = new ccCompiledScript();
-    cctemp->init();
-
-    sym.reset();
-
-    if (scriptName == NULL)
-        scriptName = "Main script";
-
-    cc_clear_error();
+ccHeaderSnapshot::ccHeaderSnapshot() = default;
+ccHeaderSnapshot::~ccHeaderSnapshot() = default;
 
+// Compiles the default headers into the script, using the current symbol table
+static bool compile_default_headers(ccCompiledScript *cctemp) {
     for (size_t t=0;t<defaultheaders.size();t++) {
         if (defaultHeaderNames[t])
             ccCurScriptName = defaultHeaderNames[t];
@@ -53,8 +47,16 @@ ccScript* ccCompileText(const char *texo, const char *scriptName) {
 
         cctemp->start_new_section(ccCurScriptName);
         cc_compile(defaultheaders[t],cctemp);
-        if (cc_has_error()) break;
+        if (cc_has_error()) return false;
     }
+    return true;
+}
+
+// Compiles the main script, following the already compiled headers,
+// and finalizes the compiled script; deletes it on failure
+static ccScript *compile_main_script(const char *texo, const char *scriptName, ccCompiledScript *cctemp) {
+    if (scriptName == NULL)
+        scriptName = "Main script";
 
     if (!cc_has_error()) {
         ccCurScriptName = scriptName;
@@ -114,3 +116,43 @@ ccScript* ccCompileText(const char *texo, const char *scriptName) {
     cctemp->free_extra();
     return cctemp;
 }
+
+ccScript* ccCompileText(const char *texo, const char *scriptName) {
+    ccCompiledScript *cctemp = new ccCompiledScript();
+    cctemp->init();
+
+    sym.reset();
+
+    cc_clear_error();
+
+    compile_default_headers(cctemp);
+    return compile_main_script(texo, scriptName, cctemp);
+}
+
+std::unique_ptr<ccHeaderSnapshot> ccCompileDefaultHeaders() {
+    std::unique_ptr<ccCompiledScript> cctemp(new ccCompiledScript());
+    cctemp->init();
+
+    sym.reset();
+
+    cc_clear_error();
+
+    if (!compile_default_headers(cctemp.get()))
+        return nullptr;
+
+    std::unique_ptr<ccHeaderSnapshot> headers(new ccHeaderSnapshot());
+    headers->Sym.reset(new symbolTable(sym));
+    headers->Script = std::move(cctemp);
+    return headers;
+}
+
+ccScript *ccCompileTextWithHeaders(const char *texo, const char *scriptName,
+        const ccHeaderSnapshot &headers) {
+    ccCompiledScript *cctemp = new ccCompiledScript(*headers.Script);
+
+    sym = *headers.Sym;
+
+    cc_clear_error();
+
+    return compile_main_script(texo, scriptName, cctemp);
+}
@@ -13,8 +13,23 @@
 #ifndef __CS_COMPILER_H
 #define __CS_COMPILER_H
 
+#include <memory>
 #include "script/cc_script.h"  // ccScript
 
+struct ccCompiledScript;
+struct symbolTable;
+
+// Compiler state after compiling the default headers. It is not modified
+// when compiling scripts, so may be shared by any number of compilations,
+// including ones running in parallel on different threads.
+struct ccHeaderSnapshot {
+    std::unique_ptr<symbolTable> Sym;
+    std::unique_ptr<ccCompiledScript> Script;
+
+    ccHeaderSnapshot();
+    ~ccHeaderSnapshot();
+};
+
 // ********* SCRIPT COMPILATION FUNCTIONS **************
 // add a script that will be compiled as a header into every compilation
 // 'name' is the name of the header, used in error reports
@@ -33,6 +48,13 @@ extern void ccSetSoftwareVersion(const char *version);
 
 // compile the script supplied, returns NULL on failure
 extern ccScript *ccCompileText(const char *script, const char *scriptName);
+// compile the default headers once, returns NULL on failure
+extern std::unique_ptr<ccHeaderSnapshot> ccCompileDefaultHeaders();
+// compile the script supplied on top of the precompiled headers,
+// returns NULL on failure; the compile options must not change while
+// the compilations are running on other threads
+extern ccScript *ccCompileTextWithHeaders(const char *script, const char *scriptName,
+    const ccHeaderSnapshot &headers);
 
 extern const char *ccSoftwareVersion;
 
@@ -2,7 +2,7 @@
 #include "script/cc_internallist.h"
 
 // defined in script_common, modified by getnext
-extern int currentline; 
+extern thread_local int currentline; 
 
 
 TEST(InternalList, Constructor) {
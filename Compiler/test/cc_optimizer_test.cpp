@@ -0,0 +1,492 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+#include <algorithm>
+#include <memory>
+#include <string.h>
+#include <vector>
+#include "gtest/gtest.h"
+#include "test/cc_test_helper.h"
+#include "script/cc_common.h"
+#include "script/cc_internal.h"
+#include "script/cc_optimizer.h"
+#include "script/cs_compiler.h"
+
+namespace
+{
+
+const int ArgCount[CC_NUM_SCCMDS] = {
+    0, 2, 2, 2, 2, 0, 2, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 2, 1, 1, 1, 1, 1, 1, 1,
+    2, 2, 1, 2, 2, 1, 2, 1, 1, 0, 1, 1, 0, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 1, 1, 2, 2, 1, 0, 0, 1, 1, 3, 2 };
+
+// Splits the bytecode into instructions, returns their positions
+std::vector<int32_t> DecodeOps(const ccScript *scrip)
+{
+    std::vector<int32_t> ops;
+    for (int32_t pos = 0; pos < scrip->codesize; pos += 1 + ArgCount[scrip->code[pos]])
+        ops.push_back(pos);
+    return ops;
+}
+
+bool HasOp(const ccScript *scrip, int32_t code)
+{
+    for (int32_t pos : DecodeOps(scrip))
+    {
+        if (scrip->code[pos] == code)
+            return true;
+    }
+    return false;
+}
+
+// A minimal interpreter, which supports a subset of bytecode sufficient
+// for running scripts working with integer variables.
+// Global data is placed at the beginning of the memory, stack follows it.
+class TestVM
+{
+public:
+    explicit TestVM(const ccScript *scrip)
+        : _scrip(scrip)
+    {
+        _mem.resize(scrip->globaldatasize + StackSize);
+        if (scrip->globaldatasize > 0)
+            memcpy(&_mem[0], scrip->globaldata, scrip->globaldatasize);
+    }
+
+    // Runs exported function without parameters
+    bool Call(const char *func_name, int32_t &result)
+    {
+        const std::string export_name = std::string(func_name) + "$0";
+        for (int i = 0; i < _scrip->numexports; ++i)
+        {
+            if (export_name == _scrip->exports[i])
+                return Run(_scrip->export_addr[i] & 0x00FFFFFF, result);
+        }
+        return false;
+    }
+
+private:
+    static const int32_t StackSize = 0x4000;
+    static const int MaxSteps = 1000000;
+
+    bool Read(int32_t addr, int size, int32_t &value) const
+    {
+        if (addr < 0 || addr + size > static_cast<int32_t>(_mem.size()))
+            return false;
+        switch (size)
+        {
+        case 1: value = _mem[addr]; break;
+        case 2: { int16_t v; memcpy(&v, &_mem[addr], 2); value = v; break; }
+        default: memcpy(&value, &_mem[addr], 4); break;
+        }
+        return true;
+    }
+
+    bool Write(int32_t addr, int size, int32_t value)
+    {
+        if (addr < 0 || addr + size > static_cast<int32_t>(_mem.size()))
+            return false;
+        switch (size)
+        {
+        case 1: _mem[addr] = static_cast<uint8_t>(value); break;
+        case 2: { int16_t v = static_cast<int16_t>(value); memcpy(&_mem[addr], &v, 2); break; }
+        default: memcpy(&_mem[addr], &value, 4); break;
+        }
+        return true;
+    }
+
+    bool Run(int32_t pc, int32_t &result)
+    {
+        for (int i = 0; i < _scrip->numfixups; ++i)
+        {
+            // only global data and function addresses are supported
+            if (_scrip->fixuptypes[i] != FIXUP_GLOBALDATA && _scrip->fixuptypes[i] != FIXUP_FUNCTION)
+                return false;
+        }
+
+        int32_t reg[CC_NUM_REGISTERS] = {};
+        int32_t &sp = reg[SREG_SP];
+        sp = _scrip->globaldatasize;
+        if (!Write(sp, 4, 0)) // return address
+            return false;
+        sp += 4;
+
+        const int32_t *code = _scrip->code;
+        for (int step = 0; step < MaxSteps; ++step)
+        {
+            if (pc < 0 || pc >= _scrip->codesize)
+                return false;
+            const int32_t cmd = code[pc];
+            if (cmd <= 0 || cmd >= CC_NUM_SCCMDS || pc + ArgCount[cmd] >= _scrip->codesize)
+                return false;
+            const int32_t arg1 = ArgCount[cmd] > 0 ? code[pc + 1] : 0;
+            const int32_t arg2 = ArgCount[cmd] > 1 ? code[pc + 2] : 0;
+            int32_t &r1 = reg[(arg1 > 0 && arg1 < CC_NUM_REGISTERS) ? arg1 : 0];
+            int32_t &r2 = reg[(arg2 > 0 && arg2 < CC_NUM_REGISTERS) ? arg2 : 0];
+            const uint32_t u1 = static_cast<uint32_t>(r1), u2 = static_cast<uint32_t>(r2);
+            int32_t value = 0;
+            bool ok = true;
+            int32_t next_pc = pc + 1 + ArgCount[cmd];
+            switch (cmd)
+            {
+            case SCMD_ADD: r1 = static_cast<int32_t>(u1 + static_cast<uint32_t>(arg2)); break;
+            case SCMD_SUB: r1 = static_cast<int32_t>(u1 - static_cast<uint32_t>(arg2)); break;
+            case SCMD_MUL: r1 = static_cast<int32_t>(u1 * static_cast<uint32_t>(arg2)); break;
+            case SCMD_REGTOREG: r2 = r1; break;
+            case SCMD_LITTOREG: r1 = arg2; break;
+            case SCMD_WRITELIT: ok = Write(reg[SREG_MAR], arg1, arg2); break;
+            case SCMD_MEMREAD: ok = Read(reg[SREG_MAR], 4, r1); break;
+            case SCMD_MEMREADW: ok = Read(reg[SREG_MAR], 2, r1); break;
+            case SCMD_MEMREADB: ok = Read(reg[SREG_MAR], 1, r1); break;
+            case SCMD_MEMWRITE: ok = Write(reg[SREG_MAR], 4, r1); break;
+            case SCMD_MEMWRITEW: ok = Write(reg[SREG_MAR], 2, r1); break;
+            case SCMD_MEMWRITEB: ok = Write(reg[SREG_MAR], 1, r1); break;
+            case SCMD_ZEROMEMORY:
+                for (int32_t i = 0; i < arg1 && ok; ++i)
+                    ok = Write(reg[SREG_MAR] + i, 1, 0);
+                break;
+            case SCMD_LOADSPOFFS: reg[SREG_MAR] = sp - arg1; break;
+            case SCMD_MULREG: r1 = static_cast<int32_t>(u1 * u2); break;
+            case SCMD_DIVREG: ok = r2 != 0; if (ok) r1 = r1 / r2; break;
+            case SCMD_MODREG: ok = r2 != 0; if (ok) r1 = r1 % r2; break;
+            case SCMD_ADDREG: r1 = static_cast<int32_t>(u1 + u2); break;
+            case SCMD_SUBREG: r1 = static_cast<int32_t>(u1 - u2); break;
+            case SCMD_BITAND: r1 = r1 & r2; break;
+            case SCMD_BITOR: r1 = r1 | r2; break;
+            case SCMD_XORREG: r1 = r1 ^ r2; break;
+            case SCMD_ISEQUAL: r1 = r1 == r2; break;
+            case SCMD_NOTEQUAL: r1 = r1 != r2; break;
+            case SCMD_GREATER: r1 = r1 > r2; break;
+            case SCMD_LESSTHAN: r1 = r1 < r2; break;
+            case SCMD_GTE: r1 = r1 >= r2; break;
+            case SCMD_LTE: r1 = r1 <= r2; break;
+            case SCMD_AND: r1 = r1 && r2; break;
+            case SCMD_OR: r1 = r1 || r2; break;
+            case SCMD_NOTREG: r1 = !r1; break;
+            case SCMD_SHIFTLEFT: r1 = static_cast<int32_t>(u1 << (r2 & 31)); break;
+            case SCMD_SHIFTRIGHT: r1 = r1 >> (r2 & 31); break;
+            case SCMD_CHECKBOUNDS: ok = r1 >= 0 && r1 < arg2; break;
+            case SCMD_CHECKNULL: ok = reg[SREG_MAR] != 0; break;
+            case SCMD_PUSHREG: ok = Write(sp, 4, r1); sp += 4; break;
+            case SCMD_POPREG: sp -= 4; ok = Read(sp, 4, value); r1 = value; break;
+            case SCMD_JMP: next_pc += arg1; break;
+            case SCMD_JZ: if (reg[SREG_AX] == 0) next_pc += arg1; break;
+            case SCMD_JNZ: if (reg[SREG_AX] != 0) next_pc += arg1; break;
+            case SCMD_CALL: ok = Write(sp, 4, next_pc); sp += 4; next_pc = r1; break;
+            case SCMD_RET:
+                sp -= 4;
+                ok = Read(sp, 4, next_pc);
+                if (ok && next_pc == 0)
+                {
+                    result = reg[SREG_AX];
+                    return true;
+                }
+                break;
+            case SCMD_LINENUM:
+            case SCMD_THISBASE:
+            case SCMD_LOOPCHECKOFF:
+            case SCMD_NUMFUNCARGS:
+                break;
+            default:
+                return false; // not supported
+            }
+            if (!ok)
+                return false;
+            pc = next_pc;
+        }
+        return false;
+    }
+
+    const ccScript *_scrip;
+    std::vector<uint8_t> _mem;
+};
+
+// Compiles the script with all functions exported, returns NULL on failure
+ccScript *CompileTestScript(const char *text)
+{
+    const int old_exportall = ccGetOption(SCOPT_EXPORTALL);
+    const int old_linenums = ccGetOption(SCOPT_LINENUMBERS);
+    ccSetOption(SCOPT_EXPORTALL, 1);
+    ccSetOption(SCOPT_LINENUMBERS, 1);
+    clear_error();
+    ccScript *scrip = ccCompileText(text, "Test");
+    ccSetOption(SCOPT_EXPORTALL, old_exportall);
+    ccSetOption(SCOPT_LINENUMBERS, old_linenums);
+    return scrip;
+}
+
+// Runs optimizer with the given line numbers option
+int OptimizeTestScript(ccScript *scrip, bool linenums = true)
+{
+    const int old_linenums = ccGetOption(SCOPT_LINENUMBERS);
+    ccSetOption(SCOPT_LINENUMBERS, linenums);
+    const int removed = ccOptimizeScript(scrip);
+    ccSetOption(SCOPT_LINENUMBERS, old_linenums);
+    return removed;
+}
+
+// Compiles the script, optimizes it, then runs every listed function
+// in both versions and compares the results
+void TestSameResults(const char *text, const std::vector<const char*> &funcs, bool linenums = true)
+{
+    std::unique_ptr<ccScript> scrip(CompileTestScript(text));
+    ASSERT_NE(nullptr, scrip.get()) << last_seen_cc_error();
+    std::unique_ptr<ccScript> opt_scrip(new ccScript(*scrip));
+
+    const int removed = OptimizeTestScript(opt_scrip.get(), linenums);
+    ASSERT_GT(removed, 0);
+    ASSERT_EQ(scrip->codesize - removed, opt_scrip->codesize);
+
+    for (const char *func : funcs)
+    {
+        int32_t result = 0, opt_result = 0;
+        ASSERT_TRUE(TestVM(scrip.get()).Call(func, result)) << func;
+        ASSERT_TRUE(TestVM(opt_scrip.get()).Call(func, opt_result)) << func;
+        EXPECT_EQ(result, opt_result) << func;
+    }
+}
+
+} // namespace
+
+
+TEST(Optimizer, FoldsConstants) {
+    const char *inpl = ""
+        "int Func()\n"
+        "{\n"
+        "  return (2 * 3 + 4) << 2;\n"
+        "}\n";
+
+    std::unique_ptr<ccScript> scrip(CompileTestScript(inpl));
+    ASSERT_NE(nullptr, scrip.get()) << last_seen_cc_error();
+    ASSERT_TRUE(HasOp(scrip.get(), SCMD_MULREG));
+    ASSERT_GT(OptimizeTestScript(scrip.get()), 0);
+    EXPECT_FALSE(HasOp(scrip.get(), SCMD_MULREG));
+    EXPECT_FALSE(HasOp(scrip.get(), SCMD_ADDREG));
+    EXPECT_FALSE(HasOp(scrip.get(), SCMD_SHIFTLEFT));
+    EXPECT_FALSE(HasOp(scrip.get(), SCMD_PUSHREG));
+    EXPECT_FALSE(HasOp(scrip.get(), SCMD_POPREG));
+
+    int32_t result = 0;
+    ASSERT_TRUE(TestVM(scrip.get()).Call("Func", result));
+    EXPECT_EQ(40, result);
+}
+
+TEST(Optimizer, CollapsesAdditions) {
+    const char *inpl = ""
+        "int a = 5;\n"
+        "int Func()\n"
+        "{\n"
+        "  return a + 1 + 2 - 4;\n"
+        "}\n";
+
+    std::unique_ptr<ccScript> scrip(CompileTestScript(inpl));
+    ASSERT_NE(nullptr, scrip.get()) << last_seen_cc_error();
+    ASSERT_GT(OptimizeTestScript(scrip.get()), 0);
+    EXPECT_FALSE(HasOp(scrip.get(), SCMD_ADDREG));
+    EXPECT_FALSE(HasOp(scrip.get(), SCMD_SUBREG));
+    EXPECT_FALSE(HasOp(scrip.get(), SCMD_PUSHREG));
+    int num_adds = 0;
+    for (int32_t pos : DecodeOps(scrip.get()))
+    {
+        if (scrip->code[pos] == SCMD_ADD && scrip->code[pos + 1] != SREG_SP)
+        {
+            num_adds++;
+            EXPECT_EQ(-1, scrip->code[pos + 2]);
+        }
+    }
+    EXPECT_EQ(1, num_adds);
+
+    int32_t result = 0;
+    ASSERT_TRUE(TestVM(scrip.get()).Call("Func", result));
+    EXPECT_EQ(4, result);
+}
+
+TEST(Optimizer, PreservesSemantics) {
+    const char *inpl = ""
+        "int glob = 7;\n"
+        "int arr[10];\n"
+        "short sh = -3;\n"
+        "char ch = 200;\n"
+        "\n"
+        "int Add(int a, int b)\n"
+        "{\n"
+        "  return a + b * 2 - 1;\n"
+        "}\n"
+        "\n"
+        "int Arithmetic()\n"
+        "{\n"
+        "  int a = glob + 1;\n"
+        "  int b = a * 2 + 3 * 4 - (10 / 3) % 2;\n"
+        "  int c = (a << 3) >> 1 | 5 & 6 ^ 9;\n"
+        "  int d = -a + -(-b) - (1 - 2 - 3);\n"
+        "  a -= 1; b += a; c *= 2; d /= 3;\n"
+        "  return a + b * 10 + c * 100 + d * 1000 + sh + ch;\n"
+        "}\n"
+        "\n"
+        "int Logic()\n"
+        "{\n"
+        "  int res = 0;\n"
+        "  int x = glob;\n"
+        "  if (x > 5 && x < 10) res += 1;\n"
+        "  if (x == 7 || Add(x, 1) == 0) res += 2;\n"
+        "  if (!(x != 7)) res += 4;\n"
+        "  if (x >= 8 || x <= 6) res += 8; else res += 16;\n"
+        "  if (1 + 1 == 2) res += 32;\n"
+        "  if (0 && x) res += 64;\n"
+        "  return res;\n"
+        "}\n"
+        "\n"
+        "int Loops()\n"
+        "{\n"
+        "  int sum = 0;\n"
+        "  for (int i = 0; i < 10; i++)\n"
+        "  {\n"
+        "    arr[i] = i * i + 1;\n"
+        "  }\n"
+        "  int j = 0;\n"
+        "  while (j < 10)\n"
+        "  {\n"
+        "    if (j % 3 == 0) { j++; continue; }\n"
+        "    sum += arr[j] * (j + 1);\n"
+        "    if (sum > 1000) break;\n"
+        "    j++;\n"
+        "  }\n"
+        "  do { sum -= 7; } while (sum > 500);\n"
+        "  return sum;\n"
+        "}\n"
+        "\n"
+        "int Switch()\n"
+        "{\n"
+        "  int res = 0;\n"
+        "  for (int i = 0; i < 6; i++)\n"
+        "  {\n"
+        "    switch (i * 2 + 1)\n"
+        "    {\n"
+        "    case 1: res += 1; break;\n"
+        "    case 3:\n"
+        "    case 5: res += 10;\n"
+        "    case 2 + 5: res += 100; break;\n"
+        "    default: res += 1000;\n"
+        "    }\n"
+        "  }\n"
+        "  return res;\n"
+        "}\n"
+        "\n"
+        "int Calls()\n"
+        "{\n"
+        "  int a = Add(1, 2) + Add(3 + 4, 5 * 6);\n"
+        "  return Add(a, Add(a, 1 + 2 + 3));\n"
+        "}\n";
+
+    TestSameResults(inpl, { "Arithmetic", "Logic", "Loops", "Switch", "Calls" });
+    TestSameResults(inpl, { "Arithmetic", "Logic", "Loops", "Switch", "Calls" }, false);
+}
+
+TEST(Optimizer, StripsLineNumbers) {
+    const char *inpl = ""
+        "int Func()\n"
+        "{\n"
+        "  int a = 1;\n"
+        "  a += 2;\n"
+        "  return a;\n"
+        "}\n";
+
+    std::unique_ptr<ccScript> scrip(CompileTestScript(inpl));
+    ASSERT_NE(nullptr, scrip.get()) << last_seen_cc_error();
+    ASSERT_TRUE(HasOp(scrip.get(), SCMD_LINENUM));
+    std::unique_ptr<ccScript> opt_scrip(new ccScript(*scrip));
+    ASSERT_GT(OptimizeTestScript(opt_scrip.get(), true), 0);
+    EXPECT_TRUE(HasOp(opt_scrip.get(), SCMD_LINENUM));
+    ASSERT_GT(OptimizeTestScript(scrip.get(), false), 0);
+    EXPECT_FALSE(HasOp(scrip.get(), SCMD_LINENUM));
+
+    int32_t result = 0;
+    ASSERT_TRUE(TestVM(scrip.get()).Call("Func", result));
+    EXPECT_EQ(3, result);
+}
+
+TEST(Optimizer, RemapsFixupsAndExports) {
+    const char *inpl = ""
+        "import int Ext(int a, int b);\n"
+        "import void Display(const string text);\n"
+        "int glob;\n"
+        "int Func(int x)\n"
+        "{\n"
+        "  int y = x + 1 + 2;\n"
+        "  glob = Ext(y * 2, 4 - 1);\n"
+        "  return glob;\n"
+        "}\n"
+        "int Func2()\n"
+        "{\n"
+        "  Display(\"text\");\n"
+        "  return Func(1 + 2 * 3);\n"
+        "}\n";
+
+    std::unique_ptr<ccScript> scrip(CompileTestScript(inpl));
+    ASSERT_NE(nullptr, scrip.get()) << last_seen_cc_error();
+    const int num_fixups = scrip->numfixups;
+    ASSERT_GT(OptimizeTestScript(scrip.get()), 0);
+    ASSERT_EQ(num_fixups, scrip->numfixups);
+
+    const std::vector<int32_t> ops = DecodeOps(scrip.get());
+    auto is_op = [&ops](int32_t pos) { return std::find(ops.begin(), ops.end(), pos) != ops.end(); };
+    std::vector<int32_t> func_addrs;
+    for (int i = 0; i < scrip->numexports; ++i)
+    {
+        if (((scrip->export_addr[i] >> 24) & 0xFF) != EXPORT_FUNCTION)
+            continue;
+        const int32_t addr = scrip->export_addr[i] & 0x00FFFFFF;
+        ASSERT_TRUE(is_op(addr));
+        func_addrs.push_back(addr);
+    }
+    ASSERT_EQ(2u, func_addrs.size());
+
+    bool has_import = false, has_func = false, has_string = false;
+    for (int i = 0; i < scrip->numfixups; ++i)
+    {
+        const int32_t pos = scrip->fixups[i];
+        // all fixups are still LITTOREG arguments
+        ASSERT_TRUE(is_op(pos - 2));
+        ASSERT_EQ(SCMD_LITTOREG, scrip->code[pos - 2]);
+        switch (scrip->fixuptypes[i])
+        {
+        case FIXUP_IMPORT:
+            // the engine expects import call right after the import address
+            EXPECT_EQ(SCMD_CALLEXT, scrip->code[pos + 1]);
+            has_import = true;
+            break;
+        case FIXUP_FUNCTION:
+            EXPECT_EQ(SCMD_CALL, scrip->code[pos + 1]);
+            EXPECT_EQ(func_addrs[0], scrip->code[pos]);
+            has_func = true;
+            break;
+        case FIXUP_STRING:
+            EXPECT_STREQ("text", &scrip->strings[scrip->code[pos]]);
+            has_string = true;
+            break;
+        }
+    }
+    EXPECT_TRUE(has_import);
+    EXPECT_TRUE(has_func);
+    EXPECT_TRUE(has_string);
+
+    // function base addresses must match their start
+    for (int32_t pos : ops)
+    {
+        if (scrip->code[pos] == SCMD_THISBASE)
+        {
+            EXPECT_NE(func_addrs.end(), std::find(func_addrs.begin(), func_addrs.end(), scrip->code[pos + 1]));
+        }
+    }
+}
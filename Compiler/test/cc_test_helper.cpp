@@ -15,7 +15,7 @@
 #include "util/string_compat.h"
 #include "util/string.h"
 
-extern int currentline; // in script/script_common
+extern thread_local int currentline; // in script/script_common
 
 typedef AGS::Common::String AGSString;
 
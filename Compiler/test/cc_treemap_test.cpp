@@ -1,3 +1,4 @@
+#include <stdio.h>
 #include "gtest/gtest.h"
 #include "script/cc_treemap.h"
 
@@ -55,3 +56,51 @@ TEST(TreeMap, Clear) {
 	symbolTree.clear();
 	ASSERT_TRUE (symbolTree.findValue("a") == -1);
 }
+
+TEST(TreeMap, ManyEntries) {
+	ccTreeMap symbolTree;
+	char key[32];
+	for (int i = 0; i < 10000; i++) {
+		sprintf(key, "sym%d", i);
+		symbolTree.addEntry(key, i);
+	}
+	ASSERT_TRUE (symbolTree.size() == 10000);
+	for (int i = 0; i < 10000; i++) {
+		sprintf(key, "sym%d", i);
+		ASSERT_TRUE (symbolTree.findValue(key) == i);
+	}
+	ASSERT_TRUE (symbolTree.findValue("sym10000") == -1);
+}
+
+TEST(TreeMap, InternedKeys) {
+	ccTreeMap symbolTree;
+	const char *a = symbolTree.addEntry("a", 1);
+	ASSERT_STREQ (a, "a");
+	// interned key remains the same as the map grows
+	char key[32];
+	for (int i = 0; i < 1000; i++) {
+		sprintf(key, "sym%d", i);
+		symbolTree.addEntry(key, i);
+	}
+	ASSERT_TRUE (symbolTree.addEntry("a", 2) == a);
+	ASSERT_TRUE (symbolTree.findKey("a") == a);
+	ASSERT_TRUE (symbolTree.findKey("b") == NULL);
+	// lookup by the key length
+	ASSERT_TRUE (symbolTree.findValue("abc", 1) == 2);
+	ASSERT_TRUE (symbolTree.findValue("sym123456", 6) == 123);
+}
+
+TEST(TreeMap, Copy) {
+	ccTreeMap symbolTree;
+	symbolTree.addEntry("a", 1);
+	symbolTree.addEntry("b", 2);
+	ccTreeMap copy(symbolTree);
+	symbolTree.clear();
+	ASSERT_TRUE (copy.findValue("a") == 1);
+	ASSERT_TRUE (copy.findValue("b") == 2);
+	ASSERT_STREQ (copy.findKey("a"), "a");
+	copy.addEntry("c", 3);
+	ASSERT_TRUE (symbolTree.findValue("c") == -1);
+	symbolTree = copy;
+	ASSERT_TRUE (symbolTree.findValue("c") == 3);
+}
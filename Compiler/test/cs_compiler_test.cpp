@@ -0,0 +1,270 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+#include "test/cc_test_helper.h"
+#include "preproc/preprocessor.h"
+#include "script/cc_common.h"
+#include "script/cc_internal.h"
+#include "script/cs_compiler.h"
+
+namespace
+{
+
+const char *TestHeader = ""
+    "import int Counter;                                \n"
+    "import int GetValue(int a);                        \n"
+    "enum Color { eRed, eGreen, eBlue };                \n"
+    "managed struct Point {                             \n"
+    "    int X, Y;                                      \n"
+    "    import int Sum();                              \n"
+    "};                                                 \n";
+
+const char *TestScripts[] = {
+    ""
+    "int Add(int a, int b) { return a + b + Counter; }  \n",
+    ""
+    "int data[10];                                      \n"
+    "int Fill(Color c) {                                \n"
+    "    for (int i = 0; i < 10; i++) data[i] = i * c;  \n"
+    "    return GetValue(data[9]);                      \n"
+    "}                                                  \n",
+    ""
+    "int Point::Sum() { return this.X + this.Y; }       \n"
+    "int Make() {                                       \n"
+    "    Point *p = new Point; p.X = eBlue; p.Y = 3;    \n"
+    "    return p.Sum();                                \n"
+    "}                                                  \n",
+    ""
+    // declares the same function as the first script
+    "int Add(int a, int b) { return a * b; }            \n"
+    "int Twice(int a) { return Add(a, a); }             \n",
+};
+
+const char *BrokenScript = ""
+    "int Broken() { return Missing(); }                 \n";
+
+// Sets up the test header and compile options, restores them when done
+struct TestCompileSetup
+{
+    const int OldExportAll = ccGetOption(SCOPT_EXPORTALL);
+    const int OldLineNumbers = ccGetOption(SCOPT_LINENUMBERS);
+    const int OldShowWarnings = ccGetOption(SCOPT_SHOWWARNINGS);
+
+    TestCompileSetup()
+    {
+        ccSetOption(SCOPT_EXPORTALL, 1);
+        ccSetOption(SCOPT_LINENUMBERS, 1);
+        ccSetOption(SCOPT_SHOWWARNINGS, 0);
+        ccRemoveDefaultHeaders();
+        ccAddDefaultHeader(TestHeader, "TestHeader");
+    }
+
+    ~TestCompileSetup()
+    {
+        ccRemoveDefaultHeaders();
+        ccSetOption(SCOPT_EXPORTALL, OldExportAll);
+        ccSetOption(SCOPT_LINENUMBERS, OldLineNumbers);
+        ccSetOption(SCOPT_SHOWWARNINGS, OldShowWarnings);
+    }
+};
+
+void ExpectSameScript(const ccScript &expected, const ccScript &actual)
+{
+    ASSERT_EQ(expected.codesize, actual.codesize);
+    EXPECT_EQ(0, memcmp(expected.code, actual.code, expected.codesize * sizeof(int32_t)));
+    ASSERT_EQ(expected.globaldatasize, actual.globaldatasize);
+    EXPECT_EQ(0, memcmp(expected.globaldata, actual.globaldata, expected.globaldatasize));
+    ASSERT_EQ(expected.stringssize, actual.stringssize);
+    EXPECT_EQ(0, memcmp(expected.strings, actual.strings, expected.stringssize));
+    ASSERT_EQ(expected.numfixups, actual.numfixups);
+    EXPECT_EQ(0, memcmp(expected.fixups, actual.fixups, expected.numfixups * sizeof(int32_t)));
+    EXPECT_EQ(0, memcmp(expected.fixuptypes, actual.fixuptypes, expected.numfixups));
+    ASSERT_EQ(expected.numimports, actual.numimports);
+    for (int i = 0; i < expected.numimports; ++i)
+        EXPECT_STREQ(expected.imports[i], actual.imports[i]);
+    ASSERT_EQ(expected.numexports, actual.numexports);
+    for (int i = 0; i < expected.numexports; ++i)
+    {
+        EXPECT_STREQ(expected.exports[i], actual.exports[i]);
+        EXPECT_EQ(expected.export_addr[i], actual.export_addr[i]);
+    }
+    ASSERT_EQ(expected.numSections, actual.numSections);
+    for (int i = 0; i < expected.numSections; ++i)
+    {
+        EXPECT_STREQ(expected.sectionNames[i], actual.sectionNames[i]);
+        EXPECT_EQ(expected.sectionOffsets[i], actual.sectionOffsets[i]);
+    }
+}
+
+// Generates a script with the given number of structs and functions,
+// which use macros, struct members, locals, loops and calls
+std::string GenerateBenchmarkScript(int struct_count, int func_count)
+{
+    std::string script;
+    char buf[1024];
+    for (int i = 0; i < struct_count; ++i)
+    {
+        snprintf(buf, sizeof(buf),
+            "#define DATA_SCALE_%d %d\n"
+            "struct Data%d {\n"
+            "    int Count, Offset;\n"
+            "    int Values[8];\n"
+            "    import int Total();\n"
+            "};\n"
+            "Data%d data%d;\n"
+            "int Data%d::Total() {\n"
+            "    int total = this.Offset * DATA_SCALE_%d;\n"
+            "    for (int i = 0; i < 8; i++) total += this.Values[i];\n"
+            "    return total;\n"
+            "}\n",
+            i, i + 1, i, i, i, i, i);
+        script += buf;
+    }
+    for (int i = 0; i < func_count; ++i)
+    {
+        const int s = i % struct_count;
+        snprintf(buf, sizeof(buf),
+            "int Func%d(int a, int b) {\n"
+            "    int local_value = a * DATA_SCALE_%d + b;\n"
+            "    if (local_value > data%d.Count) local_value -= data%d.Offset;\n"
+            "    else local_value += data%d.Values[b %% 8];\n"
+            "    while (local_value > 1000) local_value = local_value / 2;\n"
+            "    return local_value + data%d.Total()%s;\n"
+            "}\n",
+            i, s, s, s, s, s, (i > 0 ? (" + Func" + std::to_string(i - 1) + "(b, a)").c_str() : ""));
+        script += buf;
+    }
+    return script;
+}
+
+} // namespace
+
+TEST(CompileWithHeaders, SameAsCompileText) {
+    TestCompileSetup setup;
+    std::unique_ptr<ccHeaderSnapshot> headers = ccCompileDefaultHeaders();
+    ASSERT_NE(nullptr, headers.get()) << last_seen_cc_error();
+
+    // Same snapshot is used for all the scripts, in turn
+    for (const char *text : TestScripts)
+    {
+        clear_error();
+        std::unique_ptr<ccScript> expected(ccCompileText(text, "Test"));
+        ASSERT_NE(nullptr, expected.get()) << last_seen_cc_error();
+        std::unique_ptr<ccScript> actual(ccCompileTextWithHeaders(text, "Test", *headers));
+        ASSERT_NE(nullptr, actual.get()) << last_seen_cc_error();
+        ExpectSameScript(*expected, *actual);
+    }
+}
+
+TEST(CompileWithHeaders, HeaderError) {
+    TestCompileSetup setup;
+    ccAddDefaultHeader("import int Counter;\nint Broken(", "BrokenHeader");
+    clear_error();
+    std::unique_ptr<ccHeaderSnapshot> headers = ccCompileDefaultHeaders();
+    ASSERT_EQ(nullptr, headers.get());
+    EXPECT_TRUE(cc_has_error());
+    EXPECT_STREQ("BrokenHeader", ccCurScriptName);
+}
+
+TEST(CompileWithHeaders, ParallelThreads) {
+    TestCompileSetup setup;
+    std::unique_ptr<ccHeaderSnapshot> headers = ccCompileDefaultHeaders();
+    ASSERT_NE(nullptr, headers.get()) << last_seen_cc_error();
+
+    const size_t script_count = sizeof(TestScripts) / sizeof(TestScripts[0]);
+    std::vector<std::unique_ptr<ccScript>> expected;
+    for (const char *text : TestScripts)
+    {
+        expected.emplace_back(ccCompileText(text, "Test"));
+        ASSERT_NE(nullptr, expected.back().get());
+    }
+
+    // Each thread compiles all the scripts, in its own order, with one
+    // failing script in between; the error must not affect other threads
+    const size_t thread_count = 4;
+    std::vector<std::vector<std::unique_ptr<ccScript>>> results(thread_count);
+    std::vector<int> error_lines(thread_count);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < thread_count; ++t)
+    {
+        threads.emplace_back([&, t]()
+        {
+            results[t].resize(script_count);
+            for (size_t i = 0; i < script_count; ++i)
+            {
+                if (i == t % script_count)
+                {
+                    std::unique_ptr<ccScript> broken(
+                        ccCompileTextWithHeaders(BrokenScript, "Broken", *headers));
+                    error_lines[t] = (!broken && cc_has_error()) ? cc_get_error().Line : -1;
+                }
+                const size_t index = (i + t) % script_count;
+                results[t][index].reset(
+                    ccCompileTextWithHeaders(TestScripts[index], "Test", *headers));
+            }
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+
+    for (size_t t = 0; t < thread_count; ++t)
+    {
+        EXPECT_EQ(1, error_lines[t]);
+        for (size_t i = 0; i < script_count; ++i)
+        {
+            ASSERT_NE(nullptr, results[t][i].get());
+            ExpectSameScript(*expected[i], *results[t][i]);
+        }
+    }
+}
+
+// Measures preprocessor and compiler throughput on a large generated script.
+// Disabled by default, run with:
+// compiler_test --gtest_also_run_disabled_tests --gtest_filter=CompileBenchmark.*
+TEST(CompileBenchmark, DISABLED_LargeScript) {
+    TestCompileSetup setup;
+    ccRemoveDefaultHeaders();
+    const std::string script = GenerateBenchmarkScript(400, 1500);
+    const size_t line_count = std::count(script.begin(), script.end(), '\n');
+    const int runs = 5;
+
+    typedef std::chrono::steady_clock Clock;
+    Clock::duration pp_time{}, cc_time{};
+    for (int run = 0; run < runs; ++run)
+    {
+        clear_error();
+        auto start = Clock::now();
+        AGS::Preprocessor::Preprocessor pp;
+        AGS::Common::String preprocessed = pp.Preprocess(script.c_str(), "Benchmark");
+        auto pp_end = Clock::now();
+        ASSERT_FALSE(cc_has_error()) << last_seen_cc_error();
+        std::unique_ptr<ccScript> compiled(ccCompileText(preprocessed.GetCStr(), "Benchmark"));
+        cc_time += Clock::now() - pp_end;
+        pp_time += pp_end - start;
+        ASSERT_NE(nullptr, compiled.get()) << last_seen_cc_error();
+    }
+
+    const double pp_sec = std::chrono::duration<double>(pp_time).count() / runs;
+    const double cc_sec = std::chrono::duration<double>(cc_time).count() / runs;
+    printf("Script of %zu lines: preprocessed in %.3f s (%.0f lines/s), compiled in %.3f s (%.0f lines/s)\n",
+        line_count, pp_sec, line_count / pp_sec, cc_sec, line_count / cc_sec);
+}
@@ -158,6 +158,29 @@ TEST(Preprocess, MacroDoesNotExist) {
 }
 
 
+TEST(Preprocess, DefineAfterUndef) {
+    Preprocessor pp = Preprocessor();
+    const char* inpl = R"EOS(
+#define FOO 1
+int a = FOO;
+#undef FOO
+int b = FOO;
+#define FOO 2
+int c = FOO;
+)EOS";
+
+    clear_error();
+    String res = pp.Preprocess(inpl, "ScriptDefineAfterUndef");
+
+    EXPECT_STREQ(last_seen_cc_error(), "");
+
+    std::vector<AGSString> lines = SplitLines(res);
+    ASSERT_EQ(lines.size(), 9);
+    ASSERT_STREQ(lines[3].GetCStr(), "int a = 1;");
+    ASSERT_STREQ(lines[5].GetCStr(), "int b = FOO;");
+    ASSERT_STREQ(lines[7].GetCStr(), "int c = 2;");
+}
+
 TEST(Preprocess, MacroNameMissing) {
     Preprocessor pp = Preprocessor();
         const char* inpl = R"EOS(
@@ -88,6 +88,16 @@ void GUIObject::NotifyParentChanged()
     // do nothing: in Editor "guis" array is not even guaranteed to be filled!
 }
 
+bool GUIObject::HasChanged() const
+{
+    return _hasChanged;
+}
+
+void GUIObject::ClearChanged()
+{
+    _hasChanged = false;
+}
+
 void GUILabel::PrepareTextToDraw()
 {
     _textToDraw = Text;
@@ -37,6 +37,7 @@
 #include "ac/overlay.h"
 #include "ac/properties.h"
 #include "ac/room.h"
+#include "ac/roomareamap.h"
 #include "ac/screenoverlay.h"
 #include "ac/string.h"
 #include "ac/system.h"
@@ -767,11 +768,11 @@ void Character_SayAt(CharacterInfo *chaa, int x, int y, int width, const char *t
 ScriptOverlay* Character_SayBackground(CharacterInfo *chaa, const char *texx) {
 
     int ovltype = DisplaySpeechBackground(chaa->index_id, (char*)texx);
-    int ovri = find_overlay_of_type(ovltype);
-    if (ovri<0)
+    auto *over = get_overlay(ovltype);
+    if (!over)
         quit("!SayBackground internal error: no overlay");
     // Create script object with an internal ref, keep at least until internal timeout
-    return create_scriptoverlay(screenover[ovri], true);
+    return create_scriptoverlay(*over, true);
 }
 
 void Character_SetAsPlayer(CharacterInfo *chaa) {
@@ -1966,10 +1967,11 @@ int find_nearest_walkable_area_within(int *xx, int *yy, int range, int step)
         if (yheight > roomHeightLowRes) yheight = roomHeightLowRes;
     }
 
+    const RoomAreaMap &walkareas = get_room_area_map(kRoomAreaWalkable);
     for (ex = startx; ex < xwidth; ex += step) {
         for (ey = starty; ey < yheight; ey += step) {
             // non-walkalbe, so don't go here
-            if (thisroom.WalkAreaMask->GetPixel(ex,ey) == 0) continue;
+            if (walkareas.GetArea(ex, ey) == 0) continue;
             // off a screen edge, don't move them there
             if ((ex <= leftEdge) || (ex >= rightEdge) ||
                 (ey <= topEdge) || (ey >= bottomEdge))
@@ -1991,7 +1993,7 @@ int find_nearest_walkable_area_within(int *xx, int *yy, int range, int step)
 
 void find_nearest_walkable_area (int *xx, int *yy) {
 
-    int pixValue = thisroom.WalkAreaMask->GetPixel(room_to_mask_coord(xx[0]), room_to_mask_coord(yy[0]));
+    int pixValue = get_room_area_map(kRoomAreaWalkable).GetArea(room_to_mask_coord(xx[0]), room_to_mask_coord(yy[0]));
     // only fix this code if the game was built with 2.61 or above
     if (pixValue == 0 || (loaded_game_file_version >= kGameVersion_261 && pixValue < 1))
     {
@@ -2419,11 +2421,9 @@ void _displayspeech(const char*texx, int aschar, int xx, int yy, int widd, int i
 
     if (play.bgspeech_stay_on_display == 0) {
         // remove any background speech
-        for (size_t i = 0; i < screenover.size();) {
-            if (screenover[i].timeout > 0)
-                remove_screen_overlay(screenover[i].type);
-            else
-                i++;
+        for (auto &over : get_overlays()) {
+            if (over.type >= 0 && over.timeout > 0)
+                remove_screen_overlay(over.type);
         }
     }
     said_text = 1;
@@ -257,7 +257,7 @@ ScreenOverlay *_display_main(int xx, int yy, int wii, const char *text, int disp
     // we should not delete text_window_ds here, because it is now owned by Overlay
 
     if (disp_type >= DISPLAYTEXT_NORMALOVERLAY) {
-        return &screenover[nse];
+        return get_overlay(nse);
     }
 
     //
@@ -344,10 +344,11 @@ ScreenOverlay *_display_main(int xx, int yy, int wii, const char *text, int disp
 
         if (!overlayPositionFixed)
         {
-            screenover[nse].SetRoomRelative(true);
-            VpPoint vpt = play.GetRoomViewport(0)->ScreenToRoom(screenover[nse].x, screenover[nse].y, false);
-            screenover[nse].x = vpt.first.X;
-            screenover[nse].y = vpt.first.Y;
+            auto *over = get_overlay(nse);
+            over->SetRoomRelative(true);
+            VpPoint vpt = play.GetRoomViewport(0)->ScreenToRoom(over->x, over->y, false);
+            over->x = vpt.first.X;
+            over->y = vpt.first.Y;
         }
 
         GameLoopUntilNoOverlay();
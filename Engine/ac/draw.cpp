@@ -35,6 +35,7 @@
 #include "ac/movelist.h"
 #include "ac/overlay.h"
 #include "ac/sys_events.h"
+#include "ac/roomareamap.h"
 #include "ac/roomobject.h"
 #include "ac/roomstatus.h"
 #include "ac/runtime_defines.h"
@@ -59,6 +60,7 @@
 #include "gfx/graphicsdriver.h"
 #include "gfx/ali3dexception.h"
 #include "gfx/blender.h"
+#include "gfx/blender_simd.h"
 #include "media/audio/audio_system.h"
 #include "ac/game.h"
 #include "util/wgt2allg.h"
@@ -363,6 +365,16 @@ PBitmap PrepareSpriteForUse(PBitmap bitmap, bool has_alpha)
     return new_bitmap == bitmap.get() ? bitmap : PBitmap(new_bitmap); // if bitmap is same, don't create new smart ptr!
 }
 
+bool IsSpritePreparedInPlace(const Bitmap *bitmap, bool has_alpha)
+{
+    const int bmp_col_depth = bitmap->GetColorDepth();
+#if defined (AGS_INVERTED_COLOR_ORDER)
+    if (System_GetColorDepth() > 16 && bmp_col_depth == 32)
+        return true; // convert_32_to_32bgr
+#endif
+    return (game.GetColorDepth() == 32) && (bmp_col_depth == 32) && has_alpha; // set_rgb_mask_using_alpha_channel
+}
+
 Bitmap *CopyScreenIntoBitmap(int width, int height, bool at_native_res)
 {
     Bitmap *dst = new Bitmap(width, height, game.GetColorDepth());
@@ -973,8 +985,11 @@ void draw_sprite_support_alpha(Bitmap *ds, bool ds_has_alpha, int xpos, int ypos
     // Backwards-compatible drawing
     else if (src_has_alpha && alpha == 0xFF)
     {
-        set_alpha_blender();
-        ds->TransBlendBlt(image, xpos, ypos);
+        if (!draw_trans_sprite32(ds, image, xpos, ypos, kBlendRow_Argb2Rgb, 0))
+        {
+            set_alpha_blender();
+            ds->TransBlendBlt(image, xpos, ypos);
+        }
     }
     else
     {
@@ -1018,6 +1033,20 @@ void sync_object_texture(ObjTexture &obj, bool has_alpha = false , bool opaque =
     obj.Ddb = recycle_ddb_sprite(obj.Ddb, obj.SpriteID, obj.Bmp.get(), has_alpha, opaque);
 }
 
+// Updates only the given regions of the object's texture from its raw bitmap
+void sync_object_texture(ObjTexture &obj, const std::vector<Rect> &regions, bool has_alpha = false)
+{
+    if (!obj.Ddb || (obj.SpriteID != UINT32_MAX) ||
+        (obj.Ddb->GetColorDepth() != obj.Bmp->GetColorDepth()) ||
+        (obj.Ddb->GetWidth() != obj.Bmp->GetWidth()) || (obj.Ddb->GetHeight() != obj.Bmp->GetHeight()))
+    {
+        sync_object_texture(obj, has_alpha);
+        return;
+    }
+    for (const auto &rc : regions)
+        gfxDriver->UpdateDDBRegionFromBitmap(obj.Ddb, obj.Bmp.get(), has_alpha, rc);
+}
+
 //------------------------------------------------------------------------
 // Functions for filling the lists of sprites to render
 static void clear_draw_list()
@@ -1205,7 +1234,8 @@ void get_local_tint(int xpp, int ypp, int nolight,
 
         int onRegion = 0;
 
-        if ((play.ground_level_areas_disabled & GLED_EFFECTS) == 0) {
+        if (((play.ground_level_areas_disabled & GLED_EFFECTS) == 0) &&
+            !get_room_area_map(kRoomAreaRegion).IsEmpty()) {
             // check if the player is on a region, to find its
             // light/tint level
             onRegion = GetRegionIDAtRoom(xpp, ypp);
@@ -1320,17 +1350,17 @@ void apply_tint_or_light(int actspsindex, int light_level,
          if (game.color_depth == 1) {
              // 256-col
              lit_amnt = (250 - ((-light_level) * 5)/2);
+             active_spr->LitBlendBlt(oldwas.get(), 0, 0, lit_amnt);
          }
          else {
              // hi-color
-             if (light_level < 0)
-                 set_my_trans_blender(8,8,8,0);
-             else
-                 set_my_trans_blender(248,248,248,0);
+             const int lit_col = (light_level < 0) ? 8 : 248;
              lit_amnt = abs(light_level) * 2;
+             if (!draw_lit_sprite32(active_spr, oldwas.get(), 0, 0, lit_col, lit_col, lit_col, lit_amnt)) {
+                 set_my_trans_blender(lit_col, lit_col, lit_col, 0);
+                 active_spr->LitBlendBlt(oldwas.get(), 0, 0, lit_amnt);
+             }
          }
-
-         active_spr->LitBlendBlt(oldwas.get(), 0, 0, lit_amnt);
      }
 
      if (oldwas.get() == blitFrom)
@@ -1661,6 +1691,21 @@ void prepare_objects_for_drawing() {
 
 
 
+// Draws srcimg onto ds, taking hue and saturation from the tint color
+static void tint_blend_blt(Bitmap *ds, Bitmap *srcimg, int red, int grn, int blu, int luminance)
+{
+    if (draw_tinted_sprite32(ds, srcimg, 0, 0, red, grn, blu, luminance))
+        return;
+    // For performance reasons, we have a seperate blender for
+    // when light is being adjusted and when it is not.
+    // If luminance >= 250, then normal brightness, otherwise darken
+    if (luminance >= 250)
+        set_blender_mode (_myblender_color15, _myblender_color16, _myblender_color32, red, grn, blu, 0);
+    else
+        set_blender_mode (_myblender_color15_light, _myblender_color16_light, _myblender_color32_light, red, grn, blu, 0);
+    ds->LitBlendBlt(srcimg, 0, 0, luminance);
+}
+
 // Draws srcimg onto destimg, tinting to the specified level
 // Totally overwrites the contents of the destination image
 void tint_image (Bitmap *ds, Bitmap *srcimg, int red, int grn, int blu, int light_level, int luminance) {
@@ -1673,18 +1718,10 @@ void tint_image (Bitmap *ds, Bitmap *srcimg, int red, int grn, int blu, int ligh
             return;
     }
 
-    // For performance reasons, we have a seperate blender for
-    // when light is being adjusted and when it is not.
-    // If luminance >= 250, then normal brightness, otherwise darken
-    if (luminance >= 250)
-        set_blender_mode (_myblender_color15, _myblender_color16, _myblender_color32, red, grn, blu, 0);
-    else
-        set_blender_mode (_myblender_color15_light, _myblender_color16_light, _myblender_color32_light, red, grn, blu, 0);
-
     if (light_level >= 100) {
         // fully colourised
         ds->FillTransparent();
-        ds->LitBlendBlt(srcimg, 0, 0, luminance);
+        tint_blend_blt(ds, srcimg, red, grn, blu, luminance);
     }
     else {
         // light_level is between -100 and 100 normally; 0-100 in
@@ -1696,11 +1733,13 @@ void tint_image (Bitmap *ds, Bitmap *srcimg, int red, int grn, int blu, int ligh
         // Render the colourised image to a temporary bitmap,
         // then transparently draw it over the original image
         Bitmap *finaltarget = BitmapHelper::CreateTransparentBitmap(srcimg->GetWidth(), srcimg->GetHeight(), srcimg->GetColorDepth());
-        finaltarget->LitBlendBlt(srcimg, 0, 0, luminance);
+        tint_blend_blt(finaltarget, srcimg, red, grn, blu, luminance);
 
-        // customized trans blender to preserve alpha channel
-        set_my_trans_blender (0, 0, 0, light_level);
-        ds->TransBlendBlt (finaltarget, 0, 0);
+        if (!draw_trans_sprite32(ds, finaltarget, 0, 0, kBlendRow_MyTrans, light_level)) {
+            // customized trans blender to preserve alpha channel
+            set_my_trans_blender (0, 0, 0, light_level);
+            ds->TransBlendBlt (finaltarget, 0, 0);
+        }
         delete finaltarget;
     }
 }
@@ -1992,10 +2031,10 @@ void add_walkbehind_image(size_t index, Common::Bitmap *bmp, int x, int y)
 // Add active room overlays to the sprite list
 static void add_roomovers_for_drawing()
 {
-    for (size_t i = 0; i < screenover.size(); ++i)
+    const auto &overs = get_overlays();
+    for (int type : get_overlays_draw_order(true))
     {
-        auto &over = screenover[i];
-        if (!over.IsRoomLayer()) continue; // not a room layer
+        const auto &over = overs[type];
         if (over.transparency == 255) continue; // skip fully transparent
         Point pos = get_overlay_position(over);
         add_to_sprite_list(over.ddb, pos.X, pos.Y, over.zorder, false);
@@ -2207,10 +2246,10 @@ void draw_gui_and_overlays()
 
     const bool is_software_mode = !gfxDriver->HasAcceleratedTransform();
     // Add active overlays to the sprite list
-    for (size_t i = 0; i < screenover.size(); ++i)
+    const auto &overs = get_overlays();
+    for (int type : get_overlays_draw_order(false))
     {
-        auto &over = screenover[i];
-        if (over.IsRoomLayer()) continue; // not a ui layer
+        const auto &over = overs[type];
         if (over.transparency == 255) continue; // skip fully transparent
         Point pos = get_overlay_position(over);
         add_to_sprite_list(over.ddb, pos.X, pos.Y, over.zorder, false);
@@ -2228,6 +2267,7 @@ void draw_gui_and_overlays()
         our_eip = 37;
         // Prepare and update GUI textures
         {
+            std::vector<Rect> dirty_rects;
             for (int index = 0; index < game.numgui; ++index)
             {
                 auto &gui = guis[index];
@@ -2238,23 +2278,31 @@ void draw_gui_and_overlays()
                 eip_guinum = index;
                 our_eip = 372;
                 const bool draw_with_controls = !draw_controls_as_textures;
-                if (gui.HasChanged() || (draw_with_controls && gui.HasControlsChanged()))
+                auto &gbg = guibg[index];
+                const bool is_alpha = gui.HasAlphaChannel();
+                // old-style (pre-3.0.2) GUI alpha rendering requires to repair whole image
+                const bool repair_alpha = is_alpha &&
+                    (game.options[OPT_NEWGUIALPHA] == kGuiAlphaRender_Legacy) && (gui.BgImage > 0);
+                // If only some controls changed, then try to redraw only their regions
+                if (!gui.HasChanged() && draw_with_controls && !repair_alpha && gbg.Bmp &&
+                    (gbg.Bmp->GetColorDepth() == game.GetColorDepth()) &&
+                    (gbg.Bmp->GetWidth() == gui.Width) && (gbg.Bmp->GetHeight() == gui.Height) &&
+                    gui.DrawChangedControls(gbg.Bmp.get(), dirty_rects))
+                {
+                    if (!dirty_rects.empty())
+                        sync_object_texture(gbg, dirty_rects, is_alpha);
+                }
+                else if (gui.HasChanged() || (draw_with_controls && gui.HasControlsChanged()))
                 {
-                    auto &gbg = guibg[index];
                     recycle_bitmap(gbg.Bmp, game.GetColorDepth(), gui.Width, gui.Height, true);
                     if (draw_with_controls)
                         gui.DrawWithControls(gbg.Bmp.get());
                     else
                         gui.DrawSelf(gbg.Bmp.get());
 
-                    const bool is_alpha = gui.HasAlphaChannel();
-                    if (is_alpha)
+                    if (repair_alpha)
                     {
-                        if ((game.options[OPT_NEWGUIALPHA] == kGuiAlphaRender_Legacy) && (gui.BgImage > 0))
-                        {
-                            // old-style (pre-3.0.2) GUI alpha rendering
-                            repair_alpha_channel(gbg.Bmp.get(), spriteset[gui.BgImage]);
-                        }
+                        repair_alpha_channel(gbg.Bmp.get(), spriteset[gui.BgImage]);
                     }
                     sync_object_texture(gbg, is_alpha);
                 }
@@ -2454,14 +2502,16 @@ static void construct_ui_view()
 static void construct_overlays()
 {
     const bool is_software_mode = !gfxDriver->HasAcceleratedTransform();
-    if (overlaybmp.size() < screenover.size())
+    auto &overs = get_overlays();
+    if (overlaybmp.size() < overs.size())
     {
-        overlaybmp.resize(screenover.size());
-        screenovercache.resize(screenover.size());
+        overlaybmp.resize(overs.size());
+        screenovercache.resize(overs.size());
     }
-    for (size_t i = 0; i < screenover.size(); ++i)
+    for (size_t i = 0; i < overs.size(); ++i)
     {
-        auto &over = screenover[i];
+        auto &over = overs[i];
+        if (over.type < 0) continue; // empty slot
         if (over.transparency == 255) continue; // skip fully transparent
 
         bool has_changed = over.HasChanged();
@@ -2516,6 +2566,7 @@ void construct_game_scene(bool full_redraw)
 
     gfxDriver->UseSmoothScaling(IS_ANTIALIAS_SPRITES);
     gfxDriver->RenderSpritesAtScreenResolution(usetup.RenderAtScreenRes, usetup.Supersampling);
+    gfxDriver->SetRenderThreads(usetup.RenderThreads);
 
     pl_run_plugin_hooks(AGSE_PRERENDER, 0);
 
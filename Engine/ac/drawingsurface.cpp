@@ -20,6 +20,7 @@
 #include "ac/gamesetupstruct.h"
 #include "ac/gamestate.h"
 #include "ac/global_translation.h"
+#include "ac/roomareamap.h"
 #include "ac/roomobject.h"
 #include "ac/roomstatus.h"
 #include "ac/string.h"
@@ -66,6 +67,10 @@ void DrawingSurface_Release(ScriptDrawingSurface* sds)
         {
             walkbehinds_recalc();
         }
+        else
+        {
+            update_room_area_map(sds->roomMaskType);
+        }
         sds->roomMaskType = kRoomAreaNone;
     }
     if (sds->dynamicSpriteNumber >= 0)
@@ -79,6 +79,16 @@ int ccUnserializeAllObjects(Stream *in, ICCObjectReader *callback) {
     return pool.ReadFromDisk(in, callback);
 }
 
+// allocate memory for the object along with its data
+void *ccAllocObjectMemory(size_t size) {
+    return pool.AllocObjectMemory(size);
+}
+
+// free the memory allocated for the object
+void ccFreeObjectMemory(void *mem, size_t size) {
+    pool.FreeObjectMemory(mem, size);
+}
+
 // dispose the object if RefCount==0
 void ccAttemptDisposeObject(int32_t handle) {
     pool.CheckDispose(handle);
@@ -100,6 +100,11 @@ extern void  ccUnregisterAllObjects();
 extern void  ccSerializeAllObjects(Common::Stream *out);
 // un-serialise all objects (will remove all currently registered ones)
 extern int   ccUnserializeAllObjects(Common::Stream *in, ICCObjectReader *callback);
+// allocate memory for the object, which header and data are kept together;
+// the memory is recycled for the new objects when the object is disposed
+extern void *ccAllocObjectMemory(size_t size);
+// free the memory allocated with ccAllocObjectMemory; size must be the same
+extern void  ccFreeObjectMemory(void *mem, size_t size);
 // dispose the object if RefCount==0
 extern void  ccAttemptDisposeObject(int32_t handle);
 // translate between object handles and memory addresses
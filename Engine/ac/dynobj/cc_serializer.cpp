@@ -36,6 +36,7 @@ extern CCInventory ccDynamicInv;
 extern CCGUI       ccDynamicGUI;
 extern CCObject    ccDynamicObject;
 extern CCDialog    ccDynamicDialog;
+extern ScriptString myScriptStringImpl;
 extern ScriptDrawingSurface* dialogOptionsRenderingSurface;
 extern ScriptDialogOptionsRendering ccDialogOptionsRendering;
 extern PluginObjectReader pluginReaders[MAX_PLUGIN_OBJECT_READERS];
@@ -81,8 +82,7 @@ void AGSDeSerializer::Unserialize(int index, const char *objectType, const char
         ccDynamicObject.Unserialize(index, &mems, data_sz);
     }
     else if (strcmp(objectType, "String") == 0) {
-        ScriptString *scf = new ScriptString();
-        scf->Unserialize(index, &mems, data_sz);
+        myScriptStringImpl.Unserialize(index, &mems, data_sz);
     }
     else if (strcmp(objectType, "File") == 0) {
         // files cannot be restored properly -- so just recreate
@@ -136,8 +136,7 @@ void AGSDeSerializer::Unserialize(int index, const char *objectType, const char
         Camera_Unserialize(index, &mems, data_sz);
     }
     else if (strcmp(objectType, "UserObject") == 0) {
-        ScriptUserObject *suo = new ScriptUserObject();
-        suo->Unserialize(index, &mems, data_sz);
+        ScriptUserObject::CreateUnserialized(index, &mems, data_sz);
     }
     else if (!unserialize_audio_script_object(index, objectType, &mems, data_sz))
     {
@@ -0,0 +1,79 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+#include "ac/dynobj/managedobjectalloc.h"
+#include <stdlib.h>
+
+ManagedObjectAllocator::~ManagedObjectAllocator()
+{
+    for (auto *page : _pages)
+        delete [] page;
+}
+
+void *ManagedObjectAllocator::Allocate(size_t size)
+{
+    _stats.Allocated++;
+    _stats.InUse++;
+    if (size > MaxClassSize)
+    {
+        _stats.Large++;
+        return malloc(size);
+    }
+
+    const size_t size_class = GetSizeClass(size > 0 ? size : 1);
+    FreeBlock *block = _freeLists[size_class];
+    if (block)
+    {
+        _freeLists[size_class] = block->Next;
+        _stats.Reused++;
+        return block;
+    }
+
+    const size_t block_size = (size_class + 1) * Granularity;
+    if (static_cast<size_t>(_pageEnd - _pageCur) < block_size)
+    {
+        // The rest of the last page is a multiple of granularity,
+        // so it makes a block of some smaller class
+        if (_pageCur != _pageEnd)
+            PushFree(_pageCur, GetSizeClass(_pageEnd - _pageCur));
+        uint8_t *page = new uint8_t[PageSize];
+        _pages.push_back(page);
+        _pageCur = page;
+        _pageEnd = page + PageSize;
+        _stats.PageMemory += PageSize;
+    }
+    void *mem = _pageCur;
+    _pageCur += block_size;
+    return mem;
+}
+
+void ManagedObjectAllocator::Free(void *mem, size_t size)
+{
+    if (!mem)
+        return;
+    _stats.Freed++;
+    _stats.InUse--;
+    if (size > MaxClassSize)
+    {
+        free(mem);
+        return;
+    }
+    PushFree(mem, GetSizeClass(size > 0 ? size : 1));
+}
+
+void ManagedObjectAllocator::PushFree(void *mem, size_t size_class)
+{
+    FreeBlock *block = static_cast<FreeBlock*>(mem);
+    block->Next = _freeLists[size_class];
+    _freeLists[size_class] = block;
+}
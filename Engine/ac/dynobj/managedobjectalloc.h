@@ -0,0 +1,93 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// ManagedObjectAllocator provides memory for the small managed objects, such
+// as script strings and user structs, which scripts may create and dispose
+// at a high rate. Each object is allocated as a single block, containing
+// both the object's header and its data.
+//
+// Blocks are grouped in size classes and carved from the larger pages.
+// Freed blocks are put into their class's free list, and given out again
+// for the new objects of the same class. Blocks larger than the biggest
+// size class are allocated on the heap directly.
+//
+// Pages are only released when the allocator is destroyed, so the memory
+// held by it is defined by the peak number of objects that existed at once.
+// The allocator is not thread-safe.
+//
+//=============================================================================
+#ifndef __AGS_EE_DYNOBJ__MANAGEDOBJECTALLOC_H
+#define __AGS_EE_DYNOBJ__MANAGEDOBJECTALLOC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+class ManagedObjectAllocator
+{
+public:
+    // Allocation counters, for diagnostic purposes
+    struct Stats
+    {
+        uint64_t Allocated = 0u; // total number of allocated blocks
+        uint64_t Reused = 0u;    // blocks given out from the free lists
+        uint64_t Large = 0u;     // blocks too large for the size classes
+        uint64_t Freed = 0u;     // total number of freed blocks
+        size_t InUse = 0u;       // number of blocks currently in use
+        size_t PageMemory = 0u;  // memory reserved in pages, in bytes
+    };
+
+    // Block sizes are rounded up to this granularity; this also keeps
+    // all the blocks aligned same as the memory returned by malloc
+    static const size_t Granularity = 16u;
+    // Size of the biggest size class
+    static const size_t MaxClassSize = 512u;
+    // Size of a page, from which the blocks are carved
+    static const size_t PageSize = 64u * 1024u;
+
+    ManagedObjectAllocator() = default;
+    ManagedObjectAllocator(const ManagedObjectAllocator&) = delete;
+    ~ManagedObjectAllocator();
+    ManagedObjectAllocator &operator=(const ManagedObjectAllocator&) = delete;
+
+    // Allocates a memory block of the given size
+    void *Allocate(size_t size);
+    // Frees the memory block; the size must be the same
+    // as was requested when the block was allocated
+    void  Free(void *mem, size_t size);
+    const Stats &GetStats() const { return _stats; }
+
+private:
+    static const size_t ClassCount = MaxClassSize / Granularity;
+
+    // Free block, linked in its class's free list
+    struct FreeBlock
+    {
+        FreeBlock *Next;
+    };
+
+    // Returns the size class index for the block size in range [1, MaxClassSize]
+    static size_t GetSizeClass(size_t size) { return (size - 1) / Granularity; }
+    // Puts the block into the free list of the given class
+    void PushFree(void *mem, size_t size_class);
+
+    FreeBlock *_freeLists[ClassCount] = {};
+    std::vector<uint8_t*> _pages;
+    // Remaining unused space in the last page
+    uint8_t *_pageCur = nullptr;
+    uint8_t *_pageEnd = nullptr;
+    Stats _stats;
+};
+
+#endif // __AGS_EE_DYNOBJ__MANAGEDOBJECTALLOC_H
@@ -11,6 +11,7 @@
 // http://www.opensource.org/licenses/artistic-license-2.0.php
 //
 //=============================================================================
+#include <algorithm>
 #include <vector>
 #include <string.h>
 #include "ac/dynobj/managedobjectpool.h"
@@ -27,47 +28,134 @@ const auto SERIALIZE_BUFFER_SIZE = 10240;
 const auto GARBAGE_COLLECTION_INTERVAL = 1024;
 const auto RESERVED_SIZE = 2048;
 
+size_t ManagedObjectPool::AddressMap::GetBucket(const char *addr) const {
+    size_t h = (size_t)addr;
+    h ^= h >> 16;
+    h *= 0x45d9f3bu;
+    h ^= h >> 16;
+    return h & (buckets.size() - 1);
+}
+
+int32_t ManagedObjectPool::AddressMap::Find(const char *addr) const {
+    if (count == 0) { return 0; }
+    for (size_t i = GetBucket(addr); buckets[i].first; i = (i + 1) & (buckets.size() - 1)) {
+        if (buckets[i].first == addr) { return buckets[i].second; }
+    }
+    return 0;
+}
+
+void ManagedObjectPool::AddressMap::Insert(const char *addr, int32_t index) {
+    if ((count + 1) * 2 > buckets.size()) { Grow(); }
+    size_t i = GetBucket(addr);
+    for (; buckets[i].first; i = (i + 1) & (buckets.size() - 1)) {
+        if (buckets[i].first == addr) { return; } // keep the first registered
+    }
+    buckets[i] = std::make_pair(addr, index);
+    count++;
+}
+
+void ManagedObjectPool::AddressMap::Erase(const char *addr) {
+    if (count == 0) { return; }
+    const size_t mask = buckets.size() - 1;
+    size_t i = GetBucket(addr);
+    for (; buckets[i].first != addr; i = (i + 1) & mask) {
+        if (!buckets[i].first) { return; } // not found
+    }
+    // shift back the following entries of the same probe sequence,
+    // so that no searches would stop at the freed bucket
+    for (size_t j = (i + 1) & mask; buckets[j].first; j = (j + 1) & mask) {
+        const size_t home = GetBucket(buckets[j].first);
+        if (((j - home) & mask) >= ((j - i) & mask)) {
+            buckets[i] = buckets[j];
+            i = j;
+        }
+    }
+    buckets[i] = std::make_pair(nullptr, 0);
+    count--;
+}
+
+void ManagedObjectPool::AddressMap::Clear() {
+    std::fill(buckets.begin(), buckets.end(), std::make_pair((const char*)nullptr, 0));
+    count = 0;
+}
+
+void ManagedObjectPool::AddressMap::Grow() {
+    std::vector<std::pair<const char*, int32_t>> old_buckets(std::max<size_t>(buckets.size() * 2, RESERVED_SIZE * 2));
+    old_buckets.swap(buckets);
+    count = 0;
+    for (const auto &b : old_buckets) {
+        if (b.first) { Insert(b.first, b.second); }
+    }
+}
+
+int32_t ManagedObjectPool::Init(int32_t handle, const char *address, ICCDynamicObject *callback, ScriptValueType objType) {
+    const int32_t index = handle & HANDLE_INDEX_MASK;
+    if ((size_t)index >= objects.size()) {
+        objects.resize(index + 1024, ManagedObject());
+    }
+
+    auto & o = objects[index];
+    if (o.isUsed()) { cc_error("used: %d", o.handle); return 0; }
+
+    o = ManagedObject(objType, handle, address, callback);
+    // new object has no references yet
+    AddGcCandidate(o);
+    handleByAddress.Insert(address, index);
+    return o.handle;
+}
+
 int ManagedObjectPool::Remove(ManagedObject &o, bool force) {
     if (!o.isUsed()) { return 1; } // already removed
 
     bool canBeRemovedFromPool = o.callback->Dispose(o.addr, force) != 0;
     if (!(canBeRemovedFromPool || force)) { return 0; }
 
-    available_ids.push(o.handle);
-    handleByAddress.erase(o.addr);
+    const int32_t index = o.handle & HANDLE_INDEX_MASK;
+    const int32_t generation = ((o.handle >> HANDLE_INDEX_BITS) + 1) & HANDLE_GEN_MASK;
+    handleByAddress.Erase(o.addr);
     ManagedObjectLog("Line %d Disposed managed object handle=%d", currentline, o.handle);
     o = ManagedObject();
+    o.handle = (generation << HANDLE_INDEX_BITS) | index;
+    o.nextFree = freeIndex;
+    freeIndex = index;
     return 1;
 }
 
+void ManagedObjectPool::AddGcCandidate(ManagedObject &o) {
+    if (o.gcPending) { return; }
+    o.gcPending = true;
+    gcCandidates.push_back(o.handle);
+}
+
 int32_t ManagedObjectPool::AddRef(int32_t handle) {
-    if (handle < 0 || (size_t)handle >= objects.size()) { return 0; }
-    auto & o = objects[handle];
-    if (!o.isUsed()) { return 0; }
+    auto *o = GetObject(handle);
+    if (!o) { return 0; }
 
-    o.refCount += 1;
-    ManagedObjectLog("Line %d AddRef: handle=%d new refcount=%d", currentline, o.handle, o.refCount);
-    return o.refCount;
+    o->refCount += 1;
+    ManagedObjectLog("Line %d AddRef: handle=%d new refcount=%d", currentline, o->handle, o->refCount);
+    return o->refCount;
 }
 
 int ManagedObjectPool::CheckDispose(int32_t handle) {
-    if (handle < 0 || (size_t)handle >= objects.size()) { return 1; }
-    auto & o = objects[handle];
-    if (!o.isUsed()) { return 1; }
-    if (o.refCount >= 1) { return 0; }
-    return Remove(o);
+    auto *o = GetObject(handle);
+    if (!o) { return 1; }
+    if (o->refCount >= 1) { return 0; }
+    if (Remove(*o)) { return 1; }
+    AddGcCandidate(*o);
+    return 0;
 }
 
 int32_t ManagedObjectPool::SubRef(int32_t handle) {
-    if (handle < 0 || (size_t)handle >= objects.size()) { return 0; }
-    auto & o = objects[handle];
-    if (!o.isUsed()) { return 0; }
+    auto *o = GetObject(handle);
+    if (!o) { return 0; }
 
-    o.refCount--;
-    auto newRefCount = o.refCount;
-    auto canBeDisposed = (o.addr != disableDisposeForObject);
+    o->refCount--;
+    auto newRefCount = o->refCount;
+    auto canBeDisposed = (o->addr != disableDisposeForObject);
     if (canBeDisposed) {
         CheckDispose(handle);
+    } else if (newRefCount < 1) {
+        AddGcCandidate(*o);
     }
     // object could be removed at this point, don't use any values.
     ManagedObjectLog("Line %d SubRef: handle=%d new refcount=%d canBeDisposed=%d", currentline, handle, newRefCount, canBeDisposed);
@@ -76,36 +164,34 @@ int32_t ManagedObjectPool::SubRef(int32_t handle) {
 
 int32_t ManagedObjectPool::AddressToHandle(const char *addr) {
     if (addr == nullptr) { return 0; }
-    auto it = handleByAddress.find(addr);
-    if (it == handleByAddress.end()) { return 0; }
-    return it->second;
+    int32_t index = handleByAddress.Find(addr);
+    if (index == 0) { return 0; }
+    return objects[index].handle;
 }
 
 // this function is called often (whenever a pointer is used)
 const char* ManagedObjectPool::HandleToAddress(int32_t handle) {
-    if (handle < 0 || (size_t)handle >= objects.size()) { return nullptr; }
-    auto & o = objects[handle];
-    if (!o.isUsed()) { return nullptr; }
-    return o.addr;
+    auto *o = GetObject(handle);
+    if (!o) { return nullptr; }
+    return o->addr;
 }
 
 // this function is called often (whenever a pointer is used)
 ScriptValueType ManagedObjectPool::HandleToAddressAndManager(int32_t handle, void *&object, ICCDynamicObject *&manager) {
-    if (handle < 0 || (size_t)handle >= objects.size()) { return kScValUndefined; }
-    auto & o = objects[handle];
-    if (!o.isUsed()) { return kScValUndefined; }
+    auto *o = GetObject(handle);
+    if (!o) { return kScValUndefined; }
 
-    object = (void *)o.addr;  // WARNING: This strips the const from the char* pointer.
-    manager = o.callback;
-    return o.obj_type;
+    object = (void *)o->addr;  // WARNING: This strips the const from the char* pointer.
+    manager = o->callback;
+    return o->obj_type;
 }
 
 int ManagedObjectPool::RemoveObject(const char *address) {
     if (address == nullptr) { return 0; }
-    auto it = handleByAddress.find(address);
-    if (it == handleByAddress.end()) { return 0; }
+    int32_t index = handleByAddress.Find(address);
+    if (index == 0) { return 0; }
 
-    auto & o = objects[it->second];
+    auto & o = objects[index];
     return Remove(o, true);
 }
 
@@ -118,57 +204,55 @@ void ManagedObjectPool::RunGarbageCollectionIfAppropriate()
 
 void ManagedObjectPool::RunGarbageCollection()
 {
-    for (int i = 1; i < nextHandle; i++) {
-        auto & o = objects[i];
-        if (!o.isUsed()) { continue; }
-        if (o.refCount < 1) {
-            Remove(o);
+    // Only check the objects that had no references at some point; those
+    // which may not be disposed yet are kept in the list for the next time.
+    // NOTE: disposing an object may add new candidates to the list's end.
+    size_t keep = 0;
+    for (size_t i = 0; i < gcCandidates.size(); i++) {
+        const int32_t handle = gcCandidates[i];
+        auto *o = GetObject(handle);
+        if (!o) { continue; } // already removed
+        if (o->refCount >= 1) {
+            o->gcPending = false;
+            continue;
+        }
+        if (!Remove(*o)) {
+            gcCandidates[keep++] = handle;
         }
     }
+    gcCandidates.resize(keep);
     ManagedObjectLog("Ran garbage collection");
 }
 
 int ManagedObjectPool::AddObject(const char *address, ICCDynamicObject *callback, bool plugin_object) 
 {
-    int32_t handle;
-
-    if (!available_ids.empty()) {
-        handle = available_ids.front();
-        available_ids.pop();
+    int32_t index;
+    if (freeIndex > 0) {
+        index = freeIndex;
+        freeIndex = objects[index].nextFree;
     } else {
-        handle = nextHandle++;
-        if ((size_t)handle >= objects.size()) {
-           objects.resize(handle + 1024, ManagedObject());
-        }
+        if (nextIndex > HANDLE_INDEX_MASK) { cc_error("too many managed objects"); return 0; }
+        index = nextIndex++;
     }
 
-    auto & o = objects[handle];
-    if (o.isUsed()) { cc_error("used: %d", handle); return 0; }
-
-    o = ManagedObject(plugin_object ? kScValPluginObject : kScValDynamicObject, handle, address, callback);
-
-    handleByAddress.insert({address, o.handle});
+    // the free slot keeps its next handle, the new one starts with generation 0
+    const int32_t handle = ((size_t)index < objects.size()) ?
+        ((objects[index].handle & ~HANDLE_INDEX_MASK) | index) : index;
+    if (Init(handle, address, callback, plugin_object ? kScValPluginObject : kScValDynamicObject) == 0) { return 0; }
     objectCreationCounter++;
     ManagedObjectLog("Allocated managed object handle=%d, type=%s", handle, callback->GetType());
-    return o.handle;
+    return handle;
 }
 
 
 int ManagedObjectPool::AddUnserializedObject(const char *address, ICCDynamicObject *callback, bool plugin_object, int handle) 
 {
-    if (handle < 0) { cc_error("Attempt to assign invalid handle: %d", handle); return 0; }
-    if ((size_t)handle >= objects.size()) {
-        objects.resize(handle + 1024, ManagedObject());
-    }
-
-    auto & o = objects[handle];
-    if (o.isUsed()) { cc_error("bad save. used: %d", o.handle); return 0; }
-
-    o = ManagedObject(plugin_object ? kScValPluginObject : kScValDynamicObject, handle, address, callback);
+    if (handle <= 0) { cc_error("Attempt to assign invalid handle: %d", handle); return 0; }
 
-    handleByAddress.insert({address, o.handle});
-    ManagedObjectLog("Allocated unserialized managed object handle=%d, type=%s", o.handle, callback->GetType());
-    return o.handle;
+    if (Init(handle, address, callback, plugin_object ? kScValPluginObject : kScValDynamicObject) == 0) { return 0; }
+    nextIndex = std::max(nextIndex, (handle & HANDLE_INDEX_MASK) + 1);
+    ManagedObjectLog("Allocated unserialized managed object handle=%d, type=%s", handle, callback->GetType());
+    return handle;
 }
 
 void ManagedObjectPool::WriteToDisk(Stream *out) {
@@ -180,10 +264,10 @@ void ManagedObjectPool::WriteToDisk(Stream *out) {
     serializeBuffer.resize(SERIALIZE_BUFFER_SIZE);
 
     out->WriteInt32(OBJECT_CACHE_MAGIC_NUMBER);
-    out->WriteInt32(2);  // version
+    out->WriteInt32(3);  // version
 
     int size = 0;
-    for (int i = 1; i < nextHandle; i++) {
+    for (int i = 1; i < nextIndex; i++) {
         auto const & o = objects[i];
         if (o.isUsed()) { 
             size += 1;
@@ -191,7 +275,7 @@ void ManagedObjectPool::WriteToDisk(Stream *out) {
     }
     out->WriteInt32(size);
 
-    for (int i = 1; i < nextHandle; i++) {
+    for (int i = 1; i < nextIndex; i++) {
         auto const & o = objects[i];
         if (!o.isUsed()) { continue; }
 
@@ -253,6 +337,7 @@ int ManagedObjectPool::ReadFromDisk(Stream *in, ICCObjectReader *reader) {
             }
             break;
         case 2:
+        case 3: // same as 2, but handles contain slot generation
             {
                 // This is actually number of objects written.
                 int objectsSize = in->ReadInt32();
@@ -271,7 +356,9 @@ int ManagedObjectPool::ReadFromDisk(Stream *in, ICCObjectReader *reader) {
                     } else {
                         reader->Unserialize(handle, typeNameBuffer, &serializeBuffer.front(), numBytes);
                     }
-                    objects[handle].refCount = in->ReadInt32();
+                    const int refCount = in->ReadInt32();
+                    auto *o = GetObject(handle);
+                    if (o) { o->refCount = refCount; }
                     ManagedObjectLog("Read handle = %d", objects[i].handle);
                 }
             }
@@ -282,36 +369,54 @@ int ManagedObjectPool::ReadFromDisk(Stream *in, ICCObjectReader *reader) {
     }
 
     // re-adjust next handles. (in case saved in random order)
-    while (!available_ids.empty()) { available_ids.pop(); }
-    nextHandle = 1;
+    RebuildFreeList();
+    return 0;
+}
 
-    for (const auto &o : objects) {
-        if (o.isUsed()) { 
-            nextHandle = o.handle + 1;
+void ManagedObjectPool::RebuildFreeList() {
+    nextIndex = 1;
+    for (size_t i = objects.size(); i > 1; i--) {
+        if (objects[i - 1].isUsed()) {
+            nextIndex = static_cast<int32_t>(i);
+            break;
         }
     }
-    for (int i = 1; i < nextHandle; i++) {
+    freeIndex = 0;
+    for (int32_t i = nextIndex - 1; i >= 1; i--) {
         if (!objects[i].isUsed()) {
-            available_ids.push(i);
+            objects[i].nextFree = freeIndex;
+            freeIndex = i;
         }
     }
-
-    return 0;
 }
 
 // de-allocate all objects
 void ManagedObjectPool::reset() {
-    for (int i = 1; i < nextHandle; i++) {
+    for (int i = 1; i < nextIndex; i++) {
         auto & o = objects[i];
         if (!o.isUsed()) { continue; }
         Remove(o, true);
     }
-    while (!available_ids.empty()) { available_ids.pop(); }
-    nextHandle = 1;
+    // keep the slot generations, in case there are stale handles left
+    nextIndex = 1;
+    freeIndex = 0;
+    handleByAddress.Clear();
+    gcCandidates.clear();
+    for (auto & o : objects) { o.gcPending = false; }
+    LogMemoryStats();
+}
+
+void ManagedObjectPool::LogMemoryStats() {
+    const auto &stats = objectMemory.GetStats();
+    Debug::Printf(kDbgGroup_ManObj, kDbgMsg_Info,
+        "Managed object memory: allocated %llu (reused %llu, large %llu), freed %llu, in use %zu, pages %zu KB",
+        static_cast<unsigned long long>(stats.Allocated), static_cast<unsigned long long>(stats.Reused),
+        static_cast<unsigned long long>(stats.Large), static_cast<unsigned long long>(stats.Freed),
+        stats.InUse, stats.PageMemory / 1024);
 }
 
-ManagedObjectPool::ManagedObjectPool() : objectCreationCounter(0), nextHandle(1), available_ids(), objects(RESERVED_SIZE, ManagedObject()), handleByAddress() {
-    handleByAddress.reserve(RESERVED_SIZE);
+ManagedObjectPool::ManagedObjectPool() : objectCreationCounter(0), objects(RESERVED_SIZE, ManagedObject()), nextIndex(1), freeIndex(0) {
+    gcCandidates.reserve(RESERVED_SIZE);
 }
 
 ManagedObjectPool pool;
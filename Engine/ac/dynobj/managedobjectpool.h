@@ -16,46 +16,89 @@
 #define __CC_MANAGEDOBJECTPOOL_H
 
 #include <vector>
-#include <queue>
-#include <unordered_map>
 
 #include "script/runtimescriptvalue.h"
 #include "ac/dynobj/cc_dynamicobject.h"   // ICCDynamicObject
+#include "ac/dynobj/managedobjectalloc.h"
 
 namespace AGS { namespace Common { class Stream; }}
 using namespace AGS; // FIXME later
 
+// ManagedObjectPool keeps the objects in a "slot map". The object's handle
+// consists of its slot index and the slot's generation, which is incremented
+// each time the slot is freed; this way a stale handle to the disposed object
+// never refers to another object that took the same slot.
 struct ManagedObjectPool final {
 private:
-    // TODO: find out if we can make handle size_t
+    static const int32_t HANDLE_INDEX_BITS = 22;
+    static const int32_t HANDLE_INDEX_MASK = (1 << HANDLE_INDEX_BITS) - 1;
+    static const int32_t HANDLE_GEN_MASK = INT32_MAX >> HANDLE_INDEX_BITS;
+
     struct ManagedObject {
         ScriptValueType obj_type;
+        // for the free slot, this is the handle which it will be assigned next
         int32_t handle;
         // TODO: this makes no sense having this as "const char*",
         // void* will be proper (and in all related functions)
         const char *addr;
         ICCDynamicObject *callback;
         int refCount;
+        int32_t nextFree; // next free slot index, if this slot is free
+        bool gcPending; // whether the handle is in the gc candidates list
 
         bool isUsed() const { return obj_type != kScValUndefined; }
 
         ManagedObject() 
-            : obj_type(kScValUndefined), handle(0), addr(nullptr), callback(nullptr), refCount(0) {}
+            : obj_type(kScValUndefined), handle(0), addr(nullptr), callback(nullptr), refCount(0), nextFree(0), gcPending(false) {}
         ManagedObject(ScriptValueType obj_type, int32_t handle, const char *addr, ICCDynamicObject * callback) 
-            : obj_type(obj_type), handle(handle), addr(addr), callback(callback), refCount(0) {}
+            : obj_type(obj_type), handle(handle), addr(addr), callback(callback), refCount(0), nextFree(0), gcPending(false) {}
     };
 
-    int objectCreationCounter;  // used to do garbage collection every so often
+    // Maps object addresses to the slot indexes. This is an open-addressing
+    // hash table, which does not allocate anything per entry.
+    struct AddressMap {
+        int32_t Find(const char *addr) const;
+        void Insert(const char *addr, int32_t index);
+        void Erase(const char *addr);
+        void Clear();
+    private:
+        size_t GetBucket(const char *addr) const;
+        void Grow();
+
+        std::vector<std::pair<const char*, int32_t>> buckets;
+        size_t count = 0u;
+    };
 
-    int32_t nextHandle {}; // TODO: manage nextHandle's going over INT32_MAX !
-    std::queue<int32_t> available_ids;
-    std::vector<ManagedObject> objects;
-    std::unordered_map<const char *, int32_t> handleByAddress;
+    int objectCreationCounter;  // used to do garbage collection every so often
 
-    void Init(int32_t theHandle, const char *theAddress, ICCDynamicObject *theCallback, ScriptValueType objType);
+    std::vector<ManagedObject> objects; // slot 0 is never used, as 0 is a null handle
+    int32_t nextIndex; // first never used slot index
+    int32_t freeIndex; // head of the free slots list, 0 if there are none
+    AddressMap handleByAddress;
+    // Handles of the objects which may be disposed by the garbage collection:
+    // those never referenced, or left without references but not disposed
+    std::vector<int32_t> gcCandidates;
+    // Memory for the objects which are allocated along with their data;
+    // the blocks are returned to it when these objects are disposed
+    ManagedObjectAllocator objectMemory;
+
+    // Returns the used object by its handle, or null if the handle is not valid
+    inline ManagedObject *GetObject(int32_t handle) {
+        const size_t index = handle & HANDLE_INDEX_MASK;
+        if (handle <= 0 || index >= objects.size()) { return nullptr; }
+        auto & o = objects[index];
+        return (o.isUsed() && o.handle == handle) ? &o : nullptr;
+    }
+    // Adds the object to the given slot, which must not be used
+    int32_t Init(int32_t handle, const char *address, ICCDynamicObject *callback, ScriptValueType objType);
     int Remove(ManagedObject &o, bool force = false); 
+    void AddGcCandidate(ManagedObject &o);
+    // Finds the last used slot and links all the free slots before it
+    void RebuildFreeList();
 
     void RunGarbageCollection();
+    // Prints object memory allocation counters to the log
+    void LogMemoryStats();
 
 public:
 
@@ -74,6 +117,11 @@ public:
     void reset();
     ManagedObjectPool();
 
+    // Allocates memory for the object, which is co-allocated with its data
+    void *AllocObjectMemory(size_t size) { return objectMemory.Allocate(size); }
+    // Frees the object's memory; size must be same as when allocated
+    void FreeObjectMemory(void *mem, size_t size) { objectMemory.Free(mem, size); }
+
     const char* disableDisposeForObject {nullptr};
 };
 
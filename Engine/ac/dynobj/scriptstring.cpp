@@ -12,8 +12,8 @@
 //
 //=============================================================================
 #include "ac/dynobj/scriptstring.h"
-#include <stdlib.h>
 #include <string.h>
+#include <new>
 #include "ac/string.h"
 #include "util/stream.h"
 
@@ -24,13 +24,25 @@ DynObjectRef ScriptString::CreateString(const char *fromText) {
     return CreateNewScriptStringObj(fromText);
 }
 
+ScriptString *ScriptString::Create(const char *text) {
+    const size_t len = strlen(text);
+    ScriptString *str = CreateBuffer(len);
+    memcpy(str->_text, text, len + 1);
+    return str;
+}
+
+ScriptString *ScriptString::CreateBuffer(size_t len) {
+    void *mem = ccAllocObjectMemory(sizeof(ScriptString) + len + 1);
+    char *text = static_cast<char*>(mem) + sizeof(ScriptString);
+    text[len] = 0;
+    return new (mem) ScriptString(text, len);
+}
+
 int ScriptString::Dispose(const char* /*address*/, bool /*force*/) {
-    // always dispose
-    if (_text) {
-        free(_text);
-        _text = nullptr;
-    }
-    delete this;
+    // always dispose; the text is kept in the same memory block
+    const size_t mem_size = sizeof(ScriptString) + _len + 1;
+    this->~ScriptString();
+    ccFreeObjectMemory(this, mem_size);
     return 1;
 }
 
@@ -50,28 +62,9 @@ void ScriptString::Serialize(const char* /*address*/, Stream *out) {
 }
 
 void ScriptString::Unserialize(int index, Stream *in, size_t /*data_sz*/) {
-    _len = in->ReadInt32();
-    _text = (char*)malloc(_len + 1);
-    in->Read(_text, _len + 1);
-    _text[_len] = 0; // for safety
-    ccRegisterUnserializedObject(index, _text, this);
-}
-
-ScriptString::ScriptString(const char *text) {
-    _len = strlen(text);
-    _text = (char*)malloc(_len + 1);
-    memcpy(_text, text, _len + 1);
-}
-
-ScriptString::ScriptString(char *text, bool take_ownership) {
-    _len = strlen(text);
-    if (take_ownership)
-    {
-        _text = text;
-    }
-    else
-    {
-        _text = (char*)malloc(_len + 1);
-        memcpy(_text, text, _len + 1);
-    }
+    const size_t len = in->ReadInt32();
+    ScriptString *str = CreateBuffer(len);
+    in->Read(str->_text, len + 1);
+    str->_text[len] = 0; // for safety
+    ccRegisterUnserializedObject(index, str->_text, str);
 }
@@ -19,13 +19,21 @@
 struct ScriptString final : AGSCCDynamicObject, ICCStringClass {
     int Dispose(const char *address, bool force) override;
     const char *GetType() override;
+    // Creates and registers a new string object from the serialized data;
+    // the object which this is called on is not affected
     void Unserialize(int index, AGS::Common::Stream *in, size_t data_sz) override;
 
     DynObjectRef CreateString(const char *fromText) override;
 
+    // Creates a new unregistered string object with a copy of the text
+    static ScriptString *Create(const char *text);
+    // Creates a new unregistered string object with the text buffer of
+    // the given length (not counting null terminator); the caller must
+    // write exactly this number of chars into the buffer.
+    // The text buffer is allocated in the same memory block as the object.
+    static ScriptString *CreateBuffer(size_t len);
+
     ScriptString() = default;
-    ScriptString(const char *text);
-    ScriptString(char *text, bool take_ownership);
     char *GetTextPtr() const { return _text; }
 
 protected:
@@ -35,8 +43,8 @@ protected:
     void Serialize(const char *address, AGS::Common::Stream *out) override;
 
 private:
-    // TODO: the preallocated text buffer may be assigned externally;
-    // find out if it's possible to refactor while keeping same functionality
+    ScriptString(char *text, size_t len) : _text(text), _len(len) {}
+
     char *_text = nullptr;
     size_t _len = 0;
 };
@@ -12,6 +12,7 @@
 //
 //=============================================================================
 #include <memory.h>
+#include <new>
 #include "scriptuserobject.h"
 #include "util/stream.h"
 
@@ -23,46 +24,35 @@ const char *ScriptUserObject::GetType()
     return "UserObject";
 }
 
-ScriptUserObject::ScriptUserObject()
-    : _size(0)
-    , _data(nullptr)
+/* static */ ScriptUserObject *ScriptUserObject::Create(size_t size)
 {
-}
-
-ScriptUserObject::~ScriptUserObject()
-{
-    delete [] _data;
+    // The data follows the object in the same memory block
+    void *mem = ccAllocObjectMemory(sizeof(ScriptUserObject) + size);
+    char *data = static_cast<char*>(mem) + sizeof(ScriptUserObject);
+    return new (mem) ScriptUserObject(data, size);
 }
 
 /* static */ ScriptUserObject *ScriptUserObject::CreateManaged(size_t size)
 {
-    ScriptUserObject *suo = new ScriptUserObject();
-    suo->Create(nullptr, nullptr, size);
+    ScriptUserObject *suo = Create(size);
+    memset(suo->_data, 0, size);
     ccRegisterManagedObject(suo, suo);
     return suo;
 }
 
-void ScriptUserObject::Create(const char *data, Stream *in, size_t size)
+/* static */ ScriptUserObject *ScriptUserObject::CreateUnserialized(int index, Stream *in, size_t data_sz)
 {
-    delete [] _data;
-    _data = nullptr;
-
-    _size = size;
-    if (_size > 0)
-    {
-        _data = new char[size];
-        if (data)
-            memcpy(_data, data, _size);
-        else if (in)
-            in->Read(_data, _size);
-        else
-            memset(_data, 0, _size);
-    }
+    ScriptUserObject *suo = Create(data_sz);
+    in->Read(suo->_data, data_sz);
+    ccRegisterUnserializedObject(index, suo, suo);
+    return suo;
 }
 
 int ScriptUserObject::Dispose(const char* /*address*/, bool /*force*/)
 {
-    delete this;
+    const size_t mem_size = sizeof(ScriptUserObject) + _size;
+    this->~ScriptUserObject();
+    ccFreeObjectMemory(this, mem_size);
     return 1;
 }
 
@@ -76,12 +66,6 @@ int ScriptUserObject::Serialize(const char* /*address*/, char *buffer, int bufsi
     return _size;
 }
 
-void ScriptUserObject::Unserialize(int index, Stream *in, size_t data_sz)
-{
-    Create(nullptr, in, data_sz);
-    ccRegisterUnserializedObject(index, this, this);
-}
-
 const char* ScriptUserObject::GetFieldPtr(const char* /*address*/, intptr_t offset)
 {
     return _data + offset;
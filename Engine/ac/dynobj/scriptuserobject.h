@@ -22,15 +22,16 @@
 
 struct ScriptUserObject final : ICCDynamicObject
 {
-public:
-    ScriptUserObject();
-    
-protected:
-    virtual ~ScriptUserObject();
+private:
+    // Objects are allocated along with their data, use Create* functions
+    ScriptUserObject(char *data, int32_t size) : _size(size), _data(data) {}
+    ~ScriptUserObject() = default;
 
 public:
+    // Creates and registers a new managed object with zeroed data
     static ScriptUserObject *CreateManaged(size_t size);
-    void Create(const char *data, AGS::Common::Stream *in, size_t size);
+    // Creates and registers a new object, reading the data from the stream
+    static ScriptUserObject *CreateUnserialized(int index, AGS::Common::Stream *in, size_t data_sz);
 
     // return the type name of the object
     const char *GetType() override;
@@ -38,7 +39,6 @@ public:
     // serialize the object into BUFFER (which is BUFSIZE bytes)
     // return number of bytes used
     int Serialize(const char *address, char *buffer, int bufsize) override;
-    void Unserialize(int index, AGS::Common::Stream *in, size_t data_sz);
 
     // Support for reading and writing object values by their relative offset
     const char* GetFieldPtr(const char *address, intptr_t offset) override;
@@ -54,6 +54,9 @@ public:
     void    WriteFloat(const char *address, intptr_t offset, float val) override;
 
 private:
+    // Creates a new unregistered object with the uninitialized data
+    static ScriptUserObject *Create(size_t size);
+
     // NOTE: we use signed int for Size at the moment, because the managed
     // object interface's Serialize() function requires the object to return
     // negative value of size in case the provided buffer was not large
@@ -22,6 +22,7 @@
 #include "ac/path_helper.h"
 #include "ac/runtime_defines.h"
 #include "ac/string.h"
+#include "ac/dynobj/scriptstring.h"
 #include "debug/debug_log.h"
 #include "debug/debugger.h"
 #include "platform/base/agsplatformdriver.h"
@@ -166,10 +167,13 @@ const char* File_ReadStringBack(sc_File *fil) {
     return CreateNewScriptString("");;
   }
 
-  char *retVal = (char*)malloc(lle);
+  // the stored length includes the null terminator
+  ScriptString *str = ScriptString::CreateBuffer(lle - 1);
+  char *retVal = str->GetTextPtr();
   in->Read(retVal, lle);
+  retVal[lle - 1] = 0; // for safety
 
-  return CreateNewScriptString(retVal, false);
+  return CreateNewScriptString(str);
 }
 
 int File_ReadInt(sc_File *fil) {
@@ -616,7 +620,6 @@ Stream *get_valid_file_stream_from_handle(int32_t handle, const char *operation_
 #include "debug/out.h"
 #include "script/script_api.h"
 #include "script/script_runtime.h"
-#include "ac/dynobj/scriptstring.h"
 
 extern ScriptString myScriptStringImpl;
 
@@ -39,6 +39,7 @@
 #include "ac/overlay.h"
 #include "ac/path_helper.h"
 #include "ac/sys_events.h"
+#include "ac/roomareamap.h"
 #include "ac/roomstatus.h"
 #include "ac/spritecache.h"
 #include "ac/string.h"
@@ -1221,7 +1222,7 @@ int __GetLocationType(int xxx,int yyy, int allowHotspot0) {
 
     data_to_game_coords(&xxx, &yyy);
 
-    int wbat = thisroom.WalkBehindMask->GetPixel(xxx, yyy);
+    int wbat = get_room_area_map(kRoomAreaWalkBehind).GetArea(xxx, yyy);
 
     if (wbat <= 0) wbat = 0;
     else wbat = croom->walkbehind_base[wbat];
@@ -1469,9 +1470,9 @@ void game_sprite_updated(int sprnum)
         }
     }
     // overlays
-    for (auto &over : screenover)
+    for (auto &over : get_overlays())
     {
-        if (over.GetSpriteNum() == sprnum)
+        if (over.type >= 0 && over.GetSpriteNum() == sprnum)
             over.MarkChanged();
     }
 }
@@ -1539,9 +1540,9 @@ void game_sprite_deleted(int sprnum)
         }
     }
     // overlays
-    for (auto &over : screenover)
+    for (auto &over : get_overlays())
     {
-        if (over.GetSpriteNum() == sprnum)
+        if (over.type >= 0 && over.GetSpriteNum() == sprnum)
             over.SetSpriteNum(0);
     }
 }
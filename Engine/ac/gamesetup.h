@@ -81,10 +81,20 @@ struct GameSetup
     MouseSpeedDef mouse_speed_def;
     bool  RenderAtScreenRes; // render sprites at screen resolution, as opposed to native one
     int   Supersampling;
+    int   RenderThreads = 1; // number of threads to draw sprites on, 0 = choose automatically
     size_t SpriteCacheSize = 0u;
     size_t SoundLoadAtOnceSize = 1024u * 1024;
     size_t SoundCacheSize = 0u;
+    size_t SoundPcmClipSize = 0u; // max size of a decoded sound to keep in cache
+    size_t SoundPcmCacheSize = 0u;
+    size_t FontGlyphCacheSize = 0u; // max size of the rendered TTF glyphs cache
     bool  clear_cache_on_room_change; // for low-end devices: clear resource caches on room change
+    bool  prefetch_sprites = true; // load room's sprites in background when entering a room
+    bool  mmap_sprites = true; // memory-map uncompressed sprite file instead of reading it
+    bool  mmap_assets = true; // memory-map asset libraries, and read assets right from the memory
+    bool  script_predecode = true; // predecode script bytecode before running it
+    bool  script_profile = false; // profile scripts and write results on exit
+    String script_profile_path; // custom path to the script profile file
     bool  load_latest_save; // load latest saved game on launch
     ScreenRotation rotation;
     bool  show_fps;
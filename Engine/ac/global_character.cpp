@@ -548,18 +548,16 @@ void DisplaySpeechAt (int xx, int yy, int wii, int aschar, const char*spch) {
 
 int DisplaySpeechBackground(int charid, const char*speel) {
     // remove any previous background speech for this character
-    for (size_t i = 0; i < screenover.size();) {
-        if (screenover[i].bgSpeechForChar == charid)
-            remove_screen_overlay_index(i);
-        else
-            i++;
+    for (auto &over : get_overlays()) {
+        if (over.type >= 0 && over.bgSpeechForChar == charid)
+            remove_screen_overlay(over.type);
     }
 
     int ovrl=CreateTextOverlay(OVR_AUTOPLACE,charid,play.GetUIViewport().GetWidth()/2,FONT_SPEECH,
         -game.chars[charid].talkcolor, get_translation(speel), DISPLAYTEXT_NORMALOVERLAY);
 
-    int scid = find_overlay_of_type(ovrl);
-    screenover[scid].bgSpeechForChar = charid;
-    screenover[scid].timeout = GetTextDisplayTime(speel, 1);
+    auto *over = get_overlay(ovrl);
+    over->bgSpeechForChar = charid;
+    over->timeout = GetTextDisplayTime(speel, 1);
     return ovrl;
 }
@@ -17,10 +17,10 @@
 #include "ac/gamestate.h"
 #include "ac/region.h"
 #include "ac/room.h"
+#include "ac/roomareamap.h"
 #include "ac/roomstatus.h"
 #include "debug/debug_log.h"
 #include "game/roomstruct.h"
-#include "gfx/bitmap.h"
 #include "script/script.h"
 
 
@@ -38,19 +38,12 @@ int GetRegionIDAtRoom(int xxx, int yyy) {
     xxx = room_to_mask_coord(xxx);
     yyy = room_to_mask_coord(yyy);
 
+    const RoomAreaMap &regions = get_room_area_map(kRoomAreaRegion);
+    int hsthere;
     if (loaded_game_file_version >= kGameVersion_262) // Version 2.6.2+
-    {
-        if (xxx >= thisroom.RegionMask->GetWidth())
-            xxx = thisroom.RegionMask->GetWidth() - 1;
-        if (yyy >= thisroom.RegionMask->GetHeight())
-            yyy = thisroom.RegionMask->GetHeight() - 1;
-        if (xxx < 0)
-            xxx = 0;
-        if (yyy < 0)
-            yyy = 0;
-    }
-
-    int hsthere = thisroom.RegionMask->GetPixel (xxx, yyy);
+        hsthere = regions.GetAreaClamped(xxx, yyy);
+    else
+        hsthere = regions.GetArea(xxx, yyy);
     if (hsthere <= 0 || hsthere >= MAX_ROOM_REGIONS) return 0;
     if (croom->region_enabled[hsthere] == 0) return 0;
     return hsthere;
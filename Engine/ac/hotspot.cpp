@@ -19,6 +19,7 @@
 #include "ac/global_translation.h"
 #include "ac/properties.h"
 #include "ac/room.h"
+#include "ac/roomareamap.h"
 #include "ac/roomstatus.h"
 #include "ac/string.h"
 #include "game/roomstruct.h"
@@ -121,7 +122,7 @@ bool Hotspot_SetTextProperty(ScriptHotspot *hss, const char *property, const cha
 }
 
 int get_hotspot_at(int xpp,int ypp) {
-    int onhs=thisroom.HotspotMask->GetPixel(room_to_mask_coord(xpp), room_to_mask_coord(ypp));
+    int onhs=get_room_area_map(kRoomAreaHotspot).GetArea(room_to_mask_coord(xpp), room_to_mask_coord(ypp));
     if (onhs <= 0 || onhs >= MAX_ROOM_HOTSPOTS) return 0;
     if (!croom->hotspot[onhs].Enabled) return 0;
     return onhs;
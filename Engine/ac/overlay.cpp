@@ -13,6 +13,8 @@
 //=============================================================================
 #include "ac/overlay.h"
 #include <algorithm>
+#include <functional>
+#include <queue>
 #include "ac/common.h"
 #include "ac/view.h"
 #include "ac/character.h"
@@ -42,7 +44,36 @@ extern std::vector<ViewStruct> views;
 extern IGraphicsDriver *gfxDriver;
 
 
-std::vector<ScreenOverlay> screenover;
+// Overlays storage, indexed by the overlay type (id); unused slots have type -1
+static std::vector<ScreenOverlay> screenover;
+// Unused custom overlay ids below the storage size, lowest first;
+// may also contain ids which were taken since, these are skipped when met
+static std::priority_queue<int, std::vector<int>, std::greater<int>> over_free_ids;
+// Ids of the overlays on the screen and room layers, sorted by z-order
+// and then by id; kept sorted as overlays are added, removed or change z-order
+static std::vector<int> over_draw_order[2];
+
+// Tells if the first overlay is drawn before the second one
+static bool overlay_draws_before(int id1, int id2)
+{
+    const int z1 = screenover[id1].zorder, z2 = screenover[id2].zorder;
+    return (z1 < z2) || ((z1 == z2) && (id1 < id2));
+}
+
+static void add_to_draw_order(const ScreenOverlay &over)
+{
+    auto &list = over_draw_order[over.IsRoomLayer() ? 1 : 0];
+    list.insert(std::lower_bound(list.begin(), list.end(), over.type, overlay_draws_before), over.type);
+}
+
+// Must be called before the overlay's z-order or id change
+static void remove_from_draw_order(const ScreenOverlay &over)
+{
+    auto &list = over_draw_order[over.IsRoomLayer() ? 1 : 0];
+    auto it = std::lower_bound(list.begin(), list.end(), over.type, overlay_draws_before);
+    if ((it != list.end()) && (*it == over.type))
+        list.erase(it);
+}
 
 void Overlay_Remove(ScriptOverlay *sco) {
     sco->Remove();
@@ -273,7 +304,9 @@ void Overlay_SetZOrder(ScriptOverlay *scover, int zorder) {
     if (ovri < 0)
         quit("!invalid overlay ID specified");
 
+    remove_from_draw_order(screenover[ovri]);
     screenover[ovri].zorder = zorder;
+    add_to_draw_order(screenover[ovri]);
 }
 
 //=============================================================================
@@ -325,8 +358,8 @@ static void dispose_overlay(ScreenOverlay &over)
 
 void remove_screen_overlay_index(size_t over_idx)
 {
-    assert(over_idx < screenover.size());
-    if (over_idx >= screenover.size())
+    assert(over_idx < screenover.size() && screenover[over_idx].type >= 0);
+    if (over_idx >= screenover.size() || screenover[over_idx].type < 0)
         return; // something is wrong
     ScreenOverlay &over = screenover[over_idx];
     // TODO: move these custom settings outside of this function
@@ -350,42 +383,87 @@ void remove_screen_overlay_index(size_t over_idx)
     { // release internal ref for bg speech
         invalidate_and_subref(over);
     }
+    remove_from_draw_order(over);
     dispose_overlay(over);
-    screenover.erase(screenover.begin() + over_idx);
-    // if an overlay before the sierra-style speech one is removed, update the index
-    // TODO: this is bad, need more generic system to store overlay references
-    if ((size_t)face_talking > over_idx)
-        face_talking--;
+    over = ScreenOverlay();
+    over.type = -1;
+    if (over_idx > OVER_CUSTOM)
+        over_free_ids.push(over_idx);
 }
 
 void remove_screen_overlay(int type)
 {
-    for (size_t i = 0; i < screenover.size();)
+    if (type < 0)
     {
-        if (type < 0 || screenover[i].type == type)
-            remove_screen_overlay_index(i);
-        else
-            i++;
+        for (size_t i = 0; i < screenover.size(); ++i)
+        {
+            if (screenover[i].type >= 0)
+                remove_screen_overlay_index(i);
+        }
+        // all slots are free now, reset the storage
+        screenover.clear();
+        over_free_ids = decltype(over_free_ids)();
+        over_draw_order[0].clear();
+        over_draw_order[1].clear();
+    }
+    else if (get_overlay(type))
+    {
+        remove_screen_overlay_index(type);
     }
 }
 
 int find_overlay_of_type(int type)
 {
-    for (size_t i = 0; i < screenover.size(); ++i)
+    return get_overlay(type) ? type : -1;
+}
+
+ScreenOverlay *get_overlay(int type)
+{
+    return (type >= 0) && ((size_t)type < screenover.size()) && (screenover[type].type >= 0) ?
+        &screenover[type] : nullptr;
+}
+
+std::vector<ScreenOverlay> &get_overlays()
+{
+    return screenover;
+}
+
+// Makes sure that the storage has a slot for the given overlay id
+static void reserve_overlay_slot(int type)
+{
+    if ((size_t)type < screenover.size())
+        return;
+    const size_t old_size = screenover.size();
+    screenover.resize(type + 1);
+    for (size_t i = old_size; i < screenover.size(); ++i)
+    {
+        screenover[i].type = -1;
+        if ((i > OVER_CUSTOM) && (i < (size_t)type))
+            over_free_ids.push(i);
+    }
+}
+
+// Gets the lowest unused custom overlay id
+static int get_free_custom_overlay_id()
+{
+    while (!over_free_ids.empty())
     {
-        if (screenover[i].type == type) return i;
+        const int id = over_free_ids.top();
+        over_free_ids.pop();
+        if (((size_t)id < screenover.size()) && (screenover[id].type < 0))
+            return id;
     }
-    return -1;
+    return std::max<int>(screenover.size(), OVER_CUSTOM + 1);
 }
 
 size_t add_screen_overlay_impl(bool roomlayer, int x, int y, int type, int sprnum, Bitmap *piccy,
     int pic_offx, int pic_offy, bool has_alpha)
 {
     if (type == OVER_CUSTOM) {
-        // find an unused custom ID; TODO: find a better approach!
-        for (int id = OVER_CUSTOM + 1; (size_t)id <= screenover.size() + OVER_CUSTOM + 1; ++id) {
-            if (find_overlay_of_type(id) == -1) { type=id; break; }
-        }
+        type = get_free_custom_overlay_id();
+    } else if (get_overlay(type)) {
+        // only one overlay of each type may exist, replace previous one
+        remove_screen_overlay_index(type);
     }
     ScreenOverlay over;
     if (piccy)
@@ -430,8 +508,10 @@ size_t add_screen_overlay_impl(bool roomlayer, int x, int y, int type, int sprnu
         play.speech_face_schandle = over.associatedOverlayHandle;
     }
     over.MarkChanged();
-    screenover.push_back(std::move(over));
-    return screenover.size() - 1;
+    reserve_overlay_slot(type);
+    screenover[type] = std::move(over);
+    add_to_draw_order(screenover[type]);
+    return type;
 }
 
 size_t add_screen_overlay(bool roomlayer, int x, int y, int type, int sprnum)
@@ -494,10 +574,40 @@ Point get_overlay_position(const ScreenOverlay &over)
     }
 }
 
+const std::vector<int> &get_overlays_draw_order(bool room_layer)
+{
+    return over_draw_order[room_layer ? 1 : 0];
+}
+
+void restore_overlays(std::vector<ScreenOverlay> &&overs)
+{
+    remove_screen_overlay(-1);
+    for (auto &over : overs)
+    {
+        if (over.type < 0)
+            continue;
+        reserve_overlay_slot(over.type);
+        if (screenover[over.type].type >= 0)
+            continue; // duplicate overlay id, keep the first one
+        screenover[over.type] = std::move(over);
+    }
+    for (size_t i = 0; i < screenover.size(); ++i)
+    {
+        if (screenover[i].type >= 0)
+            over_draw_order[screenover[i].IsRoomLayer() ? 1 : 0].push_back(i);
+        else if (i > OVER_CUSTOM)
+            over_free_ids.push(i);
+    }
+    for (auto &list : over_draw_order)
+        std::sort(list.begin(), list.end(), overlay_draws_before);
+}
+
 void recreate_overlay_ddbs()
 {
     for (auto &over : screenover)
     {
+        if (over.type < 0)
+            continue;
         if (over.ddb)
             gfxDriver->DestroyDDB(over.ddb);
         over.ddb = nullptr; // is generated during first draw pass
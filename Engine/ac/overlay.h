@@ -38,10 +38,23 @@ ScreenOverlay *Overlay_CreateGraphicCore(bool room_layer, int x, int y, int slot
 ScreenOverlay *Overlay_CreateTextCore(bool room_layer, int x, int y, int width, int font, int text_color,
     const char *text, int disp_type, int allow_shrink);
 
+// Gets overlay's index in storage, which equals to its type (id); or -1 if not found
 int  find_overlay_of_type(int type);
+// Gets overlay of the given type (id), or null if not found
+ScreenOverlay *get_overlay(int type);
+// Gets the overlays storage; overlays are stored at the index equal to their
+// type (id), the unused slots have type -1 and should be skipped
+std::vector<ScreenOverlay> &get_overlays();
+// Gets the ids of overlays on the room or screen layer, sorted by z-order
+const std::vector<int> &get_overlays_draw_order(bool room_layer);
+// Removes all existing overlays and adds the restored ones
+void restore_overlays(std::vector<ScreenOverlay> &&overs);
+// Removes overlay of the given type (id), or all overlays if type is negative
 void remove_screen_overlay(int type);
 // Calculates overlay position in its respective layer (screen or room)
 Point get_overlay_position(const ScreenOverlay &over);
+// Adds overlay and returns its index in storage, which equals to its type (id);
+// if type is OVER_CUSTOM then a new unique id is assigned
 size_t add_screen_overlay(bool roomlayer, int x, int y, int type, int sprnum);
 size_t add_screen_overlay(bool roomlayer, int x, int y, int type, Common::Bitmap *piccy, bool has_alpha);
 size_t add_screen_overlay(bool roomlayer, int x, int y, int type, Common::Bitmap *piccy, int pic_offx, int pic_offy, bool has_alpha);
@@ -51,6 +64,4 @@ void remove_screen_overlay_index(size_t over_idx);
 ScriptOverlay* create_scriptoverlay(ScreenOverlay &over, bool internal_ref = false);
 void recreate_overlay_ddbs();
 
-
-extern std::vector<ScreenOverlay> screenover;
 #endif // __AGS_EE_AC__OVERLAY_H
@@ -37,15 +37,18 @@
 #include "ac/region.h"
 #include "ac/sys_events.h"
 #include "ac/room.h"
+#include "ac/roomareamap.h"
 #include "ac/roomobject.h"
 #include "ac/roomstatus.h"
 #include "ac/screen.h"
 #include "ac/string.h"
 #include "ac/system.h"
 #include "ac/walkablearea.h"
+#include "ac/view.h"
 #include "ac/walkbehind.h"
 #include "ac/dynobj/scriptobject.h"
 #include "ac/dynobj/scripthotspot.h"
+#include "gui/guibutton.h"
 #include "gui/guimain.h"
 #include "script/cc_instance.h"
 #include "debug/debug_log.h"
@@ -83,6 +86,7 @@ extern int our_eip;
 extern Bitmap *walkareabackup, *walkable_areas_temp;
 extern ScriptObject scrObj[MAX_ROOM_OBJECTS];
 extern SpriteCache spriteset;
+extern std::vector<ViewStruct> views;
 extern int in_new_room, new_room_was;  // 1 in new room, 2 first time in new room, 3 loading saved game
 extern ScriptHotspot scrHotspot[MAX_ROOM_HOTSPOTS];
 extern int in_leaves_screen;
@@ -448,6 +452,65 @@ static void reset_temp_room()
     troom = RoomStatus();
 }
 
+// Schedules sprites that are likely to be displayed right after entering
+// the room for loading in background: graphics of the room's characters and
+// objects, and of the visible GUI. Sprites are listed in the order of priority,
+// as the sprite cache will skip ones that don't fit into its limit.
+static void prefetch_room_sprites(int newnum)
+{
+    std::vector<sprkey_t> sprites;
+    auto add_view = [&sprites](int view)
+    {
+        if (view < 0 || view >= game.numviews)
+            return;
+        for (const auto &loop : views[view].loops)
+            for (int i = 0; i < loop.numFrames; ++i)
+                sprites.push_back(loop.frames[i].pic);
+    };
+
+    // Current graphics first
+    for (int i = 0; i < game.numcharacters; ++i)
+    {
+        if (game.chars[i].room == newnum)
+            add_view(game.chars[i].view);
+    }
+    for (uint32_t i = 0; i < croom->numobj; ++i)
+    {
+        const auto &obj = croom->obj[i];
+        sprites.push_back(obj.num);
+        if (obj.view != RoomObject::NoView)
+            add_view(obj.view);
+    }
+    for (const auto &gui : guis)
+    {
+        if (gui.IsVisible() && gui.BgImage > 0)
+            sprites.push_back(gui.BgImage);
+    }
+    for (const auto &btn : guibuts)
+    {
+        if (btn.ParentId < 0 || (size_t)btn.ParentId >= guis.size() ||
+            !guis[btn.ParentId].IsVisible() || !btn.IsVisible())
+            continue;
+        sprites.push_back(btn.Image);
+        sprites.push_back(btn.MouseOverImage);
+        sprites.push_back(btn.PushedImage);
+    }
+    // Then the characters' animations which may get used soon
+    for (int i = 0; i < game.numcharacters; ++i)
+    {
+        const auto &chi = game.chars[i];
+        if (chi.room != newnum)
+            continue;
+        if (chi.defview != chi.view)
+            add_view(chi.defview);
+        add_view(chi.talkview);
+        add_view(chi.idleview);
+    }
+
+    spriteset.CancelPrefetch(); // drop anything left from the previous room
+    spriteset.PrefetchSprites(sprites);
+}
+
 // forchar = playerchar on NewRoom, or NULL if restore saved game
 void load_new_room(int newnum, CharacterInfo*forchar) {
 
@@ -549,6 +612,7 @@ void load_new_room(int newnum, CharacterInfo*forchar) {
 
     our_eip=204;
     update_polled_stuff_if_runtime();
+    update_room_area_maps();
     redo_walkable_areas();
     update_polled_stuff_if_runtime();
     walkbehinds_recalc();
@@ -868,6 +932,9 @@ void load_new_room(int newnum, CharacterInfo*forchar) {
     }
     color_map = nullptr;
 
+    if (usetup.prefetch_sprites)
+        prefetch_room_sprites(newnum);
+
     our_eip = 209;
     update_polled_stuff_if_runtime();
     generate_light_table();
@@ -966,6 +1033,7 @@ void set_room_placeholder()
     thisroom.RegionMask = dummy_bg;
     thisroom.WalkAreaMask = dummy_bg;
     thisroom.WalkBehindMask = dummy_bg;
+    update_room_area_maps();
 
     reset_temp_room();
     croom = &troom;
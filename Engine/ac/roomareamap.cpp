@@ -0,0 +1,144 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+#include "ac/roomareamap.h"
+#include <string.h>
+
+using namespace AGS::Common;
+
+extern RoomStruct thisroom;
+
+// Lookup maps for the current room's masks, indexed by RoomAreaMask
+static RoomAreaMap room_area_maps[kRoomAreaRegion + 1];
+// Masks which were given away, and have to be read directly; the references
+// are kept so that the detached maps never point to the deleted bitmap
+static PBitmap room_area_maps_detached[kRoomAreaRegion + 1];
+
+
+void RoomAreaMap::Build(const Bitmap *mask, int area_count)
+{
+    assert(mask->GetColorDepth() == 8);
+    _detachedMask = nullptr;
+    _width = mask->GetWidth();
+    _height = mask->GetHeight();
+    _cells.resize(_width * _height);
+    _bounds.assign(std::max(0, area_count), Rect());
+    _areaCount = 0;
+
+    for (int y = 0; y < _height; ++y)
+    {
+        const uint8_t *src = mask->GetScanLine(y);
+        uint8_t *dst = &_cells[y * _width];
+        memcpy(dst, src, _width);
+        for (int x = 0; x < _width; ++x)
+        {
+            const int area = dst[x];
+            // Valid areas start with index 1, 0 = no area
+            if ((area < 1) || (area >= area_count))
+                continue;
+            Rect &r = _bounds[area];
+            if (r.Right < r.Left)
+            {
+                r = Rect(x, y, x, y);
+                _areaCount++;
+                continue;
+            }
+            r.Left = std::min(x, r.Left);
+            r.Right = std::max(x, r.Right);
+            r.Bottom = y; // rows are scanned top to bottom
+        }
+    }
+}
+
+void RoomAreaMap::Detach(const Bitmap *mask)
+{
+    _detachedMask = mask;
+    _width = mask->GetWidth();
+    _height = mask->GetHeight();
+    _cells.clear();
+    _cells.shrink_to_fit();
+}
+
+void RoomAreaMap::Reset()
+{
+    _detachedMask = nullptr;
+    _width = 0;
+    _height = 0;
+    _areaCount = 0;
+    _cells.clear();
+    _bounds.clear();
+}
+
+
+// Returns number of area indexes allowed on the mask (including 0)
+static int get_room_area_limit(RoomAreaMask mask)
+{
+    switch (mask)
+    {
+    case kRoomAreaHotspot: return MAX_ROOM_HOTSPOTS;
+    case kRoomAreaWalkBehind: return MAX_WALK_BEHINDS;
+    case kRoomAreaWalkable: return MAX_WALK_AREAS + 1;
+    case kRoomAreaRegion: return MAX_ROOM_REGIONS;
+    default: return 0;
+    }
+}
+
+const RoomAreaMap &get_room_area_map(RoomAreaMask mask)
+{
+    assert(mask > kRoomAreaNone && mask <= kRoomAreaRegion);
+    return room_area_maps[mask];
+}
+
+void update_room_area_map(RoomAreaMask mask)
+{
+    if (mask <= kRoomAreaNone || mask > kRoomAreaRegion)
+        return;
+    const Bitmap *bmp = thisroom.GetMask(mask);
+    if (!bmp)
+    {
+        room_area_maps[mask].Reset();
+        return;
+    }
+    // Area bounds are still gathered for the detached masks
+    room_area_maps[mask].Build(bmp, get_room_area_limit(mask));
+    if (room_area_maps_detached[mask])
+        room_area_maps[mask].Detach(room_area_maps_detached[mask].get());
+}
+
+void update_room_area_maps()
+{
+    for (int mask = kRoomAreaNone + 1; mask <= kRoomAreaRegion; ++mask)
+    {
+        room_area_maps_detached[mask].reset();
+        update_room_area_map(static_cast<RoomAreaMask>(mask));
+    }
+}
+
+void detach_room_area_map(RoomAreaMask mask)
+{
+    if (mask <= kRoomAreaNone || mask > kRoomAreaRegion)
+        return;
+    PBitmap bmp;
+    switch (mask)
+    {
+    case kRoomAreaHotspot: bmp = thisroom.HotspotMask; break;
+    case kRoomAreaWalkBehind: bmp = thisroom.WalkBehindMask; break;
+    case kRoomAreaWalkable: bmp = thisroom.WalkAreaMask; break;
+    case kRoomAreaRegion: bmp = thisroom.RegionMask; break;
+    default: break;
+    }
+    if (!bmp)
+        return;
+    room_area_maps_detached[mask] = bmp;
+    room_area_maps[mask].Detach(bmp.get());
+}
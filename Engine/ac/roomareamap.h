@@ -0,0 +1,111 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// RoomAreaMap is a lookup table made from the room area mask: it keeps
+// a byte per mask pixel in one contiguous array, along with the bounding
+// boxes of each area found on the mask. Area tests done by the engine
+// every frame (regions under characters, walkable areas, walk-behinds)
+// use these maps instead of reading the mask bitmaps pixel by pixel.
+//
+// The maps are built when the room is loaded, and must be rebuilt whenever
+// the mask bitmap is changed (by script drawing or walkable area toggling).
+//
+//=============================================================================
+#ifndef __AGS_EE_AC__ROOMAREAMAP_H
+#define __AGS_EE_AC__ROOMAREAMAP_H
+
+#include <algorithm>
+#include <vector>
+#include "game/roomstruct.h"
+#include "gfx/bitmap.h"
+#include "util/geometry.h"
+
+class RoomAreaMap
+{
+public:
+    // Builds the lookup from the 8-bit mask; bounding boxes are only
+    // gathered for the area indexes in range [1, area_count)
+    void Build(const AGS::Common::Bitmap *mask, int area_count);
+    // Drops the lookup and makes all the queries read the given mask
+    // directly; used when the mask may be changed outside of engine's control.
+    // Area bounds are kept as they were found by the last Build.
+    void Detach(const AGS::Common::Bitmap *mask);
+    // Clears the map; all positions are reported as outside of the mask
+    void Reset();
+
+    inline int GetWidth() const { return _width; }
+    inline int GetHeight() const { return _height; }
+    // Tells whether there are no areas on this map at all;
+    // detached map is never reported empty, as its mask may change any time
+    inline bool IsEmpty() const { return (_areaCount == 0) && !_detachedMask; }
+
+    // Returns the area index at the given mask position,
+    // or -1 if the position is outside of the mask
+    inline int GetArea(int x, int y) const
+    {
+        if (_detachedMask)
+            return _detachedMask->GetPixel(x, y);
+        if ((static_cast<unsigned>(x) >= static_cast<unsigned>(_width)) ||
+            (static_cast<unsigned>(y) >= static_cast<unsigned>(_height)))
+            return -1;
+        return _cells[y * _width + x];
+    }
+    // Returns the area index at the given mask position,
+    // clamping position to the mask bounds
+    inline int GetAreaClamped(int x, int y) const
+    {
+        x = std::max(0, std::min(x, _width - 1));
+        y = std::max(0, std::min(y, _height - 1));
+        return GetArea(x, y);
+    }
+    // Returns a pointer to the mask row; row must be within the mask bounds
+    inline const uint8_t *GetRow(int y) const
+    {
+        return _detachedMask ? _detachedMask->GetScanLine(y) : &_cells[y * _width];
+    }
+
+    // Tells whether the area is present on the mask
+    inline bool HasArea(int area) const
+    {
+        return (area > 0) && (static_cast<size_t>(area) < _bounds.size()) &&
+            (_bounds[area].Right >= _bounds[area].Left);
+    }
+    // Returns the bounding box of the area, in mask coordinates;
+    // the rectangle is invalid (Right < Left) if the area is not present
+    inline Rect GetAreaBounds(int area) const
+    {
+        return HasArea(area) ? _bounds[area] : Rect();
+    }
+
+private:
+    int _width = 0;
+    int _height = 0;
+    int _areaCount = 0; // number of areas actually present on mask
+    std::vector<uint8_t> _cells;
+    std::vector<Rect> _bounds;
+    const AGS::Common::Bitmap *_detachedMask = nullptr;
+};
+
+// Returns the lookup map for the current room's mask
+const RoomAreaMap &get_room_area_map(RoomAreaMask mask);
+// Rebuilds the lookup map from the current room's mask
+void update_room_area_map(RoomAreaMask mask);
+// Rebuilds lookup maps for all the current room's masks; this also
+// attaches back any detached maps, and should be called when room is loaded
+void update_room_area_maps();
+// Makes the lookup map read the current room's mask directly from now on,
+// until the next room is loaded; used when the mask is given away to plugins
+void detach_room_area_map(RoomAreaMask mask);
+
+#endif // __AGS_EE_AC__ROOMAREAMAP_H
@@ -32,6 +32,7 @@ public:
     virtual void set_route_move_speed(int speed_x, int speed_y) = 0;
     virtual int find_route(short srcx, short srcy, short xx, short yy, Bitmap *onscreen, int movlst, int nocross = 0, int ignore_walls = 0) = 0;
     virtual void calculate_move_stage(MoveList * mlsp, int aaa) = 0;
+    virtual void find_routes(RouteRequest *requests, size_t count) = 0;
 };
 
 class AGSRouteFinder : public IRouteFinder 
@@ -69,6 +70,10 @@ public:
     { 
         AGS::Engine::RouteFinder::calculate_move_stage(mlsp, aaa); 
     }
+    void find_routes(RouteRequest *requests, size_t count) override
+    {
+        AGS::Engine::RouteFinder::find_routes(requests, count);
+    }
 };
 
 class AGSLegacyRouteFinder : public IRouteFinder 
@@ -106,6 +111,17 @@ public:
     { 
         AGS::Engine::RouteFinderLegacy::calculate_move_stage(mlsp, aaa); 
     }
+    void find_routes(RouteRequest *requests, size_t count) override
+    {
+        // legacy pathfinder is not reentrant, find routes one by one
+        for (size_t i = 0; i < count; ++i)
+        {
+            RouteRequest &req = requests[i];
+            AGS::Engine::RouteFinderLegacy::set_route_move_speed(req.MoveSpeedX, req.MoveSpeedY);
+            req.Result = AGS::Engine::RouteFinderLegacy::find_route(req.SrcX, req.SrcY, req.DstX, req.DstY,
+                req.Wallscreen, req.MoveList, req.NoCross, req.IgnoreWalls);
+        }
+    }
 };
 
 std::unique_ptr<IRouteFinder> route_finder_impl;
@@ -161,3 +177,8 @@ void calculate_move_stage(MoveList * mlsp, int aaa)
 {
     route_finder_impl->calculate_move_stage(mlsp, aaa);
 }
+
+void find_routes(RouteRequest *requests, size_t count)
+{
+    route_finder_impl->find_routes(requests, count);
+}
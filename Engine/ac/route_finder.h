@@ -15,6 +15,7 @@
 #ifndef __AC_ROUTEFND_H
 #define __AC_ROUTEFND_H
 
+#include <stddef.h>
 #include "ac/game_version.h"
 
 // Forward declaration
@@ -34,4 +35,27 @@ void set_route_move_speed(int speed_x, int speed_y);
 int find_route(short srcx, short srcy, short xx, short yy, AGS::Common::Bitmap *onscreen, int movlst, int nocross = 0, int ignore_walls = 0);
 void calculate_move_stage(MoveList * mlsp, int aaa);
 
+// A single request for find_routes
+struct RouteRequest
+{
+    short SrcX = 0, SrcY = 0;
+    short DstX = 0, DstY = 0;
+    // walls mask; may be shared by several requests, but must not be
+    // changed until find_routes returns
+    AGS::Common::Bitmap *Wallscreen = nullptr;
+    int MoveList = 0; // index of the move list to write the route into
+    int NoCross = 0;
+    int IgnoreWalls = 0;
+    int MoveSpeedX = 0, MoveSpeedY = 0;
+    // output: move list index, or 0 if no route was found
+    int Result = 0;
+};
+
+// Finds routes for the list of requests, possibly on several threads at
+// once. Results are the same as if each request was passed to
+// set_route_move_speed and find_route in order: move lists are written
+// in the same order after all the routes are found, and the move speed
+// of the last request remains set.
+void find_routes(RouteRequest *requests, size_t count);
+
 #endif // __AC_ROUTEFND_H
\ No newline at end of file
@@ -20,18 +20,26 @@
 
 #include <string.h>
 #include <math.h>
+#include <list>
+#include <unordered_map>
+#include <atomic>
+#if !defined(AGS_DISABLE_THREADS)
+#include <thread>
+#endif
 
 #include "ac/common.h"   // quit()
 #include "ac/movelist.h"     // MoveList
 #include "ac/common_defines.h"
 #include "gfx/bitmap.h"
 #include "debug/out.h"
+#include "util/workerpool.h"
 
 #include "route_finder_jps.inl"
 
 extern std::vector<MoveList> mls;
 
 using AGS::Common::Bitmap;
+using AGS::Common::WorkerPool;
 
 // #define DEBUG_PATHFINDER
 
@@ -42,36 +50,142 @@ namespace RouteFinder {
 #define MAKE_INTCOORD(x,y) (((unsigned short)x << 16) | ((unsigned short)y))
 
 static const int MAXNAVPOINTS = MAXNEEDSTAGES;
-static int navpoints[MAXNAVPOINTS];
-static int num_navpoints;
-static fixed move_speed_x, move_speed_y;
-static Navigation nav;
-static Bitmap *wallscreen;
-static int lastcx, lastcy;
 
-void init_pathfinder()
+// Route cache, stores navpoints of the most recently found routes, tracks
+// use history with MRU list. Routes are only valid for the walls mask they
+// were found on, so the cache must be cleared whenever the mask changes.
+class RouteCache
+{
+public:
+  RouteCache(size_t max_count) : _maxCount(max_count) {}
+
+  static uint64_t MakeKey(int fromx, int fromy, int destx, int desty)
+  {
+    return ((uint64_t)MAKE_INTCOORD(fromx, fromy) << 32) | (uint32_t)MAKE_INTCOORD(destx, desty);
+  }
+
+  const std::vector<int> *Get(uint64_t key)
+  {
+    const auto found = _map.find(key);
+    if (found == _map.end())
+      return nullptr;
+    // Move to the beginning of the MRU list
+    _mru.splice(_mru.begin(), _mru, found->second.MruIt);
+    return &found->second.Navpoints;
+  }
+
+  // Add the route into the cache, remove oldest one if cache is full
+  void Put(uint64_t key, const int *points, int count)
+  {
+    if (_maxCount == 0 || _map.count(key))
+      return;
+    if (_map.size() >= _maxCount)
+    {
+      auto it = std::prev(_mru.end());
+      _map.erase(*it);
+      _mru.erase(it);
+    }
+    RouteEntry &entry = _map[key];
+    entry.Navpoints.assign(points, points + count);
+    entry.MruIt = _mru.insert(_mru.begin(), key);
+  }
+
+  void Clear()
+  {
+    _map.clear();
+    _mru.clear();
+  }
+
+private:
+  struct RouteEntry
+  {
+    // empty if the destination was unreachable
+    std::vector<int> Navpoints;
+    // MRU list reference
+    std::list<uint64_t>::const_iterator MruIt;
+  };
+
+  size_t _maxCount = 0u;
+  std::unordered_map<uint64_t, RouteEntry> _map;
+  // MRU list: the way to track which routes were used recently
+  std::list<uint64_t> _mru;
+};
+
+static const size_t MAXCACHEDROUTES = 64;
+
+struct JPSRouteFinder::Impl
+{
+  Navigation nav;
+  Bitmap *wallscreen = nullptr;
+  int navpoints[MAXNAVPOINTS]{};
+  int num_navpoints = 0;
+  fixed move_speed_x = 0, move_speed_y = 0;
+  int lastcx = 0, lastcy = 0;
+  RouteCache route_cache = RouteCache(MAXCACHEDROUTES);
+  // Copy of the walls mask which the navigation grid is bound to;
+  // it only has to be updated when the wallscreen contents change
+  std::vector<uint8_t> navmask;
+  int navmask_width = 0, navmask_height = 0;
+  // temporary buffers
+  std::vector<int> path, cpath;
+
+  void SyncNavWallscreen();
+  int CanSeeFromSynced(int x1, int y1, int x2, int y2);
+  int FindRouteJPS(int fromx, int fromy, int destx, int desty);
+};
+
+JPSRouteFinder::JPSRouteFinder()
+  : _impl(new Impl())
 {
 }
 
-void shutdown_pathfinder()
+JPSRouteFinder::~JPSRouteFinder() = default;
+
+void JPSRouteFinder::Reset()
 {
+  _impl.reset(new Impl());
 }
 
-void set_wallscreen(Bitmap *wallscreen_) 
+void JPSRouteFinder::SetWallscreen(Bitmap *wallscreen)
 {
-  wallscreen = wallscreen_;
+  _impl->wallscreen = wallscreen;
 }
 
-static void sync_nav_wallscreen()
+// Synchronizes navigation grid with the current wallscreen. The walls mask
+// is regenerated by the engine before every route search, but usually has
+// the same contents, in which case the grid and cached routes remain valid.
+void JPSRouteFinder::Impl::SyncNavWallscreen()
 {
-  // FIXME: this is dumb, but...
-  nav.Resize(wallscreen->GetWidth(), wallscreen->GetHeight());
+  const int width = wallscreen->GetWidth();
+  const int height = wallscreen->GetHeight();
+  bool changed = false;
+  if ((width != navmask_width) || (height != navmask_height))
+  {
+    navmask.resize(width * height);
+    nav.Resize(width, height);
+    for (int y = 0; y < height; y++)
+      nav.SetMapRow(y, navmask.data() + y * width);
+    navmask_width = width;
+    navmask_height = height;
+    changed = true;
+  }
+
+  for (int y = 0; y < height; y++)
+  {
+    const uint8_t *src_row = wallscreen->GetScanLine(y);
+    uint8_t *nav_row = navmask.data() + y * width;
+    if (changed || memcmp(nav_row, src_row, width) != 0)
+    {
+      memcpy(nav_row, src_row, width);
+      changed = true;
+    }
+  }
 
-  for (int y=0; y<wallscreen->GetHeight(); y++)
-    nav.SetMapRow(y, wallscreen->GetScanLine(y));
+  if (changed)
+    route_cache.Clear();
 }
 
-int can_see_from(int x1, int y1, int x2, int y2)
+int JPSRouteFinder::Impl::CanSeeFromSynced(int x1, int y1, int x2, int y2)
 {
   lastcx = x1;
   lastcy = y1;
@@ -79,28 +193,50 @@ int can_see_from(int x1, int y1, int x2, int y2)
   if ((x1 == x2) && (y1 == y2))
     return 1;
 
-  sync_nav_wallscreen();
-
   return !nav.TraceLine(x1, y1, x2, y2, lastcx, lastcy);
 }
 
-void get_lastcpos(int &lastcx_, int &lastcy_) 
+int JPSRouteFinder::CanSeeFrom(int x1, int y1, int x2, int y2)
+{
+  if ((x1 == x2) && (y1 == y2))
+  {
+    _impl->lastcx = x1;
+    _impl->lastcy = y1;
+    return 1;
+  }
+
+  _impl->SyncNavWallscreen();
+  return _impl->CanSeeFromSynced(x1, y1, x2, y2);
+}
+
+void JPSRouteFinder::GetLastCPos(int &lastcx_, int &lastcy_) const
 {
-  lastcx_ = lastcx;
-  lastcy_ = lastcy;
+  lastcx_ = _impl->lastcx;
+  lastcy_ = _impl->lastcy;
 }
 
-// new routing using JPS
-static int find_route_jps(int fromx, int fromy, int destx, int desty)
+// new routing using JPS; expects navigation grid to be synced
+int JPSRouteFinder::Impl::FindRouteJPS(int fromx, int fromy, int destx, int desty)
 {
-  sync_nav_wallscreen();
+  const uint64_t cache_key = RouteCache::MakeKey(fromx, fromy, destx, desty);
+  const std::vector<int> *cached = route_cache.Get(cache_key);
+  if (cached)
+  {
+    if (cached->empty())
+      return 0;
+    num_navpoints = (int)cached->size();
+    std::copy(cached->begin(), cached->end(), navpoints);
+    return 1;
+  }
 
-  static std::vector<int> path, cpath;
   path.clear();
   cpath.clear();
 
   if (nav.NavigateRefined(fromx, fromy, destx, desty, path, cpath) == Navigation::NAV_UNREACHABLE)
+  {
+    route_cache.Put(cache_key, nullptr, 0);
     return 0;
+  }
 
   num_navpoints = 0;
 
@@ -115,11 +251,14 @@ static int find_route_jps(int fromx, int fromy, int destx, int desty)
     navpoints[num_navpoints++] = MAKE_INTCOORD(x, y);
   }
 
+  route_cache.Put(cache_key, navpoints, num_navpoints);
   return 1;
 }
 
-void set_route_move_speed(int speed_x, int speed_y)
+void JPSRouteFinder::SetMoveSpeed(int speed_x, int speed_y)
 {
+  fixed &move_speed_x = _impl->move_speed_x;
+  fixed &move_speed_y = _impl->move_speed_y;
   // negative move speeds like -2 get converted to 1/2
   if (speed_x < 0) {
     move_speed_x = itofix(1) / (-speed_x);
@@ -138,8 +277,10 @@ void set_route_move_speed(int speed_x, int speed_y)
 
 // Calculates the X and Y per game loop, for this stage of the
 // movelist
-void calculate_move_stage(MoveList * mlsp, int aaa)
+void JPSRouteFinder::CalculateMoveStage(MoveList * mlsp, int aaa) const
 {
+  const fixed move_speed_x = _impl->move_speed_x;
+  const fixed move_speed_y = _impl->move_speed_y;
   // work out the x & y per move. First, opp/adj=tan, so work out the angle
   if (mlsp->pos[aaa] == mlsp->pos[aaa + 1]) {
     mlsp->xpermove[aaa] = 0;
@@ -214,28 +355,35 @@ void calculate_move_stage(MoveList * mlsp, int aaa)
 }
 
 
-int find_route(short srcx, short srcy, short xx, short yy, Bitmap *onscreen, int movlst, int nocross, int ignore_walls)
+bool JPSRouteFinder::FindRoute(short srcx, short srcy, short xx, short yy, Bitmap *onscreen,
+  MoveList &mlist, int nocross, int ignore_walls)
 {
   int i;
+  Impl &rf = *_impl;
+  int *navpoints = rf.navpoints;
+  int &num_navpoints = rf.num_navpoints;
 
-  wallscreen = onscreen;
+  rf.wallscreen = onscreen;
 
   num_navpoints = 0;
 
-  if (ignore_walls || can_see_from(srcx, srcy, xx, yy))
+  if (!ignore_walls)
+    rf.SyncNavWallscreen();
+
+  if (ignore_walls || rf.CanSeeFromSynced(srcx, srcy, xx, yy))
   {
     num_navpoints = 2;
     navpoints[0] = MAKE_INTCOORD(srcx, srcy);
     navpoints[1] = MAKE_INTCOORD(xx, yy);
   } else {
-    if ((nocross == 0) && (wallscreen->GetPixel(xx, yy) == 0))
-      return 0; // clicked on a wall
+    if ((nocross == 0) && (onscreen->GetPixel(xx, yy) == 0))
+      return false; // clicked on a wall
 
-    find_route_jps(srcx, srcy, xx, yy);
+    rf.FindRouteJPS(srcx, srcy, xx, yy);
   }
 
   if (!num_navpoints)
-    return 0;
+    return false;
 
   // FIXME: really necessary?
   if (num_navpoints == 1)
@@ -247,27 +395,161 @@ int find_route(short srcx, short srcy, short xx, short yy, Bitmap *onscreen, int
   AGS::Common::Debug::Printf("Route from %d,%d to %d,%d - %d stages", srcx,srcy,xx,yy,num_navpoints);
 #endif
 
-  int mlist = movlst;
-  mls[mlist].numstage = num_navpoints;
-  memcpy(&mls[mlist].pos[0], &navpoints[0], sizeof(int) * num_navpoints);
+  mlist.numstage = num_navpoints;
+  memcpy(&mlist.pos[0], &navpoints[0], sizeof(int) * num_navpoints);
 #ifdef DEBUG_PATHFINDER
   AGS::Common::Debug::Printf("stages: %d\n",num_navpoints);
 #endif
 
   for (i=0; i<num_navpoints-1; i++)
-    calculate_move_stage(&mls[mlist], i);
-
-  mls[mlist].fromx = srcx;
-  mls[mlist].fromy = srcy;
-  mls[mlist].onstage = 0;
-  mls[mlist].onpart = 0;
-  mls[mlist].doneflag = 0;
-  mls[mlist].lastx = -1;
-  mls[mlist].lasty = -1;
-  return mlist;
+    CalculateMoveStage(&mlist, i);
+
+  mlist.fromx = srcx;
+  mlist.fromy = srcy;
+  mlist.onstage = 0;
+  mlist.onpart = 0;
+  mlist.doneflag = 0;
+  mlist.lastx = -1;
+  mlist.lasty = -1;
+  return true;
 }
 
 
+
+
+// ----------------------------------------------------------------------------
+// Engine's pathfinder API
+// ----------------------------------------------------------------------------
+
+// Max number of threads to find routes on, when chosen automatically
+static const int MaxAutoRouteThreads = 4;
+
+// Pool of the threads for find_routes, and route finders, one per task;
+// created only when more than one thread is used
+static std::unique_ptr<WorkerPool> route_workers;
+static std::vector<JPSRouteFinder> route_workers_finders;
+// Number of threads to find routes on, including the calling one;
+// 0 means it's not chosen yet
+static int route_thread_count = 0;
+
+void set_pathfinder_threads(int count)
+{
+#if !defined(AGS_DISABLE_THREADS)
+  if (count <= 0)
+    count = std::min(std::max(1, (int)std::thread::hardware_concurrency()), MaxAutoRouteThreads);
+#else
+  count = 1;
+#endif
+  if (count == route_thread_count)
+    return;
+  route_workers.reset();
+  route_workers_finders.clear();
+  route_thread_count = count;
+  if (count > 1)
+  {
+    route_workers.reset(new WorkerPool(count - 1));
+    route_workers_finders = std::vector<JPSRouteFinder>(count);
+  }
+}
+
+// Main route finder instance, used by the engine's functions
+static JPSRouteFinder route_finder;
+
+void init_pathfinder()
+{
+}
+
+void shutdown_pathfinder()
+{
+  route_workers.reset();
+  route_workers_finders.clear();
+  route_thread_count = 0;
+  route_finder.Reset();
+}
+
+void set_wallscreen(Bitmap *wallscreen)
+{
+  route_finder.SetWallscreen(wallscreen);
+}
+
+int can_see_from(int x1, int y1, int x2, int y2)
+{
+  return route_finder.CanSeeFrom(x1, y1, x2, y2);
+}
+
+void get_lastcpos(int &lastcx, int &lastcy)
+{
+  route_finder.GetLastCPos(lastcx, lastcy);
+}
+
+void set_route_move_speed(int speed_x, int speed_y)
+{
+  route_finder.SetMoveSpeed(speed_x, speed_y);
+}
+
+void calculate_move_stage(MoveList * mlsp, int aaa)
+{
+  route_finder.CalculateMoveStage(mlsp, aaa);
+}
+
+int find_route(short srcx, short srcy, short xx, short yy, Bitmap *onscreen, int movlst, int nocross, int ignore_walls)
+{
+  if (!route_finder.FindRoute(srcx, srcy, xx, yy, onscreen, mls[movlst], nocross, ignore_walls))
+    return 0;
+  return movlst;
+}
+
+static void find_routes_sequential(RouteRequest *requests, size_t count)
+{
+  for (size_t i = 0; i < count; i++)
+  {
+    RouteRequest &req = requests[i];
+    set_route_move_speed(req.MoveSpeedX, req.MoveSpeedY);
+    req.Result = find_route(req.SrcX, req.SrcY, req.DstX, req.DstY, req.Wallscreen,
+      req.MoveList, req.NoCross, req.IgnoreWalls);
+  }
+}
+
+void find_routes(RouteRequest *requests, size_t count)
+{
+  if (route_thread_count == 0)
+    set_pathfinder_threads(0);
+  if ((count < 2) || !route_workers)
+  {
+    find_routes_sequential(requests, count);
+    return;
+  }
+
+  // Find routes into the temporary move lists, each task taking the next
+  // pending request, until none are left; temporary lists begin as copies
+  // of the target ones, so that the fields not set by the route finder
+  // are kept unchanged
+  std::vector<MoveList> results(count);
+  for (size_t i = 0; i < count; i++)
+    results[i] = mls[requests[i].MoveList];
+  std::atomic<size_t> next_request(0u);
+  route_workers->RunTasks(route_workers_finders.size(),
+    [requests, count, &results, &next_request](size_t task)
+  {
+    JPSRouteFinder &finder = route_workers_finders[task];
+    for (size_t i = next_request++; i < count; i = next_request++)
+    {
+      const RouteRequest &req = requests[i];
+      finder.SetMoveSpeed(req.MoveSpeedX, req.MoveSpeedY);
+      requests[i].Result = finder.FindRoute(req.SrcX, req.SrcY, req.DstX, req.DstY, req.Wallscreen,
+        results[i], req.NoCross, req.IgnoreWalls) ? req.MoveList : 0;
+    }
+  });
+
+  // Write move lists in the order of requests, same as sequential calls would
+  for (size_t i = 0; i < count; i++)
+  {
+    if (requests[i].Result > 0)
+      mls[requests[i].MoveList] = results[i];
+  }
+  set_route_move_speed(requests[count - 1].MoveSpeedX, requests[count - 1].MoveSpeedY);
+}
+
 } // namespace RouteFinder
 } // namespace Engine
 } // namespace AGS
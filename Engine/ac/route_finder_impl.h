@@ -15,7 +15,9 @@
 #ifndef __AC_ROUTE_FINDER_IMPL
 #define __AC_ROUTE_FINDER_IMPL
 
+#include <memory>
 #include "ac/game_version.h"
+#include "ac/route_finder.h"
 
 // Forward declaration
 namespace AGS { namespace Common { class Bitmap; }}
@@ -38,6 +40,40 @@ void set_route_move_speed(int speed_x, int speed_y);
 int find_route(short srcx, short srcy, short xx, short yy, AGS::Common::Bitmap *onscreen, int movlst, int nocross = 0, int ignore_walls = 0);
 void calculate_move_stage(MoveList * mlsp, int aaa);
 
+void find_routes(RouteRequest *requests, size_t count);
+// Sets the number of threads for find_routes, including the calling one;
+// 0 chooses it by the number of CPU cores
+void set_pathfinder_threads(int count);
+
+// JPS route finder instance. Keeps all the navigation state, so that
+// separate instances may be used simultaneously on different threads.
+// The functions above work with the engine's main instance.
+class JPSRouteFinder
+{
+public:
+    JPSRouteFinder();
+    ~JPSRouteFinder();
+
+    // Releases navigation data and cached routes
+    void Reset();
+
+    void SetWallscreen(AGS::Common::Bitmap *wallscreen);
+    void SetMoveSpeed(int speed_x, int speed_y);
+
+    int CanSeeFrom(int x1, int y1, int x2, int y2);
+    void GetLastCPos(int &lastcx, int &lastcy) const;
+
+    // Finds the route and writes it into the move list; returns false if
+    // no route was found, in which case the move list is not changed
+    bool FindRoute(short srcx, short srcy, short xx, short yy, AGS::Common::Bitmap *onscreen,
+        MoveList &mlist, int nocross = 0, int ignore_walls = 0);
+    void CalculateMoveStage(MoveList *mlsp, int aaa) const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> _impl;
+};
+
 } // namespace RouteFinder
 } // namespace Engine
 } // namespace AGS
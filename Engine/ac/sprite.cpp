@@ -165,7 +165,21 @@ void initialize_sprite (int ee) {
         game.SpriteInfos[ee].Width=spriteset[ee]->GetWidth();
         game.SpriteInfos[ee].Height=spriteset[ee]->GetHeight();
 
-        spriteset.SubstituteBitmap(ee, PrepareSpriteForUse(spriteset[ee], (game.SpriteInfos[ee].Flags & SPF_ALPHACHANNEL) != 0));
+        // Sprites from the memory-mapped file share pixels with the file's pages,
+        // which are reused if the sprite is disposed and loaded again; so make
+        // a copy if either the engine or the plugins are going to modify it.
+        curspr = spriteset[ee];
+        const bool has_alpha = (game.SpriteInfos[ee].Flags & SPF_ALPHACHANNEL) != 0;
+        if (spriteset.IsMappedImage(curspr) &&
+            (IsSpritePreparedInPlace(curspr, has_alpha) || pl_any_want_hook(AGSE_SPRITELOAD))) {
+            tmpdbl = BitmapHelper::CreateBitmapCopy(curspr);
+            if (tmpdbl == nullptr)
+                quit("Not enough memory to load sprite graphics");
+            delete curspr;
+            spriteset.SubstituteBitmap(ee, tmpdbl);
+        }
+
+        spriteset.SubstituteBitmap(ee, PrepareSpriteForUse(spriteset[ee], has_alpha));
 
         if (game.GetColorDepth() < 32) {
             game.SpriteInfos[ee].Flags &= ~SPF_ALPHACHANNEL;
@@ -47,10 +47,13 @@ const char* String_Copy(const char *srcString) {
 }
 
 const char* String_Append(const char *thisString, const char *extrabit) {
-    char *buffer = (char*)malloc(strlen(thisString) + strlen(extrabit) + 1);
-    strcpy(buffer, thisString);
-    strcat(buffer, extrabit);
-    return CreateNewScriptString(buffer, false);
+    const size_t this_len = strlen(thisString);
+    const size_t extra_len = strlen(extrabit);
+    ScriptString *str = ScriptString::CreateBuffer(this_len + extra_len);
+    char *buffer = str->GetTextPtr();
+    memcpy(buffer, thisString, this_len);
+    memcpy(buffer + this_len, extrabit, extra_len + 1);
+    return CreateNewScriptString(str);
 }
 
 const char* String_AppendChar(const char *thisString, int extraOne) {
@@ -60,9 +63,12 @@ const char* String_AppendChar(const char *thisString, int extraOne) {
         chw = Utf8::SetChar(extraOne, chr, sizeof(chr));
     else
         chr[0] = extraOne;
-    char *buffer = (char*)malloc(strlen(thisString) + chw + 1);
-    sprintf(buffer, "%s%s", thisString, chr);
-    return CreateNewScriptString(buffer, false);
+    const size_t this_len = strlen(thisString);
+    ScriptString *str = ScriptString::CreateBuffer(this_len + chw);
+    char *buffer = str->GetTextPtr();
+    memcpy(buffer, thisString, this_len);
+    memcpy(buffer + this_len, chr, chw + 1);
+    return CreateNewScriptString(str);
 }
 
 const char* String_ReplaceCharAt(const char *thisString, int index, int newChar) {
@@ -80,12 +86,13 @@ const char* String_ReplaceCharAt(const char *thisString, int index, int newChar)
         new_chw = Utf8::SetChar(newChar, new_chr, sizeof(new_chr));
     else
         new_chr[0] = newChar;
-    size_t total_sz = off + remain_sz + new_chw - old_sz + 1;
-    char *buffer = (char*)malloc(total_sz);
+    size_t total_len = off + remain_sz + new_chw - old_sz;
+    ScriptString *str = ScriptString::CreateBuffer(total_len);
+    char *buffer = str->GetTextPtr();
     memcpy(buffer, thisString, off);
     memcpy(buffer + off, new_chr, new_chw);
     memcpy(buffer + off + new_chw, thisString + off + old_sz, remain_sz - old_sz + 1);
-    return CreateNewScriptString(buffer, false);
+    return CreateNewScriptString(str);
 }
 
 const char* String_Truncate(const char *thisString, int length) {
@@ -96,10 +103,9 @@ const char* String_Truncate(const char *thisString, int length) {
         return thisString;
 
     size_t sz = uoffset(thisString, length);
-    char *buffer = (char*)malloc(sz + 1);
-    memcpy(buffer, thisString, sz);
-    buffer[sz] = 0;
-    return CreateNewScriptString(buffer, false);
+    ScriptString *str = ScriptString::CreateBuffer(sz);
+    memcpy(str->GetTextPtr(), thisString, sz);
+    return CreateNewScriptString(str);
 }
 
 const char* String_Substring(const char *thisString, int index, int length) {
@@ -113,10 +119,9 @@ const char* String_Substring(const char *thisString, int index, int length) {
     size_t end = uoffset(thisString + start, sublen) + start;
     size_t copysz = end - start;
 
-    char *buffer = (char*)malloc(copysz + 1);
-    memcpy(buffer, thisString + start, copysz);
-    buffer[copysz] = 0;
-    return CreateNewScriptString(buffer, false);
+    ScriptString *str = ScriptString::CreateBuffer(copysz);
+    memcpy(str->GetTextPtr(), thisString + start, copysz);
+    return CreateNewScriptString(str);
 }
 
 int String_CompareTo(const char *thisString, const char *otherString, bool caseSensitive) {
@@ -204,16 +209,25 @@ const char* String_Replace(const char *thisString, const char *lookForText, cons
     return CreateNewScriptString(resultBuffer, true);
 }
 
+// Creates a new script string with each character converted by the given
+// function; converted characters may take a different number of bytes
+static const char *CreateConvertedScriptString(const char *text, int (*convert)(int)) {
+    size_t len = 0;
+    for (const char *ptr = text; *ptr;)
+        len += ucwidth(convert(ugetxc(&ptr)));
+    ScriptString *str = ScriptString::CreateBuffer(len);
+    char *buffer = str->GetTextPtr();
+    for (const char *ptr = text; *ptr;)
+        buffer += usetc(buffer, convert(ugetxc(&ptr)));
+    return CreateNewScriptString(str);
+}
+
 const char* String_LowerCase(const char *thisString) {
-    char *buffer = ags_strdup(thisString);
-    ustrlwr(buffer);
-    return CreateNewScriptString(buffer, false);
+    return CreateConvertedScriptString(thisString, utolower);
 }
 
 const char* String_UpperCase(const char *thisString) {
-    char *buffer = ags_strdup(thisString);
-    ustrupr(buffer);
-    return CreateNewScriptString(buffer, false);
+    return CreateConvertedScriptString(thisString, utoupper);
 }
 
 int String_GetChars(const char *texx, int index) {
@@ -260,24 +274,31 @@ const char *CreateNewScriptString(const char *fromText, bool reAllocate) {
     return (const char*)CreateNewScriptStringObj(fromText, reAllocate).second;
 }
 
+const char *CreateNewScriptString(ScriptString *str) {
+    return (const char*)CreateNewScriptStringObj(str).second;
+}
+
 DynObjectRef CreateNewScriptStringObj(const String &fromText) {
     return CreateNewScriptStringObj(fromText.GetCStr(), true);
 }
 
 DynObjectRef CreateNewScriptStringObj(const char *fromText, bool reAllocate)
 {
-    ScriptString *str;
-    if (reAllocate) {
-        str = new ScriptString(fromText);
-    }
-    else { // TODO: refactor to avoid const casts!
-        str = new ScriptString((char*)fromText, true);
+    // The text is always copied, as it's kept along with the string object
+    ScriptString *str = ScriptString::Create(fromText);
+    if (!reAllocate) { // TODO: refactor to avoid const casts!
+        free((char*)fromText);
     }
+    return CreateNewScriptStringObj(str);
+}
+
+DynObjectRef CreateNewScriptStringObj(ScriptString *str)
+{
     void *obj_ptr = str->GetTextPtr();
     int32_t handle = ccRegisterManagedObject(obj_ptr, str);
     if (handle == 0)
     {
-        delete str;
+        str->Dispose(nullptr, true);
         return DynObjectRef(0, nullptr);
     }
     return DynObjectRef(handle, obj_ptr);
@@ -22,6 +22,8 @@
 #include "ac/dynobj/cc_dynamicobject.h"
 #include "util/string.h"
 
+struct ScriptString;
+
 // Check that a supplied buffer from a text script function was not null
 #define VALIDATE_STRING(strin) if ((unsigned long)strin <= 4096) quit("!String argument was null: make sure you pass a string, not an int, as a buffer")
 
@@ -48,6 +50,9 @@ const char* CreateNewScriptString(const AGS::Common::String &fromText);
 const char* CreateNewScriptString(const char *fromText, bool reAllocate = true);
 DynObjectRef CreateNewScriptStringObj(const AGS::Common::String &fromText);
 DynObjectRef CreateNewScriptStringObj(const char *fromText, bool reAllocate = true);
+// Registers the string object made with ScriptString::Create or CreateBuffer
+const char* CreateNewScriptString(ScriptString *str);
+DynObjectRef CreateNewScriptStringObj(ScriptString *str);
 class SplitLines;
 // Break up the text into lines restricted by the given width;
 // returns number of lines, or 0 if text cannot be split well to fit in this width.
@@ -19,6 +19,7 @@
 #include "ac/gamesetupstruct.h"
 #include "ac/object.h"
 #include "ac/room.h"
+#include "ac/roomareamap.h"
 #include "ac/roomobject.h"
 #include "ac/roomstatus.h"
 #include "ac/walkablearea.h"
@@ -49,11 +50,12 @@ void redo_walkable_areas()
                 walls_scanline[w] = 0;
         }
     }
+    update_room_area_map(kRoomAreaWalkable);
 }
 
 int get_walkable_area_pixel(int x, int y)
 {
-    return thisroom.WalkAreaMask->GetPixel(room_to_mask_coord(x), room_to_mask_coord(y));
+    return get_room_area_map(kRoomAreaWalkable).GetArea(room_to_mask_coord(x), room_to_mask_coord(y));
 }
 
 int get_area_scaling (int onarea, int xx, int yy) {
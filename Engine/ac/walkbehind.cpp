@@ -15,6 +15,7 @@
 #include <algorithm>
 #include "ac/draw.h"
 #include "ac/gamestate.h"
+#include "ac/roomareamap.h"
 #include "ac/roomstatus.h"
 #include "gfx/bitmap.h"
 #include "gfx/graphicsdriver.h"
@@ -33,10 +34,14 @@ struct WalkBehindColumn
 {
     bool Exists = false; // whether any WB area is in this column
     int Y1 = 0, Y2 = 0; // WB top and bottom Y coords
+    uint32_t Areas = 0; // bit flags of WB areas found in this column
+    int Baseline = INT32_MIN; // the lowest baseline of WB areas in this column
 };
 
 WalkBehindMethodEnum walkBehindMethod = DrawOverCharSprite;
 std::vector<WalkBehindColumn> walkBehindCols; // precalculated WB positions
+int walkBehindColBaselines[MAX_WALK_BEHINDS]; // WB baselines used for WB columns
+bool walkBehindColBaselinesValid = false;
 Rect walkBehindAABB[MAX_WALK_BEHINDS]; // WB bounding box
 int walkBehindsCachedForBgNum = 0; // WB textures are for this background
 bool noWalkBehindsAtAll = false; // quick report that no WBs in this room
@@ -46,7 +51,7 @@ bool walk_behind_baselines_changed = false;
 // Generates walk-behinds as separate sprites
 void walkbehinds_generate_sprites()
 {
-    const Bitmap *mask = thisroom.WalkBehindMask.get();
+    const RoomAreaMap &mask = get_room_area_map(kRoomAreaWalkBehind);
     const Bitmap *bg = thisroom.BgFrames[play.bg_frame].Graphic.get();
     
     const int coldepth = bg->GetColorDepth();
@@ -55,14 +60,14 @@ void walkbehinds_generate_sprites()
     for (int wb = 1 /* 0 is "no area" */; wb < MAX_WALK_BEHINDS; ++wb)
     {
         const Rect pos = walkBehindAABB[wb];
-        if (pos.Right > 0)
+        if (mask.HasArea(wb))
         {
             wbbmp.CreateTransparent(pos.GetWidth(), pos.GetHeight(), coldepth);
             // Copy over all solid pixels belonging to this WB area
             const int sx = pos.Left, ex = pos.Right, sy = pos.Top, ey = pos.Bottom;
             for (int y = sy; y <= ey; ++y)
             {
-                const uint8_t *check_line = mask->GetScanLine(y);
+                const uint8_t *check_line = mask.GetRow(y);
                 const uint8_t *src_line = bg->GetScanLine(y);
                 uint8_t *dst_line = wbbmp.GetScanLineForWriting(y - sy);
                 for (int x = sx; x <= ex; ++x)
@@ -93,6 +98,27 @@ void walkbehinds_generate_sprites()
     walkBehindsCachedForBgNum = play.bg_frame;
 }
 
+// Updates the lowest WB baseline in each column, if any of the WB baselines have changed
+static void walkbehinds_update_baselines()
+{
+    if (walkBehindColBaselinesValid &&
+        std::equal(walkBehindColBaselines, walkBehindColBaselines + MAX_WALK_BEHINDS,
+            croom->walkbehind_base))
+        return;
+    walkBehindColBaselinesValid = true;
+    std::copy(croom->walkbehind_base, croom->walkbehind_base + MAX_WALK_BEHINDS,
+        walkBehindColBaselines);
+    for (auto &wbcol : walkBehindCols)
+    {
+        wbcol.Baseline = INT32_MIN;
+        for (int wb = 1; wb < MAX_WALK_BEHINDS; ++wb)
+        {
+            if (wbcol.Areas & (1u << wb))
+                wbcol.Baseline = std::max(wbcol.Baseline, walkBehindColBaselines[wb]);
+        }
+    }
+}
+
 // Edits the given game object's sprite, cutting out pixels covered by walk-behinds;
 // returns whether any pixels were updated;
 bool walkbehinds_cropout(Bitmap *sprit, int sprx, int spry, int basel)
@@ -100,20 +126,24 @@ bool walkbehinds_cropout(Bitmap *sprit, int sprx, int spry, int basel)
     if (noWalkBehindsAtAll)
         return false;
 
+    walkbehinds_update_baselines();
+    const RoomAreaMap &mask = get_room_area_map(kRoomAreaWalkBehind);
     const int maskcol = sprit->GetMaskColor();
     const int spcoldep = sprit->GetColorDepth();
 
     bool pixels_changed = false;
     // pass along the sprite's pixels, but skip those that lie outside the mask
     for (int x = std::max(0, 0 - sprx);
-        (x < sprit->GetWidth()) && (x + sprx < thisroom.WalkBehindMask->GetWidth()); ++x)
+        (x < sprit->GetWidth()) && (x + sprx < static_cast<int>(walkBehindCols.size())); ++x)
     {
         // select the WB column at this x
         const auto &wbcol = walkBehindCols[x + sprx];
-        // skip if no area, or sprite lies outside of all areas in this column
+        // skip if no area, or sprite lies outside of all areas in this column,
+        // or is in front of all of them
         if ((!wbcol.Exists) ||
             (wbcol.Y2 <= spry) ||
-            (wbcol.Y1 > spry + sprit->GetHeight()))
+            (wbcol.Y1 > spry + sprit->GetHeight()) ||
+            (wbcol.Baseline <= basel))
             continue;
 
         // ensure we only check within the valid areas (between Y1 and Y2)
@@ -121,7 +151,7 @@ bool walkbehinds_cropout(Bitmap *sprit, int sprx, int spry, int basel)
         for (int y = std::max(0, wbcol.Y1 - spry);
             (y < sprit->GetHeight()) && (y + spry < wbcol.Y2); ++y)
         {
-            const int wb = thisroom.WalkBehindMask->GetScanLine(y + spry)[x + sprx];
+            const int wb = mask.GetRow(y + spry)[x + sprx];
             if (wb < 1) continue; // "no area"
             if (croom->walkbehind_base[wb] <= basel) continue;
 
@@ -149,41 +179,39 @@ bool walkbehinds_cropout(Bitmap *sprit, int sprx, int spry, int basel)
 
 void walkbehinds_recalc()
 {
-    // Reset all data
-    walkBehindCols.clear();
+    // Rebuild the mask lookup, which also finds WB bounding boxes
+    update_room_area_map(kRoomAreaWalkBehind);
+    const RoomAreaMap &mask = get_room_area_map(kRoomAreaWalkBehind);
     for (int wb = 0; wb < MAX_WALK_BEHINDS; ++wb)
     {
-        walkBehindAABB[wb] = Rect(INT32_MAX, INT32_MAX, INT32_MIN, INT32_MIN);
+        walkBehindAABB[wb] = mask.GetAreaBounds(wb);
     }
-    noWalkBehindsAtAll = true;
+    noWalkBehindsAtAll = mask.IsEmpty();
 
-    // Recalculate everything; note that mask is always 8-bit
-    const Bitmap *mask = thisroom.WalkBehindMask.get();
-    walkBehindCols.resize(mask->GetWidth());
-    for (int col = 0; col < mask->GetWidth(); ++col)
+    // Recalculate WB columns, scanning the mask row by row
+    walkBehindCols.assign(mask.GetWidth(), WalkBehindColumn());
+    for (int y = 0; y < mask.GetHeight(); ++y)
     {
-        auto &wbcol = walkBehindCols[col];
-        for (int y = 0; y < mask->GetHeight(); ++y)
+        const uint8_t *row = mask.GetRow(y);
+        for (int col = 0; col < mask.GetWidth(); ++col)
         {
-            int wb = mask->GetScanLine(y)[col];
+            int wb = row[col];
             // Valid areas start with index 1, 0 = no area
             if ((wb >= 1) && (wb < MAX_WALK_BEHINDS))
             {
+                auto &wbcol = walkBehindCols[col];
                 if (!wbcol.Exists)
                 {
                     wbcol.Y1 = y;
                     wbcol.Exists = true;
-                    noWalkBehindsAtAll = false;
                 }
                 wbcol.Y2 = y + 1; // +1 to allow bottom line of screen to work (CHECKME??)
-                // resize the bounding rect
-                walkBehindAABB[wb].Left = std::min(col, walkBehindAABB[wb].Left);
-                walkBehindAABB[wb].Top = std::min(y, walkBehindAABB[wb].Top);
-                walkBehindAABB[wb].Right = std::max(col, walkBehindAABB[wb].Right);
-                walkBehindAABB[wb].Bottom = std::max(y, walkBehindAABB[wb].Bottom);
+                wbcol.Areas |= (1u << wb);
             }
         }
     }
+    // Force column baselines to update on next use
+    walkBehindColBaselinesValid = false;
 
     if (walkBehindMethod == DrawAsSeparateSprite)
     {
@@ -845,9 +845,15 @@ HSaveError ReadDynamicSprites(Stream *in, int32_t /*cmp_ver*/, const PreservedPa
 
 HSaveError WriteOverlays(Stream *out)
 {
-    out->WriteInt32(screenover.size());
-    for (const auto &over : screenover)
-    {
+    const auto &overs = get_overlays();
+    uint32_t over_count = 0;
+    for (const auto &over : overs)
+        over_count += (over.type >= 0);
+    out->WriteInt32(over_count);
+    for (const auto &over : overs)
+    {
+        if (over.type < 0)
+            continue; // empty slot
         over.WriteToFile(out);
         if (!over.IsSpriteReference())
             serialize_bitmap(over.GetImage(), out);
@@ -858,6 +864,7 @@ HSaveError WriteOverlays(Stream *out)
 HSaveError ReadOverlays(Stream *in, int32_t cmp_ver, const PreservedParams& /*pp*/, RestoredData& /*r_data*/)
 {
     size_t over_count = in->ReadInt32();
+    std::vector<ScreenOverlay> overs;
     for (size_t i = 0; i < over_count; ++i)
     {
         ScreenOverlay over;
@@ -870,8 +877,9 @@ HSaveError ReadOverlays(Stream *in, int32_t cmp_ver, const PreservedParams& /*pp
             over.scaleWidth = over.GetImage()->GetWidth();
             over.scaleHeight = over.GetImage()->GetHeight();
         }
-        screenover.push_back(std::move(over));
+        overs.push_back(std::move(over));
     }
+    restore_overlays(std::move(overs));
     return HSaveError::None();
 }
 
@@ -303,14 +303,15 @@ static void restore_game_ambientsounds(Stream *in, RestoredData &r_data)
     }
 }
 
-static void ReadOverlays_Aligned(Stream *in, std::vector<bool> &has_bitmap, size_t num_overs)
+static void ReadOverlays_Aligned(Stream *in, std::vector<ScreenOverlay> &overs,
+    std::vector<bool> &has_bitmap, size_t num_overs)
 {
     AlignedStream align_s(in, Common::kAligned_Read);
     has_bitmap.resize(num_overs);
     for (size_t i = 0; i < num_overs; ++i)
     {
         bool has_bm;
-        screenover[i].ReadFromFile(&align_s, has_bm, 0);
+        overs[i].ReadFromFile(&align_s, has_bm, 0);
         has_bitmap[i] = has_bm;
         align_s.Reset();
     }
@@ -319,13 +320,14 @@ static void ReadOverlays_Aligned(Stream *in, std::vector<bool> &has_bitmap, size
 static void restore_game_overlays(Stream *in)
 {
     size_t num_overs = in->ReadInt32();
-    screenover.resize(num_overs);
+    std::vector<ScreenOverlay> overs(num_overs);
     std::vector<bool> has_bitmap;
-    ReadOverlays_Aligned(in, has_bitmap, num_overs);
+    ReadOverlays_Aligned(in, overs, has_bitmap, num_overs);
     for (size_t i = 0; i < num_overs; ++i) {
         if (has_bitmap[i])
-            screenover[i].SetImage(std::unique_ptr<Bitmap>(read_serialized_bitmap(in)));
+            overs[i].SetImage(std::unique_ptr<Bitmap>(read_serialized_bitmap(in)));
     }
+    restore_overlays(std::move(overs));
 }
 
 static void restore_game_dynamic_surfaces(Stream *in, RestoredData &r_data)
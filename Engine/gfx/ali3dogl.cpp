@@ -1507,6 +1507,41 @@ void OGLGraphicsDriver::UpdateTextureRegion(OGLTextureTile *tile, Bitmap *bitmap
   delete []origPtr;
 }
 
+void OGLGraphicsDriver::UpdateTextureSubRegion(OGLTextureTile *tile, Bitmap *bitmap, bool opaque, bool hasAlpha, const Rect &region)
+{
+  int textureHeight = tile->height;
+  int textureWidth = tile->width;
+  AdjustSizeToNearestSupportedByCard(&textureWidth, &textureHeight);
+  // Tile's pixels may be offset inside the texture, see UpdateTextureRegion
+  const int tilex = (textureWidth > tile->width) ? std::min(textureWidth - tile->width - 1, 1) : 0;
+  const int tiley = (textureHeight > tile->height) ? std::min(textureHeight - tile->height - 1, 1) : 0;
+
+  // Convert the region along with the 1-pixel border around it, because
+  // conversion of the transparent pixels depends on their neighbours
+  TextureTile convTile;
+  convTile.x = region.Left - 1;
+  convTile.y = region.Top - 1;
+  convTile.width = region.GetWidth() + 2;
+  convTile.height = region.GetHeight() + 2;
+  const int convPitch = convTile.width * sizeof(int);
+  char *origPtr = new char[convPitch * convTile.height];
+  if (opaque)
+    BitmapToVideoMemOpaque(bitmap, hasAlpha, &convTile, origPtr, convPitch);
+  else
+    BitmapToVideoMem(bitmap, hasAlpha, &convTile, origPtr, convPitch, _filter->UseLinearFiltering());
+
+  // Pack the region's pixels without the border, and upload them
+  const int pitch = region.GetWidth() * sizeof(int);
+  for (int y = 0; y < region.GetHeight(); y++)
+    memmove(origPtr + pitch * y, origPtr + convPitch * (y + 1) + sizeof(int), pitch);
+
+  glBindTexture(GL_TEXTURE_2D, tile->texture);
+  glTexSubImage2D(GL_TEXTURE_2D, 0, tilex + region.Left - tile->x, tiley + region.Top - tile->y,
+    region.GetWidth(), region.GetHeight(), GL_RGBA, GL_UNSIGNED_BYTE, origPtr);
+
+  delete []origPtr;
+}
+
 void OGLGraphicsDriver::UpdateDDBFromBitmap(IDriverDependantBitmap* bitmapToUpdate, Bitmap *bitmap, bool hasAlpha)
 {
   OGLBitmap *target = (OGLBitmap*)bitmapToUpdate;
@@ -1520,6 +1555,44 @@ void OGLGraphicsDriver::UpdateDDBFromBitmap(IDriverDependantBitmap* bitmapToUpda
   UpdateTextureData(target->_data.get(), bitmap, target->_opaque, hasAlpha);
 }
 
+void OGLGraphicsDriver::UpdateDDBRegionFromBitmap(IDriverDependantBitmap* bitmapToUpdate, Bitmap *bitmap, bool hasAlpha, const Rect &region)
+{
+  OGLBitmap *target = (OGLBitmap*)bitmapToUpdate;
+  if (target->_width != bitmap->GetWidth() || target->_height != bitmap->GetHeight())
+    throw Ali3DException("UpdateDDBRegionFromBitmap: mismatched bitmap size");
+  const int color_depth = bitmap->GetColorDepth();
+  if (color_depth != target->_colDepth)
+    throw Ali3DException("UpdateDDBRegionFromBitmap: mismatched colour depths");
+  if (target->_hasAlpha != hasAlpha)
+  { // the change of alpha mode affects all pixels
+    UpdateDDBFromBitmap(bitmapToUpdate, bitmap, hasAlpha);
+    return;
+  }
+
+  if (color_depth == 8)
+      select_palette(palette);
+
+  auto *ogldata = reinterpret_cast<OGLTextureData*>(target->_data.get());
+  for (size_t i = 0; i < ogldata->_numTiles; ++i)
+  {
+    OGLTextureTile *tile = &ogldata->_tiles[i];
+    const Rect tile_rc = RectWH(tile->x, tile->y, tile->width, tile->height);
+    const Rect rc = IntersectRects(region, tile_rc);
+    if (rc.IsEmpty())
+      continue; // tile not affected
+    // Regions touching the tile's edges also affect the texture's edge padding,
+    // so update the whole tile in such case
+    if ((rc.Left == tile_rc.Left) || (rc.Top == tile_rc.Top) ||
+        (rc.Right == tile_rc.Right) || (rc.Bottom == tile_rc.Bottom))
+      UpdateTextureRegion(tile, bitmap, target->_opaque, hasAlpha);
+    else
+      UpdateTextureSubRegion(tile, bitmap, target->_opaque, hasAlpha, rc);
+  }
+
+  if (color_depth == 8)
+      unselect_palette();
+}
+
 void OGLGraphicsDriver::UpdateTextureData(TextureData *txdata, Bitmap *bitmap, bool opaque, bool hasAlpha)
 {
   const int color_depth = bitmap->GetColorDepth();
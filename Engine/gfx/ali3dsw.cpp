@@ -13,12 +13,17 @@
 //=============================================================================
 #include "gfx/ali3dsw.h"
 #include <algorithm>
+#if !defined(AGS_DISABLE_THREADS)
+#include <thread>
+#endif
 #include "ac/sys_events.h"
+#include "debug/out.h"
 #include "gfx/ali3dexception.h"
 #include "gfx/gfxfilter_sdl_renderer.h"
 #include "gfx/gfx_util.h"
 #include "platform/base/agsplatformdriver.h"
 #include "platform/base/sys_main.h"
+#include "util/workerpool.h"
 #include "ac/timer.h"
 
 namespace AGS
@@ -34,6 +39,16 @@ static unsigned long _trans_alpha_blender32(unsigned long x, unsigned long y, un
 RGB faded_out_palette[256];
 
 
+// Max number of threads to draw sprites on, when chosen automatically
+static const int MaxAutoRenderThreads = 8;
+// Number of tiles per render thread; having more tiles than threads
+// lets the threads balance the work when sprites are unevenly spread
+static const int TilesPerRenderThread = 2;
+// Min height of a tile, in pixels; below that the threading overhead
+// outweighs the gain
+static const int MinRenderTileHeight = 32;
+
+
 // ----------------------------------------------------------------------------
 // SDLRendererGraphicsDriver
 // ----------------------------------------------------------------------------
@@ -267,6 +282,23 @@ void SDLRendererGraphicsDriver::UnInit()
   sys_window_destroy();
 }
 
+void SDLRendererGraphicsDriver::SetRenderThreads(int count)
+{
+#if !defined(AGS_DISABLE_THREADS)
+  if (count <= 0)
+    count = std::min(std::max(1, (int)std::thread::hardware_concurrency()), MaxAutoRenderThreads);
+  if (count == _renderThreadCount)
+    return;
+  _renderWorkers.reset();
+  _renderThreadCount = count;
+  if (count > 1)
+    _renderWorkers.reset(new WorkerPool(count - 1));
+  Debug::Printf(kDbgMsg_Info, "Software renderer: drawing sprites on %d thread(s)", count);
+#else
+  (void)count;
+#endif
+}
+
 bool SDLRendererGraphicsDriver::SupportsGammaControl() 
 {
   return _hasGamma;
@@ -439,7 +471,12 @@ void SDLRendererGraphicsDriver::RenderToBackBuffer()
 
 size_t SDLRendererGraphicsDriver::RenderSpriteBatch(const ALSpriteBatch &batch, size_t from, Bitmap *surface, int surf_offx, int surf_offy)
 {
-  for (; (from < _spriteList.size()) && (_spriteList[from].node == batch.ID); ++from)
+  size_t to = from;
+  for (; (to < _spriteList.size()) && (_spriteList[to].node == batch.ID); ++to);
+  if (RenderSpritesTiled(from, to, surface, surf_offx, surf_offy))
+    return to;
+
+  for (; from < to; ++from)
   {
     const auto &sprite = _spriteList[from];
     if (sprite.ddb == nullptr)
@@ -448,15 +485,84 @@ size_t SDLRendererGraphicsDriver::RenderSpriteBatch(const ALSpriteBatch &batch,
         _nullSpriteCallback(sprite.x, sprite.y);
       else
         throw Ali3DException("Unhandled attempt to draw null sprite");
+      continue;
+    }
+    RenderSprite(sprite, surface, surface, surf_offx, surf_offy);
+  }
+  return to;
+}
 
+bool SDLRendererGraphicsDriver::RenderSpritesTiled(size_t from, size_t to, Bitmap *surface, int surf_offx, int surf_offy)
+{
+#if !defined(AGS_DISABLE_THREADS)
+  // Palette modes rely on the shared color map
+  if (!_renderWorkers || (surface->GetColorDepth() <= 8))
+    return false;
+  const Rect clip = surface->GetClip();
+  const int tile_count = std::min(_renderThreadCount * TilesPerRenderThread,
+    clip.GetHeight() / MinRenderTileHeight);
+  if (tile_count < 2)
+    return false;
+  for (size_t i = from; i < to; ++i)
+  {
+    const ALSoftwareBitmap *bitmap = _spriteList[i].ddb;
+    // Null sprites call back the engine, which must be done on the main thread
+    if (bitmap == nullptr)
+      return false;
+    if (bitmap == reinterpret_cast<ALSoftwareBitmap*>(DRAWENTRY_TINT))
       continue;
+    // Hi-color sprites of a different color depth are converted to a temporary
+    // copy on each draw, which would be repeated for every tile
+    const int sprite_depth = bitmap->_bmp->GetColorDepth();
+    if ((sprite_depth > 8) && (sprite_depth != surface->GetColorDepth()))
+      return false;
+    // A sprite drawn from the surface onto itself would be read by one tile
+    // while another one is being written to
+    if ((bitmap->_bmp == surface) && (bitmap->_alpha != 0) &&
+        !(bitmap->_opaque && (bitmap->_alpha == 255)))
+      return false;
+  }
+
+  // Sub-bitmaps are created on the main thread, as Allegro assigns them ids
+  const int clip_height = clip.GetHeight();
+  for (int i = 0; i < tile_count; ++i)
+  {
+    const int top = clip.Top + clip_height * i / tile_count;
+    const int bottom = clip.Top + clip_height * (i + 1) / tile_count - 1;
+    Bitmap *tile = BitmapHelper::CreateSubBitmap(surface, Rect(clip.Left, top, clip.Right, bottom));
+    if (!tile)
+    {
+      _renderTiles.clear();
+      return false;
     }
-    else if (sprite.ddb == reinterpret_cast<ALSoftwareBitmap*>(DRAWENTRY_TINT))
+    _renderTiles.emplace_back(tile);
+  }
+
+  _renderWorkers->RunTasks(tile_count, [&](size_t index)
+  {
+    const int tile_x = clip.Left;
+    const int tile_y = clip.Top + clip_height * static_cast<int>(index) / tile_count;
+    Bitmap *tile = _renderTiles[index].get();
+    for (size_t i = from; i < to; ++i)
+      RenderSprite(_spriteList[i], surface, tile, surf_offx - tile_x, surf_offy - tile_y);
+  });
+  _renderTiles.clear();
+  return true;
+#else
+  (void)from; (void)to; (void)surface; (void)surf_offx; (void)surf_offy;
+  return false;
+#endif
+}
+
+void SDLRendererGraphicsDriver::RenderSprite(const ALDrawListEntry &sprite, Bitmap *batch_surface,
+    Bitmap *surface, int surf_offx, int surf_offy)
+{
+    if (sprite.ddb == reinterpret_cast<ALSoftwareBitmap*>(DRAWENTRY_TINT))
     {
       // draw screen tint fx
       set_trans_blender(_tint_red, _tint_green, _tint_blue, 0);
       surface->LitBlendBlt(surface, 0, 0, 128);
-      continue;
+      return;
     }
 
     ALSoftwareBitmap* bitmap = sprite.ddb;
@@ -464,7 +570,7 @@ size_t SDLRendererGraphicsDriver::RenderSpriteBatch(const ALSpriteBatch &batch,
     int drawAtY = sprite.y + surf_offy;
 
     if (bitmap->_alpha == 0) {} // fully transparent, do nothing
-    else if ((bitmap->_opaque) && (bitmap->_bmp == surface) && (bitmap->_alpha == 255)) {}
+    else if ((bitmap->_opaque) && (bitmap->_bmp == batch_surface) && (bitmap->_alpha == 255)) {}
     else if (bitmap->_opaque)
     {
         surface->Blit(bitmap->_bmp, 0, 0, drawAtX, drawAtY, bitmap->_bmp->GetWidth(), bitmap->_bmp->GetHeight());
@@ -487,8 +593,6 @@ size_t SDLRendererGraphicsDriver::RenderSpriteBatch(const ALSpriteBatch &batch,
       GfxUtil::DrawSpriteWithTransparency(surface, bitmap->_bmp, drawAtX, drawAtY,
           bitmap->_alpha);
     }
-  }
-  return from;
 }
 
 void SDLRendererGraphicsDriver::BlitToTexture()
@@ -31,6 +31,8 @@
 #include "gfx/gfxdriverfactorybase.h"
 #include "gfx/gfxdriverbase.h"
 
+namespace AGS { namespace Common { class WorkerPool; } }
+
 namespace AGS
 {
 namespace Engine
@@ -157,6 +159,10 @@ public:
     IDriverDependantBitmap* CreateDDB(int width, int height, int color_depth, bool opaque) override;
     IDriverDependantBitmap* CreateDDBFromBitmap(Bitmap *bitmap, bool hasAlpha, bool opaque) override;
     void UpdateDDBFromBitmap(IDriverDependantBitmap* ddb, Bitmap *bitmap, bool hasAlpha) override;
+    void UpdateDDBRegionFromBitmap(IDriverDependantBitmap* ddb, Bitmap *bitmap, bool hasAlpha, const Rect &/*region*/) override
+    { // Software renderer references the bitmap directly, there's nothing to upload
+        UpdateDDBFromBitmap(ddb, bitmap, hasAlpha);
+    }
     void DestroyDDB(IDriverDependantBitmap* ddb) override;
 
     IDriverDependantBitmap *GetSharedDDB(uint32_t /*sprite_id*/,
@@ -182,6 +188,7 @@ public:
     bool SupportsGammaControl() override ;
     void SetGamma(int newGamma) override;
     void UseSmoothScaling(bool /*enabled*/) override { }
+    void SetRenderThreads(int count) override;
     bool DoesSupportVsyncToggle() override { return false; }
     bool SetVsync(bool /*enabled*/) override
     {
@@ -235,6 +242,13 @@ private:
     // List of sprites to render
     std::vector<ALDrawListEntry> _spriteList;
 
+    // Number of threads to draw sprites on, including the main one
+    int _renderThreadCount = 1;
+    // Pool of the render threads, other than the main one
+    std::unique_ptr<Common::WorkerPool> _renderWorkers;
+    // Tiles of the surface rendered in parallel, recreated for each batch
+    std::vector<std::unique_ptr<Common::Bitmap>> _renderTiles;
+
     void InitSpriteBatch(size_t index, const SpriteBatchDesc &desc) override;
     void ResetAllBatches() override;
 
@@ -245,6 +259,14 @@ private:
     void ReleaseDisplayMode();
     // Renders single sprite batch on the precreated surface
     size_t RenderSpriteBatch(const ALSpriteBatch &batch, size_t from, Common::Bitmap *surface, int surf_offx, int surf_offy);
+    // Renders a range of sprites, splitting the surface into horizontal tiles
+    // and drawing them on the render threads; returns false if these sprites
+    // cannot be drawn in parallel, in which case nothing is drawn
+    bool   RenderSpritesTiled(size_t from, size_t to, Common::Bitmap *surface, int surf_offx, int surf_offy);
+    // Renders single sprite list entry; the surface may be either the batch's
+    // surface or its tile (sub-bitmap), with the offsets adjusted accordingly
+    void   RenderSprite(const ALDrawListEntry &sprite, Common::Bitmap *batch_surface,
+                        Common::Bitmap *surface, int surf_offx, int surf_offy);
 
     void highcolor_fade_in(Bitmap *vs, void(*draw_callback)(), int offx, int offy, int speed, int targetColourRed, int targetColourGreen, int targetColourBlue);
     void highcolor_fade_out(Bitmap *vs, void(*draw_callback)(), int offx, int offy, int speed, int targetColourRed, int targetColourGreen, int targetColourBlue);
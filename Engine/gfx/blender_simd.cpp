@@ -0,0 +1,722 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// All the "trans" style blenders (_myblender_alpha_trans24, _blender_alpha32,
+// _argb2rgb_blender) calculate each color component of the result as
+//
+//     y + (x - y) * n / 256
+//
+// using packed R|B and G arithmetic on unsigned integers. This is the same
+// as calculating each component separately, with the product (x - y) * n
+// rounded down, except that the red component also gets a carry from the
+// sum of the product's fraction with the green of y, which is added as a
+// whole to the packed R|B. SIMD kernels below do exactly this on 16-bit
+// lanes, 4 (SSE2, NEON) or 8 (AVX2) pixels at a time.
+//
+//=============================================================================
+#include "gfx/blender_simd.h"
+#include <algorithm>
+#include <allegro.h>
+#include "core/platform.h"
+#include "core/types.h"
+#include "gfx/bitmap.h"
+#include "gfx/blender.h"
+
+#if AGS_PLATFORM_ENDIAN_LITTLE && \
+    (defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86))
+#define AGS_BLEND_X86 (1)
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#else
+#define AGS_BLEND_X86 (0)
+#endif
+
+#if AGS_PLATFORM_ENDIAN_LITTLE && \
+    (defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64))
+#define AGS_BLEND_NEON (1)
+#include <arm_neon.h>
+#else
+#define AGS_BLEND_NEON (0)
+#endif
+
+// GCC and Clang only allow to use the intrinsics in the functions compiled
+// for the matching target, while MSVC allows them anywhere
+#if AGS_BLEND_X86 && (defined(__GNUC__) || defined(__clang__))
+#define AGS_TARGET_SSE2 __attribute__((target("sse2")))
+#define AGS_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define AGS_TARGET_SSE2
+#define AGS_TARGET_AVX2
+#endif
+
+using namespace AGS::Common;
+
+//-----------------------------------------------------------------------------
+// Scalar kernels: these call the original blenders, and are used as a
+// reference, and for the remaining pixels which do not fill SIMD register
+//-----------------------------------------------------------------------------
+
+// dst = _myblender_alpha_trans24(color, src, n), where src is not a mask color
+static void lit_row_scalar(uint32_t *dst, const uint32_t *src, int count, uint32_t color, uint32_t n)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        const uint32_t c = src[i];
+        if (c != MASK_COLOR_32)
+            dst[i] = static_cast<uint32_t>(_myblender_alpha_trans24(color, c, n));
+    }
+}
+
+// dst = _myblender_alpha_trans24(src, dst, n), where src is not a mask color
+static void trans_row_scalar(uint32_t *dst, const uint32_t *src, int count, uint32_t n)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        const uint32_t c = src[i];
+        if (c != MASK_COLOR_32)
+            dst[i] = static_cast<uint32_t>(_myblender_alpha_trans24(c, dst[i], n));
+    }
+}
+
+// dst = _argb2rgb_blender(src, dst, alpha), where src is not a mask color
+static void alpha_row_scalar(uint32_t *dst, const uint32_t *src, int count, uint32_t alpha)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        const uint32_t c = src[i];
+        if (c != MASK_COLOR_32)
+            dst[i] = static_cast<uint32_t>(_argb2rgb_blender(c, dst[i], alpha));
+    }
+}
+
+// dst = _opaque_alpha_blender(src, dst, 0), where src is not a mask color
+static void opaque_alpha_row_scalar(uint32_t *dst, const uint32_t *src, int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        const uint32_t c = src[i];
+        if (c != MASK_COLOR_32)
+            dst[i] = c | 0xFF000000u;
+    }
+}
+
+// Converts blender's amount to the factor used in the component formula
+inline uint32_t trans_factor(uint32_t n)
+{
+    return n ? n + 1 : 0;
+}
+
+// Converts blender's alpha parameter to the multiplier of the pixel's alpha
+// used by _argb2rgb_blender, or 0 if the pixel's alpha is used as is
+inline uint32_t alpha_multiplier(uint32_t alpha)
+{
+    return alpha > 0 ? (alpha & 0xFF) + 1 : 0;
+}
+
+
+#if AGS_BLEND_X86
+//-----------------------------------------------------------------------------
+// SSE2 kernels
+//-----------------------------------------------------------------------------
+
+// Blends 16-bit component lanes: y + (((x - y) * n + c) >> 8)
+AGS_TARGET_SSE2 static inline __m128i trans_lanes_sse2(__m128i x, __m128i y, __m128i c, __m128i n)
+{
+    const __m128i d = _mm_sub_epi16(x, y);
+    // the 32-bit product does not fit the lane, so it is shifted from halves
+    const __m128i lo = _mm_mullo_epi16(d, n);
+    const __m128i hi = _mm_mulhi_epi16(d, n);
+    const __m128i carry = _mm_srli_epi16(_mm_add_epi16(_mm_srli_epi16(_mm_slli_epi16(lo, 8), 8), c), 8);
+    const __m128i p = _mm_or_si128(_mm_slli_epi16(hi, 8), _mm_srli_epi16(lo, 8));
+    return _mm_add_epi16(_mm_add_epi16(y, p), carry);
+}
+
+// Blends 4 pixels; n_lo and n_hi are factors for the pixels 0-1 and 2-3
+AGS_TARGET_SSE2 static inline __m128i trans_px_sse2(__m128i x, __m128i y, __m128i n_lo, __m128i n_hi)
+{
+    const __m128i zero = _mm_setzero_si128();
+    // green of y, at the red position
+    const __m128i c = _mm_and_si128(_mm_slli_epi32(y, 8), _mm_set1_epi32(0x00FF0000));
+    const __m128i lo = trans_lanes_sse2(_mm_unpacklo_epi8(x, zero), _mm_unpacklo_epi8(y, zero),
+        _mm_unpacklo_epi8(c, zero), n_lo);
+    const __m128i hi = trans_lanes_sse2(_mm_unpackhi_epi8(x, zero), _mm_unpackhi_epi8(y, zero),
+        _mm_unpackhi_epi8(c, zero), n_hi);
+    return _mm_packus_epi16(lo, hi);
+}
+
+// Calculates _argb2rgb_blender factors from the pixels' alpha, spread over
+// the component lanes of the pixels 0-1 and 2-3
+AGS_TARGET_SSE2 static inline void alpha_factors_sse2(__m128i s, int mul, __m128i &n_lo, __m128i &n_hi)
+{
+    __m128i n = _mm_srli_epi32(s, 24);
+    if (mul > 0) // alpha * mul fits 16 bits, and the high words are zero
+        n = _mm_srli_epi32(_mm_mullo_epi16(n, _mm_set1_epi32(mul)), 8);
+    n = _mm_sub_epi32(n, _mm_cmpgt_epi32(n, _mm_setzero_si128())); // n + 1 if n > 0
+    n = _mm_or_si128(n, _mm_slli_epi32(n, 16));
+    n_lo = _mm_unpacklo_epi32(n, n);
+    n_hi = _mm_unpackhi_epi32(n, n);
+}
+
+// Keeps the destination pixels where the source is a mask color
+AGS_TARGET_SSE2 static inline __m128i skip_mask_sse2(__m128i s, __m128i d, __m128i res)
+{
+    const __m128i skip = _mm_cmpeq_epi32(s, _mm_set1_epi32(MASK_COLOR_32));
+    return _mm_or_si128(_mm_and_si128(skip, d), _mm_andnot_si128(skip, res));
+}
+
+AGS_TARGET_SSE2 static void lit_row_sse2(uint32_t *dst, const uint32_t *src, int count, uint32_t color, uint32_t n)
+{
+    int i = 0;
+    if (n <= 0xFF)
+    {
+        const __m128i x = _mm_set1_epi32(static_cast<int>(color));
+        const __m128i nn = _mm_set1_epi16(static_cast<short>(trans_factor(n)));
+        const __m128i amask = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+        for (; i + 4 <= count; i += 4)
+        {
+            const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+            __m128i res = trans_px_sse2(x, s, nn, nn);
+            res = _mm_or_si128(_mm_andnot_si128(amask, res), _mm_and_si128(amask, s));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), skip_mask_sse2(s, d, res));
+        }
+    }
+    lit_row_scalar(dst + i, src + i, count - i, color, n);
+}
+
+AGS_TARGET_SSE2 static void trans_row_sse2(uint32_t *dst, const uint32_t *src, int count, uint32_t n)
+{
+    int i = 0;
+    if (n <= 0xFF)
+    {
+        const __m128i nn = _mm_set1_epi16(static_cast<short>(trans_factor(n)));
+        const __m128i amask = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+        for (; i + 4 <= count; i += 4)
+        {
+            const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+            __m128i res = trans_px_sse2(s, d, nn, nn);
+            res = _mm_or_si128(_mm_andnot_si128(amask, res), _mm_and_si128(amask, d));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), skip_mask_sse2(s, d, res));
+        }
+    }
+    trans_row_scalar(dst + i, src + i, count - i, n);
+}
+
+AGS_TARGET_SSE2 static void alpha_row_sse2(uint32_t *dst, const uint32_t *src, int count, uint32_t alpha)
+{
+    const int mul = static_cast<int>(alpha_multiplier(alpha));
+    const __m128i rgb_mask = _mm_set1_epi32(0x00FFFFFF);
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        __m128i n_lo, n_hi;
+        alpha_factors_sse2(s, mul, n_lo, n_hi);
+        const __m128i res = _mm_and_si128(trans_px_sse2(s, d, n_lo, n_hi), rgb_mask);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), skip_mask_sse2(s, d, res));
+    }
+    alpha_row_scalar(dst + i, src + i, count - i, alpha);
+}
+
+AGS_TARGET_SSE2 static void opaque_alpha_row_sse2(uint32_t *dst, const uint32_t *src, int count)
+{
+    const __m128i amask = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), skip_mask_sse2(s, d, _mm_or_si128(s, amask)));
+    }
+    opaque_alpha_row_scalar(dst + i, src + i, count - i);
+}
+
+//-----------------------------------------------------------------------------
+// AVX2 kernels: same as SSE2 ones, but for 8 pixels; AVX2 unpack and pack
+// instructions work within 128-bit halves, which does not matter here,
+// as long as all the operands are unpacked the same way
+//-----------------------------------------------------------------------------
+
+AGS_TARGET_AVX2 static inline __m256i trans_lanes_avx2(__m256i x, __m256i y, __m256i c, __m256i n)
+{
+    const __m256i d = _mm256_sub_epi16(x, y);
+    const __m256i lo = _mm256_mullo_epi16(d, n);
+    const __m256i hi = _mm256_mulhi_epi16(d, n);
+    const __m256i carry = _mm256_srli_epi16(_mm256_add_epi16(_mm256_srli_epi16(_mm256_slli_epi16(lo, 8), 8), c), 8);
+    const __m256i p = _mm256_or_si256(_mm256_slli_epi16(hi, 8), _mm256_srli_epi16(lo, 8));
+    return _mm256_add_epi16(_mm256_add_epi16(y, p), carry);
+}
+
+AGS_TARGET_AVX2 static inline __m256i trans_px_avx2(__m256i x, __m256i y, __m256i n_lo, __m256i n_hi)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i c = _mm256_and_si256(_mm256_slli_epi32(y, 8), _mm256_set1_epi32(0x00FF0000));
+    const __m256i lo = trans_lanes_avx2(_mm256_unpacklo_epi8(x, zero), _mm256_unpacklo_epi8(y, zero),
+        _mm256_unpacklo_epi8(c, zero), n_lo);
+    const __m256i hi = trans_lanes_avx2(_mm256_unpackhi_epi8(x, zero), _mm256_unpackhi_epi8(y, zero),
+        _mm256_unpackhi_epi8(c, zero), n_hi);
+    return _mm256_packus_epi16(lo, hi);
+}
+
+AGS_TARGET_AVX2 static inline void alpha_factors_avx2(__m256i s, int mul, __m256i &n_lo, __m256i &n_hi)
+{
+    __m256i n = _mm256_srli_epi32(s, 24);
+    if (mul > 0)
+        n = _mm256_srli_epi32(_mm256_mullo_epi16(n, _mm256_set1_epi32(mul)), 8);
+    n = _mm256_sub_epi32(n, _mm256_cmpgt_epi32(n, _mm256_setzero_si256()));
+    n = _mm256_or_si256(n, _mm256_slli_epi32(n, 16));
+    n_lo = _mm256_unpacklo_epi32(n, n);
+    n_hi = _mm256_unpackhi_epi32(n, n);
+}
+
+AGS_TARGET_AVX2 static inline __m256i skip_mask_avx2(__m256i s, __m256i d, __m256i res)
+{
+    const __m256i skip = _mm256_cmpeq_epi32(s, _mm256_set1_epi32(MASK_COLOR_32));
+    return _mm256_blendv_epi8(res, d, skip);
+}
+
+AGS_TARGET_AVX2 static void lit_row_avx2(uint32_t *dst, const uint32_t *src, int count, uint32_t color, uint32_t n)
+{
+    int i = 0;
+    if (n <= 0xFF)
+    {
+        const __m256i x = _mm256_set1_epi32(static_cast<int>(color));
+        const __m256i nn = _mm256_set1_epi16(static_cast<short>(trans_factor(n)));
+        const __m256i amask = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+        for (; i + 8 <= count; i += 8)
+        {
+            const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+            const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+            __m256i res = trans_px_avx2(x, s, nn, nn);
+            res = _mm256_blendv_epi8(res, s, amask);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), skip_mask_avx2(s, d, res));
+        }
+    }
+    lit_row_scalar(dst + i, src + i, count - i, color, n);
+}
+
+AGS_TARGET_AVX2 static void trans_row_avx2(uint32_t *dst, const uint32_t *src, int count, uint32_t n)
+{
+    int i = 0;
+    if (n <= 0xFF)
+    {
+        const __m256i nn = _mm256_set1_epi16(static_cast<short>(trans_factor(n)));
+        const __m256i amask = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+        for (; i + 8 <= count; i += 8)
+        {
+            const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+            const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+            __m256i res = trans_px_avx2(s, d, nn, nn);
+            res = _mm256_blendv_epi8(res, d, amask);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), skip_mask_avx2(s, d, res));
+        }
+    }
+    trans_row_scalar(dst + i, src + i, count - i, n);
+}
+
+AGS_TARGET_AVX2 static void alpha_row_avx2(uint32_t *dst, const uint32_t *src, int count, uint32_t alpha)
+{
+    const int mul = static_cast<int>(alpha_multiplier(alpha));
+    const __m256i rgb_mask = _mm256_set1_epi32(0x00FFFFFF);
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        __m256i n_lo, n_hi;
+        alpha_factors_avx2(s, mul, n_lo, n_hi);
+        const __m256i res = _mm256_and_si256(trans_px_avx2(s, d, n_lo, n_hi), rgb_mask);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), skip_mask_avx2(s, d, res));
+    }
+    alpha_row_scalar(dst + i, src + i, count - i, alpha);
+}
+
+AGS_TARGET_AVX2 static void opaque_alpha_row_avx2(uint32_t *dst, const uint32_t *src, int count)
+{
+    const __m256i amask = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), skip_mask_avx2(s, d, _mm256_or_si256(s, amask)));
+    }
+    opaque_alpha_row_scalar(dst + i, src + i, count - i);
+}
+
+//-----------------------------------------------------------------------------
+// x86 CPU features detection
+//-----------------------------------------------------------------------------
+
+static bool cpu_has_sse2()
+{
+#if defined(_M_X64) || defined(__x86_64__)
+    return true; // part of the 64-bit instruction set
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[3] & (1 << 26)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2") != 0;
+#endif
+}
+
+static bool cpu_has_avx2()
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+    __cpuid(info, 1);
+    // the OS must also save the AVX registers on the context switch
+    const bool os_avx = ((info[2] & (1 << 27)) != 0) && ((info[2] & (1 << 28)) != 0) &&
+        ((_xgetbv(0) & 0x6) == 0x6);
+    if (!os_avx)
+        return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+#endif // AGS_BLEND_X86
+
+
+#if AGS_BLEND_NEON
+//-----------------------------------------------------------------------------
+// NEON kernels
+//-----------------------------------------------------------------------------
+
+// Blends 16-bit component lanes: y + (((x - y) * n + c) >> 8)
+static inline int16x8_t trans_lanes_neon(uint8x8_t x, uint8x8_t y, uint8x8_t c, int16x8_t n)
+{
+    const int16x8_t y16 = vreinterpretq_s16_u16(vmovl_u8(y));
+    const int16x8_t c16 = vreinterpretq_s16_u16(vmovl_u8(c));
+    const int16x8_t d = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(x)), y16);
+    const int32x4_t p_lo = vaddw_s16(vmull_s16(vget_low_s16(d), vget_low_s16(n)), vget_low_s16(c16));
+    const int32x4_t p_hi = vaddw_s16(vmull_s16(vget_high_s16(d), vget_high_s16(n)), vget_high_s16(c16));
+    return vaddq_s16(y16, vcombine_s16(vshrn_n_s32(p_lo, 8), vshrn_n_s32(p_hi, 8)));
+}
+
+// Blends 4 pixels; n_lo and n_hi are factors for the pixels 0-1 and 2-3
+static inline uint32x4_t trans_px_neon(uint32x4_t x, uint32x4_t y, int16x8_t n_lo, int16x8_t n_hi)
+{
+    const uint8x16_t x8 = vreinterpretq_u8_u32(x);
+    const uint8x16_t y8 = vreinterpretq_u8_u32(y);
+    // green of y, at the red position
+    const uint8x16_t c8 = vreinterpretq_u8_u32(vandq_u32(vshlq_n_u32(y, 8), vdupq_n_u32(0x00FF0000u)));
+    const int16x8_t lo = trans_lanes_neon(vget_low_u8(x8), vget_low_u8(y8), vget_low_u8(c8), n_lo);
+    const int16x8_t hi = trans_lanes_neon(vget_high_u8(x8), vget_high_u8(y8), vget_high_u8(c8), n_hi);
+    return vreinterpretq_u32_u8(vcombine_u8(vqmovun_s16(lo), vqmovun_s16(hi)));
+}
+
+static inline void alpha_factors_neon(uint32x4_t s, uint32_t mul, int16x8_t &n_lo, int16x8_t &n_hi)
+{
+    uint32x4_t n = vshrq_n_u32(s, 24);
+    if (mul > 0)
+        n = vshrq_n_u32(vmulq_n_u32(n, mul), 8);
+    n = vsubq_u32(n, vcgtq_u32(n, vdupq_n_u32(0))); // n + 1 if n > 0
+    n = vorrq_u32(n, vshlq_n_u32(n, 16));
+    const uint32x4x2_t nn = vzipq_u32(n, n);
+    n_lo = vreinterpretq_s16_u32(nn.val[0]);
+    n_hi = vreinterpretq_s16_u32(nn.val[1]);
+}
+
+static inline uint32x4_t skip_mask_neon(uint32x4_t s, uint32x4_t d, uint32x4_t res)
+{
+    return vbslq_u32(vceqq_u32(s, vdupq_n_u32(MASK_COLOR_32)), d, res);
+}
+
+static void lit_row_neon(uint32_t *dst, const uint32_t *src, int count, uint32_t color, uint32_t n)
+{
+    int i = 0;
+    if (n <= 0xFF)
+    {
+        const uint32x4_t x = vdupq_n_u32(color);
+        const int16x8_t nn = vdupq_n_s16(static_cast<int16_t>(trans_factor(n)));
+        const uint32x4_t amask = vdupq_n_u32(0xFF000000u);
+        for (; i + 4 <= count; i += 4)
+        {
+            const uint32x4_t s = vld1q_u32(src + i);
+            const uint32x4_t d = vld1q_u32(dst + i);
+            const uint32x4_t res = vbslq_u32(amask, s, trans_px_neon(x, s, nn, nn));
+            vst1q_u32(dst + i, skip_mask_neon(s, d, res));
+        }
+    }
+    lit_row_scalar(dst + i, src + i, count - i, color, n);
+}
+
+static void trans_row_neon(uint32_t *dst, const uint32_t *src, int count, uint32_t n)
+{
+    int i = 0;
+    if (n <= 0xFF)
+    {
+        const int16x8_t nn = vdupq_n_s16(static_cast<int16_t>(trans_factor(n)));
+        const uint32x4_t amask = vdupq_n_u32(0xFF000000u);
+        for (; i + 4 <= count; i += 4)
+        {
+            const uint32x4_t s = vld1q_u32(src + i);
+            const uint32x4_t d = vld1q_u32(dst + i);
+            const uint32x4_t res = vbslq_u32(amask, d, trans_px_neon(s, d, nn, nn));
+            vst1q_u32(dst + i, skip_mask_neon(s, d, res));
+        }
+    }
+    trans_row_scalar(dst + i, src + i, count - i, n);
+}
+
+static void alpha_row_neon(uint32_t *dst, const uint32_t *src, int count, uint32_t alpha)
+{
+    const uint32_t mul = alpha_multiplier(alpha);
+    const uint32x4_t rgb_mask = vdupq_n_u32(0x00FFFFFFu);
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const uint32x4_t s = vld1q_u32(src + i);
+        const uint32x4_t d = vld1q_u32(dst + i);
+        int16x8_t n_lo, n_hi;
+        alpha_factors_neon(s, mul, n_lo, n_hi);
+        const uint32x4_t res = vandq_u32(trans_px_neon(s, d, n_lo, n_hi), rgb_mask);
+        vst1q_u32(dst + i, skip_mask_neon(s, d, res));
+    }
+    alpha_row_scalar(dst + i, src + i, count - i, alpha);
+}
+
+static void opaque_alpha_row_neon(uint32_t *dst, const uint32_t *src, int count)
+{
+    const uint32x4_t amask = vdupq_n_u32(0xFF000000u);
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const uint32x4_t s = vld1q_u32(src + i);
+        const uint32x4_t d = vld1q_u32(dst + i);
+        vst1q_u32(dst + i, skip_mask_neon(s, d, vorrq_u32(s, amask)));
+    }
+    opaque_alpha_row_scalar(dst + i, src + i, count - i);
+}
+#endif // AGS_BLEND_NEON
+
+
+//-----------------------------------------------------------------------------
+// Kernels selection
+//-----------------------------------------------------------------------------
+
+struct BlendKernels
+{
+    void (*LitRow)(uint32_t *dst, const uint32_t *src, int count, uint32_t color, uint32_t n);
+    void (*TransRow)(uint32_t *dst, const uint32_t *src, int count, uint32_t n);
+    void (*AlphaRow)(uint32_t *dst, const uint32_t *src, int count, uint32_t alpha);
+    void (*OpaqueAlphaRow)(uint32_t *dst, const uint32_t *src, int count);
+};
+
+static const BlendKernels KernelsScalar =
+    { lit_row_scalar, trans_row_scalar, alpha_row_scalar, opaque_alpha_row_scalar };
+#if AGS_BLEND_X86
+static const BlendKernels KernelsSSE2 =
+    { lit_row_sse2, trans_row_sse2, alpha_row_sse2, opaque_alpha_row_sse2 };
+static const BlendKernels KernelsAVX2 =
+    { lit_row_avx2, trans_row_avx2, alpha_row_avx2, opaque_alpha_row_avx2 };
+#endif
+#if AGS_BLEND_NEON
+static const BlendKernels KernelsNEON =
+    { lit_row_neon, trans_row_neon, alpha_row_neon, opaque_alpha_row_neon };
+#endif
+
+static const BlendKernels *Kernels = &KernelsScalar;
+static BlendSimdSet KernelSet = kBlendSimd_Scalar;
+
+BlendSimdSet init_blend_kernels()
+{
+    if (!set_blend_kernels(kBlendSimd_AVX2) &&
+        !set_blend_kernels(kBlendSimd_SSE2) &&
+        !set_blend_kernels(kBlendSimd_NEON))
+        set_blend_kernels(kBlendSimd_Scalar);
+    return KernelSet;
+}
+
+bool set_blend_kernels(BlendSimdSet set)
+{
+    const BlendKernels *kernels = nullptr;
+    switch (set)
+    {
+    case kBlendSimd_Scalar:
+        kernels = &KernelsScalar;
+        break;
+#if AGS_BLEND_X86
+    case kBlendSimd_SSE2:
+        if (cpu_has_sse2())
+            kernels = &KernelsSSE2;
+        break;
+    case kBlendSimd_AVX2:
+        if (cpu_has_avx2())
+            kernels = &KernelsAVX2;
+        break;
+#endif
+#if AGS_BLEND_NEON
+    case kBlendSimd_NEON:
+        kernels = &KernelsNEON;
+        break;
+#endif
+    default:
+        break;
+    }
+    if (!kernels)
+        return false;
+    Kernels = kernels;
+    KernelSet = set;
+    return true;
+}
+
+BlendSimdSet get_blend_kernels()
+{
+    return KernelSet;
+}
+
+const char *get_blend_kernels_name(BlendSimdSet set)
+{
+    switch (set)
+    {
+    case kBlendSimd_SSE2: return "SSE2";
+    case kBlendSimd_AVX2: return "AVX2";
+    case kBlendSimd_NEON: return "NEON";
+    default: return "scalar";
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+// Sprite drawing
+//-----------------------------------------------------------------------------
+
+// Clips the sprite by the destination's clip rect, same way as Allegro's
+// sprite routines do, and calls the row function for each visible row
+template <typename TRowFn>
+static void draw_rows(Bitmap *ds, Bitmap *sprite, int x, int y, TRowFn row_fn)
+{
+    const Rect clip = ds->GetClip();
+    const int sx = std::max(0, clip.Left - x);
+    const int sy = std::max(0, clip.Top - y);
+    const int w = std::min(sprite->GetWidth(), clip.Right + 1 - x) - sx;
+    const int h = std::min(sprite->GetHeight(), clip.Bottom + 1 - y) - sy;
+    if ((w <= 0) || (h <= 0))
+        return;
+    for (int row = 0; row < h; ++row)
+    {
+        uint32_t *dst = reinterpret_cast<uint32_t*>(ds->GetScanLineForWriting(y + sy + row)) + x + sx;
+        const uint32_t *src = reinterpret_cast<const uint32_t*>(sprite->GetScanLine(sy + row)) + sx;
+        row_fn(dst, src, w);
+    }
+}
+
+inline bool is_32bit_pair(Bitmap *ds, Bitmap *sprite)
+{
+    return (ds->GetColorDepth() == 32) && (sprite->GetColorDepth() == 32);
+}
+
+bool draw_lit_sprite32(Bitmap *ds, Bitmap *sprite, int x, int y, int r, int g, int b, int light_amount)
+{
+    if (!is_32bit_pair(ds, sprite))
+        return false;
+    const uint32_t color = static_cast<uint32_t>(makecol32(r, g, b));
+    const uint32_t n = static_cast<uint32_t>(light_amount);
+    const auto lit_row = Kernels->LitRow;
+    draw_rows(ds, sprite, x, y, [lit_row, color, n](uint32_t *dst, const uint32_t *src, int w)
+        { lit_row(dst, src, w, color, n); });
+    return true;
+}
+
+bool draw_tinted_sprite32(Bitmap *ds, Bitmap *sprite, int x, int y, int r, int g, int b, int luminance)
+{
+    if (!is_32bit_pair(ds, sprite))
+        return false;
+    // The tint blenders combine hue and saturation of the tint color with
+    // the value of the pixel, which is its max color component; so the
+    // result only depends on the latter, and may be looked up in a table.
+    const unsigned long color = makecol32(r, g, b);
+    unsigned long (*blender)(unsigned long, unsigned long, unsigned long) =
+        (luminance >= 250) ? _myblender_color32 : _myblender_color32_light;
+    uint32_t lut[256];
+    for (int v = 0; v < 256; ++v)
+        lut[v] = static_cast<uint32_t>(blender(color, makeacol32(v, 0, 0, 0), luminance));
+    const uint32_t amask = static_cast<uint32_t>(makeacol32(0, 0, 0, 0xFF));
+    draw_rows(ds, sprite, x, y, [&lut, amask](uint32_t *dst, const uint32_t *src, int w)
+    {
+        for (int i = 0; i < w; ++i)
+        {
+            const uint32_t c = src[i];
+            if (c == MASK_COLOR_32)
+                continue;
+            const int v = std::max(getr32(c), std::max(getg32(c), getb32(c)));
+            dst[i] = lut[v] | (c & amask);
+        }
+    });
+    return true;
+}
+
+bool draw_trans_sprite32(Bitmap *ds, Bitmap *sprite, int x, int y, BlendRowMode mode, int alpha)
+{
+    if (!is_32bit_pair(ds, sprite))
+        return false;
+    const uint32_t n = static_cast<uint32_t>(alpha);
+    switch (mode)
+    {
+    case kBlendRow_MyTrans:
+    {
+        const auto trans_row = Kernels->TransRow;
+        draw_rows(ds, sprite, x, y, [trans_row, n](uint32_t *dst, const uint32_t *src, int w)
+            { trans_row(dst, src, w, n); });
+        return true;
+    }
+    case kBlendRow_Argb2Rgb:
+    {
+        // SIMD kernels expect alpha in the highest byte
+        const auto alpha_row = (_rgb_a_shift_32 == 24) ? Kernels->AlphaRow : alpha_row_scalar;
+        draw_rows(ds, sprite, x, y, [alpha_row, n](uint32_t *dst, const uint32_t *src, int w)
+            { alpha_row(dst, src, w, n); });
+        return true;
+    }
+    case kBlendRow_Argb2Argb:
+    case kBlendRow_Rgb2Argb:
+    {
+        // these divide by the resulting alpha, and are left scalar
+        unsigned long (*blender)(unsigned long, unsigned long, unsigned long) =
+            (mode == kBlendRow_Argb2Argb) ? _argb2argb_blender : _rgb2argb_blender;
+        draw_rows(ds, sprite, x, y, [blender, n](uint32_t *dst, const uint32_t *src, int w)
+        {
+            for (int i = 0; i < w; ++i)
+            {
+                const uint32_t c = src[i];
+                if (c != MASK_COLOR_32)
+                    dst[i] = static_cast<uint32_t>(blender(c, dst[i], n));
+            }
+        });
+        return true;
+    }
+    case kBlendRow_OpaqueAlpha:
+    {
+        const auto opaque_row = Kernels->OpaqueAlphaRow;
+        draw_rows(ds, sprite, x, y, [opaque_row](uint32_t *dst, const uint32_t *src, int w)
+            { opaque_row(dst, src, w); });
+        return true;
+    }
+    default:
+        return false;
+    }
+}
@@ -0,0 +1,76 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Row blending kernels for the 32-bit blenders declared in blender.h.
+//
+// Allegro's sprite routines call the blender through a function pointer
+// for each pixel. Functions below draw a whole row at once instead, using
+// SIMD instructions where possible: SSE2 or AVX2 on x86, chosen at runtime
+// by the CPU features, or NEON when the engine is built for ARM with it.
+// Each function gives exactly the same result as the Allegro routine with
+// the matching blender set. If it cannot handle the given bitmaps (e.g.
+// these are not 32-bit) it returns false without drawing anything, and
+// the caller should fall back to Allegro.
+//
+//=============================================================================
+#ifndef __AC_BLENDERSIMD_H
+#define __AC_BLENDERSIMD_H
+
+namespace AGS { namespace Common { class Bitmap; } }
+
+// Instruction set used by the row kernels
+enum BlendSimdSet
+{
+    kBlendSimd_Scalar,
+    kBlendSimd_SSE2,
+    kBlendSimd_AVX2,
+    kBlendSimd_NEON,
+    kNumBlendSimdSets
+};
+
+// Blender to use with draw_trans_sprite32
+enum BlendRowMode
+{
+    kBlendRow_MyTrans,      // set_my_trans_blender(0, 0, 0, alpha)
+    kBlendRow_Argb2Rgb,     // _argb2rgb_blender; with alpha 0 same as set_alpha_blender()
+    kBlendRow_Argb2Argb,    // _argb2argb_blender
+    kBlendRow_Rgb2Argb,     // _rgb2argb_blender
+    kBlendRow_OpaqueAlpha   // _opaque_alpha_blender
+};
+
+// Selects the fastest kernels supported by both the build and the CPU;
+// returns the selected instruction set
+BlendSimdSet init_blend_kernels();
+// Selects the kernels for the given instruction set; returns false if it's
+// not supported, in which case the selection is not changed
+bool set_blend_kernels(BlendSimdSet set);
+// Returns the instruction set of the current kernels
+BlendSimdSet get_blend_kernels();
+const char *get_blend_kernels_name(BlendSimdSet set);
+
+// Same as set_my_trans_blender(r, g, b, 0) followed by
+// ds->LitBlendBlt(sprite, x, y, light_amount)
+bool draw_lit_sprite32(AGS::Common::Bitmap *ds, AGS::Common::Bitmap *sprite, int x, int y,
+    int r, int g, int b, int light_amount);
+// Same as setting _myblender_color* blenders with the (r, g, b) tint color,
+// or _myblender_color*_light ones if luminance is below 250, followed by
+// ds->LitBlendBlt(sprite, x, y, luminance)
+bool draw_tinted_sprite32(AGS::Common::Bitmap *ds, AGS::Common::Bitmap *sprite, int x, int y,
+    int r, int g, int b, int luminance);
+// Same as setting the blender for the given mode and alpha, followed by
+// ds->TransBlendBlt(sprite, x, y)
+bool draw_trans_sprite32(AGS::Common::Bitmap *ds, AGS::Common::Bitmap *sprite, int x, int y,
+    BlendRowMode mode, int alpha);
+
+#endif // __AC_BLENDERSIMD_H
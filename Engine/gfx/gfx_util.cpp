@@ -15,6 +15,7 @@
 #include "core/platform.h"
 #include "gfx/gfx_util.h"
 #include "gfx/blender.h"
+#include "gfx/blender_simd.h"
 
 namespace AGS
 {
@@ -64,24 +65,31 @@ static const BlendModeSetter BlendModeSets[kNumBlendModes] =
     // NOTE: add new modes here
 };
 
-bool SetBlender(BlendMode blend_mode, bool dst_has_alpha, bool src_has_alpha, int blend_alpha)
+PfnBlenderCb GetBlender(BlendMode blend_mode, bool dst_has_alpha, bool src_has_alpha, int blend_alpha)
 {
     if (blend_mode < 0 || blend_mode > kNumBlendModes)
-        return false;
+        return nullptr;
     const BlendModeSetter &set = BlendModeSets[blend_mode];
-    PfnBlenderCb blender;
     if (dst_has_alpha)
-        blender = src_has_alpha ? set.AllAlpha :
+        return src_has_alpha ? set.AllAlpha :
             (blend_alpha == 0xFF ? set.OpaqueToAlphaNoTrans : set.OpaqueToAlpha);
-    else
-        blender = src_has_alpha ? set.AlphaToOpaque : set.AllOpaque;
+    return src_has_alpha ? set.AlphaToOpaque : set.AllOpaque;
+}
 
-    if (blender)
-    {
-        set_blender_mode(nullptr, nullptr, blender, 0, 0, 0, blend_alpha);
-        return true;
-    }
-    return false;
+// Finds the row kernels' mode which gives same result as the blender
+bool GetBlendRowMode(PfnBlenderCb blender, BlendRowMode &row_mode)
+{
+    if (blender == _argb2argb_blender)
+        row_mode = kBlendRow_Argb2Argb;
+    else if (blender == _argb2rgb_blender)
+        row_mode = kBlendRow_Argb2Rgb;
+    else if (blender == _rgb2argb_blender)
+        row_mode = kBlendRow_Rgb2Argb;
+    else if (blender == _opaque_alpha_blender)
+        row_mode = kBlendRow_OpaqueAlpha;
+    else
+        return false;
+    return true;
 }
 
 void DrawSpriteBlend(Bitmap *ds, const Point &ds_at, Bitmap *sprite,
@@ -90,11 +98,16 @@ void DrawSpriteBlend(Bitmap *ds, const Point &ds_at, Bitmap *sprite,
     if (blend_alpha <= 0)
         return; // do not draw 100% transparent image
 
-    if (// support only 32-bit blending at the moment
-        ds->GetColorDepth() == 32 && sprite->GetColorDepth() == 32 &&
-        // set blenders if applicable and tell if succeeded
-        SetBlender(blend_mode, dst_has_alpha, src_has_alpha, blend_alpha))
+    // support only 32-bit blending at the moment
+    PfnBlenderCb blender = (ds->GetColorDepth() == 32 && sprite->GetColorDepth() == 32) ?
+        GetBlender(blend_mode, dst_has_alpha, src_has_alpha, blend_alpha) : nullptr;
+    if (blender)
     {
+        BlendRowMode row_mode;
+        if (GetBlendRowMode(blender, row_mode) &&
+            draw_trans_sprite32(ds, sprite, ds_at.X, ds_at.Y, row_mode, blend_alpha))
+            return;
+        set_blender_mode(nullptr, nullptr, blender, 0, 0, 0, blend_alpha);
         ds->TransBlendBlt(sprite, ds_at.X, ds_at.Y);
     }
     else
@@ -129,6 +129,9 @@ public:
   // Creates DDB, initializes from the given bitmap
   virtual IDriverDependantBitmap* CreateDDBFromBitmap(Common::Bitmap *bitmap, bool hasAlpha, bool opaque = false) = 0;
   virtual void UpdateDDBFromBitmap(IDriverDependantBitmap* bitmapToUpdate, Common::Bitmap *bitmap, bool hasAlpha) = 0;
+  // Updates only the given region of DDB from the bitmap of the same size;
+  // the region is in the bitmap's coordinates
+  virtual void UpdateDDBRegionFromBitmap(IDriverDependantBitmap* bitmapToUpdate, Common::Bitmap *bitmap, bool hasAlpha, const Rect &region) = 0;
   virtual void DestroyDDB(IDriverDependantBitmap* bitmap) = 0;
 
   // Get shared texture from cache, or create from bitmap and assign ID
@@ -187,6 +190,10 @@ public:
   // Runs box-out animation in a blocking manner.
   virtual void BoxOutEffect(bool blackingOut, int speed, int delay) = 0;
   virtual void UseSmoothScaling(bool enabled) = 0;
+  // Sets the number of threads the renderer may use to draw the sprites;
+  // 0 lets the renderer decide, 1 means to only draw on the calling thread.
+  // Not all renderers support this.
+  virtual void SetRenderThreads(int count) = 0;
   virtual bool SupportsGammaControl() = 0;
   virtual void SetGamma(int newGamma) = 0;
   // Returns the virtual screen. Will return NULL if renderer does not support memory backbuffer.
@@ -26,6 +26,7 @@
 #include "debug/debugger.h"
 #include "debug/debug_log.h"
 #include "device/mousew32.h"
+#include "font/fonts.h"
 #include "main/config.h"
 #include "media/audio/audio_system.h"
 #include "platform/base/agsplatformdriver.h"
@@ -327,6 +328,7 @@ void apply_config(const ConfigTree &cfg)
         usetup.Screen.Params.VSync = CfgReadBoolInt(cfg, "graphics", "vsync");
         usetup.RenderAtScreenRes = CfgReadBoolInt(cfg, "graphics", "render_at_screenres");
         usetup.Supersampling = CfgReadInt(cfg, "graphics", "supersampling", 1);
+        usetup.RenderThreads = CfgReadInt(cfg, "graphics", "render_threads", usetup.RenderThreads);
         usetup.software_render_driver = CfgReadString(cfg, "graphics", "software_driver");
 
         usetup.rotation = (ScreenRotation)CfgReadInt(cfg, "graphics", "rotation", usetup.rotation);
@@ -348,15 +350,30 @@ void apply_config(const ConfigTree &cfg)
 
         // Resource caches and options
         usetup.clear_cache_on_room_change = CfgReadBoolInt(cfg, "misc", "clear_cache_on_room_change", usetup.clear_cache_on_room_change);
+        usetup.prefetch_sprites = CfgReadBoolInt(cfg, "misc", "prefetch_sprites", usetup.prefetch_sprites);
+        usetup.mmap_sprites = CfgReadBoolInt(cfg, "misc", "mmap_sprites", usetup.mmap_sprites);
+        usetup.mmap_assets = CfgReadBoolInt(cfg, "misc", "mmap_assets", usetup.mmap_assets);
+        usetup.script_predecode = CfgReadBoolInt(cfg, "misc", "script_predecode", usetup.script_predecode);
+        usetup.script_profile = CfgReadBoolInt(cfg, "misc", "script_profile", usetup.script_profile);
+        usetup.script_profile_path = CfgReadString(cfg, "misc", "script_profile_path");
         int size_kb = CfgReadInt(cfg, "misc", "cachemax", DEFAULTCACHESIZE_KB);
         if (size_kb > 0)
             usetup.SpriteCacheSize = size_kb * 1024;
+        size_kb = CfgReadInt(cfg, "misc", "glyph_cache_size", DEFAULT_GLYPHCACHESIZE_KB);
+        if (size_kb >= 0)
+            usetup.FontGlyphCacheSize = size_kb * 1024;
         size_kb = CfgReadInt(cfg, "sound", "cache_size", DEFAULT_SOUNDCACHESIZE_KB);
         if (size_kb > 0)
             usetup.SoundCacheSize = size_kb * 1024;
         size_kb = CfgReadInt(cfg, "sound", "stream_threshold", DEFAULT_SOUNDLOADATONCE_KB);
         if (size_kb > 0)
             usetup.SoundLoadAtOnceSize = size_kb * 1024;
+        size_kb = CfgReadInt(cfg, "sound", "pcm_clip_threshold", DEFAULT_SOUNDPCMCLIP_KB);
+        if (size_kb >= 0)
+            usetup.SoundPcmClipSize = size_kb * 1024;
+        size_kb = CfgReadInt(cfg, "sound", "pcm_cache_size", DEFAULT_SOUNDPCMCACHESIZE_KB);
+        if (size_kb >= 0)
+            usetup.SoundPcmCacheSize = size_kb * 1024;
 
         // Mouse options
         usetup.mouse_auto_lock = CfgReadBoolInt(cfg, "mouse", "auto_lock");
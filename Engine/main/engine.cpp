@@ -56,6 +56,7 @@
 #include "device/mousew32.h"
 #include "font/agsfontrenderer.h"
 #include "font/fonts.h"
+#include "gfx/blender_simd.h"
 #include "gfx/graphicsdriver.h"
 #include "gfx/gfxdriverfactory.h"
 #include "gfx/ddb.h"
@@ -70,6 +71,7 @@
 #include "media/audio/audio_core.h"
 #include "platform/base/sys_main.h"
 #include "platform/base/agsplatformdriver.h"
+#include "script/script_runtime.h"
 #include "util/directory.h"
 #include "util/error.h"
 #include "util/path.h"
@@ -296,6 +298,7 @@ void engine_init_fonts()
     Debug::Printf(kDbgMsg_Info, "Initializing TTF renderer");
 
     init_font_renderer();
+    set_font_glyph_cache_size(usetup.FontGlyphCacheSize);
 }
 
 void engine_init_mouse()
@@ -343,6 +346,7 @@ void engine_locate_audio_pak()
 // Assign asset locations to the AssetManager
 void engine_assign_assetpaths()
 {
+    AssetMgr->SetMemoryMapping(usetup.mmap_assets);
     AssetMgr->AddLibrary(ResPaths.GamePak.Path, ",audio"); // main pack may have audio bundled too
     // The asset filters are currently a workaround for limiting search to certain locations;
     // this is both an optimization and to prevent unexpected behavior.
@@ -398,7 +402,8 @@ void engine_init_audio()
     
     if (usetup.audio_enabled)
     {
-        soundcache_set_rules(usetup.SoundLoadAtOnceSize, usetup.SoundCacheSize);
+        soundcache_set_rules(usetup.SoundLoadAtOnceSize, usetup.SoundCacheSize,
+            usetup.SoundPcmClipSize, usetup.SoundPcmCacheSize);
     }
     else
     {
@@ -413,6 +418,8 @@ void engine_init_debug()
 {
     if (usetup.show_fps)
         display_fps = kFPS_Forced;
+    ccSetScriptCodePredecoding(usetup.script_predecode);
+    ccSetScriptProfiling(usetup.script_profile);
     if ((debug_flags & (~DBG_DEBUGMODE)) >0) {
         platform->DisplayAlert("Engine debugging enabled.\n"
             "\nNOTE: You have selected to enable one or more engine debugging options.\n"
@@ -451,6 +458,12 @@ void engine_init_pathfinder()
     init_pathfinder(loaded_game_file_version);
 }
 
+void engine_init_blenders()
+{
+    const BlendSimdSet set = init_blend_kernels();
+    Debug::Printf(kDbgMsg_Info, "Sprite blending kernels: %s", get_blend_kernels_name(set));
+}
+
 void engine_pre_init_gfx()
 {
     //Debug::Printf("Initialize gfx");
@@ -584,6 +597,7 @@ void show_preload()
 int engine_init_sprites()
 {
     Debug::Printf(kDbgMsg_Info, "Initialize sprites");
+    spriteset.SetMemoryMapping(usetup.mmap_sprites);
     HError err = spriteset.InitFile(SpriteFile::DefaultSpriteFileName, SpriteFile::DefaultSpriteIndexName);
     if (!err) 
     {
@@ -1256,6 +1270,8 @@ int initialize_engine(const ConfigTree &startup_opts)
 
     engine_init_pathfinder();
 
+    engine_init_blenders();
+
     set_game_speed(40);
 
     our_eip=-20;
@@ -185,6 +185,8 @@ void main_print_help() {
            "  --novideo                    Don't play game videos\n"
            "  --rotation <MODE>            Screen rotation preferences. MODEs are:\n"
            "                                 unlocked (0), portrait (1), landscape (2)\n"
+           "  --script-profile[=PATH]      Profile the scripts, and write the results to\n"
+           "                               the file on exit\n"
            "  --sdl-log=LEVEL              Setup SDL backend logging level\n"
            "                               LEVELs are:\n"
            "                                 verbose (1), debug (2), info (3), warn (4),\n"
@@ -334,6 +336,12 @@ static int main_process_cmdline(ConfigTree &cfg, int argc, char *argv[])
         else if (ags_stricmp(arg, "--novideo") == 0) debug_flags |= DBG_NOVIDEO;
         else if (ags_stricmp(arg, "--rotation") == 0 && (argc > ee + 1))
             cfg["graphics"]["rotation"] = argv[++ee];
+        else if (ags_strnicmp(arg, "--script-profile", 16) == 0 && (arg[16] == 0 || arg[16] == '='))
+        {
+            cfg["misc"]["script_profile"] = "1";
+            if (arg[16] == '=')
+                cfg["misc"]["script_profile_path"] = arg + 17;
+        }
         else if (ags_strnicmp(arg, "--log-", 6) == 0 && arg[6] != 0)
         {
             String logarg = arg + 6;
@@ -16,6 +16,8 @@
 // Quit game procedure
 //
 #include <stdio.h>
+#include <algorithm>
+#include <memory>
 #include "core/platform.h"
 #include <allegro.h> // find files, allegro_exit
 #include "ac/cdaudio.h"
@@ -24,6 +26,7 @@
 #include "ac/gamesetup.h"
 #include "ac/gamesetupstruct.h"
 #include "ac/gamestate.h"
+#include "ac/path_helper.h"
 #include "ac/roomstatus.h"
 #include "ac/route_finder.h"
 #include "ac/translation.h"
@@ -44,8 +47,12 @@
 #include "platform/base/sys_main.h"
 #include "plugin/plugin_engine.h"
 #include "script/cc_common.h"
+#include "script/script_profiler.h"
+#include "script/script_runtime.h"
 #include "media/audio/audio_system.h"
 #include "media/video/video.h"
+#include "util/file.h"
+#include "util/path.h"
 
 using namespace AGS::Common;
 using namespace AGS::Engine;
@@ -83,8 +90,59 @@ void quit_stop_cd()
         cd_manager(3,0);
 }
 
+// Writes the collected script profile, and prints the summary to the log
+void quit_write_script_profile()
+{
+    ScriptProfiler *profiler = ccGetScriptProfiler();
+    if (!profiler)
+        return;
+
+    String time_path = usetup.script_profile_path;
+    if (time_path.IsEmpty())
+    {
+        FSLocation fs = platform->GetAppOutputDirectory();
+        CreateFSDirs(fs);
+        time_path = Path::ConcatPaths(fs.FullDir, "script_profile.txt");
+    }
+    String ext = Path::GetFileExtension(time_path);
+    String instr_path = String::FromFormat("%s.instr%s%s", Path::RemoveExtension(time_path).GetCStr(),
+        ext.IsEmpty() ? "" : ".", ext.GetCStr());
+    const struct { String Path; ScriptProfiler::ProfileValue Value; } outputs[] = {
+        { time_path, ScriptProfiler::kProfile_Time }, { instr_path, ScriptProfiler::kProfile_Instructions } };
+    for (const auto &output : outputs)
+    {
+        std::unique_ptr<Stream> out(File::CreateFile(output.Path));
+        if (!out)
+        {
+            Debug::Printf(kDbgMsg_Error, "Failed to write script profile to %s", output.Path.GetCStr());
+            continue;
+        }
+        profiler->WriteCollapsedStacks(out.get(), output.Value);
+        Debug::Printf(kDbgMsg_Info, "Script profile written to %s", output.Path.GetCStr());
+    }
+
+    auto stats = profiler->GetFunctionStats();
+    std::sort(stats.begin(), stats.end(),
+        [](const ScriptProfiler::FunctionStats &a, const ScriptProfiler::FunctionStats &b)
+        { return a.SelfTime > b.SelfTime; });
+    const size_t max_stats = 20;
+    Debug::Printf(kDbgMsg_Info, "Script functions by self time (ms), top %zu:", max_stats);
+    Debug::Printf(kDbgMsg_Info, "%10s %10s %12s %14s  %s", "self", "total", "calls", "instructions", "function");
+    for (size_t i = 0; i < stats.size() && i < max_stats; ++i)
+    {
+        const auto &st = stats[i];
+        Debug::Printf(kDbgMsg_Info, "%10.2f %10.2f %12llu %14llu  %s",
+            std::chrono::duration<double, std::milli>(st.SelfTime).count(),
+            std::chrono::duration<double, std::milli>(st.TotalTime).count(),
+            static_cast<unsigned long long>(st.Calls), static_cast<unsigned long long>(st.Instructions),
+            st.Name.GetCStr());
+    }
+    ccSetScriptProfiling(false);
+}
+
 void quit_shutdown_scripts()
 {
+    quit_write_script_profile();
     ccUnregisterAllObjects();
 }
 
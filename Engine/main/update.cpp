@@ -229,16 +229,12 @@ void update_following_exactly_characters(const std::vector<int> &followingAsShee
 void update_overlay_timers()
 {
 	// update overlay timers
-  for (size_t i = 0; i < screenover.size();) {
-    if (screenover[i].timeout > 0) {
-      screenover[i].timeout--;
-      if (screenover[i].timeout == 0)
-      {
-        remove_screen_overlay_index(i);
-        continue;
-      }
+  for (auto &over : get_overlays()) {
+    if (over.type >= 0 && over.timeout > 0) {
+      over.timeout--;
+      if (over.timeout == 0)
+        remove_screen_overlay(over.type);
     }
-    i++;
   }
 }
 
@@ -417,7 +413,8 @@ void update_sierra_speech()
       int view_frame_x = 0;
       int view_frame_y = 0;
 
-      Bitmap *frame_pic = screenover[face_talking].GetImage();
+      ScreenOverlay *face_over = get_overlay(face_talking);
+      Bitmap *frame_pic = face_over->GetImage();
       if (game.options[OPT_SPEECHTYPE] == 3) {
         // QFG4-style fullscreen dialog
         if (facetalk_qfg4_override_placement_x)
@@ -449,8 +446,8 @@ void update_sierra_speech()
         DrawViewFrame(frame_pic, blink_vf, view_frame_x, view_frame_y, face_has_alpha);
       }
 
-      screenover[face_talking].SetAlphaChannel(face_has_alpha);
-      screenover[face_talking].MarkChanged();
+      face_over->SetAlphaChannel(face_has_alpha);
+      face_over->MarkChanged();
     }  // end if updatedFrame
   }
 }
@@ -18,6 +18,7 @@
 
 #include "media/audio/audio_core.h"
 #include <math.h>
+#include <algorithm>
 #include <condition_variable>
 #include <mutex>
 #include <thread>
@@ -34,22 +35,26 @@ const auto GlobalGainScaling = 0.7f; // TODO: find out why 0.7f is here?
 
 static void audio_core_entry();
 
+// Size of a chunk of decoded sound data passed to the player at once
+const size_t PcmChunkSize = 64 * 1024;
+
 // AudioCoreSlot is a single playback manager, that handles two components:
 // decoder and "player"; controls the current playback state, passes data
 // from the decoder into the player.
+// Alternatively the slot may play an already decoded sound data, in which
+// case there's no decoder, and the data is passed to the player directly.
 class AudioCoreSlot
 {
 public:
     AudioCoreSlot(int handle, std::unique_ptr<SDLDecoder> decoder);
+    AudioCoreSlot(int handle, const std::shared_ptr<SoundPcmData> &pcm, bool repeat);
 
     // Gets current playback state
     PlaybackState GetPlayState() const { return _playState; }
     // Gets duration, in ms
-    float GetDurationMs() const { return _decoder->GetDurationMs(); }
+    float GetDurationMs() const { return _decoder ? _decoder->GetDurationMs() : _pcm->DurationMs; }
     // Gets playback position, in ms
     float GetPositionMs() const { return _source->GetPositionMs(); }
-    // Gives access to decoder object
-    SDLDecoder &GetDecoder() const { return *_decoder; }
     // Gives access to the "player" object
     OpenAlSource &GetAlSource() const { return *_source; }
 
@@ -67,9 +72,20 @@ public:
 private:
     // Opens decoder and sets up playback state
     void Init();
+    // Tells if the sound data reading has reached EOS
+    bool EOS() const;
+    // Returns the next chunk of sound data
+    SoundBuffer GetData();
+    // Seeks to the given read position; returns the new position
+    float SeekData(float pos_ms);
 
     int handle_ = -1;
     std::unique_ptr<SDLDecoder> _decoder;
+    // Decoded sound data, and a read position in it
+    std::shared_ptr<SoundPcmData> _pcm;
+    size_t _pcmPos = 0u;
+    bool _pcmRepeat = false;
+    bool _pcmEOS = false;
     std::unique_ptr<OpenAlSource> _source;
     PlaybackState _playState = PlayStateInitial;
     PlaybackState _onLoadPlayState = PlayStatePaused;
@@ -84,10 +100,19 @@ AudioCoreSlot::AudioCoreSlot(int handle, std::unique_ptr<SDLDecoder> decoder)
         _decoder->GetFormat(), _decoder->GetChannels(), _decoder->GetFreq());
 }
 
+AudioCoreSlot::AudioCoreSlot(int handle, const std::shared_ptr<SoundPcmData> &pcm, bool repeat)
+    : handle_(handle), _pcm(pcm), _pcmRepeat(repeat)
+{
+    _source = std::make_unique<OpenAlSource>(
+        _pcm->Format.format, _pcm->Format.channels, _pcm->Format.rate);
+}
+
 void AudioCoreSlot::Init()
 {
     bool success;
-    if (_decoder->IsValid()) // if already opened, then just seek to start
+    if (_pcm) // decoded data is always ready, only seek
+        success = SeekData(_onLoadPositionMs) == _onLoadPositionMs;
+    else if (_decoder->IsValid()) // if already opened, then just seek to start
         success = _decoder->Seek(_onLoadPositionMs) == _onLoadPositionMs;
     else
         success = _decoder->Open(_onLoadPositionMs);
@@ -104,9 +129,9 @@ void AudioCoreSlot::Poll()
         return;
 
     // Read data from Decoder and pass into the Al Source
-    if (!_bufferPending.Data && !_decoder->EOS())
+    if (!_bufferPending.Data && !EOS())
     { // if no buffer saved, and still something to decode, then read a buffer
-        _bufferPending = _decoder->GetData();
+        _bufferPending = GetData();
         assert(!_bufferPending.Data || _bufferPending.Size > 0);
     }
     if (_bufferPending.Data)
@@ -116,7 +141,7 @@ void AudioCoreSlot::Poll()
     }
     _source->Poll();
     // If both finished decoding and playing, we done here.
-    if (_decoder->EOS() && _source->IsEmpty())
+    if (EOS() && _source->IsEmpty())
     {
         _playState = PlayStateFinished;
     }
@@ -130,7 +155,7 @@ void AudioCoreSlot::Play()
         _onLoadPlayState = PlayStatePlaying;
         break;
     case PlayStateStopped:
-        _decoder->Seek(0.0f);
+        SeekData(0.0f);
         /* fall-through */
     case PlayStatePaused:
         _playState = PlayStatePlaying;
@@ -188,7 +213,7 @@ void AudioCoreSlot::Seek(float pos_ms)
         {
             _source->Stop();
             _bufferPending = SoundBuffer(); // clear
-            float new_pos = _decoder->Seek(pos_ms);
+            float new_pos = SeekData(pos_ms);
             _source->SetPlaybackPosMs(new_pos);
         }
         break;
@@ -197,6 +222,47 @@ void AudioCoreSlot::Seek(float pos_ms)
     }
 }
 
+bool AudioCoreSlot::EOS() const
+{
+    return _pcm ? _pcmEOS : _decoder->EOS();
+}
+
+SoundBuffer AudioCoreSlot::GetData()
+{
+    if (!_pcm)
+        return _decoder->GetData();
+    if (_pcmEOS)
+        return SoundBuffer();
+    const auto &fmt = _pcm->Format;
+    const size_t size = std::min(PcmChunkSize, _pcm->Data.size() - _pcmPos);
+    SoundBuffer buf(&_pcm->Data[_pcmPos], size,
+        static_cast<float>(SoundHelper::MillisecondsFromBytes(_pcmPos, fmt.format, fmt.channels, fmt.rate)),
+        static_cast<float>(SoundHelper::MillisecondsFromBytes(size, fmt.format, fmt.channels, fmt.rate)));
+    _pcmPos += size;
+    if (_pcmPos >= _pcm->Data.size())
+    {
+        if (_pcmRepeat)
+            _pcmPos = 0u;
+        else
+            _pcmEOS = true;
+    }
+    return buf;
+}
+
+float AudioCoreSlot::SeekData(float pos_ms)
+{
+    if (!_pcm)
+        return _decoder->Seek(pos_ms);
+    const auto &fmt = _pcm->Format;
+    if (pos_ms < 0.f || pos_ms > _pcm->DurationMs)
+        return static_cast<float>(SoundHelper::MillisecondsFromBytes(_pcmPos, fmt.format, fmt.channels, fmt.rate));
+    const size_t frame_size = (SDL_AUDIO_BITSIZE(fmt.format) / 8) * fmt.channels;
+    size_t pos = SoundHelper::BytesPerMs(static_cast<uint32_t>(pos_ms), fmt.format, fmt.channels, fmt.rate);
+    _pcmPos = std::min(pos - pos % frame_size, _pcm->Data.size());
+    _pcmEOS = _pcmPos == _pcm->Data.size();
+    return pos_ms;
+}
+
 
 // Global audio core state and resources
 static struct 
@@ -317,7 +383,7 @@ static int audio_core_slot_init(std::unique_ptr<SDLDecoder> decoder)
     return handle;
 }
 
-int audio_core_slot_init(std::shared_ptr<std::vector<uint8_t>> &data, const String &extension_hint, bool repeat)
+int audio_core_slot_init(const AssetDataView &data, const String &extension_hint, bool repeat)
 {
     auto decoder = std::make_unique<SDLDecoder>(data, extension_hint, repeat);
     if (!decoder->Open())
@@ -333,6 +399,52 @@ int audio_core_slot_init(std::unique_ptr<Stream> in, const String &extension_hin
     return audio_core_slot_init(std::move(decoder));
 }
 
+int audio_core_slot_init(const std::shared_ptr<SoundPcmData> &pcm, bool repeat)
+{
+    if (!pcm || pcm->Data.empty())
+        return -1;
+    auto handle = avail_slot_id();
+    std::lock_guard<std::mutex> lk(g_acore.mixer_mutex_m);
+    g_acore.slots_[handle] = std::make_unique<AudioCoreSlot>(handle, pcm, repeat);
+    g_acore.mixer_cv.notify_all();
+    return handle;
+}
+
+std::shared_ptr<SoundPcmData> audio_core_decode_pcm(const AssetDataView &data,
+    const String &extension_hint, size_t max_size)
+{
+    SDLDecoder decoder(data, extension_hint, false);
+    if (!decoder.Open())
+        return nullptr;
+    auto pcm = std::make_shared<SoundPcmData>();
+    pcm->Format = OpenAlSource::GetPlaybackFormat(decoder.GetFormat(), decoder.GetChannels(), decoder.GetFreq());
+    const auto &fmt = pcm->Format;
+    // Don't bother decoding if the duration is known and it's too long
+    const uint32_t dur_ms = static_cast<uint32_t>(decoder.GetDurationMs());
+    if (SoundHelper::BytesPerMs(dur_ms, fmt.format, fmt.channels, fmt.rate) > max_size)
+        return nullptr;
+
+    SDLResampler resampler(decoder.GetFormat(), decoder.GetChannels(), decoder.GetFreq(),
+        fmt.format, fmt.channels, fmt.rate);
+    while (!decoder.EOS())
+    {
+        SoundBuffer buf = decoder.GetData();
+        if (!buf)
+            continue;
+        size_t conv_sz;
+        const uint8_t *conv = static_cast<const uint8_t*>(resampler.Convert(buf.Data, buf.Size, conv_sz));
+        if (!conv || (pcm->Data.size() + conv_sz > max_size))
+            return nullptr;
+        pcm->Data.insert(pcm->Data.end(), conv, conv + conv_sz);
+    }
+    if (pcm->Data.empty())
+        return nullptr;
+    pcm->Data.shrink_to_fit();
+    pcm->DurationMs = static_cast<float>(
+        SoundHelper::MillisecondsFromBytes(pcm->Data.size(), fmt.format, fmt.channels, fmt.rate));
+    return pcm;
+}
+
 // -------------------------------------------------------------------------------------------------
 // SLOT CONTROL
 // -------------------------------------------------------------------------------------------------
@@ -405,7 +517,7 @@ float audio_core_slot_get_pos_ms(int slot_handle)
 float audio_core_slot_get_duration(int slot_handle)
 {
     std::lock_guard<std::mutex> lk(g_acore.mixer_mutex_m);
-    auto dur = g_acore.slots_[slot_handle]->GetDecoder().GetDurationMs();
+    auto dur = g_acore.slots_[slot_handle]->GetDurationMs();
     g_acore.mixer_cv.notify_all();
     return dur;
 }
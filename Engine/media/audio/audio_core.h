@@ -19,9 +19,12 @@
 #define __AGS_EE_MEDIA__AUDIOCORE_H
 #include <memory>
 #include <vector>
+#include "core/assetmanager.h"
 #include "media/audio/audiodefines.h"
 #include "util/string.h"
 
+namespace AGS { namespace Engine { struct SoundPcmData; } }
+
 // Initializes audio core system;
 // starts polling on a background thread.
 void audio_core_init(/*config, soundlib*/);
@@ -32,10 +35,17 @@ void audio_core_shutdown();
 // Audio slot controls: slots are abstract holders for a playback.
 //
 // Initializes playback on a free playback slot (reuses spare one or allocates new if there's none).
-// Data array must contain full wave data to play.
-int audio_core_slot_init(std::shared_ptr<std::vector<uint8_t>> &data, const AGS::Common::String &extension_hint, bool repeat);
+// Data view must contain full wave data to play, and is kept by the slot until it's released.
+int audio_core_slot_init(const AGS::Common::AssetDataView &data, const AGS::Common::String &extension_hint, bool repeat);
 // Initializes playback streaming
 int audio_core_slot_init(std::unique_ptr<AGS::Common::Stream> in, const AGS::Common::String &extension_hint, bool repeat);
+// Initializes playback of the sound data decoded by audio_core_decode_pcm;
+// this does not require a decoder, the data is passed to the player as is.
+int audio_core_slot_init(const std::shared_ptr<AGS::Engine::SoundPcmData> &pcm, bool repeat);
+// Decodes the whole sound data and converts it to the playback format;
+// returns null on failure, or if the result would exceed max_size bytes.
+std::shared_ptr<AGS::Engine::SoundPcmData> audio_core_decode_pcm(const AGS::Common::AssetDataView &data,
+    const AGS::Common::String &extension_hint, size_t max_size);
 // Start playback on a slot
 PlaybackState audio_core_slot_play(int slot_handle);
 // Pause playback on a slot, resume with 'audio_core_slot_play'
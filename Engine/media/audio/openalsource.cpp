@@ -127,6 +127,16 @@ OpenAlSource::~OpenAlSource()
     }
 }
 
+Sound_AudioInfo OpenAlSource::GetPlaybackFormat(SDL_AudioFormat format, int channels, int freq)
+{
+    Sound_AudioInfo input, conv;
+    input.format = format;
+    input.channels = static_cast<Uint8>(channels);
+    input.rate = freq;
+    OpenAlFormatFromSDLFormat(input, conv);
+    return conv;
+}
+
 float OpenAlSource::GetPositionMs() const
 {
     float al_offset = 0.f;
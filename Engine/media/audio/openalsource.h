@@ -42,6 +42,10 @@ public:
     OpenAlSource(OpenAlSource&& src);
     ~OpenAlSource();
 
+    // Gets the format which the sound in the given input format is
+    // converted to before passing to OpenAL
+    static Sound_AudioInfo GetPlaybackFormat(SDL_AudioFormat format, int channels, int freq);
+
     // Tells if the al source is valid and usable
     bool IsValid() const { return _source > 0; }
     // Gets current playback state
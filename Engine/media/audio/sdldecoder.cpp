@@ -57,7 +57,7 @@ const void *SDLResampler::Convert(const void *data, size_t sz, size_t &out_sz)
 //-----------------------------------------------------------------------------
 const auto SampleDefaultBufferSize = 64 * 1024;
 
-SDLDecoder::SDLDecoder(std::shared_ptr<std::vector<uint8_t>> &data,
+SDLDecoder::SDLDecoder(const AssetDataView &data,
     const AGS::Common::String &ext_hint, bool repeat)
     : _sampleData(data)
     , _sampleExt(ext_hint)
@@ -101,12 +101,12 @@ bool SDLDecoder::Open(float pos_ms)
     else
     {
         sample = SoundSampleUniquePtr(Sound_NewSampleFromMem(
-            _sampleData->data(), _sampleData->size(), _sampleExt.GetCStr(), nullptr, SampleDefaultBufferSize));
+            _sampleData.Data, _sampleData.Size, _sampleExt.GetCStr(), nullptr, SampleDefaultBufferSize));
     }
     if (!sample)
     {
         _rwops = nullptr; // rwops was closed by the Sound_NewSample
-        _sampleData = nullptr;
+        _sampleData = {};
         return false;
     }
 
@@ -125,7 +125,7 @@ void SDLDecoder::Close()
 {
     _sample.reset();
     _rwops = nullptr; // rwops was closed by the Sound_NewSample
-    _sampleData = nullptr;
+    _sampleData = {};
 }
 
 float SDLDecoder::Seek(float pos_ms)
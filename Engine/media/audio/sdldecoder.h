@@ -24,6 +24,7 @@
 #include <memory>
 #include <vector>
 #include <SDL_sound.h>
+#include "core/assetmanager.h"
 #include "util/stream.h"
 #include "util/string.h"
 #ifdef AUDIO_CORE_DEBUG
@@ -35,6 +36,7 @@ namespace AGS
 namespace Engine
 {
 
+using AGS::Common::AssetDataView;
 using AGS::Common::Stream;
 using AGS::Common::String;
 
@@ -71,6 +73,14 @@ struct SoundBuffer
     operator bool() const { return Data && Size > 0; }
 };
 
+// Fully decoded sound data, in the format ready for the playback.
+struct SoundPcmData
+{
+    Sound_AudioInfo Format{};
+    std::vector<uint8_t> Data;
+    float DurationMs = 0.f;
+};
+
 // RAII wrapper over SDL resampling filter;
 // initialized by passing input and desired sound format;
 // tells whether conversion is necessary and performs one on command.
@@ -107,8 +117,8 @@ private:
 class SDLDecoder
 {
 public:
-    // Initializes decoder with a complete sound data loaded to memory
-    SDLDecoder(std::shared_ptr<std::vector<uint8_t>> &data, const String &ext_hint, bool repeat);
+    // Initializes decoder with a complete sound data in memory
+    SDLDecoder(const AssetDataView &data, const String &ext_hint, bool repeat);
     // Initializes decoder with an input stream
     SDLDecoder(const std::unique_ptr<Stream> in, const String &ext_hint, bool repeat);
     SDLDecoder(SDLDecoder&& dec);
@@ -140,7 +150,7 @@ public:
 
 private:
     SDL_RWops *_rwops = nullptr;
-    std::shared_ptr<std::vector<uint8_t>> _sampleData{};
+    AssetDataView _sampleData{};
     String _sampleExt = "";
     SoundSampleUniquePtr _sample = nullptr;
     uint32_t _durationMs = 0u;
@@ -15,14 +15,17 @@
 #include <cmath>
 #include <list>
 #include <unordered_map>
+#include <unordered_set>
 #include "core/assetmanager.h"
 #include "media/audio/audio_core.h"
 #include "media/audio/audiodefines.h"
+#include "media/audio/sdldecoder.h"
 #include "util/path.h"
 #include "util/stream.h"
 #include "util/string_types.h"
 
 using namespace AGS::Common;
+using namespace AGS::Engine;
 
 static int GuessSoundTypeFromExt(const String &extension)
 {
@@ -56,12 +59,19 @@ static int GuessSoundTypeFromExt(const String &extension)
     return 0;
 }
 
+// Size of the cached sound data, in bytes
+inline size_t GetSoundDataSize(const std::vector<uint8_t> &data) { return data.size(); }
+inline size_t GetSoundDataSize(const SoundPcmData &data) { return data.Data.size(); }
+
 // Sound cache, stores most recent used sounds, tracks use history with MRU list.
 // TODO: refactor into the resource cache class, share with the sprite cache.
+template <typename TData>
 class SoundCache
 {
 public:
-    typedef std::shared_ptr<std::vector<uint8_t>> DataRef;
+    typedef std::shared_ptr<TData> DataRef;
+
+    SoundCache(size_t max_size) : _maxSize(max_size) {}
 
     void SetMaxCacheSize(size_t size)
     {
@@ -90,12 +100,13 @@ public:
         if (_maxSize == 0)
             return; // cache is disabled
         // Clear up space before adding
-        if (_cacheSize + ref->size() > _maxSize)
-            FreeMem(ref->size());
+        const size_t size = GetSoundDataSize(*ref);
+        if (_cacheSize + size > _maxSize)
+            FreeMem(size);
         SoundEntry entry(name, ref);
         entry.MruIt = _mru.insert(_mru.begin(), name);
         _map[name] = std::move(entry);
-        _cacheSize += ref->size();
+        _cacheSize += size;
     }
 
     // Clear the cache, dispose all resources
@@ -114,7 +125,7 @@ private:
         if (_mru.size() == 0) return;
         auto it = std::prev(_mru.end());
         const auto id = *it;
-        _cacheSize -= _map[id].Data->size();
+        _cacheSize -= GetSoundDataSize(*_map[id].Data);
         _map.erase(id);
         // Remove from the mru list
         _mru.erase(it);
@@ -140,7 +151,7 @@ private:
     };
 
     size_t _cacheSize = 0u;
-    size_t _maxSize = DEFAULT_SOUNDCACHESIZE_KB;
+    size_t _maxSize = 0u;
     std::unordered_map<String, SoundEntry, HashStrNoCase> _map;
     // MRU list: the way to track which items were used recently.
     // When clearing up space for new items, cache first deletes the items
@@ -151,60 +162,106 @@ private:
 
 // Maximal sound asset size which is allowed to be loaded at once;
 // anything larger will be streamed
-// TODO: make configureable?
-static size_t MaxLoadAtOnce = DEFAULT_SOUNDLOADATONCE_KB;
-static SoundCache SndCache;
+static size_t MaxLoadAtOnce = DEFAULT_SOUNDLOADATONCE_KB * 1024;
+// Cache of the sound assets' data
+static SoundCache<std::vector<uint8_t>> SndCache(DEFAULT_SOUNDCACHESIZE_KB * 1024);
+// Maximal size of the decoded sound which is allowed to be kept in the
+// decoded sound cache; 0 disables decoding sounds in advance
+static size_t MaxPcmClip = DEFAULT_SOUNDPCMCLIP_KB * 1024;
+// Cache of the decoded sounds, which are played without a decoder
+static SoundCache<SoundPcmData> PcmCache(DEFAULT_SOUNDPCMCACHESIZE_KB * 1024);
+// Sounds that failed to decode within the MaxPcmClip limit, these
+// are not tried again
+static std::unordered_set<String, HashStrNoCase, StrEqNoCase> PcmRejected;
 
-void soundcache_set_rules(size_t max_loadatonce, size_t max_cachesize)
+void soundcache_set_rules(size_t max_loadatonce, size_t max_cachesize,
+    size_t max_pcmclip, size_t max_pcmcachesize)
 {
     MaxLoadAtOnce = max_loadatonce;
     SndCache.SetMaxCacheSize(max_cachesize);
+    MaxPcmClip = std::min(max_pcmclip, max_pcmcachesize);
+    PcmCache.SetMaxCacheSize(max_pcmcachesize);
+    PcmRejected.clear();
 }
 
 void soundcache_clear()
 {
     SndCache.Clear();
+    PcmCache.Clear();
+    PcmRejected.clear();
 }
 
-static SOUNDCLIP *my_load_clip(const AssetPath &apath, const char *extension_hint, bool loop)
+// Tries to decode the sound and put it into the decoded sound cache
+static std::shared_ptr<SoundPcmData> decode_to_cache(const String &name,
+    const AssetDataView &sounddata, const String &ext_hint)
+{
+    if ((MaxPcmClip == 0) || (PcmRejected.count(name) > 0))
+        return nullptr;
+    auto pcmdata = audio_core_decode_pcm(sounddata, ext_hint, MaxPcmClip);
+    if (pcmdata)
+        PcmCache.Put(name, pcmdata);
+    else
+        PcmRejected.insert(name);
+    return pcmdata;
+}
+
+// Makes a data view of the sound loaded into a buffer
+static AssetDataView make_sound_view(const std::shared_ptr<std::vector<uint8_t>> &buf)
 {
-    size_t asset_size;
-    std::unique_ptr<Stream> s_in;
-    auto sounddata = SndCache.Get(apath.Name);
-    if (sounddata)
+    AssetDataView view;
+    view.Owner = buf;
+    view.Data = buf->data();
+    view.Size = buf->size();
+    return view;
+}
+
+static int my_load_clip_slot(const AssetPath &apath, const String &ext_hint, bool loop)
+{
+    // If the decoded sound was cached, then play it without decoding
+    auto pcmdata = PcmCache.Get(apath.Name);
+    if (pcmdata)
+        return audio_core_slot_init(pcmdata, loop);
+
+    AssetDataView sounddata;
+    auto cached = SndCache.Get(apath.Name);
+    if (cached)
     {
-        asset_size = sounddata->size();
+        sounddata = make_sound_view(cached);
     }
-    else
+    // If the asset's file is memory-mapped, then the sound is played right
+    // from the mapped data, which does not have to be loaded nor cached
+    else if (!AssetMgr->GetAssetView(apath, sounddata))
     {
-        s_in.reset(AssetMgr->OpenAsset(apath));
+        std::unique_ptr<Stream> s_in(AssetMgr->OpenAsset(apath));
         if (!s_in)
-            return nullptr;
-        asset_size = static_cast<size_t>(s_in->GetLength());
+            return -1;
+        const size_t asset_size = static_cast<size_t>(s_in->GetLength());
+        // If asset's size is too large, start streaming
+        if (asset_size > MaxLoadAtOnce)
+            return audio_core_slot_init(std::move(s_in), ext_hint, loop);
+        // Otherwise load it at once, and update the cache
+        auto buf = std::make_shared<std::vector<uint8_t>>(asset_size);
+        s_in->Read(buf->data(), asset_size);
+        SndCache.Put(apath.Name, buf);
+        sounddata = make_sound_view(buf);
     }
 
-    const auto asset_ext = AGS::Common::Path::GetFileExtension(apath.Name);
-    const auto ext_hint = asset_ext.IsEmpty() ? String(extension_hint) : asset_ext;
-
-    int slot{};
-    // If sound data was cached, or asset's size is small enough to load at once,
-    // then load/use it and update the cache if necessary
-    if (sounddata || asset_size <= MaxLoadAtOnce)
-    {
-        if (!sounddata)
-        {
-            sounddata.reset(new std::vector<uint8_t>(asset_size));
-            s_in->Read(sounddata->data(), asset_size);
-            SndCache.Put(apath.Name, sounddata);
-        }
-        slot = audio_core_slot_init(sounddata, ext_hint, loop);
-    }
-    // Otherwise, if asset's size is too large, start streaming
-    else
+    // Short sounds are decoded once, and replayed from the decoded data
+    if (sounddata.Size <= MaxLoadAtOnce)
     {
-        slot = audio_core_slot_init(std::move(s_in), ext_hint, loop);
+        pcmdata = decode_to_cache(apath.Name, sounddata, ext_hint);
+        if (pcmdata)
+            return audio_core_slot_init(pcmdata, loop);
     }
+    return audio_core_slot_init(sounddata, ext_hint, loop);
+}
+
+static SOUNDCLIP *my_load_clip(const AssetPath &apath, const char *extension_hint, bool loop)
+{
+    const auto asset_ext = AGS::Common::Path::GetFileExtension(apath.Name);
+    const auto ext_hint = asset_ext.IsEmpty() ? String(extension_hint) : asset_ext;
 
+    const int slot = my_load_clip_slot(apath, ext_hint, loop);
     if (slot < 0) { return nullptr; }
 
     const auto sound_type = GuessSoundTypeFromExt(ext_hint);
@@ -25,11 +25,20 @@
 const size_t DEFAULT_SOUNDLOADATONCE_KB = 1024u;
 // Sound cache limit, in KB
 const size_t DEFAULT_SOUNDCACHESIZE_KB = 1024u * 32; // 32 MB
+// Threshold for keeping decoded sounds in cache, in KB
+const size_t DEFAULT_SOUNDPCMCLIP_KB = 512u;
+// Decoded sound cache limit, in KB
+const size_t DEFAULT_SOUNDPCMCACHESIZE_KB = 1024u * 16; // 16 MB
 
 // Sets sound loading and caching rules:
 // * max_loadatonce - threshold in bytes for loading sounds immediately, vs streaming
 // * max_cachesize - sound cache limit, in bytes
-void soundcache_set_rules(size_t max_loadatonce, size_t max_cachesize);
+// * max_pcmclip - threshold in bytes for the decoded sound size, below which
+//   sounds are decoded once and replayed from the decoded sound cache;
+//   0 disables this
+// * max_pcmcachesize - decoded sound cache limit, in bytes
+void soundcache_set_rules(size_t max_loadatonce, size_t max_cachesize,
+    size_t max_pcmclip, size_t max_pcmcachesize);
 void soundcache_clear();
 SOUNDCLIP *my_load_wave(const AssetPath &asset_name, bool loop);
 SOUNDCLIP *my_load_mp3(const AssetPath &asset_name, bool loop);
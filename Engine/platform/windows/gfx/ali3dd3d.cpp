@@ -1520,6 +1520,37 @@ void D3DGraphicsDriver::UpdateDDBFromBitmap(IDriverDependantBitmap* bitmapToUpda
   UpdateTextureData(target->_data.get(), bitmap, target->_opaque, hasAlpha);
 }
 
+void D3DGraphicsDriver::UpdateDDBRegionFromBitmap(IDriverDependantBitmap* bitmapToUpdate, Bitmap *bitmap, bool hasAlpha, const Rect &region)
+{
+  D3DBitmap *target = (D3DBitmap*)bitmapToUpdate;
+  if (target->_width != bitmap->GetWidth() || target->_height != bitmap->GetHeight())
+    throw Ali3DException("UpdateDDBRegionFromBitmap: mismatched bitmap size");
+  const int color_depth = bitmap->GetColorDepth();
+  if (color_depth != target->_colDepth)
+    throw Ali3DException("UpdateDDBRegionFromBitmap: mismatched colour depths");
+  if (target->_hasAlpha != hasAlpha)
+  { // the change of alpha mode affects all pixels
+    UpdateDDBFromBitmap(bitmapToUpdate, bitmap, hasAlpha);
+    return;
+  }
+
+  if (color_depth == 8)
+      select_palette(palette);
+
+  // Tile textures are locked with discard flag, so update only the whole
+  // tiles which intersect the region
+  auto *d3ddata = reinterpret_cast<D3DTextureData*>(target->_data.get());
+  for (size_t i = 0; i < d3ddata->_numTiles; ++i)
+  {
+    D3DTextureTile *tile = &d3ddata->_tiles[i];
+    if (AreRectsIntersecting(region, RectWH(tile->x, tile->y, tile->width, tile->height)))
+      UpdateTextureRegion(tile, bitmap, target->_opaque, hasAlpha);
+  }
+
+  if (color_depth == 8)
+      unselect_palette();
+}
+
 void D3DGraphicsDriver::UpdateTextureData(TextureData *txdata, Bitmap *bitmap, bool opaque, bool hasAlpha)
 {
   const int color_depth = bitmap->GetColorDepth();
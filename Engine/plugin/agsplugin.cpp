@@ -35,6 +35,7 @@
 #include "ac/movelist.h"
 #include "ac/parser.h"
 #include "ac/path_helper.h"
+#include "ac/roomareamap.h"
 #include "ac/roomstatus.h"
 #include "ac/string.h"
 #include "ac/spritecache.h"
@@ -467,20 +468,29 @@ void IAGSEngine::FreeBitmap (BITMAP *tofree) {
         destroy_bitmap (tofree);
 }
 BITMAP *IAGSEngine::GetSpriteGraphic (int32 num) {
+    // plugin may draw onto the sprite, which must not go into the mapped file
+    spriteset.DetachMappedSprite(num);
     return (BITMAP*)spriteset[num]->GetAllegroBitmap();
 }
 BITMAP *IAGSEngine::GetRoomMask (int32 index) {
+    RoomAreaMask mask;
     if (index == MASK_WALKABLE)
-        return (BITMAP*)thisroom.WalkAreaMask->GetAllegroBitmap();
+        mask = kRoomAreaWalkable;
     else if (index == MASK_WALKBEHIND)
-        return (BITMAP*)thisroom.WalkBehindMask->GetAllegroBitmap();
+        mask = kRoomAreaWalkBehind;
     else if (index == MASK_HOTSPOT)
-        return (BITMAP*)thisroom.HotspotMask->GetAllegroBitmap();
+        mask = kRoomAreaHotspot;
     else if (index == MASK_REGIONS)
-        return (BITMAP*)thisroom.RegionMask->GetAllegroBitmap();
+        mask = kRoomAreaRegion;
     else
+    {
         quit("!IAGSEngine::GetRoomMask: invalid mask requested");
-    return nullptr;
+        return nullptr;
+    }
+    // the plugin may draw on the mask at any time, so the engine has to
+    // read the mask directly until another room is loaded
+    detach_room_area_map(mask);
+    return (BITMAP*)thisroom.GetMask(mask)->GetAllegroBitmap();
 }
 AGSViewFrame *IAGSEngine::GetViewFrame (int32 view, int32 loop, int32 frame) {
     view--;
@@ -11,6 +11,7 @@
 // http://www.opensource.org/licenses/artistic-license-2.0.php
 //
 //=============================================================================
+#include <algorithm>
 #include <cstdio>
 #include <deque>
 #include <string.h>
@@ -24,6 +25,7 @@
 #include "debug/out.h"
 #include "script/cc_common.h"
 #include "script/script.h"
+#include "script/script_profiler.h"
 #include "script/script_runtime.h"
 #include "script/systemimports.h"
 #include "util/bbop.h"
@@ -215,6 +217,8 @@ struct FunctionCallStack
 
 unsigned ccInstance::_timeoutCheckMs = 60u;
 unsigned ccInstance::_timeoutAbortMs = 60u * 10;
+bool ccInstance::_predecodeCode = true;
+ScriptProfiler *ccInstance::_profiler = nullptr;
 
 
 ccInstance *ccInstance::GetCurrentInstance()
@@ -246,6 +250,16 @@ void ccInstance::SetExecTimeout(unsigned sys_poll_ms, unsigned abort_ms)
     _timeoutAbortMs = abort_ms;
 }
 
+void ccInstance::SetCodePredecoding(bool on)
+{
+    _predecodeCode = on;
+}
+
+void ccInstance::SetProfiler(ScriptProfiler *profiler)
+{
+    _profiler = profiler;
+}
+
 ccInstance::ccInstance()
 {
     flags               = 0;
@@ -446,6 +460,19 @@ int ccInstance::CallScriptFunction(const char *funcname, int32_t numargs, const
     line_number = callStackLineNumber[callStackSize];\
     currentline = line_number
 
+// With GCC and Clang the interpreter jumps to the operation's handler
+// through a table of label addresses (computed goto), skipping the switch's
+// range check, as the instruction codes are validated when the operation
+// is read; other compilers use the plain switch.
+#if defined(__GNUC__)
+#define SCRIPT_COMPUTED_GOTO
+#define CASE_SCMD(cmd) case cmd: op_##cmd
+#define CASE_SCMD_DEFAULT default: op_default
+#else
+#define CASE_SCMD(cmd) case cmd
+#define CASE_SCMD_DEFAULT default
+#endif
+
 #define MAXNEST 50  // number of recursive function calls allowed
 int ccInstance::Run(int32_t curpc)
 {
@@ -475,101 +502,81 @@ int ccInstance::Run(int32_t curpc)
     _lastAliveTs = AGS_Clock::now();
     bool timeout_warn = false;
 
-    while ((flags & INSTF_ABORTED) == 0) {
-        /*
-		if (!codeInst->ReadOperation(codeOp, pc))
-        {
-            return -1;
-        }
-        */
-        /* ReadOperation */
-        //=====================================================================
-        codeOp.Instruction.Code			= codeInst->code[pc];
-        codeOp.Instruction.InstanceId	= (codeOp.Instruction.Code >> INSTANCE_ID_SHIFT) & INSTANCE_ID_MASK;
-        codeOp.Instruction.Code		   &= INSTANCE_ID_REMOVEMASK; // now this is pure instruction code
-
-        if (codeOp.Instruction.Code < 0 || codeOp.Instruction.Code >= CC_NUM_SCCMDS)
-        {
-            cc_error("invalid instruction %d found in code stream", codeOp.Instruction.Code);
-            return -1;
-        }
-
-        codeOp.ArgCount = sccmd_info[codeOp.Instruction.Code].ArgCount;
-        if (pc + codeOp.ArgCount >= codeInst->codesize)
-        {
-            cc_error("unexpected end of code data (%d; %d)", pc + codeOp.ArgCount, codeInst->codesize);
-            return -1;
-        }
+    const ScriptPredecodedCode *precode = codeInst->predecoded.get();
+
+#if defined(SCRIPT_COMPUTED_GOTO)
+    // Operation handlers, indexed by the instruction code
+    static const void *const op_handlers[CC_NUM_SCCMDS] = {
+        &&op_default, &&op_SCMD_ADD, &&op_SCMD_SUB, &&op_SCMD_REGTOREG,
+        &&op_SCMD_WRITELIT, &&op_SCMD_RET, &&op_SCMD_LITTOREG, &&op_SCMD_MEMREAD,
+        &&op_SCMD_MEMWRITE, &&op_SCMD_MULREG, &&op_SCMD_DIVREG, &&op_SCMD_ADDREG,
+        &&op_SCMD_SUBREG, &&op_SCMD_BITAND, &&op_SCMD_BITOR, &&op_SCMD_ISEQUAL,
+        &&op_SCMD_NOTEQUAL, &&op_SCMD_GREATER, &&op_SCMD_LESSTHAN, &&op_SCMD_GTE,
+        &&op_SCMD_LTE, &&op_SCMD_AND, &&op_SCMD_OR, &&op_SCMD_CALL,
+        &&op_SCMD_MEMREADB, &&op_SCMD_MEMREADW, &&op_SCMD_MEMWRITEB, &&op_SCMD_MEMWRITEW,
+        &&op_SCMD_JZ, &&op_SCMD_PUSHREG, &&op_SCMD_POPREG, &&op_SCMD_JMP,
+        &&op_SCMD_MUL, &&op_SCMD_CALLEXT, &&op_SCMD_PUSHREAL, &&op_SCMD_SUBREALSTACK,
+        &&op_SCMD_LINENUM, &&op_SCMD_CALLAS, &&op_SCMD_THISBASE, &&op_SCMD_NUMFUNCARGS,
+        &&op_SCMD_MODREG, &&op_SCMD_XORREG, &&op_SCMD_NOTREG, &&op_SCMD_SHIFTLEFT,
+        &&op_SCMD_SHIFTRIGHT, &&op_SCMD_CALLOBJ, &&op_SCMD_CHECKBOUNDS, &&op_SCMD_MEMWRITEPTR,
+        &&op_SCMD_MEMREADPTR, &&op_SCMD_MEMZEROPTR, &&op_SCMD_MEMINITPTR, &&op_SCMD_LOADSPOFFS,
+        &&op_SCMD_CHECKNULL, &&op_SCMD_FADD, &&op_SCMD_FSUB, &&op_SCMD_FMULREG,
+        &&op_SCMD_FDIVREG, &&op_SCMD_FADDREG, &&op_SCMD_FSUBREG, &&op_SCMD_FGREATER,
+        &&op_SCMD_FLESSTHAN, &&op_SCMD_FGTE, &&op_SCMD_FLTE, &&op_SCMD_ZEROMEMORY,
+        &&op_SCMD_CREATESTRING, &&op_SCMD_STRINGSEQUAL, &&op_SCMD_STRINGSNOTEQ, &&op_SCMD_CHECKNULLREG,
+        &&op_SCMD_LOOPCHECKOFF, &&op_SCMD_MEMZEROPTRND, &&op_SCMD_JNZ, &&op_SCMD_DYNAMICBOUNDS,
+        &&op_SCMD_NEWARRAY, &&op_SCMD_NEWUSEROBJECT
+    };
+#endif
+
+    // Profiler's call stack is unwound when the function returns, or when
+    // the execution breaks, whichever way the interpreter exits
+    ScriptProfiler *profiler = _profiler;
+    struct ProfilerScope
+    {
+        ScriptProfiler *Profiler;
+        size_t Depth;
+        ~ProfilerScope() { if (Profiler) Profiler->LeaveTo(Depth); }
+    } profiler_scope = { profiler, profiler ? profiler->GetDepth() : 0u };
+    if (profiler)
+        profiler->Enter(codeInst->GetProfilerFunction(pc));
 
-        int pc_at = pc + 1;
-        for (int i = 0; i < codeOp.ArgCount; ++i, ++pc_at)
+    while ((flags & INSTF_ABORTED) == 0) {
+        if (profiler)
+            profiler->CountInstruction();
+
+        // Get the next operation, either predecoded or decoded from the bytecode
+        const ScriptOperation *op_ptr = &codeOp;
+        int32_t op_index = -1;
+        if (precode && (pc >= 0) && (pc < codeInst->codesize))
+            op_index = precode->PcToOp[pc];
+        if (op_index >= 0)
         {
-            char fixup = codeInst->code_fixups[pc_at];
-            if (fixup > 0)
+            const ScriptPredecodedOp &pre_op = precode->Ops[op_index];
+            op_ptr = &pre_op.Op;
+            if (pre_op.HasDynamicArgs)
             {
-                // could be relative pointer or import address
-                /*
-                if (!FixupArgument(code[pc], fixup, codeOp.Args[i]))
+                // copy, and resolve the arguments that depend on the current state
+                codeOp = pre_op.Op;
+                for (int i = 0; i < codeOp.ArgCount; ++i)
                 {
-                    return -1;
+                    if (pre_op.DynamicFixups[i] &&
+                        !FixupArgument(codeInst, codeOp.Args[i].IValue, pre_op.DynamicFixups[i], codeOp.Args[i]))
+                        return -1;
                 }
-                */
-                /* FixupArgument */
-                //=====================================================================
-                switch (fixup)
-                {
-                case FIXUP_GLOBALDATA:
-                    {
-                        ScriptVariable *gl_var = (ScriptVariable*)codeInst->code[pc_at];
-                        codeOp.Args[i].SetGlobalVar(&gl_var->RValue);
-                    }
-                    break;
-                case FIXUP_FUNCTION:
-                    // originally commented -- CHECKME: could this be used in very old versions of AGS?
-                    //      code[fixup] += (long)&code[0];
-                    // This is a program counter value, presumably will be used as SCMD_CALL argument
-                    codeOp.Args[i].SetInt32((int32_t)codeInst->code[pc_at]);
-                    break;
-                case FIXUP_STRING:
-                    codeOp.Args[i].SetStringLiteral(&codeInst->strings[0] + codeInst->code[pc_at]);
-                    break;
-                case FIXUP_IMPORT:
-                    {
-                        const ScriptImport *import = simp.getByIndex(static_cast<uint32_t>(codeInst->code[pc_at]));
-                        if (import)
-                        {
-                            codeOp.Args[i] = import->Value;
-                        }
-                        else
-                        {
-                            cc_error("cannot resolve import, key = %ld", codeInst->code[pc_at]);
-                            return -1;
-                        }
-                    }
-                    break;
-                case FIXUP_STACK:
-                    codeOp.Args[i] = GetStackPtrOffsetFw((int32_t)codeInst->code[pc_at]);
-                    break;
-                default:
-                    cc_error("internal fixup type error: %d", fixup);
-                    return -1;
-                }
-                /* End FixupArgument */
-                //=====================================================================
-            }
-            else
-            {
-                // should be a numeric literal (int32 or float)
-                codeOp.Args[i].SetInt32( (int32_t)codeInst->code[pc_at] );
+                op_ptr = &codeOp;
             }
         }
-        /* End ReadOperation */
-        //=====================================================================
+        else if (!ReadOperation(codeInst, codeOp, pc))
+        {
+            return -1;
+        }
+        const ScriptOperation &op = *op_ptr;
 
         // save the arguments for quick access
-        RuntimeScriptValue &arg1 = codeOp.Args[0];
-        RuntimeScriptValue &arg2 = codeOp.Args[1];
-        RuntimeScriptValue &arg3 = codeOp.Args[2];
+        const RuntimeScriptValue &arg1 = op.Args[0];
+        const RuntimeScriptValue &arg2 = op.Args[1];
+        const RuntimeScriptValue &arg3 = op.Args[2];
         RuntimeScriptValue &reg1 = 
             registers[arg1.IValue >= 0 && arg1.IValue < CC_NUM_REGISTERS ? arg1.IValue : 0];
         RuntimeScriptValue &reg2 = 
@@ -580,17 +587,20 @@ int ccInstance::Run(int32_t curpc)
 
         if (write_debug_dump)
         {
-            DumpInstruction(codeOp);
+            DumpInstruction(op);
         }
 
-        switch (codeOp.Instruction.Code) {
-      case SCMD_LINENUM:
+#if defined(SCRIPT_COMPUTED_GOTO)
+        goto *op_handlers[op.Instruction.Code];
+#endif
+        switch (op.Instruction.Code) {
+      CASE_SCMD(SCMD_LINENUM):
           line_number = arg1.IValue;
           currentline = arg1.IValue;
           if (new_line_hook)
               new_line_hook(this, currentline);
           break;
-      case SCMD_ADD:
+      CASE_SCMD(SCMD_ADD):
           // If the the register is SREG_SP, we are allocating new variable on the stack
           if (arg1.IValue == SREG_SP)
           {
@@ -616,7 +626,7 @@ int ccInstance::Run(int32_t curpc)
             reg1.IValue += arg2.IValue;
           }
           break;
-      case SCMD_SUB:
+      CASE_SCMD(SCMD_SUB):
           if (reg1.Type == kScValStackPtr)
           {
             // If this is SREG_SP, this is stack pop, which frees local variables;
@@ -643,10 +653,10 @@ int ccInstance::Run(int32_t curpc)
             reg1.IValue -= arg2.IValue;
           }
           break;
-      case SCMD_REGTOREG:
+      CASE_SCMD(SCMD_REGTOREG):
           reg2 = reg1;
           break;
-      case SCMD_WRITELIT:
+      CASE_SCMD(SCMD_WRITELIT):
           // Take the data address from reg[MAR] and copy there arg1 bytes from arg2 address
           //
           // NOTE: since it reads directly from arg2 (which originally was
@@ -670,7 +680,7 @@ int ccInstance::Run(int32_t curpc)
               break;
           }
           break;
-      case SCMD_RET:
+      CASE_SCMD(SCMD_RET):
           {
           if (loopIterationCheckDisabled > 0)
               loopIterationCheckDisabled--;
@@ -685,20 +695,22 @@ int ccInstance::Run(int32_t curpc)
               return 0;
           }
           POP_CALL_STACK;
+          if (profiler)
+              profiler->Leave();
           continue; // continue so that the PC doesn't get overwritten
           }
-      case SCMD_LITTOREG:
+      CASE_SCMD(SCMD_LITTOREG):
           reg1 = arg2;
           break;
-      case SCMD_MEMREAD:
+      CASE_SCMD(SCMD_MEMREAD):
           // Take the data address from reg[MAR] and copy int32_t to reg[arg1]
           reg1 = registers[SREG_MAR].ReadValue();
           break;
-      case SCMD_MEMWRITE:
+      CASE_SCMD(SCMD_MEMWRITE):
           // Take the data address from reg[MAR] and copy there int32_t from reg[arg1]
           registers[SREG_MAR].WriteValue(reg1);
           break;
-      case SCMD_LOADSPOFFS:
+      CASE_SCMD(SCMD_LOADSPOFFS):
           registers[SREG_MAR] = GetStackPtrOffsetRw(arg1.IValue);
           if (cc_has_error())
           {
@@ -707,68 +719,68 @@ int ccInstance::Run(int32_t curpc)
           break;
 
           // 64 bit: Force 32 bit math
-      case SCMD_MULREG:
+      CASE_SCMD(SCMD_MULREG):
           reg1.SetInt32(reg1.IValue * reg2.IValue);
           break;
-      case SCMD_DIVREG:
+      CASE_SCMD(SCMD_DIVREG):
           if (reg2.IValue == 0) {
               cc_error("!Integer divide by zero");
               return -1;
           } 
           reg1.SetInt32(reg1.IValue / reg2.IValue);
           break;
-      case SCMD_ADDREG:
+      CASE_SCMD(SCMD_ADDREG):
           // This may be pointer arithmetics, in which case IValue stores offset from base pointer
           reg1.IValue += reg2.IValue;
           break;
-      case SCMD_SUBREG:
+      CASE_SCMD(SCMD_SUBREG):
           // This may be pointer arithmetics, in which case IValue stores offset from base pointer
           reg1.IValue -= reg2.IValue;
           break;
-      case SCMD_BITAND:
+      CASE_SCMD(SCMD_BITAND):
           reg1.SetInt32(reg1.IValue & reg2.IValue);
           break;
-      case SCMD_BITOR:
+      CASE_SCMD(SCMD_BITOR):
           reg1.SetInt32(reg1.IValue | reg2.IValue);
           break;
-      case SCMD_ISEQUAL:
+      CASE_SCMD(SCMD_ISEQUAL):
           reg1.SetInt32AsBool(reg1 == reg2);
           break;
-      case SCMD_NOTEQUAL:
+      CASE_SCMD(SCMD_NOTEQUAL):
           reg1.SetInt32AsBool(reg1 != reg2);
           break;
-      case SCMD_GREATER:
+      CASE_SCMD(SCMD_GREATER):
           reg1.SetInt32AsBool(reg1.IValue > reg2.IValue);
           break;
-      case SCMD_LESSTHAN:
+      CASE_SCMD(SCMD_LESSTHAN):
           reg1.SetInt32AsBool(reg1.IValue < reg2.IValue);
           break;
-      case SCMD_GTE:
+      CASE_SCMD(SCMD_GTE):
           reg1.SetInt32AsBool(reg1.IValue >= reg2.IValue);
           break;
-      case SCMD_LTE:
+      CASE_SCMD(SCMD_LTE):
           reg1.SetInt32AsBool(reg1.IValue <= reg2.IValue);
           break;
-      case SCMD_AND:
+      CASE_SCMD(SCMD_AND):
           reg1.SetInt32AsBool(reg1.IValue && reg2.IValue);
           break;
-      case SCMD_OR:
+      CASE_SCMD(SCMD_OR):
           reg1.SetInt32AsBool(reg1.IValue || reg2.IValue);
           break;
-      case SCMD_XORREG:
+      CASE_SCMD(SCMD_XORREG):
           reg1.SetInt32(reg1.IValue ^ reg2.IValue);
           break;
-      case SCMD_MODREG:
+      CASE_SCMD(SCMD_MODREG):
           if (reg2.IValue == 0) {
               cc_error("!Integer divide by zero");
               return -1;
           } 
           reg1.SetInt32(reg1.IValue % reg2.IValue);
           break;
-      case SCMD_NOTREG:
+      CASE_SCMD(SCMD_NOTREG):
           reg1 = !(reg1);
           break;
-      case SCMD_CALL:
+      CASE_SCMD(SCMD_CALL):
           // Call another function within same script, just save PC
           // and continue from there
           if (curnest >= MAXNEST - 1) {
@@ -779,7 +791,7 @@ int ccInstance::Run(int32_t curpc)
           PUSH_CALL_STACK;
 
           ASSERT_STACK_SPACE_AVAILABLE(1);
-          PushValueToStack(RuntimeScriptValue().SetInt32(pc + codeOp.ArgCount + 1));
+          PushValueToStack(RuntimeScriptValue().SetInt32(pc + op.ArgCount + 1));
 
           if (thisbase[curnest] == 0)
               pc = reg1.IValue;
@@ -796,41 +808,43 @@ int ccInstance::Run(int32_t curpc)
           curnest++;
           thisbase[curnest] = 0;
           funcstart[curnest] = pc;
+          if (profiler)
+              profiler->Enter(codeInst->GetProfilerFunction(pc));
           continue; // continue so that the PC doesn't get overwritten
-      case SCMD_MEMREADB:
+      CASE_SCMD(SCMD_MEMREADB):
           // Take the data address from reg[MAR] and copy byte to reg[arg1]
           reg1.SetUInt8(registers[SREG_MAR].ReadByte());
           break;
-      case SCMD_MEMREADW:
+      CASE_SCMD(SCMD_MEMREADW):
           // Take the data address from reg[MAR] and copy int16_t to reg[arg1]
           reg1.SetInt16(registers[SREG_MAR].ReadInt16());
           break;
-      case SCMD_MEMWRITEB:
+      CASE_SCMD(SCMD_MEMWRITEB):
           // Take the data address from reg[MAR] and copy there byte from reg[arg1]
           registers[SREG_MAR].WriteByte(reg1.IValue);
           break;
-      case SCMD_MEMWRITEW:
+      CASE_SCMD(SCMD_MEMWRITEW):
           // Take the data address from reg[MAR] and copy there int16_t from reg[arg1]
           registers[SREG_MAR].WriteInt16(reg1.IValue);
           break;
-      case SCMD_JZ:
+      CASE_SCMD(SCMD_JZ):
           if (registers[SREG_AX].IsNull())
               pc += arg1.IValue;
           break;
-      case SCMD_JNZ:
+      CASE_SCMD(SCMD_JNZ):
           if (!registers[SREG_AX].IsNull())
               pc += arg1.IValue;
           break;
-      case SCMD_PUSHREG:
+      CASE_SCMD(SCMD_PUSHREG):
           // Push reg[arg1] value to the stack
           ASSERT_STACK_SPACE_AVAILABLE(1);
           PushValueToStack(reg1);
           break;
-      case SCMD_POPREG:
+      CASE_SCMD(SCMD_POPREG):
           ASSERT_STACK_SIZE(1);
           reg1 = PopValueFromStack();
           break;
-      case SCMD_JMP:
+      CASE_SCMD(SCMD_JMP):
           pc += arg1.IValue;
 
           // Make sure it's not stuck in a While loop
@@ -864,17 +878,17 @@ int ccInstance::Run(int32_t curpc)
               }
           }
           break;
-      case SCMD_MUL:
+      CASE_SCMD(SCMD_MUL):
           reg1.IValue *= arg2.IValue;
           break;
-      case SCMD_CHECKBOUNDS:
+      CASE_SCMD(SCMD_CHECKBOUNDS):
           if ((reg1.IValue < 0) ||
               (reg1.IValue >= arg2.IValue)) {
                   cc_error("!Array index out of bounds (index: %d, bounds: 0..%d)", reg1.IValue, arg2.IValue - 1);
                   return -1;
           }
           break;
-      case SCMD_DYNAMICBOUNDS:
+      CASE_SCMD(SCMD_DYNAMICBOUNDS):
           {
               // TODO: test reg[MAR] type here;
               // That might be dynamic object, but also a non-managed dynamic array, "allocated"
@@ -899,7 +913,7 @@ int ccInstance::Run(int32_t curpc)
 
           // 64 bit: Handles are always 32 bit values. They are not C pointer.
 
-      case SCMD_MEMREADPTR: {
+      CASE_SCMD(SCMD_MEMREADPTR): {
           cc_clear_error();
 
           int32_t handle = registers[SREG_MAR].ReadInt32();
@@ -919,7 +933,7 @@ int ccInstance::Run(int32_t curpc)
           if (cc_has_error())
               return -1;
           break; }
-      case SCMD_MEMWRITEPTR: {
+      CASE_SCMD(SCMD_MEMWRITEPTR): {
 
           int32_t handle = registers[SREG_MAR].ReadInt32();
           char *address = nullptr;
@@ -955,7 +969,7 @@ int ccInstance::Run(int32_t curpc)
           }
           break;
                              }
-      case SCMD_MEMINITPTR: { 
+      CASE_SCMD(SCMD_MEMINITPTR): { 
           char *address = nullptr;
 
           if (reg1.Type == kScValStaticArray && reg1.StcArr->GetDynamicManager())
@@ -986,13 +1000,13 @@ int ccInstance::Run(int32_t curpc)
           registers[SREG_MAR].WriteInt32(newHandle);
           break;
                             }
-      case SCMD_MEMZEROPTR: {
+      CASE_SCMD(SCMD_MEMZEROPTR): {
           int32_t handle = registers[SREG_MAR].ReadInt32();
           ccReleaseObjectReference(handle);
           registers[SREG_MAR].WriteInt32(0);
           break;
                             }
-      case SCMD_MEMZEROPTRND: {
+      CASE_SCMD(SCMD_MEMZEROPTRND): {
           int32_t handle = registers[SREG_MAR].ReadInt32();
 
           // don't do the Dispose check for the object being returned -- this is
@@ -1006,22 +1020,22 @@ int ccInstance::Run(int32_t curpc)
           registers[SREG_MAR].WriteInt32(0);
           break;
                               }
-      case SCMD_CHECKNULL:
+      CASE_SCMD(SCMD_CHECKNULL):
           if (registers[SREG_MAR].IsNull()) {
               cc_error("!Null pointer referenced");
               return -1;
           }
           break;
-      case SCMD_CHECKNULLREG:
+      CASE_SCMD(SCMD_CHECKNULLREG):
           if (reg1.IsNull()) {
               cc_error("!Null string referenced");
               return -1;
           }
           break;
-      case SCMD_NUMFUNCARGS:
+      CASE_SCMD(SCMD_NUMFUNCARGS):
           num_args_to_func = arg1.IValue;
           break;
-      case SCMD_CALLAS:{
+      CASE_SCMD(SCMD_CALLAS):{
           PUSH_CALL_STACK;
 
           // Call to a function in another script
@@ -1052,7 +1066,7 @@ int ccInstance::Run(int32_t curpc)
           ccInstance *wasRunning = runningInst;
 
           // extract the instance ID
-          int32_t instId = codeOp.Instruction.InstanceId;
+          int32_t instId = op.Instruction.InstanceId;
           // determine the offset into the code of the instance we want
           runningInst = loadedInstances[instId];
           intptr_t callAddr = reg1.Ptr - (char*)&runningInst->code[0];
@@ -1080,7 +1094,7 @@ int ccInstance::Run(int32_t curpc)
           POP_CALL_STACK;
           break;
                        }
-      case SCMD_CALLEXT: {
+      CASE_SCMD(SCMD_CALLEXT): {
           // Call to a real 'C' code function
           was_just_callas = -1;
           if (num_args_to_func < 0)
@@ -1096,6 +1110,8 @@ int ccInstance::Run(int32_t curpc)
           }
 
           RuntimeScriptValue return_value;
+          if (profiler)
+              profiler->Enter(GetProfilerFunction(reg1));
 
           if (reg1.Type == kScValPluginFunction)
           {
@@ -1148,6 +1164,8 @@ int ccInstance::Run(int32_t curpc)
             cc_error("invalid pointer type for function call: %d", reg1.Type);
           }
 
+          if (profiler)
+              profiler->Leave();
           if (cc_has_error())
           {
             return -1;
@@ -1158,10 +1176,10 @@ int ccInstance::Run(int32_t curpc)
           num_args_to_func = -1;
           break;
                          }
-      case SCMD_PUSHREAL:
+      CASE_SCMD(SCMD_PUSHREAL):
           PushToFuncCallStack(func_callstack, reg1);
           break;
-      case SCMD_SUBREALSTACK:
+      CASE_SCMD(SCMD_SUBREALSTACK):
           PopFromFuncCallStack(func_callstack, arg1.IValue);
           if (was_just_callas >= 0)
           {
@@ -1170,7 +1188,7 @@ int ccInstance::Run(int32_t curpc)
               was_just_callas = -1;
           }
           break;
-      case SCMD_CALLOBJ:
+      CASE_SCMD(SCMD_CALLOBJ):
           // set the OP register
           if (reg1.IsNull()) {
               cc_error("!Null pointer referenced");
@@ -1205,16 +1223,16 @@ int ccInstance::Run(int32_t curpc)
           }
           next_call_needs_object = 1;
           break;
-      case SCMD_SHIFTLEFT:
+      CASE_SCMD(SCMD_SHIFTLEFT):
           reg1.SetInt32(reg1.IValue << reg2.IValue);
           break;
-      case SCMD_SHIFTRIGHT:
+      CASE_SCMD(SCMD_SHIFTRIGHT):
           reg1.SetInt32(reg1.IValue >> reg2.IValue);
           break;
-      case SCMD_THISBASE:
+      CASE_SCMD(SCMD_THISBASE):
           thisbase[curnest] = arg1.IValue;
           break;
-      case SCMD_NEWARRAY:
+      CASE_SCMD(SCMD_NEWARRAY):
           {
               int numElements = reg1.IValue;
               if (numElements < 1)
@@ -1226,7 +1244,7 @@ int ccInstance::Run(int32_t curpc)
               reg1.SetDynamicObject(ref.second, &globalDynamicArray);
               break;
           }
-      case SCMD_NEWUSEROBJECT:
+      CASE_SCMD(SCMD_NEWUSEROBJECT):
           {
               const int32_t size = arg2.IValue;
               if (size < 0)
@@ -1238,41 +1256,41 @@ int ccInstance::Run(int32_t curpc)
               reg1.SetDynamicObject(suo, suo);
               break;
           }
-      case SCMD_FADD:
+      CASE_SCMD(SCMD_FADD):
           reg1.SetFloat(reg1.FValue + arg2.IValue); // arg2 was used as int here originally
           break;
-      case SCMD_FSUB:
+      CASE_SCMD(SCMD_FSUB):
           reg1.SetFloat(reg1.FValue - arg2.IValue); // arg2 was used as int here originally
           break;
-      case SCMD_FMULREG:
+      CASE_SCMD(SCMD_FMULREG):
           reg1.SetFloat(reg1.FValue * reg2.FValue);
           break;
-      case SCMD_FDIVREG:
+      CASE_SCMD(SCMD_FDIVREG):
           if (reg2.FValue == 0.0) {
               cc_error("!Floating point divide by zero");
               return -1;
           } 
           reg1.SetFloat(reg1.FValue / reg2.FValue);
           break;
-      case SCMD_FADDREG:
+      CASE_SCMD(SCMD_FADDREG):
           reg1.SetFloat(reg1.FValue + reg2.FValue);
           break;
-      case SCMD_FSUBREG:
+      CASE_SCMD(SCMD_FSUBREG):
           reg1.SetFloat(reg1.FValue - reg2.FValue);
           break;
-      case SCMD_FGREATER:
+      CASE_SCMD(SCMD_FGREATER):
           reg1.SetFloatAsBool(reg1.FValue > reg2.FValue);
           break;
-      case SCMD_FLESSTHAN:
+      CASE_SCMD(SCMD_FLESSTHAN):
           reg1.SetFloatAsBool(reg1.FValue < reg2.FValue);
           break;
-      case SCMD_FGTE:
+      CASE_SCMD(SCMD_FGTE):
           reg1.SetFloatAsBool(reg1.FValue >= reg2.FValue);
           break;
-      case SCMD_FLTE:
+      CASE_SCMD(SCMD_FLTE):
           reg1.SetFloatAsBool(reg1.FValue <= reg2.FValue);
           break;
-      case SCMD_ZEROMEMORY:
+      CASE_SCMD(SCMD_ZEROMEMORY):
           // Check if we are zeroing at stack tail
           if (registers[SREG_MAR] == registers[SREG_SP]) {
               // creating a local variable -- check the stack to ensure no mem overrun
@@ -1297,7 +1315,7 @@ int ccInstance::Run(int32_t curpc)
             return -1;
           }
           break;
-      case SCMD_CREATESTRING:
+      CASE_SCMD(SCMD_CREATESTRING):
           if (stringClassImpl == nullptr) {
               cc_error("No string class implementation set, but opcode was used");
               return -1;
@@ -1307,7 +1325,7 @@ int ccInstance::Run(int32_t curpc)
               stringClassImpl->CreateString(direct_ptr1).second,
               &myScriptStringImpl);
           break;
-      case SCMD_STRINGSEQUAL:
+      CASE_SCMD(SCMD_STRINGSEQUAL):
           if ((reg1.IsNull()) || (reg2.IsNull())) {
               cc_error("!Null pointer referenced");
               return -1;
@@ -1317,7 +1335,7 @@ int ccInstance::Run(int32_t curpc)
           reg1.SetInt32AsBool(strcmp(direct_ptr1, direct_ptr2) == 0);
           
           break;
-      case SCMD_STRINGSNOTEQ:
+      CASE_SCMD(SCMD_STRINGSNOTEQ):
           if ((reg1.IsNull()) || (reg2.IsNull())) {
               cc_error("!Null pointer referenced");
               return -1;
@@ -1326,16 +1344,16 @@ int ccInstance::Run(int32_t curpc)
           direct_ptr2 = (const char*)reg2.GetDirectPtr();
           reg1.SetInt32AsBool(strcmp(direct_ptr1, direct_ptr2) != 0 );
           break;
-      case SCMD_LOOPCHECKOFF:
+      CASE_SCMD(SCMD_LOOPCHECKOFF):
           if (loopIterationCheckDisabled == 0)
               loopIterationCheckDisabled++;
           break;
-      default:
-          cc_error("instruction %d is not implemented", codeOp.Instruction.Code);
+      CASE_SCMD_DEFAULT:
+          cc_error("instruction %d is not implemented", op.Instruction.Code);
           return -1;
         }
 
-        pc += codeOp.ArgCount + 1;
+        pc += op.ArgCount + 1;
     }
     return 0;
 }
@@ -1380,6 +1398,48 @@ RuntimeScriptValue ccInstance::GetSymbolAddress(const char *symname) const
     return rval_null;
 }
 
+uint32_t ccInstance::GetProfilerFunction(int32_t at_pc)
+{
+    if (!prof_functions)
+    {
+        // Every script function is exported, so the exports table tells
+        // where each one of them begins
+        prof_functions.reset(new std::vector<std::pair<int32_t, uint32_t>>());
+        for (int i = 0; i < instanceof->numexports; ++i)
+        {
+            const int32_t etype = (instanceof->export_addr[i] >> 24L) & 0x000ff;
+            if (etype != EXPORT_FUNCTION)
+                continue;
+            const int32_t addr = instanceof->export_addr[i] & 0x00ffffff;
+            String name = instanceof->exports[i];
+            size_t mangled_at = name.FindChar('$');
+            if (mangled_at != String::NoIndex)
+                name.TruncateToLeft(mangled_at);
+            // the function may begin exactly at the section's start
+            int sect = instanceof->numSections - 1;
+            for (; (sect >= 0) && (instanceof->sectionOffsets[sect] > addr); --sect);
+            name.AppendFmt(" (%s)", (sect >= 0) ? instanceof->sectionNames[sect] : "unknown section");
+            prof_functions->push_back(std::make_pair(addr, _profiler->RegisterFunction(name)));
+        }
+        std::sort(prof_functions->begin(), prof_functions->end());
+    }
+
+    auto it = std::upper_bound(prof_functions->begin(), prof_functions->end(),
+        std::make_pair(at_pc, UINT32_MAX));
+    if (it == prof_functions->begin())
+        return _profiler->RegisterFunction(String::FromFormat("(unknown) (%s)", instanceof->GetSectionName(at_pc)));
+    return (--it)->second;
+}
+
+uint32_t ccInstance::GetProfilerFunction(const RuntimeScriptValue &fn)
+{
+    uint32_t id;
+    if (_profiler->FindFunction(fn.Ptr, id))
+        return id;
+    String name = simp.findName(fn);
+    return _profiler->RegisterFunction(name.IsEmpty() ? "(unknown)" : name, fn.Ptr);
+}
+
 void ccInstance::DumpInstruction(const ScriptOperation &op) const
 {
     // line_num local var should be shared between all the instances
@@ -1543,6 +1603,8 @@ bool ccInstance::_Create(PScript scri, ccInstance * joined)
     {
         resolved_imports = joined->resolved_imports;
         code_fixups = joined->code_fixups;
+        predecoded = joined->predecoded;
+        prof_functions = joined->prof_functions;
     }
     else
     {
@@ -1643,6 +1705,8 @@ void ccInstance::Free()
     }
     resolved_imports = nullptr;
     code_fixups = nullptr;
+    predecoded.reset();
+    prof_functions.reset();
 }
 
 bool ccInstance::ResolveScriptImports(const ccScript *scri)
@@ -1879,32 +1943,97 @@ bool ccInstance::ResolveImportFixups(const ccScript *scri)
         if (import->InstancePtr != nullptr && (code[fixup + 1] & INSTANCE_ID_REMOVEMASK) == SCMD_CALLEXT)
             code[fixup + 1] = SCMD_CALLAS | (import->InstancePtr->loadedInstanceId << INSTANCE_ID_SHIFT);
     }
+
+    // The bytecode is final now, and may be predecoded
+    if (_predecodeCode)
+        PredecodeCode();
     return true;
 }
 
-/*
-bool ccInstance::ReadOperation(ScriptOperation &op, int32_t at_pc)
+void ccInstance::PredecodeCode()
+{
+    std::shared_ptr<ScriptPredecodedCode> pre(new ScriptPredecodedCode());
+    pre->PcToOp.resize(codesize, -1);
+    for (int32_t at_pc = 0; at_pc < codesize;)
+    {
+        ScriptPredecodedOp pre_op;
+        ScriptOperation &op = pre_op.Op;
+        op.Instruction.Code         = code[at_pc];
+        op.Instruction.InstanceId   = (op.Instruction.Code >> INSTANCE_ID_SHIFT) & INSTANCE_ID_MASK;
+        op.Instruction.Code        &= INSTANCE_ID_REMOVEMASK;
+        // stop at the bad data, and let it be reported if it's ever run
+        if (op.Instruction.Code < 0 || op.Instruction.Code >= CC_NUM_SCCMDS)
+            break;
+        op.ArgCount = sccmd_info[op.Instruction.Code].ArgCount;
+        if (at_pc + op.ArgCount >= codesize)
+            break;
+
+        bool is_valid = true;
+        int32_t pc_at = at_pc + 1;
+        for (int i = 0; i < op.ArgCount; ++i, ++pc_at)
+        {
+            const char fixup = code_fixups[pc_at];
+            switch (fixup)
+            {
+            case 0: // numeric literal (int32 or float)
+                op.Args[i].SetInt32((int32_t)code[pc_at]);
+                break;
+            case FIXUP_GLOBALDATA:
+            case FIXUP_FUNCTION:
+            case FIXUP_STRING:
+                // these are constant while the instance exists
+                FixupArgument(this, code[pc_at], fixup, op.Args[i]);
+                break;
+            case FIXUP_IMPORT:
+            case FIXUP_STACK:
+                // these may only be resolved when the operation is run
+                op.Args[i].SetInt32((int32_t)code[pc_at]);
+                pre_op.DynamicFixups[i] = fixup;
+                pre_op.HasDynamicArgs = true;
+                break;
+            default:
+                is_valid = false; // let it be reported if it's ever run
+                break;
+            }
+        }
+
+        if (is_valid)
+        {
+            pre->PcToOp[at_pc] = static_cast<int32_t>(pre->Ops.size());
+            pre->Ops.push_back(pre_op);
+        }
+        at_pc += op.ArgCount + 1;
+    }
+    predecoded = pre;
+}
+
+bool ccInstance::ReadOperation(const ccInstance *code_inst, ScriptOperation &op, int32_t at_pc)
 {
-	op.Instruction.Code			= code[at_pc];
-	op.Instruction.InstanceId	= (op.Instruction.Code >> INSTANCE_ID_SHIFT) & INSTANCE_ID_MASK;
-	op.Instruction.Code		   &= INSTANCE_ID_REMOVEMASK; // now this is pure instruction code
+    op.Instruction.Code         = code_inst->code[at_pc];
+    op.Instruction.InstanceId   = (op.Instruction.Code >> INSTANCE_ID_SHIFT) & INSTANCE_ID_MASK;
+    op.Instruction.Code        &= INSTANCE_ID_REMOVEMASK; // now this is pure instruction code
+
+    if (op.Instruction.Code < 0 || op.Instruction.Code >= CC_NUM_SCCMDS)
+    {
+        cc_error("invalid instruction %d found in code stream", op.Instruction.Code);
+        return false;
+    }
 
-    int want_args = sccmd_info[op.Instruction.Code].ArgCount;
-    if (at_pc + want_args >= codesize)
+    op.ArgCount = sccmd_info[op.Instruction.Code].ArgCount;
+    if (at_pc + op.ArgCount >= code_inst->codesize)
     {
-        cc_error("unexpected end of code data at %d", at_pc + want_args);
+        cc_error("unexpected end of code data (%d; %d)", at_pc + op.ArgCount, code_inst->codesize);
         return false;
     }
-    op.ArgCount = want_args;
 
     at_pc++;
     for (int i = 0; i < op.ArgCount; ++i, ++at_pc)
     {
-        char fixup = code_fixups[at_pc];
+        char fixup = code_inst->code_fixups[at_pc];
         if (fixup > 0)
         {
             // could be relative pointer or import address
-            if (!FixupArgument(code[at_pc], fixup, op.Args[i]))
+            if (!FixupArgument(code_inst, code_inst->code[at_pc], fixup, op.Args[i]))
             {
                 return false;
             }
@@ -1912,15 +2041,15 @@ bool ccInstance::ReadOperation(ScriptOperation &op, int32_t at_pc)
         else
         {
             // should be a numeric literal (int32 or float)
-            op.Args[i].SetInt32( (int32_t)code[at_pc] );
+            op.Args[i].SetInt32( (int32_t)code_inst->code[at_pc] );
         }
     }
 
     return true;
 }
-*/
-/*
-bool ccInstance::FixupArgument(intptr_t code_value, char fixup_type, RuntimeScriptValue &argument)
+
+bool ccInstance::FixupArgument(const ccInstance *code_inst, intptr_t code_value, char fixup_type,
+    RuntimeScriptValue &argument)
 {
     switch (fixup_type)
     {
@@ -1937,11 +2066,11 @@ bool ccInstance::FixupArgument(intptr_t code_value, char fixup_type, RuntimeScri
         argument.SetInt32((int32_t)code_value);
         break;
     case FIXUP_STRING:
-        argument.SetStringLiteral(&strings[0] + code_value);
+        argument.SetStringLiteral(&code_inst->strings[0] + code_value);
         break;
     case FIXUP_IMPORT:
         {
-            const ScriptImport *import = simp.getByIndex((int32_t)code_value);
+            const ScriptImport *import = simp.getByIndex(static_cast<uint32_t>(code_value));
             if (import)
             {
                 argument = import->Value;
@@ -1958,11 +2087,11 @@ bool ccInstance::FixupArgument(intptr_t code_value, char fixup_type, RuntimeScri
         break;
     default:
         cc_error("internal fixup type error: %d", fixup_type);
-        return false;;
+        return false;
     }
     return true;
 }
-*/
+
 //-----------------------------------------------------------------------------
 
 void ccInstance::PushValueToStack(const RuntimeScriptValue &rval)
@@ -20,6 +20,7 @@
 
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 #include "ac/timer.h"
 #include "script/cc_script.h"  // ccScript
@@ -29,6 +30,8 @@
 
 using namespace AGS;
 
+class ScriptProfiler;
+
 #define INSTF_SHAREDATA     1
 #define INSTF_ABORTED       2
 #define INSTF_FREE          4
@@ -68,6 +71,25 @@ struct ScriptOperation
 	int				    ArgCount;
 };
 
+// Script operation decoded in advance, before the script is run
+struct ScriptPredecodedOp
+{
+    ScriptOperation Op;
+    // Fixup types of the arguments which must be resolved at the time of
+    // execution (e.g. stack offsets), or 0 for the arguments ready to use
+    char            DynamicFixups[MAX_SCMD_ARGS] = {};
+    bool            HasDynamicArgs = false;
+};
+
+// Script bytecode translated into the sequence of predecoded operations
+struct ScriptPredecodedCode
+{
+    std::vector<ScriptPredecodedOp> Ops;
+    // Index of the operation for each bytecode position, or -1 if there's
+    // no operation starting at this position, or it could not be predecoded
+    std::vector<int32_t> PcToOp;
+};
+
 struct ScriptVariable
 {
     ScriptVariable()
@@ -144,6 +166,11 @@ public:
     int  numimports;
 
     char *code_fixups;
+    // predecoded operations, shared with the forked instances
+    std::shared_ptr<ScriptPredecodedCode> predecoded;
+    // script function addresses paired with their profiler ids, sorted
+    // by address; shared with the forked instances
+    std::shared_ptr<std::vector<std::pair<int32_t, uint32_t>>> prof_functions;
 
     // returns the currently executing instance, or NULL if none
     static ccInstance *GetCurrentInstance(void);
@@ -151,6 +178,11 @@ public:
     static ccInstance *CreateFromScript(PScript script);
     static ccInstance *CreateEx(PScript scri, ccInstance * joined);
     static void SetExecTimeout(unsigned sys_poll_ms, unsigned abort_ms);
+    // Sets whether to predecode the script bytecode when the instance is
+    // created; otherwise each operation is decoded every time it's run
+    static void SetCodePredecoding(bool on);
+    // Sets the profiler to notify about the script execution, or null
+    static void SetProfiler(ScriptProfiler *profiler);
 
     ccInstance();
     ~ccInstance();
@@ -180,7 +212,8 @@ public:
     bool    ResolveScriptImports(const ccScript *scri);
 
     // Using resolved_imports[], resolve the IMPORT fixups
-    // Also change CALLEXT op-codes to CALLAS when they pertain to a script instance 
+    // Also change CALLEXT op-codes to CALLAS when they pertain to a script instance;
+    // finally predecodes the bytecode, if predecoding is enabled
     bool    ResolveImportFixups(const ccScript *scri);
 
 private:
@@ -192,12 +225,21 @@ private:
     bool    AddGlobalVar(const ScriptVariable &glvar);
     ScriptVariable *FindGlobalVar(int32_t var_addr);
     bool    CreateRuntimeCodeFixups(const ccScript *scri);
-	//bool    ReadOperation(ScriptOperation &op, int32_t at_pc);
+    // Translates the bytecode into the predecoded operations
+    void    PredecodeCode();
+    // Decodes the operation from the code_inst's bytecode, resolving its arguments
+    bool    ReadOperation(const ccInstance *code_inst, ScriptOperation &op, int32_t at_pc);
+
+    // Gets the profiler's id of the script function at the given address
+    uint32_t GetProfilerFunction(int32_t at_pc);
+    // Gets the profiler's id of the engine or plugin function
+    static uint32_t GetProfilerFunction(const RuntimeScriptValue &fn);
 
     // Begin executing script starting from the given bytecode index
     int     Run(int32_t curpc);
     // Runtime fixups
-    //bool    FixupArgument(intptr_t code_value, char fixup_type, RuntimeScriptValue &argument);
+    bool    FixupArgument(const ccInstance *code_inst, intptr_t code_value, char fixup_type,
+                RuntimeScriptValue &argument);
 
     // Stack processing
     // Push writes new value and increments stack ptr;
@@ -227,6 +269,10 @@ private:
     // Critical timeout: how much time may pass without any engine update
     // before we abort or post a warning
     static unsigned _timeoutAbortMs;
+    // Whether to predecode the bytecode of the new instances
+    static bool _predecodeCode;
+    // Profiler to notify about the script execution
+    static ScriptProfiler *_profiler;
     // Last time the script was noted of being "alive"
     AGS_Clock::time_point _lastAliveTs;
 };
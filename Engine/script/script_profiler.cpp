@@ -0,0 +1,176 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+#include "script/script_profiler.h"
+#include <algorithm>
+#include "util/stream.h"
+
+using namespace AGS::Common;
+
+ScriptProfiler::ScriptProfiler()
+{
+    Reset();
+}
+
+ScriptProfiler::FuncId ScriptProfiler::RegisterFunction(const String &name, const void *key)
+{
+    FuncId id;
+    auto it = _funcByName.find(name);
+    if (it != _funcByName.end())
+    {
+        id = it->second;
+    }
+    else
+    {
+        id = static_cast<FuncId>(_funcNames.size());
+        _funcNames.push_back(name);
+        _funcByName.insert(std::make_pair(name, id));
+    }
+    if (key)
+        _funcByKey[key] = id;
+    return id;
+}
+
+bool ScriptProfiler::FindFunction(const void *key, FuncId &id) const
+{
+    auto it = _funcByKey.find(key);
+    if (it == _funcByKey.end())
+        return false;
+    id = it->second;
+    return true;
+}
+
+void ScriptProfiler::Reset()
+{
+    _nodes.clear();
+    _children.clear();
+    _stack.clear();
+    _nodes.push_back(CallNode(UINT32_MAX, UINT32_MAX));
+    _current = 0u;
+    _lastTime = AGS_Clock::now();
+    _instructions = 0u;
+}
+
+void ScriptProfiler::Flush()
+{
+    const auto now = AGS_Clock::now();
+    CallNode &node = _nodes[_current];
+    node.Time += now - _lastTime;
+    node.Instructions += _instructions;
+    _lastTime = now;
+    _instructions = 0u;
+}
+
+void ScriptProfiler::Enter(FuncId id)
+{
+    Flush();
+    const uint64_t key = (static_cast<uint64_t>(_current) << 32) | id;
+    auto it = _children.find(key);
+    uint32_t child;
+    if (it != _children.end())
+    {
+        child = it->second;
+    }
+    else
+    {
+        child = static_cast<uint32_t>(_nodes.size());
+        _nodes.push_back(CallNode(id, _current));
+        _children.insert(std::make_pair(key, child));
+    }
+    _nodes[child].Calls++;
+    _stack.push_back(child);
+    _current = child;
+}
+
+void ScriptProfiler::Leave()
+{
+    if (_stack.empty())
+        return;
+    Flush();
+    _stack.pop_back();
+    _current = _stack.empty() ? 0u : _stack.back();
+}
+
+void ScriptProfiler::LeaveTo(size_t depth)
+{
+    if (depth >= _stack.size())
+        return;
+    Flush();
+    _stack.resize(depth);
+    _current = _stack.empty() ? 0u : _stack.back();
+}
+
+std::vector<ScriptProfiler::FunctionStats> ScriptProfiler::GetFunctionStats()
+{
+    Flush();
+    // Nodes are always added after their parents, so a backwards pass
+    // gathers the total time of each node's subtree
+    std::vector<AGS_Clock::duration> total_time(_nodes.size());
+    for (size_t i = 0; i < _nodes.size(); ++i)
+        total_time[i] = _nodes[i].Time;
+    for (size_t i = _nodes.size() - 1; i > 0; --i)
+        total_time[_nodes[i].Parent] += total_time[i];
+
+    std::vector<FunctionStats> func_stats(_funcNames.size());
+    for (size_t i = 1; i < _nodes.size(); ++i)
+    {
+        const CallNode &node = _nodes[i];
+        FunctionStats &stats = func_stats[node.Func];
+        stats.Calls += node.Calls;
+        stats.Instructions += node.Instructions;
+        stats.SelfTime += node.Time;
+        // count the total time only for the outermost call of the recursion
+        uint32_t parent = node.Parent;
+        for (; (parent != 0u) && (_nodes[parent].Func != node.Func); parent = _nodes[parent].Parent);
+        if (parent == 0u)
+            stats.TotalTime += total_time[i];
+    }
+
+    std::vector<FunctionStats> result;
+    for (size_t i = 0; i < func_stats.size(); ++i)
+    {
+        if (func_stats[i].Calls == 0u)
+            continue;
+        func_stats[i].Name = _funcNames[i];
+        result.push_back(func_stats[i]);
+    }
+    return result;
+}
+
+void ScriptProfiler::WriteCollapsedStacks(Stream *out, ProfileValue value)
+{
+    Flush();
+    std::vector<uint32_t> path;
+    String line;
+    for (size_t i = 1; i < _nodes.size(); ++i)
+    {
+        const CallNode &node = _nodes[i];
+        const uint64_t node_value = (value == kProfile_Time) ?
+            std::chrono::duration_cast<std::chrono::microseconds>(node.Time).count() :
+            node.Instructions;
+        if (node_value == 0u)
+            continue;
+        path.clear();
+        for (uint32_t n = static_cast<uint32_t>(i); n != 0u; n = _nodes[n].Parent)
+            path.push_back(_nodes[n].Func);
+        line.Empty();
+        for (auto it = path.rbegin(); it != path.rend(); ++it)
+        {
+            if (it != path.rbegin())
+                line.AppendChar(';');
+            line.Append(_funcNames[*it]);
+        }
+        line.AppendFmt(" %llu\n", static_cast<unsigned long long>(node_value));
+        out->Write(line.GetCStr(), line.GetLength());
+    }
+}
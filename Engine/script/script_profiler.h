@@ -0,0 +1,121 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// ScriptProfiler is an instrumenting profiler for the script interpreter.
+// Interpreter notifies it whenever a function is entered or left, and
+// counts executed instructions; profiler attributes the wall time and the
+// instructions to the function on top of the current call stack, separately
+// for each distinct call stack.
+//
+// Collected data may be written in the "collapsed stacks" text format, which
+// is accepted by the common flame graph tools: a line per call stack, with
+// function names separated by ';', followed by a space and a value, e.g.:
+//
+//   game_start (GlobalScript.asc);Character::Say^3 1250
+//
+//=============================================================================
+#ifndef __AGS_EE_SCRIPT__SCRIPTPROFILER_H
+#define __AGS_EE_SCRIPT__SCRIPTPROFILER_H
+
+#include <unordered_map>
+#include <vector>
+#include "ac/timer.h"
+#include "util/string_types.h"
+
+namespace AGS { namespace Common { class Stream; } }
+using namespace AGS; // FIXME later
+
+class ScriptProfiler
+{
+public:
+    // Function's id, unique for each registered name
+    typedef uint32_t FuncId;
+
+    // Which value to write for each call stack
+    enum ProfileValue
+    {
+        kProfile_Time,          // time spent, in microseconds
+        kProfile_Instructions   // number of executed instructions
+    };
+
+    // Function statistics, summed over all of its call stacks
+    struct FunctionStats
+    {
+        Common::String Name;
+        uint64_t Calls = 0u;
+        uint64_t Instructions = 0u; // not including called functions
+        AGS_Clock::duration SelfTime = AGS_Clock::duration::zero();
+        AGS_Clock::duration TotalTime = AGS_Clock::duration::zero();
+    };
+
+    ScriptProfiler();
+
+    // Registers the function name, returns its id; the same name always
+    // gets the same id. Optional unique key allows to find it later
+    // without resolving the name again.
+    FuncId RegisterFunction(const Common::String &name, const void *key = nullptr);
+    // Finds the function registered with the given key
+    bool   FindFunction(const void *key, FuncId &id) const;
+    // Clears the collected data, but keeps the registered functions
+    void   Reset();
+
+    // Notifies that the function is called from the current one
+    void   Enter(FuncId id);
+    // Notifies that the current function returned
+    void   Leave();
+    // Returns the depth of the current call stack
+    inline size_t GetDepth() const { return _stack.size(); }
+    // Unwinds the current call stack to the given depth
+    void   LeaveTo(size_t depth);
+    // Counts the instruction executed by the current function
+    inline void CountInstruction() { _instructions++; }
+
+    // Returns the statistics of all the called functions
+    std::vector<FunctionStats> GetFunctionStats();
+    // Writes collected call stacks in the collapsed stacks format
+    void   WriteCollapsedStacks(Common::Stream *out, ProfileValue value);
+
+private:
+    struct CallNode
+    {
+        FuncId   Func;
+        uint32_t Parent;
+        uint64_t Calls = 0u;
+        uint64_t Instructions = 0u;
+        AGS_Clock::duration Time = AGS_Clock::duration::zero(); // self time
+
+        CallNode(FuncId func, uint32_t parent) : Func(func), Parent(parent) {}
+    };
+
+    // Assigns the time and instructions passed since the last event
+    // to the current call node
+    void Flush();
+
+    // Registered function names, indexed by FuncId
+    std::vector<Common::String> _funcNames;
+    std::unordered_map<Common::String, FuncId> _funcByName;
+    std::unordered_map<const void*, FuncId> _funcByKey;
+    // Call tree: node 0 is the root, which stands for the engine code;
+    // the children are found by a combined (parent node, function) key
+    std::vector<CallNode> _nodes;
+    std::unordered_map<uint64_t, uint32_t> _children;
+    // Nodes of the current call stack, excluding root
+    std::vector<uint32_t> _stack;
+    uint32_t _current = 0u;
+    // Time of the last event and the instructions counted since
+    AGS_Clock::time_point _lastTime;
+    uint64_t _instructions = 0u;
+};
+
+#endif // __AGS_EE_SCRIPT__SCRIPTPROFILER_H
@@ -31,6 +31,7 @@
 #include "ac/statobj/staticobject.h"
 #include "script/cc_common.h"
 #include "script/systemimports.h"
+#include "script/script_profiler.h"
 #include "script/script_runtime.h"
 
 bool ccAddExternalStaticFunction(const String &name, ScriptAPIFunction *pfn)
@@ -132,6 +133,30 @@ void ccSetScriptAliveTimer(unsigned sys_poll_timeout, unsigned abort_timeout) {
     ccInstance::SetExecTimeout(sys_poll_timeout, abort_timeout);
 }
 
+void ccSetScriptCodePredecoding(bool on) {
+    ccInstance::SetCodePredecoding(on);
+}
+
+// The profiler is kept once created, because the script instances
+// remember the ids of their functions registered in it
+static std::unique_ptr<ScriptProfiler> ScProfiler;
+static bool ScProfilerOn = false;
+
+void ccSetScriptProfiling(bool on) {
+    if (on) {
+        if (!ScProfiler)
+            ScProfiler.reset(new ScriptProfiler());
+        else
+            ScProfiler->Reset();
+    }
+    ScProfilerOn = on;
+    ccInstance::SetProfiler(on ? ScProfiler.get() : nullptr);
+}
+
+ScriptProfiler *ccGetScriptProfiler() {
+    return ScProfilerOn ? ScProfiler.get() : nullptr;
+}
+
 void ccNotifyScriptStillAlive () {
     ccInstance *cur_inst = ccInstance::GetCurrentInstance();
     if (cur_inst)
@@ -33,6 +33,7 @@
 struct ICCStaticObject;
 struct ICCDynamicObject;
 struct StaticArray;
+class ScriptProfiler;
 
 using AGS::Common::String;
 using AGS::Common::String;
@@ -70,6 +71,13 @@ extern void ccSetDebugHook(new_line_hook_type jibble);
 // * sys_poll_timeout - defines the timeout at which the interpreter will run system events poll;
 // * abort_timeout - defines the timeout at which the interpreter will cancel with error.
 extern void ccSetScriptAliveTimer(unsigned sys_poll_timeout, unsigned abort_timeout);
+// Set whether the script bytecode is predecoded when the script is loaded
+extern void ccSetScriptCodePredecoding(bool on);
+// Starts or stops collecting the script execution profile;
+// restarting the profiler clears the previously collected data
+extern void ccSetScriptProfiling(bool on);
+// Returns the active script profiler, or null if profiling is off
+extern ScriptProfiler *ccGetScriptProfiler();
 // reset the current while loop counter
 extern void ccNotifyScriptStillAlive();
 // for calling exported plugin functions old-style
@@ -0,0 +1,100 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+#include <memory>
+#include <vector>
+#include "gtest/gtest.h"
+#include "gfx/ali3dsw.h"
+#include "gfx/bitmap.h"
+#include "test/test_random.h"
+
+using namespace AGS::Common;
+using namespace AGS::Engine;
+using namespace AGS::Engine::ALSW;
+
+struct TestSprite
+{
+    int X, Y;
+    int Width, Height;
+    bool HasAlpha;
+    bool Opaque;
+    int Alpha;
+};
+
+// Draws the same sprite batch with the given number of render threads,
+// and returns a copy of the resulting screen
+static Bitmap *RenderBatch(int thread_count, const std::vector<TestSprite> &sprites)
+{
+    const int screen_w = 320, screen_h = 240;
+    SDLRendererGraphicsDriver driver;
+    driver.SetRenderThreads(thread_count);
+    EXPECT_TRUE(driver.SetNativeResolution(GraphicResolution(screen_w, screen_h, 32)));
+    uint32_t seed = 1;
+    FillRandom(driver.GetMemoryBackBuffer(), seed);
+
+    std::vector<std::unique_ptr<Bitmap>> bitmaps;
+    std::vector<IDriverDependantBitmap*> ddbs;
+    driver.BeginSpriteBatch(RectWH(0, 0, screen_w, screen_h), SpriteTransform());
+    for (const auto &spr : sprites)
+    {
+        Bitmap *bmp = BitmapHelper::CreateBitmap(spr.Width, spr.Height, 32);
+        FillRandom(bmp, seed);
+        bitmaps.emplace_back(bmp);
+        IDriverDependantBitmap *ddb = driver.CreateDDBFromBitmap(bmp, spr.HasAlpha, spr.Opaque);
+        ddb->SetAlpha(spr.Alpha);
+        ddbs.push_back(ddb);
+        driver.DrawSprite(spr.X, spr.Y, ddb);
+    }
+    driver.SetScreenTint(40, 120, 200);
+    driver.EndSpriteBatch();
+    driver.RenderToBackBuffer();
+
+    Bitmap *screen = driver.GetMemoryBackBuffer();
+    Bitmap *result = BitmapHelper::CreateBitmapCopy(screen);
+    for (auto *ddb : ddbs)
+        driver.DestroyDDB(ddb);
+    return result;
+}
+
+TEST(SoftwareRenderer, TiledMatchesSerial) {
+    // Sprites cross the tile borders and the screen edges, and use every
+    // drawing mode: opaque, masked, translucent and alpha blended
+    const std::vector<TestSprite> sprites = {
+        { -20, -10, 120, 90, false, true, 255 },
+        { 150, 30, 100, 150, false, false, 255 },
+        { 40, 60, 200, 50, false, false, 100 },
+        { 10, 100, 80, 130, true, false, 255 },
+        { 200, 120, 160, 140, true, false, 128 },
+        { 60, 20, 33, 200, true, false, 1 },
+        { 90, 170, 50, 50, false, false, 0 },
+        { 0, 0, 320, 240, true, false, 77 }
+    };
+
+    std::unique_ptr<Bitmap> serial(RenderBatch(1, sprites));
+    for (int thread_count : { 2, 3, 4 })
+    {
+        std::unique_ptr<Bitmap> tiled(RenderBatch(thread_count, sprites));
+        ASSERT_EQ(serial->GetWidth(), tiled->GetWidth());
+        ASSERT_EQ(serial->GetHeight(), tiled->GetHeight());
+        for (int y = 0; y < serial->GetHeight(); ++y)
+        {
+            const uint32_t *serial_line = reinterpret_cast<const uint32_t*>(serial->GetScanLine(y));
+            const uint32_t *tiled_line = reinterpret_cast<const uint32_t*>(tiled->GetScanLine(y));
+            for (int x = 0; x < serial->GetWidth(); ++x)
+            {
+                ASSERT_EQ(serial_line[x], tiled_line[x]) << "using " << thread_count
+                    << " threads, at pixel " << x << "," << y;
+            }
+        }
+    }
+}
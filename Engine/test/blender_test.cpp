@@ -0,0 +1,147 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+#include <functional>
+#include <memory>
+#include "gtest/gtest.h"
+#include <allegro.h>
+#include "gfx/bitmap.h"
+#include "gfx/blender.h"
+#include "gfx/blender_simd.h"
+#include "test/test_random.h"
+
+using namespace AGS::Common;
+
+// Draws the sprite with both the kernels and the reference function,
+// at several positions and with clipping, and compares the results
+static void TestDraw(const char *what,
+    const std::function<bool(Bitmap*, Bitmap*, int, int)> &draw_kernels,
+    const std::function<void(Bitmap*, Bitmap*, int, int)> &draw_ref)
+{
+    const Point positions[] = { Point(0, 0), Point(5, 3), Point(-7, -2), Point(30, 21), Point(60, 40) };
+    const Rect clips[] = { Rect(0, 0, 63, 47), Rect(3, 2, 50, 40), Rect(10, 10, 10, 10) };
+    uint32_t seed = 1;
+    std::unique_ptr<Bitmap> sprite(BitmapHelper::CreateBitmap(37, 29, 32));
+    std::unique_ptr<Bitmap> dst(BitmapHelper::CreateBitmap(64, 48, 32));
+    std::unique_ptr<Bitmap> ref(BitmapHelper::CreateBitmap(64, 48, 32));
+    for (const Rect &clip : clips)
+    {
+        for (const Point &pos : positions)
+        {
+            FillRandom(sprite.get(), seed);
+            FillRandom(dst.get(), seed);
+            ref->ResetClip();
+            ref->Blit(dst.get(), 0, 0, 0, 0, dst->GetWidth(), dst->GetHeight());
+            dst->SetClip(clip);
+            ref->SetClip(clip);
+            ASSERT_TRUE(draw_kernels(dst.get(), sprite.get(), pos.X, pos.Y));
+            draw_ref(ref.get(), sprite.get(), pos.X, pos.Y);
+            for (int y = 0; y < dst->GetHeight(); ++y)
+            {
+                const uint32_t *dst_line = reinterpret_cast<const uint32_t*>(dst->GetScanLine(y));
+                const uint32_t *ref_line = reinterpret_cast<const uint32_t*>(ref->GetScanLine(y));
+                for (int x = 0; x < dst->GetWidth(); ++x)
+                {
+                    ASSERT_EQ(ref_line[x], dst_line[x]) << what << " using "
+                        << get_blend_kernels_name(get_blend_kernels()) << ", at pixel " << x << "," << y;
+                }
+            }
+        }
+    }
+}
+
+static void TestAllModes()
+{
+    for (int light : { 0, 1, 90, 200, 255 })
+    {
+        for (int col : { 8, 248 })
+        {
+            TestDraw("Lit",
+                [light, col](Bitmap *ds, Bitmap *spr, int x, int y)
+                { return draw_lit_sprite32(ds, spr, x, y, col, col, col, light); },
+                [light, col](Bitmap *ds, Bitmap *spr, int x, int y)
+                { set_my_trans_blender(col, col, col, 0); ds->LitBlendBlt(spr, x, y, light); });
+        }
+    }
+
+    for (int lum : { 100, 250 })
+    {
+        TestDraw("Tint",
+            [lum](Bitmap *ds, Bitmap *spr, int x, int y)
+            { return draw_tinted_sprite32(ds, spr, x, y, 40, 120, 200, lum); },
+            [lum](Bitmap *ds, Bitmap *spr, int x, int y)
+            {
+                if (lum >= 250)
+                    set_blender_mode(nullptr, nullptr, _myblender_color32, 40, 120, 200, 0);
+                else
+                    set_blender_mode(nullptr, nullptr, _myblender_color32_light, 40, 120, 200, 0);
+                ds->LitBlendBlt(spr, x, y, lum);
+            });
+    }
+
+    for (int alpha : { 0, 1, 77, 128, 254, 255 })
+    {
+        TestDraw("MyTrans",
+            [alpha](Bitmap *ds, Bitmap *spr, int x, int y)
+            { return draw_trans_sprite32(ds, spr, x, y, kBlendRow_MyTrans, alpha); },
+            [alpha](Bitmap *ds, Bitmap *spr, int x, int y)
+            { set_my_trans_blender(0, 0, 0, alpha); ds->TransBlendBlt(spr, x, y); });
+
+        const struct { BlendRowMode Mode; BLENDER_FUNC Blender; const char *Name; } blenders[] = {
+            { kBlendRow_Argb2Rgb, _argb2rgb_blender, "Argb2Rgb" },
+            { kBlendRow_Argb2Argb, _argb2argb_blender, "Argb2Argb" },
+            { kBlendRow_Rgb2Argb, _rgb2argb_blender, "Rgb2Argb" },
+            { kBlendRow_OpaqueAlpha, _opaque_alpha_blender, "OpaqueAlpha" }
+        };
+        for (const auto &b : blenders)
+        {
+            const BlendRowMode mode = b.Mode;
+            const BLENDER_FUNC blender = b.Blender;
+            TestDraw(b.Name,
+                [mode, alpha](Bitmap *ds, Bitmap *spr, int x, int y)
+                { return draw_trans_sprite32(ds, spr, x, y, mode, alpha); },
+                [blender, alpha](Bitmap *ds, Bitmap *spr, int x, int y)
+                { set_blender_mode(nullptr, nullptr, blender, 0, 0, 0, alpha); ds->TransBlendBlt(spr, x, y); });
+        }
+    }
+
+    // Standard Allegro's alpha blender
+    TestDraw("Alpha",
+        [](Bitmap *ds, Bitmap *spr, int x, int y)
+        { return draw_trans_sprite32(ds, spr, x, y, kBlendRow_Argb2Rgb, 0); },
+        [](Bitmap *ds, Bitmap *spr, int x, int y)
+        { set_alpha_blender(); ds->TransBlendBlt(spr, x, y); });
+}
+
+TEST(Blender, RowKernels) {
+    const BlendSimdSet best_set = init_blend_kernels();
+    for (int set = kBlendSimd_Scalar; set < kNumBlendSimdSets; ++set)
+    {
+        if (!set_blend_kernels(static_cast<BlendSimdSet>(set)))
+            continue;
+        TestAllModes();
+    }
+    set_blend_kernels(best_set);
+}
+
+TEST(Blender, RowKernelsFallback) {
+    std::unique_ptr<Bitmap> sprite(BitmapHelper::CreateBitmap(8, 8, 16));
+    std::unique_ptr<Bitmap> dst(BitmapHelper::CreateBitmap(8, 8, 32));
+    // kernels only draw 32-bit sprites on 32-bit bitmaps
+    ASSERT_FALSE(draw_lit_sprite32(dst.get(), sprite.get(), 0, 0, 8, 8, 8, 100));
+    ASSERT_FALSE(draw_tinted_sprite32(dst.get(), sprite.get(), 0, 0, 8, 8, 8, 100));
+    ASSERT_FALSE(draw_trans_sprite32(dst.get(), sprite.get(), 0, 0, kBlendRow_MyTrans, 100));
+    ASSERT_TRUE(set_blend_kernels(kBlendSimd_Scalar));
+    ASSERT_EQ(kBlendSimd_Scalar, get_blend_kernels());
+    init_blend_kernels();
+}
@@ -0,0 +1,151 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+#include <memory>
+#include <vector>
+#include "gtest/gtest.h"
+#include "gfx/bitmap.h"
+#include "gui/guimain.h"
+#include "gui/guiobject.h"
+#include "test/test_random.h"
+
+using namespace AGS::Common;
+
+// Simple control, which fills its rect with a color, and optionally draws
+// a line that sticks out of its bounds
+class TestControl : public GUIObject
+{
+public:
+    color_t Color = 0;
+    bool    Clipped = true;
+
+    bool IsContentClipped() const override { return Clipped; }
+    Rect CalcGraphicRect(bool clipped) override
+    {
+        return clipped ? RectWH(0, 0, Width, Height) : Rect(-3, -3, Width + 2, Height + 2);
+    }
+    void Draw(Bitmap *ds, int x, int y) override
+    {
+        ds->FillRect(RectWH(x, y, Width, Height), Color | 0xFF000000);
+        ds->DrawLine(Line(x - 3, y - 3, x + Width + 2, y + Height + 2), (Color ^ 0xFFFFFF) | 0xFF000000);
+        if (!IsEnabled())
+            ds->DrawLine(Line(x, y + Height - 1, x + Width - 1, y), 0xFF00FF00);
+    }
+};
+
+// Randomly changes controls and redraws only the changed parts of GUI,
+// then compares the result with the GUI drawn from scratch
+static void TestDrawChangedControls(uint32_t seed)
+{
+    const int num_ctrls = 12;
+    const int gui_w = 200, gui_h = 120;
+    std::vector<TestControl> ctrls(num_ctrls);
+    guis.resize(1);
+    GUIMain &gui = guis[0];
+    GUIMain ref_gui; // reference gui, always redrawn whole
+    gui.InitDefaults();
+    gui.Width = ref_gui.Width = gui_w;
+    gui.Height = ref_gui.Height = gui_h;
+    gui.BgColor = ref_gui.BgColor = 0xFF334455;
+    gui.FgColor = ref_gui.FgColor = 0xFF112233;
+    for (int i = 0; i < num_ctrls; ++i)
+    {
+        TestControl &ctrl = ctrls[i];
+        ctrl.Id = i;
+        ctrl.ParentId = 0;
+        ctrl.ZOrder = i;
+        ctrl.X = NextRandom(seed, gui_w) - 20;
+        ctrl.Y = NextRandom(seed, gui_h) - 20;
+        ctrl.Width = 1 + NextRandom(seed, 50);
+        ctrl.Height = 1 + NextRandom(seed, 40);
+        ctrl.Color = NextRandom(seed, 0xFFFFFF);
+        ctrl.Clipped = NextRandom(seed, 2) == 0;
+        if (NextRandom(seed, 4) == 0)
+            ctrl.SetTransparency(NextRandom(seed, 255));
+        gui.AddControl(kGUIButton, i, &ctrl);
+        ref_gui.AddControl(kGUIButton, i, &ctrl);
+    }
+    gui.ResortZOrder();
+    ref_gui.ResortZOrder();
+
+    std::unique_ptr<Bitmap> bmp(BitmapHelper::CreateTransparentBitmap(gui_w, gui_h, 32));
+    std::unique_ptr<Bitmap> ref_bmp(BitmapHelper::CreateTransparentBitmap(gui_w, gui_h, 32));
+    std::vector<Rect> dirty_rects;
+    int partial_updates = 0;
+    for (int step = 0; step < 1000; ++step)
+    {
+        for (int n = 1 + NextRandom(seed, 3); n > 0; --n)
+        {
+            TestControl &ctrl = ctrls[NextRandom(seed, num_ctrls)];
+            switch (NextRandom(seed, 10))
+            {
+            case 0: ctrl.X += NextRandom(seed, 21) - 10; ctrl.NotifyParentChanged(); break;
+            case 1: ctrl.Y += NextRandom(seed, 21) - 10; ctrl.NotifyParentChanged(); break;
+            case 2: ctrl.Width = NextRandom(seed, 50); ctrl.OnResized(); break;
+            case 3: ctrl.Color = NextRandom(seed, 0xFFFFFF); ctrl.MarkChanged(); break;
+            case 4: ctrl.SetVisible(!ctrl.IsVisible()); break;
+            case 5: ctrl.SetTransparency(NextRandom(seed, 3) ? 0 : NextRandom(seed, 256)); break;
+            case 6: ctrl.SetEnabled(!ctrl.IsEnabled()); break;
+            case 7:
+                gui.HighlightCtrl = ref_gui.HighlightCtrl = NextRandom(seed, num_ctrls + 1) - 1;
+                gui.MarkControlsChanged();
+                break;
+            case 8:
+                if (NextRandom(seed, 5) == 0 && gui.SetControlZOrder(ctrl.Id, NextRandom(seed, num_ctrls)))
+                    ref_gui.ResortZOrder();
+                break;
+            default:
+                if (NextRandom(seed, 10) == 0)
+                {
+                    gui.BgColor = ref_gui.BgColor = 0xFF000000 | NextRandom(seed, 0xFFFFFF);
+                    gui.MarkChanged();
+                }
+                break;
+            }
+        }
+
+        if (!gui.HasChanged() && gui.DrawChangedControls(bmp.get(), dirty_rects))
+        {
+            partial_updates++;
+        }
+        else
+        {
+            bmp->ClearTransparent();
+            gui.DrawWithControls(bmp.get());
+        }
+        gui.ClearChanged();
+        ref_bmp->ClearTransparent();
+        ref_gui.DrawWithControls(ref_bmp.get());
+
+        for (int y = 0; y < gui_h; ++y)
+        {
+            const uint32_t *line = reinterpret_cast<const uint32_t*>(bmp->GetScanLine(y));
+            const uint32_t *ref_line = reinterpret_cast<const uint32_t*>(ref_bmp->GetScanLine(y));
+            for (int x = 0; x < gui_w; ++x)
+                ASSERT_EQ(ref_line[x], line[x]) << "at step " << step << ", pixel " << x << "," << y;
+        }
+    }
+    ASSERT_GT(partial_updates, 0);
+    guis.clear();
+}
+
+TEST(GUI, DrawChangedControls) {
+    const GuiOptions old_options = GUI::Options;
+    GUI::Options.ClipControls = true;
+    GUI::Options.OutlineControls = false;
+    TestDrawChangedControls(1);
+    GUI::Options.ClipControls = false;
+    GUI::Options.OutlineControls = true;
+    TestDrawChangedControls(2);
+    GUI::Options = old_options;
+}
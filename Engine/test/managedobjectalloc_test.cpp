@@ -0,0 +1,99 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include "gtest/gtest.h"
+#include "ac/dynobj/managedobjectalloc.h"
+
+TEST(ManagedObjectAllocator, ReuseBlocks) {
+    ManagedObjectAllocator alloc;
+    void *a = alloc.Allocate(40);
+    void *b = alloc.Allocate(48); // same size class as 40
+    void *c = alloc.Allocate(100);
+    ASSERT_NE(nullptr, a);
+    ASSERT_NE(nullptr, b);
+    ASSERT_NE(nullptr, c);
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(a) % ManagedObjectAllocator::Granularity);
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(c) % ManagedObjectAllocator::Granularity);
+    memset(a, 1, 40); memset(b, 2, 48); memset(c, 3, 100);
+    EXPECT_EQ(3u, alloc.GetStats().InUse);
+
+    // Freed block is given out again for the same size class only
+    alloc.Free(b, 48);
+    void *d = alloc.Allocate(100);
+    EXPECT_NE(b, d);
+    void *e = alloc.Allocate(33);
+    EXPECT_EQ(b, e);
+    EXPECT_EQ(1u, alloc.GetStats().Reused);
+
+    alloc.Free(a, 40);
+    alloc.Free(c, 100);
+    alloc.Free(d, 100);
+    alloc.Free(e, 33);
+    const auto &stats = alloc.GetStats();
+    EXPECT_EQ(5u, stats.Allocated);
+    EXPECT_EQ(5u, stats.Freed);
+    EXPECT_EQ(0u, stats.InUse);
+    const size_t page_size = ManagedObjectAllocator::PageSize;
+    EXPECT_EQ(page_size, stats.PageMemory);
+}
+
+TEST(ManagedObjectAllocator, LargeBlocks) {
+    ManagedObjectAllocator alloc;
+    const size_t large_size = ManagedObjectAllocator::MaxClassSize + 1;
+    void *a = alloc.Allocate(large_size);
+    void *b = alloc.Allocate(0);
+    ASSERT_NE(nullptr, a);
+    ASSERT_NE(nullptr, b);
+    memset(a, 1, large_size);
+    alloc.Free(a, large_size);
+    alloc.Free(b, 0);
+    alloc.Free(nullptr, 16);
+    EXPECT_EQ(1u, alloc.GetStats().Large);
+    EXPECT_EQ(2u, alloc.GetStats().Freed);
+    EXPECT_EQ(0u, alloc.GetStats().InUse);
+}
+
+TEST(ManagedObjectAllocator, ManyBlocks) {
+    ManagedObjectAllocator alloc;
+    const size_t count = 20000;
+    std::vector<std::pair<uint8_t*, size_t>> blocks;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const size_t size = 1 + (i * 37) % ManagedObjectAllocator::MaxClassSize;
+        uint8_t *mem = static_cast<uint8_t*>(alloc.Allocate(size));
+        memset(mem, static_cast<uint8_t>(i), size);
+        blocks.emplace_back(mem, size);
+    }
+    // Blocks must not overlap, and keep their contents
+    std::vector<std::pair<uint8_t*, size_t>> sorted = blocks;
+    std::sort(sorted.begin(), sorted.end());
+    for (size_t i = 1; i < sorted.size(); ++i)
+        ASSERT_LE(sorted[i - 1].first + sorted[i - 1].second, sorted[i].first);
+    for (size_t i = 0; i < count; ++i)
+        ASSERT_EQ(static_cast<uint8_t>(i), blocks[i].first[blocks[i].second - 1]);
+
+    // Reallocating the same sizes does not take any more pages
+    const size_t page_memory = alloc.GetStats().PageMemory;
+    for (const auto &b : blocks)
+        alloc.Free(b.first, b.second);
+    for (auto &b : blocks)
+        b.first = static_cast<uint8_t*>(alloc.Allocate(b.second));
+    EXPECT_EQ(page_memory, alloc.GetStats().PageMemory);
+    EXPECT_LE(count, alloc.GetStats().Reused);
+    for (const auto &b : blocks)
+        alloc.Free(b.first, b.second);
+    EXPECT_EQ(0u, alloc.GetStats().InUse);
+}
@@ -0,0 +1,258 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+#include <string.h>
+#include <vector>
+#include "gtest/gtest.h"
+#include "ac/dynobj/cc_agsdynamicobject.h"
+#include "ac/dynobj/managedobjectpool.h"
+#include "util/memorystream.h"
+
+using namespace AGS::Common;
+
+// Same as ManagedObjectPool::HANDLE_INDEX_MASK: the slot index part of a handle
+static const int32_t HandleIndexMask = (1 << 22) - 1;
+
+// Manager of the test objects, which are the bytes of its own buffer;
+// counts the disposal attempts, and may refuse to dispose chosen objects
+struct TestObjectManager final : AGSCCDynamicObject {
+    std::vector<char> Memory;
+    std::vector<int> DisposeCalls;
+    std::vector<bool> KeepAlive;
+
+    TestObjectManager(size_t count)
+        : Memory(count), DisposeCalls(count), KeepAlive(count) {}
+
+    const char *Addr(size_t index) const { return &Memory[index]; }
+    size_t Index(const char *address) const { return address - &Memory[0]; }
+
+    int Dispose(const char *address, bool force) override {
+        const size_t index = Index(address);
+        DisposeCalls[index]++;
+        return (force || !KeepAlive[index]) ? 1 : 0;
+    }
+    const char *GetType() override { return "TestObject"; }
+    void Unserialize(int, Stream *, size_t) override {}
+
+protected:
+    size_t CalcSerializeSize() override { return sizeof(int32_t); }
+    void Serialize(const char *address, Stream *out) override {
+        out->WriteInt32(static_cast<int32_t>(Index(address)));
+    }
+};
+
+// Registers the unserialized test objects in the given pool
+struct TestObjectReader final : ICCObjectReader {
+    ManagedObjectPool &Pool;
+    TestObjectManager &Manager;
+
+    TestObjectReader(ManagedObjectPool &objpool, TestObjectManager &mgr)
+        : Pool(objpool), Manager(mgr) {}
+
+    void Unserialize(int index, const char *objectType, const char *serializedData, int dataSize) override {
+        ASSERT_STREQ("TestObject", objectType);
+        ASSERT_EQ(static_cast<int>(sizeof(int32_t)), dataSize);
+        int32_t obj_index;
+        memcpy(&obj_index, serializedData, sizeof(obj_index));
+        Pool.AddUnserializedObject(Manager.Addr(obj_index), &Manager, false, index);
+    }
+};
+
+TEST(ManagedObjectPool, StaleHandles) {
+    ManagedObjectPool objpool;
+    TestObjectManager mgr(4);
+
+    const int32_t h1 = objpool.AddObject(mgr.Addr(0), &mgr, false);
+    ASSERT_GT(h1, 0);
+    EXPECT_EQ(1, objpool.AddRef(h1));
+    EXPECT_EQ(mgr.Addr(0), objpool.HandleToAddress(h1));
+    EXPECT_EQ(0, objpool.SubRef(h1)); // disposed when the last ref is gone
+    EXPECT_EQ(1, mgr.DisposeCalls[0]);
+    EXPECT_EQ(nullptr, objpool.HandleToAddress(h1));
+
+    // New object takes the freed slot, but with the next generation
+    const int32_t h2 = objpool.AddObject(mgr.Addr(1), &mgr, false);
+    ASSERT_GT(h2, 0);
+    EXPECT_EQ(h1 & HandleIndexMask, h2 & HandleIndexMask);
+    EXPECT_NE(h1, h2);
+    EXPECT_EQ(mgr.Addr(1), objpool.HandleToAddress(h2));
+    EXPECT_EQ(1, objpool.AddRef(h2));
+
+    // The stale handle does not refer to the new object in any way
+    void *obj = nullptr;
+    ICCDynamicObject *manager = nullptr;
+    EXPECT_EQ(nullptr, objpool.HandleToAddress(h1));
+    EXPECT_EQ(kScValUndefined, objpool.HandleToAddressAndManager(h1, obj, manager));
+    EXPECT_EQ(0, objpool.AddRef(h1));
+    EXPECT_EQ(0, objpool.SubRef(h1));
+    EXPECT_EQ(1, objpool.CheckDispose(h1));
+    EXPECT_EQ(0, mgr.DisposeCalls[1]);
+    EXPECT_EQ(kScValDynamicObject, objpool.HandleToAddressAndManager(h2, obj, manager));
+    EXPECT_EQ(mgr.Addr(1), obj);
+    EXPECT_EQ(&mgr, manager);
+    EXPECT_EQ(0, objpool.SubRef(h2));
+
+    // Slot is reused again after the next generation is disposed
+    const int32_t h3 = objpool.AddObject(mgr.Addr(2), &mgr, false);
+    EXPECT_EQ(h1 & HandleIndexMask, h3 & HandleIndexMask);
+    EXPECT_NE(h1, h3);
+    EXPECT_NE(h2, h3);
+    EXPECT_EQ(nullptr, objpool.HandleToAddress(h2));
+    EXPECT_EQ(mgr.Addr(2), objpool.HandleToAddress(h3));
+    objpool.reset();
+}
+
+TEST(ManagedObjectPool, AddressToHandle) {
+    ManagedObjectPool objpool;
+    const size_t count = 5000; // more than the initial reserve
+    TestObjectManager mgr(count + 1);
+    std::vector<int32_t> handles(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        handles[i] = objpool.AddObject(mgr.Addr(i), &mgr, false);
+        ASSERT_GT(handles[i], 0);
+    }
+    EXPECT_EQ(0, objpool.AddressToHandle(nullptr));
+    EXPECT_EQ(0, objpool.AddressToHandle(mgr.Addr(count))); // never registered
+    for (size_t i = 0; i < count; ++i)
+        ASSERT_EQ(handles[i], objpool.AddressToHandle(mgr.Addr(i)));
+
+    // Removing objects must not break the lookup of the remaining ones
+    for (size_t i = 0; i < count; i += 3)
+        EXPECT_EQ(1, objpool.RemoveObject(mgr.Addr(i)));
+    for (size_t i = 0; i < count; ++i)
+        ASSERT_EQ((i % 3 == 0) ? 0 : handles[i], objpool.AddressToHandle(mgr.Addr(i))) << "object " << i;
+
+    // Address registered again gets a new handle
+    const int32_t h = objpool.AddObject(mgr.Addr(0), &mgr, false);
+    EXPECT_NE(handles[0], h);
+    EXPECT_EQ(h, objpool.AddressToHandle(mgr.Addr(0)));
+    objpool.reset();
+    EXPECT_EQ(0, objpool.AddressToHandle(mgr.Addr(1)));
+}
+
+TEST(ManagedObjectPool, GarbageCollection) {
+    ManagedObjectPool objpool;
+    // GC runs after this many new objects
+    const size_t gc_interval = 1024;
+    const size_t count = gc_interval + 100;
+    TestObjectManager mgr(count * 2 + gc_interval + 1);
+    std::vector<int32_t> handles(count * 2);
+    // Odd objects are referenced, some of the even ones refuse to be disposed
+    for (size_t i = 0; i < count; ++i)
+    {
+        handles[i] = objpool.AddObject(mgr.Addr(i), &mgr, false);
+        if (i % 2 == 1)
+            objpool.AddRef(handles[i]);
+        mgr.KeepAlive[i] = (i % 10 == 0);
+    }
+    objpool.RunGarbageCollectionIfAppropriate();
+    for (size_t i = 0; i < count; ++i)
+    {
+        ASSERT_EQ((i % 2 == 0) ? 1 : 0, mgr.DisposeCalls[i]) << "object " << i;
+        ASSERT_EQ((i % 2 == 1) || mgr.KeepAlive[i], objpool.HandleToAddress(handles[i]) != nullptr) << "object " << i;
+    }
+
+    // Next collection only retries the objects which refused to be disposed;
+    // new objects are all referenced, and are not disposed either
+    for (size_t i = count; i < count * 2; ++i)
+    {
+        handles[i] = objpool.AddObject(mgr.Addr(i), &mgr, false);
+        objpool.AddRef(handles[i]);
+    }
+    objpool.RunGarbageCollectionIfAppropriate();
+    for (size_t i = 0; i < count * 2; ++i)
+    {
+        const int expect_calls = (i >= count || i % 2 == 1) ? 0 : (mgr.KeepAlive[i] ? 2 : 1);
+        ASSERT_EQ(expect_calls, mgr.DisposeCalls[i]) << "object " << i;
+    }
+
+    // Object which lost its references is disposed right away if it may be,
+    // or else becomes a candidate for the next collection
+    mgr.KeepAlive[count + 1] = true;
+    EXPECT_EQ(0, objpool.SubRef(handles[count]));
+    EXPECT_EQ(0, objpool.SubRef(handles[count + 1]));
+    EXPECT_EQ(1, mgr.DisposeCalls[count]);
+    EXPECT_EQ(1, mgr.DisposeCalls[count + 1]);
+    EXPECT_EQ(nullptr, objpool.HandleToAddress(handles[count]));
+    EXPECT_EQ(mgr.Addr(count + 1), objpool.HandleToAddress(handles[count + 1]));
+    mgr.KeepAlive[count + 1] = false;
+    for (size_t i = 0; i <= gc_interval; ++i)
+        objpool.AddRef(objpool.AddObject(mgr.Addr(count * 2 + i), &mgr, false));
+    objpool.RunGarbageCollectionIfAppropriate();
+    EXPECT_EQ(2, mgr.DisposeCalls[count + 1]);
+    EXPECT_EQ(nullptr, objpool.HandleToAddress(handles[count + 1]));
+    objpool.reset();
+}
+
+TEST(ManagedObjectPool, FreeSlotsAfterUnserialize) {
+    const size_t count = 8;
+    TestObjectManager mgr(count + 3);
+    ManagedObjectPool src_pool;
+    std::vector<int32_t> handles(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        handles[i] = src_pool.AddObject(mgr.Addr(i), &mgr, false);
+        src_pool.AddRef(handles[i]);
+    }
+    // Free two slots in the middle, and one more which is reused at once,
+    // so that its handle has a non-zero generation
+    EXPECT_EQ(1, src_pool.RemoveObject(mgr.Addr(2)));
+    EXPECT_EQ(1, src_pool.RemoveObject(mgr.Addr(5)));
+    EXPECT_EQ(1, src_pool.RemoveObject(mgr.Addr(6)));
+    const int32_t old_handle6 = handles[6];
+    handles[6] = src_pool.AddObject(mgr.Addr(6), &mgr, false);
+    EXPECT_EQ(old_handle6 & HandleIndexMask, handles[6] & HandleIndexMask);
+    EXPECT_NE(old_handle6, handles[6]);
+    src_pool.AddRef(handles[6]);
+    src_pool.AddRef(handles[6]);
+
+    std::vector<uint8_t> data;
+    {
+        VectorStream out(data, kStream_Write);
+        src_pool.WriteToDisk(&out);
+    }
+    src_pool.reset();
+
+    ManagedObjectPool dst_pool;
+    TestObjectReader reader(dst_pool, mgr);
+    {
+        VectorStream in(data);
+        ASSERT_EQ(0, dst_pool.ReadFromDisk(&in, &reader));
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (i == 2 || i == 5)
+            continue;
+        ASSERT_EQ(mgr.Addr(i), dst_pool.HandleToAddress(handles[i])) << "object " << i;
+        ASSERT_EQ(handles[i], dst_pool.AddressToHandle(mgr.Addr(i))) << "object " << i;
+    }
+    EXPECT_EQ(3, dst_pool.AddRef(handles[6])); // ref count was restored
+    EXPECT_EQ(nullptr, dst_pool.HandleToAddress(handles[2]));
+
+    // Free slots left between the restored objects are given out first,
+    // lowest index first, and only then the slots past the last object
+    const int32_t h1 = dst_pool.AddObject(mgr.Addr(count), &mgr, false);
+    const int32_t h2 = dst_pool.AddObject(mgr.Addr(count + 1), &mgr, false);
+    const int32_t h3 = dst_pool.AddObject(mgr.Addr(count + 2), &mgr, false);
+    EXPECT_EQ(handles[2] & HandleIndexMask, h1 & HandleIndexMask);
+    EXPECT_EQ(handles[5] & HandleIndexMask, h2 & HandleIndexMask);
+    EXPECT_EQ((handles[7] & HandleIndexMask) + 1, h3 & HandleIndexMask);
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (i == 2 || i == 5)
+            continue;
+        ASSERT_EQ(mgr.Addr(i), dst_pool.HandleToAddress(handles[i])) << "object " << i;
+    }
+    dst_pool.reset();
+}
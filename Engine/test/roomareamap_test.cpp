@@ -0,0 +1,98 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+#include <memory>
+#include "gtest/gtest.h"
+#include "ac/roomareamap.h"
+#include "gfx/bitmap.h"
+
+using namespace AGS::Common;
+
+static Bitmap *MakeMask()
+{
+    Bitmap *bmp = BitmapHelper::CreateBitmap(40, 30, 8);
+    bmp->Clear(0);
+    bmp->FillRect(Rect(2, 3, 10, 8), 1);
+    bmp->FillRect(Rect(20, 0, 39, 4), 2);
+    bmp->PutPixel(39, 29, 2);
+    bmp->PutPixel(0, 29, 250); // out of area range
+    return bmp;
+}
+
+TEST(RoomAreaMap, SameAsMask) {
+    std::unique_ptr<Bitmap> mask(MakeMask());
+    RoomAreaMap map;
+    map.Build(mask.get(), 16);
+    ASSERT_EQ(mask->GetWidth(), map.GetWidth());
+    ASSERT_EQ(mask->GetHeight(), map.GetHeight());
+    for (int y = -2; y < mask->GetHeight() + 2; ++y)
+        for (int x = -2; x < mask->GetWidth() + 2; ++x)
+            ASSERT_EQ(mask->GetPixel(x, y), map.GetArea(x, y)) << x << "," << y;
+
+    EXPECT_EQ(1, map.GetAreaClamped(5, 5));
+    EXPECT_EQ(0, map.GetAreaClamped(-5, 5));
+    EXPECT_EQ(2, map.GetAreaClamped(100, -1));
+    EXPECT_EQ(2, map.GetAreaClamped(100, 100));
+    EXPECT_EQ(250, map.GetAreaClamped(-1, 100));
+}
+
+TEST(RoomAreaMap, AreaBounds) {
+    std::unique_ptr<Bitmap> mask(MakeMask());
+    RoomAreaMap map;
+    map.Build(mask.get(), 16);
+    EXPECT_FALSE(map.IsEmpty());
+    EXPECT_FALSE(map.HasArea(0));
+    ASSERT_TRUE(map.HasArea(1));
+    ASSERT_TRUE(map.HasArea(2));
+    EXPECT_FALSE(map.HasArea(3));
+    EXPECT_FALSE(map.HasArea(250));
+
+    const Rect r1 = map.GetAreaBounds(1);
+    EXPECT_EQ(2, r1.Left); EXPECT_EQ(3, r1.Top);
+    EXPECT_EQ(10, r1.Right); EXPECT_EQ(8, r1.Bottom);
+    const Rect r2 = map.GetAreaBounds(2);
+    EXPECT_EQ(20, r2.Left); EXPECT_EQ(0, r2.Top);
+    EXPECT_EQ(39, r2.Right); EXPECT_EQ(29, r2.Bottom);
+    EXPECT_LT(map.GetAreaBounds(3).Right, map.GetAreaBounds(3).Left);
+
+    mask->Clear(0);
+    map.Build(mask.get(), 16);
+    EXPECT_TRUE(map.IsEmpty());
+    EXPECT_FALSE(map.HasArea(1));
+}
+
+TEST(RoomAreaMap, Detached) {
+    std::unique_ptr<Bitmap> mask(MakeMask());
+    RoomAreaMap map;
+    map.Build(mask.get(), 16);
+    map.Detach(mask.get());
+    // detached map follows the changes to the mask
+    mask->PutPixel(5, 20, 7);
+    EXPECT_EQ(7, map.GetArea(5, 20));
+    EXPECT_EQ(7, map.GetRow(20)[5]);
+    EXPECT_EQ(-1, map.GetArea(-1, 0));
+    EXPECT_FALSE(map.IsEmpty());
+    // bounds remain from the last build
+    EXPECT_TRUE(map.HasArea(1));
+    EXPECT_FALSE(map.HasArea(7));
+
+    map.Build(mask.get(), 16);
+    mask->PutPixel(5, 20, 0);
+    EXPECT_EQ(7, map.GetArea(5, 20));
+    EXPECT_TRUE(map.HasArea(7));
+
+    map.Reset();
+    EXPECT_EQ(-1, map.GetArea(0, 0));
+    EXPECT_EQ(-1, map.GetAreaClamped(0, 0));
+    EXPECT_TRUE(map.IsEmpty());
+}
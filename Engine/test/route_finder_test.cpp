@@ -0,0 +1,137 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+#include <memory>
+#include <vector>
+#include "gtest/gtest.h"
+#include "ac/movelist.h"
+#include "ac/route_finder_impl.h"
+#include "gfx/bitmap.h"
+#include "test/test_random.h"
+
+using namespace AGS::Common;
+using namespace AGS::Engine;
+
+extern std::vector<MoveList> mls;
+
+// Makes a walls mask with random obstacles and walkable areas
+static Bitmap *MakeWalls(int width, int height, uint32_t &seed)
+{
+    Bitmap *bmp = BitmapHelper::CreateBitmap(width, height, 8);
+    bmp->Clear(1);
+    for (int i = 0; i < 60; ++i)
+    {
+        NextRandom(seed);
+        const int x = (seed >> 8) % width, y = (seed >> 4) % height;
+        const int w = 4 + (seed >> 16) % 40, h = 4 + (seed >> 24) % 30;
+        bmp->FillRect(Rect(x, y, x + w, y + h), (i % 4 == 0) ? (1 + i % 3) : 0);
+    }
+    return bmp;
+}
+
+static void AssertSameMoveList(const MoveList &ml1, const MoveList &ml2)
+{
+    ASSERT_EQ(ml1.numstage, ml2.numstage);
+    for (int i = 0; i < ml1.numstage; ++i)
+        ASSERT_EQ(ml1.pos[i], ml2.pos[i]);
+    // the last stage has no movement
+    for (int i = 0; i < ml1.numstage - 1; ++i)
+    {
+        ASSERT_EQ(ml1.xpermove[i], ml2.xpermove[i]);
+        ASSERT_EQ(ml1.ypermove[i], ml2.ypermove[i]);
+    }
+    ASSERT_EQ(ml1.fromx, ml2.fromx);
+    ASSERT_EQ(ml1.fromy, ml2.fromy);
+    ASSERT_EQ(ml1.onstage, ml2.onstage);
+    ASSERT_EQ(ml1.doneflag, ml2.doneflag);
+}
+
+TEST(RouteFinder, BatchSameAsSequential) {
+    const int num_movelists = 24;
+    const int num_requests = 60;
+    uint32_t seed = 7;
+    std::unique_ptr<Bitmap> walls[] = { std::unique_ptr<Bitmap>(MakeWalls(320, 200, seed)),
+        std::unique_ptr<Bitmap>(MakeWalls(320, 200, seed)) };
+
+    std::vector<RouteRequest> requests(num_requests);
+    for (int i = 0; i < num_requests; ++i)
+    {
+        RouteRequest &req = requests[i];
+        NextRandom(seed);
+        req.SrcX = (seed >> 4) % 320;
+        req.SrcY = (seed >> 12) % 200;
+        req.DstX = (seed >> 16) % 320;
+        req.DstY = (seed >> 20) % 200;
+        req.Wallscreen = walls[i % 2].get();
+        // some move lists are written more than once
+        req.MoveList = 1 + i % (num_movelists - 1);
+        req.NoCross = (i % 3 != 0);
+        req.IgnoreWalls = (i % 11 == 0);
+        req.MoveSpeedX = 1 + i % 4;
+        req.MoveSpeedY = (i % 5 == 0) ? -2 : 1 + i % 3;
+    }
+
+    // Sequential calls
+    mls.assign(num_movelists, MoveList());
+    std::vector<int> seq_results;
+    for (const auto &req : requests)
+    {
+        RouteFinder::set_route_move_speed(req.MoveSpeedX, req.MoveSpeedY);
+        seq_results.push_back(RouteFinder::find_route(req.SrcX, req.SrcY, req.DstX, req.DstY,
+            req.Wallscreen, req.MoveList, req.NoCross, req.IgnoreWalls));
+    }
+    const std::vector<MoveList> seq_mls = mls;
+    int found = 0;
+    for (int result : seq_results)
+        found += (result > 0);
+    ASSERT_GT(found, num_requests / 2);
+
+    // Same requests in a batch, repeated to also use the cached routes
+    RouteFinder::shutdown_pathfinder();
+    for (int pass = 0; pass < 4; ++pass)
+    {
+        RouteFinder::set_pathfinder_threads(1 + pass / 2 * 3);
+        mls.assign(num_movelists, MoveList());
+        RouteFinder::find_routes(requests.data(), requests.size());
+        for (int i = 0; i < num_requests; ++i)
+            ASSERT_EQ(seq_results[i], requests[i].Result);
+        for (int i = 0; i < num_movelists; ++i)
+            AssertSameMoveList(seq_mls[i], mls[i]);
+    }
+    RouteFinder::shutdown_pathfinder();
+    mls.clear();
+}
+
+TEST(RouteFinder, Instances) {
+    uint32_t seed = 3;
+    std::unique_ptr<Bitmap> walls(MakeWalls(200, 150, seed));
+    RouteFinder::JPSRouteFinder finder1, finder2;
+    finder1.SetMoveSpeed(3, 3);
+    finder2.SetMoveSpeed(3, 3);
+    MoveList ml1, ml2;
+    walls->FillRect(Rect(0, 0, 10, 149), 1);
+    walls->FillRect(Rect(190, 0, 199, 149), 1);
+    walls->FillRect(Rect(0, 140, 199, 149), 1);
+    ASSERT_TRUE(finder1.FindRoute(5, 5, 195, 5, walls.get(), ml1, 1));
+    ASSERT_TRUE(finder2.FindRoute(5, 5, 195, 5, walls.get(), ml2, 1));
+    AssertSameMoveList(ml1, ml2);
+    ASSERT_EQ(ml1.pos[0], (5 << 16) | 5);
+    ASSERT_EQ(ml1.pos[ml1.numstage - 1], (195 << 16) | 5);
+    // Changing walls invalidates the found routes;
+    // when the destination is cut off the route leads to the closest point
+    walls->FillRect(Rect(100, 0, 100, 149), 0);
+    ASSERT_TRUE(finder1.FindRoute(5, 5, 195, 5, walls.get(), ml1, 1));
+    ASSERT_NE(ml1.pos[ml1.numstage - 1], (195 << 16) | 5);
+    ASSERT_FALSE(finder1.CanSeeFrom(5, 5, 195, 5));
+    ASSERT_TRUE(finder2.CanSeeFrom(5, 5, 5, 140));
+}
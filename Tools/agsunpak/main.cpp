@@ -1,16 +1,23 @@
 #include <algorithm>
+#include <chrono>
 #include <stdio.h>
+#if !defined(AGS_DISABLE_THREADS)
+#include <thread>
+#endif
 #include "data/mfl_utils.h"
 #include "util/file.h"
 #include "util/multifilelib.h"
 #include "util/path.h"
 #include "util/stdio_compat.h"
 #include "util/string_compat.h"
+#include "util/string_utils.h"
 
 using namespace AGS::Common;
 using namespace AGS::DataUtil;
 
-const char *HELP_STRING = "Usage: agsunpak <input-pak> <output-dir>";
+const char *HELP_STRING = "Usage: agsunpak <input-pak> <output-dir> [OPTIONS]\n"
+"Options:\n"
+"  -j, --jobs <N> extract up to N files in parallel (default: number of CPUs)";
 
 int main(int argc, char *argv[])
 {
@@ -32,6 +39,26 @@ int main(int argc, char *argv[])
         return -1;
     }
 
+    int jobs = 0;
+    for (int i = 3; i < argc; ++i)
+    {
+        if ((ags_stricmp(argv[i], "-j") == 0 || ags_stricmp(argv[i], "--jobs") == 0) && (i < argc - 1))
+        {
+            jobs = StrUtil::StringToInt(argv[++i]);
+            if (jobs <= 0)
+            {
+                printf("Error: invalid number of jobs: %s\n", argv[i]);
+                return -1;
+            }
+        }
+    }
+#if !defined(AGS_DISABLE_THREADS)
+    if (jobs == 0)
+        jobs = std::max(1, (int)std::thread::hardware_concurrency());
+#else
+    jobs = 1;
+#endif
+
     const char *src = argv[1];
     const char *dst = argv[2];
     printf("Input pack file: %s\n", src);
@@ -78,12 +105,20 @@ int main(int argc, char *argv[])
     // file we just opened, because it may be different from the name
     // saved in lib; e.g. if the lib was attached to *.exe.
     lib.LibFileNames[0] = lib_basefile;
-    HError err = UnpackLibrary(lib, lib_dir, dst);
+    typedef std::chrono::steady_clock Clock;
+    const auto start = Clock::now();
+    HError err = UnpackLibrary(lib, lib_dir, dst, jobs);
     if (!err)
     {
         printf("Failed unpacking the library\n%s", err->FullMessage().GetCStr());
         return -1;
     }
-    printf("Done.\n");
+    const double unpack_sec = std::chrono::duration<double>(Clock::now() - start).count();
+    soff_t total_size = 0;
+    for (const auto &asset : lib.AssetInfos)
+        total_size += asset.Size;
+    const double total_mb = total_size / (1024.0 * 1024.0);
+    printf("Extracted %zu assets (%.1f MB) in %.3f s (%.1f MB/s), using %d job(s)\nDone.\n",
+        lib.AssetInfos.size(), total_mb, unpack_sec, unpack_sec > 0.0 ? total_mb / unpack_sec : 0.0, jobs);
     return 0;
 }
@@ -12,9 +12,16 @@
 //
 //=============================================================================
 #include "data/mfl_utils.h"
+#include <algorithm>
 #include <memory>
+#include <stdexcept>
+#if !defined(AGS_DISABLE_THREADS)
+#include <atomic>
+#include <thread>
+#endif
 #include "util/directory.h"
 #include "util/file.h"
+#include "util/filestream.h"
 #include "util/path.h"
 #include "util/stream.h"
 
@@ -28,44 +35,147 @@ namespace DataUtil
 // TODO: might replace "printf" with the logging functions,
 // but then we'd also need to make sure they are initialized in tools
 
-HError UnpackLibrary(const AssetLibInfo &lib, const String &lib_dir, const String &dst_dir)
+// Size of the buffer used when copying asset data between files
+static const size_t CopyBufferSize = 1024 * 1024;
+
+// CopyContext holds the resources of a single copying thread
+struct CopyContext
+{
+    std::vector<uint8_t> Buffer;
+    std::unique_ptr<Stream> LibFile; // library file opened by this thread
+};
+
+// Opens a file stream without the intermediate buffering,
+// which is only in the way when the data is copied in large chunks
+static Stream *OpenFileUnbuffered(const String &filename, FileOpenMode open_mode, FileWorkMode work_mode)
+{
+    try
+    {
+        std::unique_ptr<Stream> fs(new FileStream(filename, open_mode, work_mode));
+        return fs->IsValid() ? fs.release() : nullptr;
+    }
+    catch (const std::runtime_error &)
+    {
+        return nullptr;
+    }
+}
+
+// Copies the data between streams through the context's buffer
+static soff_t CopyStreamData(Stream *in, Stream *out, soff_t length, CopyContext &ctx)
+{
+    ctx.Buffer.resize(CopyBufferSize);
+    soff_t wrote_num = 0;
+    while (length > 0)
+    {
+        const size_t to_read = static_cast<size_t>(std::min<soff_t>(ctx.Buffer.size(), length));
+        const size_t was_read = in->Read(ctx.Buffer.data(), to_read);
+        if (was_read == 0)
+            break;
+        const size_t wrote = out->Write(ctx.Buffer.data(), was_read);
+        wrote_num += wrote;
+        if (wrote < was_read)
+            break;
+        length -= was_read;
+    }
+    return wrote_num;
+}
+
+// Runs the job for each index in [0, count), using up to the given number of threads;
+// the job function receives the index and the thread's copying context
+template <typename TJobFunc>
+static void RunCopyJobs(size_t count, int jobs, TJobFunc job)
+{
+#if !defined(AGS_DISABLE_THREADS)
+    const size_t thread_count = std::min(static_cast<size_t>(std::max(1, jobs)), count);
+    if (thread_count > 1)
+    {
+        // each thread takes the next job in line, until there are none left
+        std::atomic<size_t> next_job(0);
+        auto worker = [&]()
+        {
+            CopyContext ctx;
+            for (size_t i = next_job++; i < count; i = next_job++)
+                job(i, ctx);
+        };
+        std::vector<std::thread> threads;
+        for (size_t i = 1; i < thread_count; ++i)
+            threads.emplace_back(worker);
+        worker(); // calling thread does its share too
+        for (auto &thread : threads)
+            thread.join();
+        return;
+    }
+#endif
+    CopyContext ctx;
+    for (size_t i = 0; i < count; ++i)
+        job(i, ctx);
+}
+
+HError UnpackLibrary(const AssetLibInfo &lib, const String &lib_dir, const String &dst_dir, int jobs)
 {
     for (size_t i = 0; i < lib.LibFileNames.size(); ++i)
     {
         String lib_f = lib.LibFileNames[i];
         String path = Path::ConcatPaths(lib_dir, lib_f);
-        std::unique_ptr<Stream> lib_in(File::OpenFileRead(path));
-        if (!lib_in)
+        if (!File::IsFile(path))
         {
             return new Error(String::FromFormat("Failed to open a library file for reading: %s",
                 lib_f.GetCStr()));
         }
         printf("Extracting %s:\n", lib_f.GetCStr());
+
+        // Prepare the output locations first; the subdirectories are created
+        // here, so that the threads would not compete making the same ones
+        std::vector<const AssetInfo*> assets;
+        std::vector<String> dst_files;
+        std::vector<String> results;
         for (const auto &asset : lib.AssetInfos)
         {
             if (asset.LibUid != i) continue;
-            String dst_f = Path::ConcatPaths(dst_dir, asset.FileName);
             String sub_dir = Path::GetParent(asset.FileName);
             if (!sub_dir.IsEmpty() && sub_dir != "." &&
                 !Directory::CreateAllDirectories(dst_dir, sub_dir))
             {
-                printf("Error: unable to create a subdirectory: %s\n", sub_dir.GetCStr());
+                results.push_back(String::FromFormat("Error: unable to create a subdirectory: %s", sub_dir.GetCStr()));
                 continue;
             }
-            std::unique_ptr<Stream> out(File::CreateFile(dst_f));
+            assets.push_back(&asset);
+            dst_files.push_back(Path::ConcatPaths(dst_dir, asset.FileName));
+        }
+        for (const auto &msg : results)
+            printf("%s\n", msg.GetCStr());
+
+        // Each thread reads from its own library file handle,
+        // and reports the result in the asset's slot
+        results.clear();
+        results.resize(assets.size());
+        RunCopyJobs(assets.size(), jobs, [&](size_t index, CopyContext &ctx)
+        {
+            const AssetInfo &asset = *assets[index];
+            if (!ctx.LibFile)
+                ctx.LibFile.reset(OpenFileUnbuffered(path, kFile_Open, kFile_Read));
+            if (!ctx.LibFile)
+            {
+                results[index] = String::FromFormat("Error: unable to read the library file for: %s", asset.FileName.GetCStr());
+                return;
+            }
+            std::unique_ptr<Stream> out(OpenFileUnbuffered(dst_files[index], kFile_CreateAlways, kFile_Write));
             if (!out)
             {
-                printf("Error: unable to open a file for writing: %s\n", asset.FileName.GetCStr());
-                continue;
+                results[index] = String::FromFormat("Error: unable to open a file for writing: %s", asset.FileName.GetCStr());
+                return;
             }
-            lib_in->Seek(asset.Offset, kSeekBegin);
-            soff_t wrote = CopyStream(lib_in.get(), out.get(), asset.Size);
+            ctx.LibFile->Seek(asset.Offset, kSeekBegin);
+            soff_t wrote = CopyStreamData(ctx.LibFile.get(), out.get(), asset.Size, ctx);
             if (wrote == asset.Size)
-                printf("+ %s\n", asset.FileName.GetCStr());
+                results[index] = String::FromFormat("+ %s", asset.FileName.GetCStr());
             else
-                printf("Error: file was not written correctly: %s\n Expected: %jd, wrote: %jd bytes\n",
+                results[index] = String::FromFormat("Error: file was not written correctly: %s\n Expected: %jd, wrote: %jd bytes",
                     asset.FileName.GetCStr(), static_cast<intmax_t>(asset.Size), static_cast<intmax_t>(wrote));
-        }
+        });
+        // Print results in the order of assets, regardless of which were done first
+        for (const auto &msg : results)
+            printf("%s\n", msg.GetCStr());
     }
     return HError::None();
 }
@@ -140,41 +250,87 @@ HError MakeAssetLib(AssetLibInfo &lib, const String &lib_basefile,
 }
 
 HError WriteLibraryFile(AssetLibInfo &lib, const String &asset_dir,
-    const String &lib_filename, MFLUtil::MFLVersion lib_version, int lib_index)
+    const String &lib_filename, MFLUtil::MFLVersion lib_version, int lib_index, int jobs)
 {
-    std::unique_ptr<Stream> out(File::CreateFile(lib_filename));
+    std::unique_ptr<Stream> out(OpenFileUnbuffered(lib_filename, kFile_CreateAlways, kFile_Write));
     if (!out)
         return new Error("Error: failed to open pack file for writing.");
 
-    soff_t s_offset = out->GetPosition();
+    // Assign the asset offsets in advance, so that the complete header and
+    // ender could be written first, and the assets copied in any order after
+    const soff_t s_offset = out->GetPosition();
     MFLUtil::WriteHeader(lib, MFLUtil::kMFLVersion_MultiV30, lib_index, out.get());
+    soff_t data_end = out->GetPosition();
+    std::vector<AssetInfo*> assets;
+    std::vector<String> src_files;
     for (auto &asset : lib.AssetInfos)
     {
         if (asset.LibUid == lib_index)
         {
-            asset.Offset = out->GetPosition() - s_offset;
-            String path = Path::ConcatPaths(asset_dir, asset.FileName);
-            std::unique_ptr<Stream> in(File::OpenFileRead(path));
-            if (!in)
-                return new Error("Failed to open the file for reading.");
-            if (CopyStream(in.get(), out.get(), asset.Size) < asset.Size)
-                return new Error(String::FromFormat("Failed to write the asset '%s'.", asset.FileName.GetCStr()));
+            asset.Offset = data_end - s_offset;
+            data_end += asset.Size;
+            assets.push_back(&asset);
+            src_files.push_back(Path::ConcatPaths(asset_dir, asset.FileName));
         }
     }
     out->Seek(s_offset, kSeekBegin);
     MFLUtil::WriteHeader(lib, MFLUtil::kMFLVersion_MultiV30, lib_index, out.get());
-    out->Seek(0, kSeekEnd);
+    out->Seek(data_end, kSeekBegin);
     MFLUtil::WriteEnder(s_offset, lib_version, out.get());
+    out.reset();
+
+    // Each thread writes into the pack file through its own handle,
+    // every asset has its own place in the file, so they never overlap
+    std::vector<String> errors(assets.size());
+#if !defined(AGS_DISABLE_THREADS)
+    std::atomic<bool> failed(false);
+#else
+    bool failed = false;
+#endif
+    RunCopyJobs(assets.size(), jobs, [&](size_t index, CopyContext &ctx)
+    {
+        if (failed)
+            return; // don't bother with the rest
+        const AssetInfo &asset = *assets[index];
+        if (!ctx.LibFile)
+            ctx.LibFile.reset(OpenFileUnbuffered(lib_filename, kFile_Open, kFile_Write));
+        if (!ctx.LibFile)
+        {
+            errors[index] = "Error: failed to open pack file for writing.";
+            failed = true;
+            return;
+        }
+        std::unique_ptr<Stream> in(OpenFileUnbuffered(src_files[index], kFile_Open, kFile_Read));
+        if (!in)
+        {
+            errors[index] = "Failed to open the file for reading.";
+            failed = true;
+            return;
+        }
+        ctx.LibFile->Seek(s_offset + asset.Offset, kSeekBegin);
+        if (CopyStreamData(in.get(), ctx.LibFile.get(), asset.Size, ctx) < asset.Size)
+        {
+            errors[index] = String::FromFormat("Failed to write the asset '%s'.", asset.FileName.GetCStr());
+            failed = true;
+        }
+    });
+    for (const auto &err : errors)
+    {
+        if (!err.IsEmpty())
+            return new Error(err);
+    }
     return HError::None();
 }
 
 HError WriteLibrary(AssetLibInfo &lib, const String &asset_dir,
-    const String &dst_dir, MFLUtil::MFLVersion lib_version)
+    const String &dst_dir, MFLUtil::MFLVersion lib_version, int jobs)
 {
-    for (size_t id = 0; id < lib.LibFileNames.size(); ++id)
+    // The first file holds the table of contents for all the partitions,
+    // so it's written last, when the offsets in other files are known
+    for (size_t id = lib.LibFileNames.size(); id-- > 0;)
     {
         String dst_file = Path::ConcatPaths(dst_dir, lib.LibFileNames[id]);
-        HError err = WriteLibraryFile(lib, asset_dir, dst_file, lib_version, id);
+        HError err = WriteLibraryFile(lib, asset_dir, dst_file, lib_version, id, jobs);
         if (!err)
             return err;
     }
@@ -34,7 +34,9 @@ namespace DataUtil
     // The output files will be written into dst_dir directory;
     // if the asset name contains directories, they will be created as sub-
     // directories inside dst_dir.
-    HError UnpackLibrary(const AssetLibInfo &lib, const String &lib_dir, const String &dst_dir);
+    // jobs - tells how many files may be extracted in parallel.
+    HError UnpackLibrary(const AssetLibInfo &lib, const String &lib_dir, const String &dst_dir,
+        int jobs = 1);
     // Gather a list of files from a given directory
     HError MakeAssetList(std::vector<AssetInfo> &assets, const String &asset_dir,
         bool do_subdirs, const String &lib_basefile);
@@ -44,12 +46,15 @@ namespace DataUtil
         std::vector<AssetInfo> &assets, soff_t part_size = 0);
     // Writes the library partition into the file lib_filename;
     // recalculates asset offsets and stores in lib as it goes.
+    // jobs - tells how many assets may be copied into the file in parallel;
+    // the result does not depend on the number of jobs.
     HError WriteLibraryFile(AssetLibInfo &lib, const String &src_dir,
-        const String &lib_filename, AGS::Common::MFLUtil::MFLVersion lib_version, int lib_index);
+        const String &lib_filename, AGS::Common::MFLUtil::MFLVersion lib_version, int lib_index,
+        int jobs = 1);
     // Writes the potentially multi-file library into the dst_dir directory;
     // recalculates asset offsets and stores in lib as it goes.
     HError WriteLibrary(AssetLibInfo &lib, const String &asset_dir,
-        const String &dst_dir, AGS::Common::MFLUtil::MFLVersion lib_version);
+        const String &dst_dir, AGS::Common::MFLUtil::MFLVersion lib_version, int jobs = 1);
 
 } // namespace DataUtil
 } // namespace AGS
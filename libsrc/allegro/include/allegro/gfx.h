@@ -297,6 +297,7 @@ AL_FUNC(int, get_color_conversion, (void));
 AL_FUNC(BITMAP *, create_bitmap, (int width, int height));
 AL_FUNC(BITMAP *, create_bitmap_ex, (int color_depth, int width, int height));
 AL_FUNC(BITMAP *, create_sub_bitmap, (BITMAP *parent, int x, int y, int width, int height));
+AL_FUNC(BITMAP *, create_bitmap_on_data, (int color_depth, int width, int height, void *data));
 AL_FUNC(void, destroy_bitmap, (BITMAP *bitmap));
 AL_FUNC(void, set_clip_rect, (BITMAP *bitmap, int x1, int y_1, int x2, int y2));
 AL_FUNC(void, add_clip_rect, (BITMAP *bitmap, int x1, int y_1, int x2, int y2));
@@ -217,22 +217,24 @@ AL_ARRAY(int, _palette_color16);
 AL_ARRAY(int, _palette_color24);
 AL_ARRAY(int, _palette_color32);
 
-/* truecolor blending functions */
-AL_VAR(BLENDER_FUNC, _blender_func15);
-AL_VAR(BLENDER_FUNC, _blender_func16);
-AL_VAR(BLENDER_FUNC, _blender_func24);
-AL_VAR(BLENDER_FUNC, _blender_func32);
-
-AL_VAR(BLENDER_FUNC, _blender_func15x);
-AL_VAR(BLENDER_FUNC, _blender_func16x);
-AL_VAR(BLENDER_FUNC, _blender_func24x);
-
-AL_VAR(int, _blender_col_15);
-AL_VAR(int, _blender_col_16);
-AL_VAR(int, _blender_col_24);
-AL_VAR(int, _blender_col_32);
-
-AL_VAR(int, _blender_alpha);
+/* truecolor blending functions; the blender state is kept per thread,
+ * so that different threads may draw with different blenders at once
+ */
+AL_VAR(AL_THREAD_LOCAL BLENDER_FUNC, _blender_func15);
+AL_VAR(AL_THREAD_LOCAL BLENDER_FUNC, _blender_func16);
+AL_VAR(AL_THREAD_LOCAL BLENDER_FUNC, _blender_func24);
+AL_VAR(AL_THREAD_LOCAL BLENDER_FUNC, _blender_func32);
+
+AL_VAR(AL_THREAD_LOCAL BLENDER_FUNC, _blender_func15x);
+AL_VAR(AL_THREAD_LOCAL BLENDER_FUNC, _blender_func16x);
+AL_VAR(AL_THREAD_LOCAL BLENDER_FUNC, _blender_func24x);
+
+AL_VAR(AL_THREAD_LOCAL int, _blender_col_15);
+AL_VAR(AL_THREAD_LOCAL int, _blender_col_16);
+AL_VAR(AL_THREAD_LOCAL int, _blender_col_24);
+AL_VAR(AL_THREAD_LOCAL int, _blender_col_32);
+
+AL_VAR(AL_THREAD_LOCAL int, _blender_alpha);
 
 AL_FUNC(unsigned long, _blender_black, (unsigned long x, unsigned long y, unsigned long n));
 
@@ -219,6 +219,14 @@
    #define AL_VAR(type, name)                      extern type name
 #endif
 
+#ifndef AL_THREAD_LOCAL
+   #if defined _MSC_VER
+      #define AL_THREAD_LOCAL                      __declspec(thread)
+   #else
+      #define AL_THREAD_LOCAL                      __thread
+   #endif
+#endif
+
 #ifndef AL_ARRAY
    #define AL_ARRAY(type, name)                    extern type name[]
 #endif
@@ -51,21 +51,21 @@ int _palette_color32[256];
 
 int *palette_color = _palette_color8; 
 
-BLENDER_FUNC _blender_func15 = NULL;   /* truecolor pixel blender routines */
-BLENDER_FUNC _blender_func16 = NULL;
-BLENDER_FUNC _blender_func24 = NULL;
-BLENDER_FUNC _blender_func32 = NULL;
+AL_THREAD_LOCAL BLENDER_FUNC _blender_func15 = NULL;   /* truecolor pixel blender routines */
+AL_THREAD_LOCAL BLENDER_FUNC _blender_func16 = NULL;
+AL_THREAD_LOCAL BLENDER_FUNC _blender_func24 = NULL;
+AL_THREAD_LOCAL BLENDER_FUNC _blender_func32 = NULL;
 
-BLENDER_FUNC _blender_func15x = NULL;
-BLENDER_FUNC _blender_func16x = NULL;
-BLENDER_FUNC _blender_func24x = NULL;
+AL_THREAD_LOCAL BLENDER_FUNC _blender_func15x = NULL;
+AL_THREAD_LOCAL BLENDER_FUNC _blender_func16x = NULL;
+AL_THREAD_LOCAL BLENDER_FUNC _blender_func24x = NULL;
 
-int _blender_col_15 = 0;               /* for truecolor lit sprites */
-int _blender_col_16 = 0;
-int _blender_col_24 = 0;
-int _blender_col_32 = 0;
+AL_THREAD_LOCAL int _blender_col_15 = 0;               /* for truecolor lit sprites */
+AL_THREAD_LOCAL int _blender_col_16 = 0;
+AL_THREAD_LOCAL int _blender_col_24 = 0;
+AL_THREAD_LOCAL int _blender_col_32 = 0;
 
-int _blender_alpha = 0;                /* for truecolor translucent drawing */
+AL_THREAD_LOCAL int _blender_alpha = 0;                /* for truecolor translucent drawing */
 
 int _rgb_r_shift_15 = DEFAULT_RGB_R_SHIFT_15;     /* truecolor pixel format */
 int _rgb_g_shift_15 = DEFAULT_RGB_G_SHIFT_15;
@@ -347,6 +347,54 @@ BITMAP *create_bitmap(int width, int height)
 
 
 
+/* create_bitmap_on_data:
+ *  Creates a memory bitmap which uses the provided pixel buffer instead of
+ *  allocating its own. The buffer must contain width * height tightly packed
+ *  pixels of the given color depth and stay valid for the bitmap's lifetime;
+ *  it is not freed when the bitmap is destroyed.
+ */
+BITMAP *create_bitmap_on_data(int color_depth, int width, int height, void *data)
+{
+   GFX_VTABLE *vtable;
+   BITMAP *bitmap;
+   int nr_pointers;
+   int i;
+
+   ASSERT(width >= 0);
+   ASSERT(height > 0);
+   ASSERT(data);
+
+   vtable = _get_vtable(color_depth);
+   if (!vtable)
+      return NULL;
+
+   nr_pointers = MAX(2, height);
+   bitmap = _AL_MALLOC(sizeof(BITMAP) + (sizeof(char *) * nr_pointers));
+   if (!bitmap)
+      return NULL;
+
+   bitmap->dat = NULL; /* not owned, see destroy_bitmap() */
+   bitmap->w = bitmap->cr = width;
+   bitmap->h = bitmap->cb = height;
+   bitmap->clip = TRUE;
+   bitmap->cl = bitmap->ct = 0;
+   bitmap->vtable = vtable;
+   bitmap->write_bank = bitmap->read_bank = _stub_bank_switch;
+   bitmap->id = 0;
+   bitmap->extra = NULL;
+   bitmap->x_ofs = 0;
+   bitmap->y_ofs = 0;
+   bitmap->seg = _default_ds();
+
+   bitmap->line[0] = data;
+   for (i=1; i<height; i++)
+      bitmap->line[i] = bitmap->line[i-1] + width * BYTES_PER_PIXEL(color_depth);
+
+   return bitmap;
+}
+
+
+
 /* create_sub_bitmap:
  *  Creates a sub bitmap, ie. a bitmap sharing drawing memory with a
  *  pre-existing bitmap, but possibly with different clipping settings.